@@ -0,0 +1,189 @@
+//
+//  MrsWatsonBenchMain.c
+//  MrsWatson
+//
+//  Created by Nik Reiman on 5/19/13.
+//  Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app/ProgramOption.h"
+#include "audio/AudioSettings.h"
+#include "audio/SampleConversion.h"
+#include "base/CharString.h"
+#include "base/FileUtilities.h"
+#include "base/StringUtilities.h"
+#include "base/LinkedList.h"
+#include "logging/EventLogger.h"
+#include "sequencer/AudioClock.h"
+#include "unit/BenchmarkRunner.h"
+
+#include "MrsWatsonBenchMain.h"
+
+extern BenchmarkSuite addEventLoggerBenchmarks(void);
+extern BenchmarkSuite addMidiSequenceBenchmarks(void);
+extern BenchmarkSuite addPluginChainBenchmarks(void);
+extern BenchmarkSuite addSampleBufferBenchmarks(void);
+extern BenchmarkSuite addSampleConversionBenchmarks(void);
+extern BenchmarkSuite addSampleSourcePcmBenchmarks(void);
+
+// Default trial length and count, and the shorter ones used with --quick
+static const double kBenchmarkTrialTimeInMs = 100.0;
+static const int kBenchmarkNumTrials = 7;
+static const double kBenchmarkQuickTrialTimeInMs = 5.0;
+static const int kBenchmarkQuickNumTrials = 3;
+
+static ProgramOptions _newBenchProgramOptions(void) {
+  ProgramOptions programOptions = newProgramOptions(NUM_BENCH_OPTIONS);
+
+  programOptionsAdd(programOptions, newProgramOptionWithValues(OPTION_BENCH_SUITE, "suite",
+    "Run only a single benchmark suite (use '--list' to see all suite names)",
+    true, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+  programOptionsAdd(programOptions, newProgramOptionWithValues(OPTION_BENCH_OUTPUT, "output",
+    "Write JSON results to this file instead of standard output. Progress is always \
+printed to standard error.",
+    true, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+  programOptionsAdd(programOptions, newProgramOptionWithValues(OPTION_BENCH_QUICK, "quick",
+    "Use short and few trials. Results are noisier, but this is useful for checking \
+that all benchmarks run.",
+    true, kProgramOptionArgumentTypeNone, NO_DEFAULT_VALUE));
+  programOptionsAdd(programOptions, newProgramOptionWithValues(OPTION_BENCH_LIST, "list",
+    "List all benchmark suites and their benchmarks",
+    true, kProgramOptionArgumentTypeNone, NO_DEFAULT_VALUE));
+  programOptionsAdd(programOptions, newProgramOptionWithValues(OPTION_BENCH_HELP, "help",
+    "Print full program help (this screen), or just the help for a single argument.",
+    true, kProgramOptionArgumentTypeOptional, NO_DEFAULT_VALUE));
+
+  return programOptions;
+}
+
+static LinkedList _getBenchmarkSuites(void) {
+  LinkedList benchmarkSuites = newLinkedList();
+  linkedListAppend(benchmarkSuites, addSampleBufferBenchmarks());
+  linkedListAppend(benchmarkSuites, addSampleConversionBenchmarks());
+  linkedListAppend(benchmarkSuites, addSampleSourcePcmBenchmarks());
+  linkedListAppend(benchmarkSuites, addMidiSequenceBenchmarks());
+  linkedListAppend(benchmarkSuites, addPluginChainBenchmarks());
+  linkedListAppend(benchmarkSuites, addEventLoggerBenchmarks());
+  return benchmarkSuites;
+}
+
+static void _printBenchmarkCaseName(void* item, void* extraData) {
+  BenchmarkCase benchmarkCase = (BenchmarkCase)item;
+  BenchmarkSuite benchmarkSuite = (BenchmarkSuite)extraData;
+  printf("%s:%s\n", benchmarkSuite->name, benchmarkCase->name);
+}
+
+static void _printBenchmarkSuite(void* item, void* extraData) {
+  BenchmarkSuite benchmarkSuite = (BenchmarkSuite)item;
+  linkedListForeach(benchmarkSuite->benchmarkCases, _printBenchmarkCaseName, benchmarkSuite);
+}
+
+static BenchmarkSuite _findBenchmarkSuite(LinkedList benchmarkSuites, const CharString name) {
+  LinkedListIterator iterator = benchmarkSuites;
+  BenchmarkSuite benchmarkSuite;
+
+  while(iterator != NULL && iterator->item != NULL) {
+    benchmarkSuite = (BenchmarkSuite)iterator->item;
+    if(charStringIsEqualToCString(name, benchmarkSuite->name, true)) {
+      return benchmarkSuite;
+    }
+    iterator = iterator->nextItem;
+  }
+  return NULL;
+}
+
+static void _freeBenchmarkSuite(void* item) {
+  freeBenchmarkSuite((BenchmarkSuite)item);
+}
+
+int main(int argc, char* argv[]) {
+  ProgramOptions programOptions;
+  LinkedList benchmarkSuites;
+  BenchmarkSuite benchmarkSuite = NULL;
+  BenchmarkRunner benchmarkRunner;
+  FILE* output = stdout;
+  boolByte quick;
+  int numFailed;
+
+  programOptions = _newBenchProgramOptions();
+  if(!programOptionsParseArgs(programOptions, argc, argv)) {
+    printf("Or run %s --help (option) to see help for a single option\n", getFileBasename(argv[0]));
+    return -1;
+  }
+
+  if(programOptions->options[OPTION_BENCH_HELP]->enabled) {
+    printf("Run with '--help full' to see extended help for all options.\n");
+    if(charStringIsEmpty(programOptions->options[OPTION_BENCH_HELP]->argument)) {
+      printf("All options, where <argument> is required and [argument] is optional\n");
+      programOptionsPrintHelp(programOptions, false, DEFAULT_INDENT_SIZE);
+    }
+    else {
+      programOptionsPrintHelp(programOptions, true, DEFAULT_INDENT_SIZE);
+    }
+    return -1;
+  }
+
+  // The code being measured expects the same global state as the host
+  initEventLogger();
+  setLogLevel(LOG_ERROR);
+  initAudioSettings();
+  initAudioClock();
+  benchmarkSuites = _getBenchmarkSuites();
+
+  if(programOptions->options[OPTION_BENCH_LIST]->enabled) {
+    linkedListForeach(benchmarkSuites, _printBenchmarkSuite, NULL);
+    freeLinkedListAndItems(benchmarkSuites, _freeBenchmarkSuite);
+    freeProgramOptions(programOptions);
+    return -1;
+  }
+
+  if(programOptions->options[OPTION_BENCH_SUITE]->enabled) {
+    benchmarkSuite = _findBenchmarkSuite(benchmarkSuites, programOptions->options[OPTION_BENCH_SUITE]->argument);
+    if(benchmarkSuite == NULL) {
+      printf("ERROR: Invalid benchmark suite '%s'\n", programOptions->options[OPTION_BENCH_SUITE]->argument->data);
+      printf("Run '%s --list' to show possible benchmark suites\n", getFileBasename(argv[0]));
+      freeLinkedListAndItems(benchmarkSuites, _freeBenchmarkSuite);
+      freeProgramOptions(programOptions);
+      return -1;
+    }
+  }
+
+  if(programOptions->options[OPTION_BENCH_OUTPUT]->enabled) {
+    output = fopen(programOptions->options[OPTION_BENCH_OUTPUT]->argument->data, "w");
+    if(output == NULL) {
+      printf("ERROR: Could not open '%s' for writing\n", programOptions->options[OPTION_BENCH_OUTPUT]->argument->data);
+      freeLinkedListAndItems(benchmarkSuites, _freeBenchmarkSuite);
+      freeProgramOptions(programOptions);
+      return -1;
+    }
+  }
+
+  quick = programOptions->options[OPTION_BENCH_QUICK]->enabled;
+  benchmarkRunner = newBenchmarkRunner(output,
+    quick ? kBenchmarkQuickTrialTimeInMs : kBenchmarkTrialTimeInMs,
+    quick ? kBenchmarkQuickNumTrials : kBenchmarkNumTrials);
+  benchmarkRunnerStart(benchmarkRunner);
+  if(benchmarkSuite != NULL) {
+    runBenchmarkSuite(benchmarkSuite, benchmarkRunner);
+  }
+  else {
+    linkedListForeach(benchmarkSuites, runBenchmarkSuite, benchmarkRunner);
+  }
+  benchmarkRunnerFinish(benchmarkRunner);
+  numFailed = benchmarkRunner->numFailed;
+
+  if(output != stdout) {
+    fclose(output);
+  }
+  freeBenchmarkRunner(benchmarkRunner);
+  freeLinkedListAndItems(benchmarkSuites, _freeBenchmarkSuite);
+  freeProgramOptions(programOptions);
+  freeAudioClock(audioClockInstance);
+  freeAudioSettings();
+  freeEventLogger();
+  return numFailed;
+}
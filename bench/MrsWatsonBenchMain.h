@@ -0,0 +1,16 @@
+//
+//  MrsWatsonBenchMain.h
+//  MrsWatson
+//
+//  Created by Nik Reiman on 5/19/13.
+//  Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+
+typedef enum {
+  OPTION_BENCH_SUITE,
+  OPTION_BENCH_OUTPUT,
+  OPTION_BENCH_QUICK,
+  OPTION_BENCH_LIST,
+  OPTION_BENCH_HELP,
+  NUM_BENCH_OPTIONS
+} BenchProgramOptionIndex;
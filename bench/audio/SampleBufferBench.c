@@ -0,0 +1,62 @@
+#include <stdlib.h>
+
+#include "audio/SampleBuffer.h"
+#include "unit/BenchmarkRunner.h"
+
+typedef struct {
+  SampleBuffer source;
+  SampleBuffer destination;
+} SampleBufferFixtureMembers;
+typedef SampleBufferFixtureMembers* SampleBufferFixture;
+
+static void* _sampleBufferSetup(const unsigned int numChannels, const unsigned long blocksize) {
+  SampleBufferFixture fixture = (SampleBufferFixture)malloc(sizeof(SampleBufferFixtureMembers));
+  unsigned int i;
+  unsigned long j;
+
+  fixture->source = newSampleBuffer(numChannels, blocksize);
+  fixture->destination = newSampleBuffer(numChannels, blocksize);
+  for(i = 0; i < numChannels; i++) {
+    for(j = 0; j < blocksize; j++) {
+      fixture->source->samples[i][j] = (Sample)j / (Sample)blocksize;
+    }
+  }
+  return fixture;
+}
+
+static unsigned long _sampleBufferCopy(void* fixturePtr) {
+  SampleBufferFixture fixture = (SampleBufferFixture)fixturePtr;
+  sampleBufferCopy(fixture->destination, fixture->source);
+  return fixture->source->numChannels * fixture->source->blocksize;
+}
+
+static unsigned long _sampleBufferClear(void* fixturePtr) {
+  SampleBufferFixture fixture = (SampleBufferFixture)fixturePtr;
+  sampleBufferClear(fixture->destination);
+  return fixture->destination->numChannels * fixture->destination->blocksize;
+}
+
+// Adds a channel and removes it again, which is what the plugin chain does
+// when a plugin has more inputs than the source.
+static unsigned long _sampleBufferResize(void* fixturePtr) {
+  SampleBufferFixture fixture = (SampleBufferFixture)fixturePtr;
+  const unsigned int numChannels = fixture->destination->numChannels;
+  sampleBufferResize(fixture->destination, numChannels + 1, true);
+  sampleBufferResize(fixture->destination, numChannels, false);
+  return fixture->destination->blocksize;
+}
+
+static void _sampleBufferTeardown(void* fixturePtr) {
+  SampleBufferFixture fixture = (SampleBufferFixture)fixturePtr;
+  freeSampleBuffer(fixture->source);
+  freeSampleBuffer(fixture->destination);
+  free(fixture);
+}
+
+BenchmarkSuite addSampleBufferBenchmarks(void) {
+  BenchmarkSuite benchmarkSuite = newBenchmarkSuite("SampleBuffer");
+  addBenchmark(benchmarkSuite, "Copy", _sampleBufferSetup, _sampleBufferCopy, _sampleBufferTeardown);
+  addBenchmark(benchmarkSuite, "Clear", _sampleBufferSetup, _sampleBufferClear, _sampleBufferTeardown);
+  addBenchmark(benchmarkSuite, "Resize", _sampleBufferSetup, _sampleBufferResize, _sampleBufferTeardown);
+  return benchmarkSuite;
+}
@@ -0,0 +1,73 @@
+#include <stdlib.h>
+
+#include "audio/SampleBuffer.h"
+#include "audio/SampleConversion.h"
+#include "unit/BenchmarkRunner.h"
+
+typedef struct {
+  SampleBuffer sampleBuffer;
+  byte* pcmData;
+} SampleConversionFixtureMembers;
+typedef SampleConversionFixtureMembers* SampleConversionFixture;
+
+static void* _sampleConversionSetup(const unsigned int numChannels, const unsigned long blocksize) {
+  SampleConversionFixture fixture = (SampleConversionFixture)malloc(sizeof(SampleConversionFixtureMembers));
+  // Large enough for the biggest sample format
+  const size_t pcmDataSize = sampleFormatGetBytesPerSample(kSampleFormatFloat64) * numChannels * blocksize;
+  size_t i;
+
+  fixture->sampleBuffer = newSampleBuffer(numChannels, blocksize);
+  fixture->pcmData = (byte*)malloc(pcmDataSize);
+  for(i = 0; i < pcmDataSize; i++) {
+    fixture->pcmData[i] = (byte)(i * 7);
+  }
+  return fixture;
+}
+
+static unsigned long _convertPcm16ToSamples(void* fixturePtr) {
+  SampleConversionFixture fixture = (SampleConversionFixture)fixturePtr;
+  SampleBuffer sampleBuffer = fixture->sampleBuffer;
+  convertPcm16ToSamples((const short*)fixture->pcmData, sampleBuffer->samples,
+    sampleBuffer->numChannels, sampleBuffer->blocksize, false);
+  return sampleBuffer->numChannels * sampleBuffer->blocksize;
+}
+
+static unsigned long _convertSamplesToPcm16(void* fixturePtr) {
+  SampleConversionFixture fixture = (SampleConversionFixture)fixturePtr;
+  SampleBuffer sampleBuffer = fixture->sampleBuffer;
+  convertSamplesToPcm16((const Samples*)sampleBuffer->samples, (short*)fixture->pcmData,
+    sampleBuffer->numChannels, sampleBuffer->blocksize, false);
+  return sampleBuffer->numChannels * sampleBuffer->blocksize;
+}
+
+static unsigned long _convertPcm24ToSamples(void* fixturePtr) {
+  SampleConversionFixture fixture = (SampleConversionFixture)fixturePtr;
+  SampleBuffer sampleBuffer = fixture->sampleBuffer;
+  convertPcmDataToSamples(fixture->pcmData, kSampleFormatInt24, sampleBuffer->samples,
+    sampleBuffer->numChannels, sampleBuffer->blocksize, false);
+  return sampleBuffer->numChannels * sampleBuffer->blocksize;
+}
+
+static unsigned long _convertSamplesToPcm24(void* fixturePtr) {
+  SampleConversionFixture fixture = (SampleConversionFixture)fixturePtr;
+  SampleBuffer sampleBuffer = fixture->sampleBuffer;
+  convertSamplesToPcmData((const Samples*)sampleBuffer->samples, fixture->pcmData, kSampleFormatInt24,
+    sampleBuffer->numChannels, sampleBuffer->blocksize, false);
+  return sampleBuffer->numChannels * sampleBuffer->blocksize;
+}
+
+static void _sampleConversionTeardown(void* fixturePtr) {
+  SampleConversionFixture fixture = (SampleConversionFixture)fixturePtr;
+  freeSampleBuffer(fixture->sampleBuffer);
+  free(fixture->pcmData);
+  free(fixture);
+}
+
+BenchmarkSuite addSampleConversionBenchmarks(void) {
+  BenchmarkSuite benchmarkSuite = newBenchmarkSuite("SampleConversion");
+  addBenchmark(benchmarkSuite, "Pcm16ToSamples", _sampleConversionSetup, _convertPcm16ToSamples, _sampleConversionTeardown);
+  addBenchmark(benchmarkSuite, "SamplesToPcm16", _sampleConversionSetup, _convertSamplesToPcm16, _sampleConversionTeardown);
+  addBenchmark(benchmarkSuite, "Pcm24ToSamples", _sampleConversionSetup, _convertPcm24ToSamples, _sampleConversionTeardown);
+  addBenchmark(benchmarkSuite, "SamplesToPcm24", _sampleConversionSetup, _convertSamplesToPcm24, _sampleConversionTeardown);
+  return benchmarkSuite;
+}
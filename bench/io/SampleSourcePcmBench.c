@@ -0,0 +1,113 @@
+#include <stdlib.h>
+
+#include "audio/AudioSettings.h"
+#include "audio/SampleBuffer.h"
+#include "base/CharString.h"
+#include "base/PlatformUtilities.h"
+#include "io/SampleSource.h"
+#include "io/SampleSourcePcm.h"
+#include "unit/BenchmarkRunner.h"
+
+#if UNIX
+#include <unistd.h>
+#endif
+
+#if UNIX
+#define BENCHMARK_PCM_FILE "/tmp/mrswatsonbench.pcm"
+#elif WINDOWS
+#define BENCHMARK_PCM_FILE "C:\\Temp\\mrswatsonbench.pcm"
+#else
+#define BENCHMARK_PCM_FILE "mrswatsonbench.pcm"
+#endif
+
+// Number of frames in the file which is read or written by each iteration.
+// This is long enough that opening the file is only a small part of the time.
+#define BENCHMARK_PCM_FILE_NUM_FRAMES (1 << 16)
+
+typedef struct {
+  CharString filename;
+  SampleBuffer sampleBuffer;
+  unsigned long blocksize;
+  unsigned long numBlocks;
+} SampleSourcePcmFixtureMembers;
+typedef SampleSourcePcmFixtureMembers* SampleSourcePcmFixture;
+
+static SampleSource _openPcmFile(SampleSourcePcmFixture fixture, const SampleSourceOpenAs openAs) {
+  SampleSource sampleSource = newSampleSourcePcm(fixture->filename);
+  sampleSourcePcmSetNumChannels(sampleSource, (int)fixture->sampleBuffer->numChannels);
+  sampleSourcePcmSetSampleRate(sampleSource, DEFAULT_SAMPLE_RATE);
+  if(!sampleSource->openSampleSource(sampleSource, openAs)) {
+    freeSampleSource(sampleSource);
+    return NULL;
+  }
+  return sampleSource;
+}
+
+static unsigned long _writePcmFile(void* fixturePtr) {
+  SampleSourcePcmFixture fixture = (SampleSourcePcmFixture)fixturePtr;
+  SampleSource sampleSource = _openPcmFile(fixture, SAMPLE_SOURCE_OPEN_WRITE);
+  unsigned long numSamples;
+  unsigned long i;
+
+  if(sampleSource == NULL) {
+    return 0;
+  }
+  for(i = 0; i < fixture->numBlocks; i++) {
+    sampleSource->writeSampleBlock(sampleSource, fixture->sampleBuffer);
+  }
+  sampleSource->closeSampleSource(sampleSource);
+  numSamples = sampleSource->numSamplesProcessed;
+  freeSampleSource(sampleSource);
+  return numSamples;
+}
+
+static unsigned long _readPcmFile(void* fixturePtr) {
+  SampleSourcePcmFixture fixture = (SampleSourcePcmFixture)fixturePtr;
+  SampleSource sampleSource = _openPcmFile(fixture, SAMPLE_SOURCE_OPEN_READ);
+  unsigned long numSamples;
+
+  if(sampleSource == NULL) {
+    return 0;
+  }
+  while(sampleSource->readSampleBlock(sampleSource, fixture->sampleBuffer));
+  // The source shortens the buffer for the final block
+  fixture->sampleBuffer->blocksize = fixture->blocksize;
+  sampleSource->closeSampleSource(sampleSource);
+  numSamples = sampleSource->numSamplesProcessed;
+  freeSampleSource(sampleSource);
+  return numSamples;
+}
+
+static void* _sampleSourcePcmSetup(const unsigned int numChannels, const unsigned long blocksize) {
+  SampleSourcePcmFixture fixture = (SampleSourcePcmFixture)malloc(sizeof(SampleSourcePcmFixtureMembers));
+  unsigned int i;
+  unsigned long j;
+
+  fixture->filename = newCharStringWithCString(BENCHMARK_PCM_FILE);
+  fixture->sampleBuffer = newSampleBuffer(numChannels, blocksize);
+  fixture->blocksize = blocksize;
+  fixture->numBlocks = BENCHMARK_PCM_FILE_NUM_FRAMES / blocksize;
+  for(i = 0; i < numChannels; i++) {
+    for(j = 0; j < blocksize; j++) {
+      fixture->sampleBuffer->samples[i][j] = (Sample)j / (Sample)blocksize - 0.5f;
+    }
+  }
+  // Reading needs a file to read from
+  _writePcmFile(fixture);
+  return fixture;
+}
+
+static void _sampleSourcePcmTeardown(void* fixturePtr) {
+  SampleSourcePcmFixture fixture = (SampleSourcePcmFixture)fixturePtr;
+  unlink(fixture->filename->data);
+  freeCharString(fixture->filename);
+  freeSampleBuffer(fixture->sampleBuffer);
+  free(fixture);
+}
+
+BenchmarkSuite addSampleSourcePcmBenchmarks(void) {
+  BenchmarkSuite benchmarkSuite = newBenchmarkSuite("SampleSourcePcm");
+  addBenchmark(benchmarkSuite, "ReadFile", _sampleSourcePcmSetup, _readPcmFile, _sampleSourcePcmTeardown);
+  addBenchmark(benchmarkSuite, "WriteFile", _sampleSourcePcmSetup, _writePcmFile, _sampleSourcePcmTeardown);
+  return benchmarkSuite;
+}
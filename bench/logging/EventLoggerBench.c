@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/PlatformUtilities.h"
+#include "logging/EventLogger.h"
+#include "unit/BenchmarkRunner.h"
+
+#if UNIX
+#include <unistd.h>
+#endif
+
+#if UNIX
+#include <unistd.h>
+#endif
+
+#if UNIX
+#define BENCHMARK_LOG_FILE "/tmp/mrswatsonbench.log"
+#elif WINDOWS
+#define BENCHMARK_LOG_FILE "C:\\Temp\\mrswatsonbench.log"
+#else
+#define BENCHMARK_LOG_FILE "mrswatsonbench.log"
+#endif
+
+// Number of messages logged by each iteration
+#define BENCHMARK_LOG_NUM_CALLS 256
+
+static void* _eventLoggerSetup(const unsigned int numChannels, const unsigned long blocksize) {
+  // A copy of the global logger which writes info messages to a file, so
+  // that the benchmark neither floods the console nor changes global state
+  EventLogger eventLogger = (EventLogger)malloc(sizeof(EventLoggerMembers));
+  memcpy(eventLogger, eventLoggerInstance, sizeof(EventLoggerMembers));
+  eventLogger->logLevel = LOG_INFO;
+  eventLogger->useColor = false;
+  eventLogger->logFile = fopen(BENCHMARK_LOG_FILE, "w");
+  eventLogger->asyncQueue = NULL;
+  eventLogger->asyncThread = NULL;
+  setThreadEventLogger(eventLogger);
+  return eventLogger;
+}
+
+static unsigned long _logDebugDisabled(void* eventLoggerPtr) {
+  int i;
+  for(i = 0; i < BENCHMARK_LOG_NUM_CALLS; i++) {
+    logDebug("Read %d samples from PCM file", i);
+  }
+  return BENCHMARK_LOG_NUM_CALLS;
+}
+
+static unsigned long _logInfoToFile(void* eventLoggerPtr) {
+  EventLogger eventLogger = (EventLogger)eventLoggerPtr;
+  int i;
+
+  if(eventLogger->logFile == NULL) {
+    return 0;
+  }
+  for(i = 0; i < BENCHMARK_LOG_NUM_CALLS; i++) {
+    logInfo("Read %d samples from PCM file", i);
+  }
+  return BENCHMARK_LOG_NUM_CALLS;
+}
+
+static void* _asyncEventLoggerSetup(const unsigned int numChannels, const unsigned long blocksize) {
+  void* eventLogger = _eventLoggerSetup(numChannels, blocksize);
+  startAsyncLogging();
+  return eventLogger;
+}
+
+static void _eventLoggerTeardown(void* eventLoggerPtr) {
+  EventLogger eventLogger = (EventLogger)eventLoggerPtr;
+  stopAsyncLogging();
+  setThreadEventLogger(NULL);
+  if(eventLogger->logFile != NULL) {
+    fclose(eventLogger->logFile);
+    unlink(BENCHMARK_LOG_FILE);
+  }
+  free(eventLogger);
+}
+
+BenchmarkSuite addEventLoggerBenchmarks(void) {
+  BenchmarkSuite benchmarkSuite = newBenchmarkSuite("EventLogger");
+  addBenchmarkWithParameters(benchmarkSuite, "DisabledLogDebug", "call", kBenchmarkParametersNone,
+    _eventLoggerSetup, _logDebugDisabled, _eventLoggerTeardown);
+  addBenchmarkWithParameters(benchmarkSuite, "LogInfoToFile", "call", kBenchmarkParametersNone,
+    _eventLoggerSetup, _logInfoToFile, _eventLoggerTeardown);
+  addBenchmarkWithParameters(benchmarkSuite, "LogInfoToFileAsync", "call", kBenchmarkParametersNone,
+    _asyncEventLoggerSetup, _logInfoToFile, _eventLoggerTeardown);
+  return benchmarkSuite;
+}
@@ -0,0 +1,81 @@
+#include <stdlib.h>
+
+#include "audio/AudioSettings.h"
+#include "audio/SampleBuffer.h"
+#include "base/CharString.h"
+#include "plugin/PluginChain.h"
+#include "time/TaskTimer.h"
+#include "unit/BenchmarkRunner.h"
+
+typedef struct {
+  PluginChain pluginChain;
+  SampleBuffer inputSampleBuffer;
+  SampleBuffer outputSampleBuffer;
+  TaskTimer taskTimer;
+} PluginChainFixtureMembers;
+typedef PluginChainFixtureMembers* PluginChainFixture;
+
+static PluginChainFixture _newPluginChainFixture(const char* pluginChainArgument,
+  const unsigned int numChannels, const unsigned long blocksize) {
+  PluginChainFixture fixture = (PluginChainFixture)malloc(sizeof(PluginChainFixtureMembers));
+  CharString argumentString = newCharStringWithCString(pluginChainArgument);
+
+  // Internal plugins take their channel count from the global settings
+  setNumChannels(numChannels);
+  setBlocksize(blocksize);
+  fixture->pluginChain = newPluginChain();
+  fixture->inputSampleBuffer = newSampleBuffer(numChannels, blocksize);
+  fixture->outputSampleBuffer = newSampleBuffer(numChannels, blocksize);
+  fixture->taskTimer = NULL;
+  if(pluginChainAddFromArgumentString(fixture->pluginChain, argumentString, NULL) &&
+    pluginChainInitialize(fixture->pluginChain) == RETURN_CODE_SUCCESS) {
+    pluginChainPrepareForProcessing(fixture->pluginChain);
+    fixture->taskTimer = newTaskTimer(fixture->pluginChain->numPlugins + 1);
+  }
+
+  freeCharString(argumentString);
+  return fixture;
+}
+
+static void* _passthruSetup(const unsigned int numChannels, const unsigned long blocksize) {
+  return _newPluginChainFixture("mrs_passthru", numChannels, blocksize);
+}
+
+static void* _silenceSetup(const unsigned int numChannels, const unsigned long blocksize) {
+  return _newPluginChainFixture("mrs_silence", numChannels, blocksize);
+}
+
+static void* _fourPassthrusSetup(const unsigned int numChannels, const unsigned long blocksize) {
+  return _newPluginChainFixture("mrs_passthru;mrs_passthru;mrs_passthru;mrs_passthru", numChannels, blocksize);
+}
+
+static unsigned long _pluginChainProcessAudio(void* fixturePtr) {
+  PluginChainFixture fixture = (PluginChainFixture)fixturePtr;
+  // Returning zero samples marks the benchmark as failed
+  if(fixture->taskTimer == NULL) {
+    return 0;
+  }
+  pluginChainProcessAudio(fixture->pluginChain, fixture->inputSampleBuffer,
+    fixture->outputSampleBuffer, fixture->taskTimer);
+  return fixture->outputSampleBuffer->numChannels * fixture->outputSampleBuffer->blocksize;
+}
+
+static void _pluginChainTeardown(void* fixturePtr) {
+  PluginChainFixture fixture = (PluginChainFixture)fixturePtr;
+  pluginChainShutdown(fixture->pluginChain);
+  freePluginChain(fixture->pluginChain);
+  freeSampleBuffer(fixture->inputSampleBuffer);
+  freeSampleBuffer(fixture->outputSampleBuffer);
+  if(fixture->taskTimer != NULL) {
+    freeTaskTimer(fixture->taskTimer);
+  }
+  free(fixture);
+}
+
+BenchmarkSuite addPluginChainBenchmarks(void) {
+  BenchmarkSuite benchmarkSuite = newBenchmarkSuite("PluginChain");
+  addBenchmark(benchmarkSuite, "Passthru", _passthruSetup, _pluginChainProcessAudio, _pluginChainTeardown);
+  addBenchmark(benchmarkSuite, "Silence", _silenceSetup, _pluginChainProcessAudio, _pluginChainTeardown);
+  addBenchmark(benchmarkSuite, "FourPassthrus", _fourPassthrusSetup, _pluginChainProcessAudio, _pluginChainTeardown);
+  return benchmarkSuite;
+}
@@ -0,0 +1,65 @@
+#include <stdlib.h>
+
+#include "base/LinkedList.h"
+#include "midi/MidiEvent.h"
+#include "sequencer/MidiSequence.h"
+#include "unit/BenchmarkRunner.h"
+
+// Length of the sequence and spacing between its events, in frames
+#define BENCHMARK_MIDI_SEQUENCE_NUM_FRAMES (1 << 16)
+#define BENCHMARK_MIDI_EVENT_SPACING 16
+
+typedef struct {
+  MidiSequence midiSequence;
+  unsigned long blocksize;
+} MidiSequenceFixtureMembers;
+typedef MidiSequenceFixtureMembers* MidiSequenceFixture;
+
+static void* _midiSequenceSetup(const unsigned int numChannels, const unsigned long blocksize) {
+  MidiSequenceFixture fixture = (MidiSequenceFixture)malloc(sizeof(MidiSequenceFixtureMembers));
+  MidiEvent midiEvent;
+  unsigned long i;
+
+  fixture->midiSequence = newMidiSequence();
+  fixture->blocksize = blocksize;
+  for(i = 0; i < BENCHMARK_MIDI_SEQUENCE_NUM_FRAMES; i += BENCHMARK_MIDI_EVENT_SPACING) {
+    midiEvent = newMidiEvent();
+    midiEvent->eventType = MIDI_TYPE_REGULAR;
+    midiEvent->status = (i / BENCHMARK_MIDI_EVENT_SPACING) % 2 ? 0x80 : 0x90;
+    midiEvent->data1 = 60;
+    midiEvent->data2 = 100;
+    midiEvent->timestamp = i;
+    appendMidiEventToSequence(fixture->midiSequence, midiEvent);
+  }
+  return fixture;
+}
+
+static unsigned long _fillMidiEventsFromRange(void* fixturePtr) {
+  MidiSequenceFixture fixture = (MidiSequenceFixture)fixturePtr;
+  MidiSequence midiSequence = fixture->midiSequence;
+  LinkedList midiEventsForBlock;
+  unsigned long currentFrame;
+
+  // Rewind the sequence
+  midiSequenceSeek(midiSequence, 0);
+  // Same as the host's processing loop, which makes a new list for each block
+  for(currentFrame = 0; currentFrame < BENCHMARK_MIDI_SEQUENCE_NUM_FRAMES; currentFrame += fixture->blocksize) {
+    midiEventsForBlock = newLinkedList();
+    fillMidiEventsFromRange(midiSequence, currentFrame, fixture->blocksize, midiEventsForBlock);
+    freeLinkedList(midiEventsForBlock);
+  }
+  return BENCHMARK_MIDI_SEQUENCE_NUM_FRAMES;
+}
+
+static void _midiSequenceTeardown(void* fixturePtr) {
+  MidiSequenceFixture fixture = (MidiSequenceFixture)fixturePtr;
+  freeMidiSequence(fixture->midiSequence);
+  free(fixture);
+}
+
+BenchmarkSuite addMidiSequenceBenchmarks(void) {
+  BenchmarkSuite benchmarkSuite = newBenchmarkSuite("MidiSequence");
+  addBenchmarkWithParameters(benchmarkSuite, "FillEventsFromRange", "frame", kBenchmarkParametersBlocksize,
+    _midiSequenceSetup, _fillMidiEventsFromRange, _midiSequenceTeardown);
+  return benchmarkSuite;
+}
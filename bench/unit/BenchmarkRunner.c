@@ -0,0 +1,206 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/SampleConversion.h"
+#include "base/CharString.h"
+#include "base/PlatformUtilities.h"
+#include "logging/EventLogger.h"
+#include "unit/BenchmarkRunner.h"
+
+#if WINDOWS
+#include <Windows.h>
+#elif MACOSX
+#include <mach/mach_time.h>
+#elif UNIX
+#include <time.h>
+#endif
+
+static const unsigned int kBenchmarkNumChannels[] = {1, 2, 8};
+static const unsigned long kBenchmarkBlocksizes[] = {64, 512, 4096};
+#define NUM_BENCHMARK_CHANNEL_COUNTS (sizeof(kBenchmarkNumChannels) / sizeof(unsigned int))
+#define NUM_BENCHMARK_BLOCKSIZES (sizeof(kBenchmarkBlocksizes) / sizeof(unsigned long))
+
+double getBenchmarkTimeInNs(void) {
+#if WINDOWS
+  LARGE_INTEGER counter;
+  LARGE_INTEGER frequency;
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+  return (double)counter.QuadPart * 1000000000.0 / (double)frequency.QuadPart;
+#elif MACOSX
+  mach_timebase_info_data_t timebase;
+  mach_timebase_info(&timebase);
+  return (double)mach_absolute_time() * (double)timebase.numer / (double)timebase.denom;
+#elif UNIX
+  struct timespec currentTime;
+  clock_gettime(CLOCK_MONOTONIC, &currentTime);
+  return (double)currentTime.tv_sec * 1000000000.0 + (double)currentTime.tv_nsec;
+#else
+  return 0.0;
+#endif
+}
+
+BenchmarkSuite newBenchmarkSuite(char* name) {
+  BenchmarkSuite benchmarkSuite = (BenchmarkSuite)malloc(sizeof(BenchmarkSuiteMembers));
+  benchmarkSuite->name = name;
+  benchmarkSuite->benchmarkCases = newLinkedList();
+  return benchmarkSuite;
+}
+
+BenchmarkCase newBenchmarkCase(char* name, char* unit, BenchmarkParameters parameters,
+  BenchmarkSetupFunc setup, BenchmarkRunFunc run, BenchmarkTeardownFunc teardown) {
+  BenchmarkCase benchmarkCase = (BenchmarkCase)malloc(sizeof(BenchmarkCaseMembers));
+  benchmarkCase->name = name;
+  benchmarkCase->unit = unit;
+  benchmarkCase->parameters = parameters;
+  benchmarkCase->setup = setup;
+  benchmarkCase->run = run;
+  benchmarkCase->teardown = teardown;
+  return benchmarkCase;
+}
+
+void addBenchmarkToBenchmarkSuite(BenchmarkSuite benchmarkSuite, BenchmarkCase benchmarkCase) {
+  linkedListAppend(benchmarkSuite->benchmarkCases, benchmarkCase);
+}
+
+BenchmarkRunner newBenchmarkRunner(FILE* output, const double trialTimeInMs, const int numTrials) {
+  BenchmarkRunner benchmarkRunner = (BenchmarkRunner)malloc(sizeof(BenchmarkRunnerMembers));
+  benchmarkRunner->trialTimeInNs = trialTimeInMs * 1000000.0;
+  benchmarkRunner->numTrials = numTrials > 0 ? numTrials : 1;
+  benchmarkRunner->output = output;
+  benchmarkRunner->numResults = 0;
+  benchmarkRunner->numFailed = 0;
+  return benchmarkRunner;
+}
+
+void benchmarkRunnerStart(BenchmarkRunner self) {
+  CharString versionString = newCharString();
+  CharString platformName = getPlatformName();
+
+  fillVersionString(versionString);
+  fprintf(self->output, "{\n");
+  fprintf(self->output, "  \"version\": \"%s\",\n", versionString->data);
+  fprintf(self->output, "  \"platform\": \"%s\",\n", platformName->data);
+  fprintf(self->output, "  \"bits\": %d,\n", isExecutable64Bit() ? 64 : 32);
+  fprintf(self->output, "  \"conversionKernel\": \"%s\",\n", sampleConversionKernelGetName(sampleConversionGetKernel()));
+  fprintf(self->output, "  \"trials\": %d,\n", self->numTrials);
+  fprintf(self->output, "  \"results\": [");
+
+  freeCharString(versionString);
+  freeCharString(platformName);
+}
+
+static int _compareDoubles(const void* a, const void* b) {
+  const double first = *(const double*)a;
+  const double second = *(const double*)b;
+  return (first > second) - (first < second);
+}
+
+static void _runBenchmarkCaseWithParameters(BenchmarkRunner self, BenchmarkSuite benchmarkSuite,
+  BenchmarkCase benchmarkCase, const unsigned int numChannels, const unsigned long blocksize) {
+  double* trialTimes = (double*)malloc(sizeof(double) * self->numTrials);
+  double startTime;
+  double elapsedTime;
+  double unitsInTrial;
+  unsigned long numIterations = 0;
+  unsigned long numUnits = 0;
+  unsigned long i;
+  int trial;
+  void* fixture;
+
+  fprintf(stderr, "  %s:%s (%u channels, blocksize %lu): ", benchmarkSuite->name, benchmarkCase->name, numChannels, blocksize);
+  fflush(stderr);
+  fixture = benchmarkCase->setup != NULL ? benchmarkCase->setup(numChannels, blocksize) : NULL;
+
+  // Warm up caches and estimate how many iterations fit in a trial
+  startTime = getBenchmarkTimeInNs();
+  do {
+    numUnits = benchmarkCase->run(fixture);
+    numIterations++;
+    elapsedTime = getBenchmarkTimeInNs() - startTime;
+  } while(numUnits > 0 && elapsedTime < self->trialTimeInNs / 4.0);
+
+  if(numUnits == 0) {
+    fprintf(stderr, "FAIL\n");
+    self->numFailed++;
+  }
+  else {
+    numIterations = (unsigned long)(self->trialTimeInNs / (elapsedTime / (double)numIterations)) + 1;
+    for(trial = 0; trial < self->numTrials; trial++) {
+      unitsInTrial = 0.0;
+      startTime = getBenchmarkTimeInNs();
+      for(i = 0; i < numIterations; i++) {
+        unitsInTrial += (double)benchmarkCase->run(fixture);
+      }
+      trialTimes[trial] = (getBenchmarkTimeInNs() - startTime) / unitsInTrial;
+    }
+    qsort(trialTimes, (size_t)self->numTrials, sizeof(double), _compareDoubles);
+    fprintf(stderr, "%.3f ns/%s\n", trialTimes[self->numTrials / 2], benchmarkCase->unit);
+
+    fprintf(self->output, "%s\n    {", self->numResults > 0 ? "," : "");
+    fprintf(self->output, "\"suite\": \"%s\", \"name\": \"%s\", ", benchmarkSuite->name, benchmarkCase->name);
+    fprintf(self->output, "\"channels\": %u, \"blocksize\": %lu, ", numChannels, blocksize);
+    fprintf(self->output, "\"unit\": \"%s\", \"iterations\": %lu, ", benchmarkCase->unit, numIterations);
+    fprintf(self->output, "\"nsPerUnit\": %.4f, \"nsPerUnitMin\": %.4f, \"nsPerUnitMax\": %.4f}",
+      trialTimes[self->numTrials / 2], trialTimes[0], trialTimes[self->numTrials - 1]);
+    self->numResults++;
+  }
+
+  if(benchmarkCase->teardown != NULL) {
+    benchmarkCase->teardown(fixture);
+  }
+  free(trialTimes);
+}
+
+static void _runBenchmarkCase(void* item, void* extraData) {
+  BenchmarkCase benchmarkCase = (BenchmarkCase)item;
+  void** arguments = (void**)extraData;
+  BenchmarkRunner self = (BenchmarkRunner)arguments[0];
+  BenchmarkSuite benchmarkSuite = (BenchmarkSuite)arguments[1];
+  unsigned int i, j;
+
+  switch(benchmarkCase->parameters) {
+    case kBenchmarkParametersAll:
+      for(i = 0; i < NUM_BENCHMARK_CHANNEL_COUNTS; i++) {
+        for(j = 0; j < NUM_BENCHMARK_BLOCKSIZES; j++) {
+          _runBenchmarkCaseWithParameters(self, benchmarkSuite, benchmarkCase, kBenchmarkNumChannels[i], kBenchmarkBlocksizes[j]);
+        }
+      }
+      break;
+    case kBenchmarkParametersBlocksize:
+      for(j = 0; j < NUM_BENCHMARK_BLOCKSIZES; j++) {
+        _runBenchmarkCaseWithParameters(self, benchmarkSuite, benchmarkCase, 1, kBenchmarkBlocksizes[j]);
+      }
+      break;
+    case kBenchmarkParametersNone:
+    default:
+      _runBenchmarkCaseWithParameters(self, benchmarkSuite, benchmarkCase, 1, 1);
+      break;
+  }
+}
+
+void runBenchmarkSuite(void* benchmarkSuitePtr, void* benchmarkRunnerPtr) {
+  BenchmarkSuite benchmarkSuite = (BenchmarkSuite)benchmarkSuitePtr;
+  void* arguments[2];
+
+  arguments[0] = benchmarkRunnerPtr;
+  arguments[1] = benchmarkSuite;
+  fprintf(stderr, "Running benchmarks in %s\n", benchmarkSuite->name);
+  linkedListForeach(benchmarkSuite->benchmarkCases, _runBenchmarkCase, arguments);
+}
+
+void benchmarkRunnerFinish(BenchmarkRunner self) {
+  fprintf(self->output, "\n  ],\n");
+  fprintf(self->output, "  \"failed\": %d\n", self->numFailed);
+  fprintf(self->output, "}\n");
+  fflush(self->output);
+}
+
+void freeBenchmarkRunner(BenchmarkRunner self) {
+  free(self);
+}
+
+void freeBenchmarkSuite(BenchmarkSuite self) {
+  freeLinkedListAndItems(self->benchmarkCases, (LinkedListFreeItemFunc)free);
+  free(self);
+}
@@ -0,0 +1,93 @@
+#ifndef MrsWatsonBench_BenchmarkRunner_h
+#define MrsWatsonBench_BenchmarkRunner_h
+
+#include <stdio.h>
+
+#include "base/LinkedList.h"
+#include "base/Types.h"
+
+/**
+ * Create the data used by a benchmark, such as buffers and open sources.
+ * Anything done here is not timed.
+ * @param numChannels Channel count to benchmark with
+ * @param blocksize Blocksize to benchmark with
+ * @return Fixture passed to the run and teardown functions
+ */
+typedef void* (*BenchmarkSetupFunc)(const unsigned int numChannels, const unsigned long blocksize);
+/**
+ * Run the code being measured once
+ * @param fixture Data created by the setup function
+ * @return Number of units (samples, frames, calls) which were processed
+ */
+typedef unsigned long (*BenchmarkRunFunc)(void* fixture);
+typedef void (*BenchmarkTeardownFunc)(void* fixture);
+
+typedef enum {
+  // Run with every combination of channel count and blocksize
+  kBenchmarkParametersAll,
+  // Run with every blocksize, but only one channel
+  kBenchmarkParametersBlocksize,
+  // Run only once
+  kBenchmarkParametersNone
+} BenchmarkParameters;
+
+typedef struct {
+  char* name;
+  char* unit;
+  BenchmarkParameters parameters;
+  BenchmarkSetupFunc setup;
+  BenchmarkRunFunc run;
+  BenchmarkTeardownFunc teardown;
+} BenchmarkCaseMembers;
+typedef BenchmarkCaseMembers* BenchmarkCase;
+
+typedef struct {
+  char* name;
+  LinkedList benchmarkCases;
+} BenchmarkSuiteMembers;
+typedef BenchmarkSuiteMembers* BenchmarkSuite;
+
+typedef struct {
+  // Minimum time for each timed trial. Faster benchmarks run more iterations
+  // per trial to reach it.
+  double trialTimeInNs;
+  int numTrials;
+  FILE* output;
+  int numResults;
+  int numFailed;
+} BenchmarkRunnerMembers;
+typedef BenchmarkRunnerMembers* BenchmarkRunner;
+
+BenchmarkSuite newBenchmarkSuite(char* name);
+BenchmarkCase newBenchmarkCase(char* name, char* unit, BenchmarkParameters parameters,
+  BenchmarkSetupFunc setup, BenchmarkRunFunc run, BenchmarkTeardownFunc teardown);
+void addBenchmarkToBenchmarkSuite(BenchmarkSuite benchmarkSuite, BenchmarkCase benchmarkCase);
+
+/**
+ * @param output File to write the JSON results to
+ * @param trialTimeInMs Minimum time for each timed trial
+ * @param numTrials Number of timed trials per benchmark, of which the median
+ * and fastest are reported
+ */
+BenchmarkRunner newBenchmarkRunner(FILE* output, const double trialTimeInMs, const int numTrials);
+void benchmarkRunnerStart(BenchmarkRunner self);
+void runBenchmarkSuite(void* benchmarkSuitePtr, void* benchmarkRunnerPtr);
+void benchmarkRunnerFinish(BenchmarkRunner self);
+
+/**
+ * @return Monotonic time in nanoseconds, from an unspecified starting point
+ */
+double getBenchmarkTimeInNs(void);
+
+void freeBenchmarkRunner(BenchmarkRunner self);
+void freeBenchmarkSuite(BenchmarkSuite self);
+
+#define addBenchmark(benchmarkSuite, name, setup, run, teardown) { \
+  addBenchmarkToBenchmarkSuite(benchmarkSuite, newBenchmarkCase(name, "sample", kBenchmarkParametersAll, setup, run, teardown)); \
+}
+
+#define addBenchmarkWithParameters(benchmarkSuite, name, unit, parameters, setup, run, teardown) { \
+  addBenchmarkToBenchmarkSuite(benchmarkSuite, newBenchmarkCase(name, unit, parameters, setup, run, teardown)); \
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include "MrsWatson.h"
 #include "logging/ErrorReporter.h"
 #include "logging/EventLogger.h"
+#include "plugin/PluginSandbox.h"
 
 // This is global so that in case of a crash or signal, we can still generate
 // a complete error report with a reference
@@ -23,6 +24,13 @@ static void handleSignal(int signum) {
 }
 
 int main(int argc, char* argv[]) {
+  int result;
+
+  // Sandboxed plugins are hosted by another instance of this program
+  if(pluginSandboxIsChildProcess(argc, argv)) {
+    return pluginSandboxChildMain(argc, argv, newPlugin);
+  }
+
   gErrorReporter = newErrorReporter();
 
   // Set up signal handling only after logging is initialized. If we crash before
@@ -64,5 +72,9 @@ int main(int argc, char* argv[]) {
   signal(SIGTERM, handleSignal);
 #endif
 
-  return mrsWatsonMain(gErrorReporter, argc, argv);
+  result = mrsWatsonMain(gErrorReporter, argc, argv);
+  // Write any queued log messages, since not every path through the program
+  // frees the logger before returning
+  stopAsyncLogging();
+  return result;
 }
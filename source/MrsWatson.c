@@ -29,12 +29,19 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "app/BatchManifest.h"
 #include "app/BuildInfo.h"
+#include "app/MrsWatsonContext.h"
+#include "app/RunStatistics.h"
 #include "audio/AudioSettings.h"
+#include "audio/SampleConversion.h"
 #include "base/FileUtilities.h"
 #include "base/PlatformUtilities.h"
 #include "base/StringUtilities.h"
+#include "base/Thread.h"
 #include "io/SampleSource.h"
+#include "io/SampleSourceAsync.h"
+#include "io/SampleSourceBuffered.h"
 #include "io/SampleSourcePcm.h"
 #include "io/SampleSourceSilence.h"
 #include "io/SampleSourceWave.h"
@@ -42,6 +49,7 @@
 #include "logging/LogPrinter.h"
 #include "midi/MidiSource.h"
 #include "plugin/PluginChain.h"
+#include "plugin/PluginScanCache.h"
 #include "sequencer/AudioClock.h"
 #include "sequencer/MidiSequence.h"
 
@@ -93,8 +101,11 @@ static void printWelcomeMessage(int argc, char** argv) {
     logWarn("Running in 64-bit mode, this is experimental. Hold on to your hats!");
   }
 
+  // This also picks the conversion kernel before any worker threads are started
+  logDebug("Sample conversion kernel is %s", sampleConversionKernelGetName(sampleConversionGetKernel()));
+
   // Prevent a bunch of silly work in case the log level isn't debug
-  if(isLogLevelAtLeast(LOG_DEBUG)) {
+  if(isLogLevelEnabled(LOG_DEBUG)) {
     stringBuffer = getPlatformName();
     logDebug("Host platform is %s (%s)", getShortPlatformName(), stringBuffer->data);
     logDebug("Application is %d-bit", isExecutable64Bit() ? 64 : 32);
@@ -137,8 +148,6 @@ static ReturnCodes buildPluginChain(PluginChain pluginChain, const CharString ar
   if(!pluginChainAddFromArgumentString(pluginChain, argument, pluginSearchRoot)) {
     return RETURN_CODE_INVALID_PLUGIN_CHAIN;
   }
-  // No longer needed
-  freeCharString(pluginSearchRoot);
 
   if(pluginChain->numPlugins == 0) {
     logError("No plugins loaded");
@@ -217,17 +226,447 @@ static void _processMidiMetaEvent(void* item, void* userData) {
   }
 }
 
+// Plugins with more channels than the input expand the buffers while processing,
+// so the channels are reserved up front to keep the processing loop free of
+// allocations.
+static void _reserveSampleBufferChannels(PluginChain pluginChain, SampleBuffer inputSampleBuffer, SampleBuffer outputSampleBuffer) {
+  const unsigned int maxNumChannels = pluginChainGetMaxNumChannels(pluginChain, getNumChannels());
+  sampleBufferReserve(inputSampleBuffer, maxNumChannels, getBlocksize());
+  sampleBufferReserve(outputSampleBuffer, maxNumChannels, getBlocksize());
+}
+
+static ReturnCodes processSampleSources(PluginChain pluginChain, SampleSource inputSource, SampleSource outputSource,
+  MidiSequence midiSequence, SampleBuffer inputSampleBuffer, SampleBuffer outputSampleBuffer, TaskTimer taskTimer,
+  const unsigned long maxTimeInFrames, unsigned long tailTimeInFrames, const boolByte usePipeline) {
+  AudioClock audioClock = getAudioClock();
+  SampleBuffer outputSampleBufferResized = NULL;
+  SampleSource silentSampleInput;
+  // Reused for each block, so that dense MIDI sequences do not allocate memory while rendering
+  LinkedList midiEventsForBlock;
+  boolByte finishedReading = false;
+  boolByte hasOutput;
+  int hostTaskId = taskTimer->numTasks - 1;
+  int ioTaskId = taskTimer->numTasks - 2;
+  const double blockDeadlineInMs = (double)getBlocksize() * 1000.0 / getSampleRate();
+  unsigned long stopFrame;
+  ReturnCodes result = RETURN_CODE_SUCCESS;
+
+  // The final block of a previous input source may have been shortened
+  inputSampleBuffer->blocksize = getBlocksize();
+  outputSampleBuffer->blocksize = getBlocksize();
+  if(usePipeline) {
+    if(!pluginChainStartPipeline(pluginChain, getNumChannels(), getBlocksize())) {
+      logError("Could not start processing pipeline");
+      return RETURN_CODE_INTERNAL_ERROR;
+    }
+  }
+
+  midiEventsForBlock = newLinkedList();
+  // Main processing loop
+  while(!finishedReading) {
+    startTimingTask(taskTimer, ioTaskId);
+    finishedReading = !inputSource->readSampleBlock(inputSource, inputSampleBuffer);
+    startTimingTask(taskTimer, hostTaskId);
+
+    // TODO: For streaming MIDI, we would need to read in events from source here
+    if(midiSequence != NULL) {
+      linkedListClear(midiEventsForBlock);
+      // MIDI source overrides the value set to finishedReading by the input source
+      finishedReading = !fillMidiEventsFromRange(midiSequence, audioClock->currentFrame, getBlocksize(), midiEventsForBlock);
+      linkedListForeach(midiEventsForBlock, _processMidiMetaEvent, &finishedReading);
+      pluginChainProcessMidi(pluginChain, midiEventsForBlock, taskTimer);
+      startTimingTask(taskTimer, hostTaskId);
+    }
+
+    if(maxTimeInFrames > 0 && audioClock->currentFrame >= maxTimeInFrames) {
+      logInfo("Maximum time reached, stopping processing after this block");
+      finishedReading = true;
+    }
+
+    hasOutput = pluginChainProcessAudio(pluginChain, inputSampleBuffer, outputSampleBuffer, taskTimer);
+    startTimingTask(taskTimer, hostTaskId);
+    if(pluginChainHasCrashed(pluginChain)) {
+      logError("Stopping processing because a plugin crashed");
+      result = RETURN_CODE_PLUGIN_ERROR;
+      break;
+    }
+
+    if(finishedReading) {
+      logInfo("Finished processing input source");
+      // When pipelined, the output is from an earlier block and the final block
+      // keeps its own size, so tail time is always processed in full blocks.
+      if(usePipeline) {
+        inputSampleBuffer->blocksize = getBlocksize();
+      }
+      // Tail time is given to process, but it will fill up this entire block.
+      // In this case, we re-extend the input buffer to the end of the block,
+      // and subtract that length from the total amount of tail time to process.
+      else if(inputSampleBuffer->blocksize + (long)tailTimeInFrames > outputSampleBuffer->blocksize) {
+        tailTimeInFrames -= inputSampleBuffer->blocksize;
+        inputSampleBuffer->blocksize = outputSampleBuffer->blocksize;
+      }
+      // Otherwise re-adjust the blocksize of the output sample buffer to match
+      // the input's size and the tail time (if given).
+      else {
+        outputSampleBuffer->blocksize = inputSampleBuffer->blocksize + tailTimeInFrames;
+        inputSampleBuffer->blocksize += tailTimeInFrames;
+      }
+      logDebug("Using buffer size of %d for final block", outputSampleBuffer->blocksize);
+    }
+
+    // Before writing the output source, see if one of the plugins in the chain
+    // has expanded the channel count. If so, we need to allocate a new buffer
+    // which will hold only the channels needed.
+    if(!hasOutput) {
+      // Pipeline is still filling up, nothing to write yet
+    }
+    else if(outputSampleBuffer->numChannels > getNumChannels()) {
+      if(outputSampleBufferResized == NULL) {
+        outputSampleBufferResized = newSampleBuffer(getNumChannels(), getBlocksize());
+      }
+      sampleBufferCopy(outputSampleBufferResized, outputSampleBuffer);
+      //outputSource->writeSampleBlock(outputSource, outputSampleBufferResized);
+    }
+    else {
+      startTimingTask(taskTimer, ioTaskId);
+      outputSource->writeSampleBlock(outputSource, outputSampleBuffer);
+      startTimingTask(taskTimer, hostTaskId);
+    }
+    advanceAudioClock(audioClock, getBlocksize());
+    taskTimerFinishBlock(taskTimer, blockDeadlineInMs);
+  }
+
+  // Process tail time
+  if(result == RETURN_CODE_SUCCESS && tailTimeInFrames > 0) {
+    stopFrame = audioClock->currentFrame + tailTimeInFrames;
+    logInfo("Adding %d extra frames", stopFrame - audioClock->currentFrame);
+    silentSampleInput = newSampleSource(SAMPLE_SOURCE_TYPE_SILENCE, NULL);
+    while(audioClock->currentFrame < stopFrame) {
+      startTimingTask(taskTimer, hostTaskId);
+      silentSampleInput->readSampleBlock(silentSampleInput, inputSampleBuffer);
+
+      hasOutput = pluginChainProcessAudio(pluginChain, inputSampleBuffer, outputSampleBuffer, taskTimer);
+      if(pluginChainHasCrashed(pluginChain)) {
+        logError("Stopping processing because a plugin crashed");
+        result = RETURN_CODE_PLUGIN_ERROR;
+        break;
+      }
+
+      if(hasOutput) {
+        startTimingTask(taskTimer, ioTaskId);
+        outputSource->writeSampleBlock(outputSource, outputSampleBuffer);
+      }
+      startTimingTask(taskTimer, hostTaskId);
+      advanceAudioClock(audioClock, getBlocksize());
+      taskTimerFinishBlock(taskTimer, blockDeadlineInMs);
+    }
+    freeSampleSource(silentSampleInput);
+  }
+
+  // Write any blocks which are still in the pipeline, then add the time used by
+  // each plugin on its own thread to the task timer.
+  while(result == RETURN_CODE_SUCCESS && pluginChainFlushAudio(pluginChain, outputSampleBuffer, taskTimer)) {
+    startTimingTask(taskTimer, ioTaskId);
+    outputSource->writeSampleBlock(outputSource, outputSampleBuffer);
+    startTimingTask(taskTimer, hostTaskId);
+    taskTimerFinishBlock(taskTimer, blockDeadlineInMs);
+  }
+  pluginChainStopPipeline(pluginChain, taskTimer);
+  audioClockStop(audioClock);
+
+  freeLinkedList(midiEventsForBlock);
+  if(outputSampleBufferResized != NULL) {
+    freeSampleBuffer(outputSampleBufferResized);
+  }
+  return result;
+}
+
+// Large I/O blocks are split up before the I/O queue, so that whole chunks are
+// also read and written on the I/O threads.
+static void _setupSampleSourceIo(SampleSource* inputSource, SampleSource* outputSource,
+  const unsigned long ioBlocksize, const int ioQueueDepth) {
+  if(ioBlocksize > getBlocksize()) {
+    *inputSource = newSampleSourceBuffered(*inputSource, ioBlocksize);
+    *outputSource = newSampleSourceBuffered(*outputSource, ioBlocksize);
+  }
+  if(ioQueueDepth > 0) {
+    *inputSource = newSampleSourceAsync(*inputSource, ioQueueDepth);
+    *outputSource = newSampleSourceAsync(*outputSource, ioQueueDepth);
+  }
+}
+
+static ReturnCodes setupBatchJob(const BatchJob batchJob, const unsigned long ioBlocksize, const int ioQueueDepth,
+  SampleSource* outInputSource, SampleSource* outOutputSource) {
+  SampleSource inputSource = newSampleSource(sampleSourceGuess(batchJob->inputSource), batchJob->inputSource);
+  SampleSource outputSource = newSampleSource(sampleSourceGuess(batchJob->outputSource), batchJob->outputSource);
+  ReturnCodes result = setupInputSource(inputSource);
+
+  if(result == RETURN_CODE_SUCCESS) {
+    result = setupOutputSource(outputSource);
+  }
+  if(result != RETURN_CODE_SUCCESS) {
+    if(inputSource != NULL) {
+      freeSampleSource(inputSource);
+    }
+    if(outputSource != NULL) {
+      freeSampleSource(outputSource);
+    }
+    return result;
+  }
+
+  _setupSampleSourceIo(&inputSource, &outputSource, ioBlocksize, ioQueueDepth);
+  *outInputSource = inputSource;
+  *outOutputSource = outputSource;
+  return RETURN_CODE_SUCCESS;
+}
+
+static void closeSampleSources(SampleSource inputSource, SampleSource outputSource,
+  MidiSource midiSource, MidiSequence midiSequence) {
+  // Close file handles for input/output sources
+  inputSource->closeSampleSource(inputSource);
+  outputSource->closeSampleSource(outputSource);
+
+  if(midiSequence != NULL) {
+    logInfo("Read %ld MIDI events from %s",
+      midiSequence->numMidiEventsProcessed,
+      midiSource->sourceName->data);
+  }
+  else {
+    logInfo("Read %ld frames from %s",
+      inputSource->numSamplesProcessed / getNumChannels(),
+      inputSource->sourceName->data);
+  }
+  logInfo("Wrote %ld frames to %s",
+    outputSource->numSamplesProcessed / getNumChannels(),
+    outputSource->sourceName->data);
+}
+
+/**
+ * Jobs from a batch manifest which are shared between all worker threads
+ */
+typedef struct {
+  BatchManifest batchManifest;
+  Mutex mutex;
+  int nextJobIndex;
+  int numFailedJobs;
+  unsigned long ioBlocksize;
+  int ioQueueDepth;
+  unsigned long maxTimeInFrames;
+  unsigned long tailTimeInFrames;
+  boolByte usePipeline;
+  PluginSandboxMode sandboxMode;
+  RunStatistics runStatistics;
+} BatchQueueMembers;
+typedef BatchQueueMembers* BatchQueue;
+
+/**
+ * Each worker renders jobs with its own copy of the plugin chain and its own
+ * context. The context is NULL for the main thread, which uses the global one.
+ */
+typedef struct {
+  BatchQueue queue;
+  PluginChain pluginChain;
+  MrsWatsonContext context;
+  SampleBuffer inputSampleBuffer;
+  SampleBuffer outputSampleBuffer;
+  TaskTimer taskTimer;
+  boolByte isChainUsed;
+  Thread thread;
+  ReturnCodes result;
+} BatchWorkerMembers;
+typedef BatchWorkerMembers* BatchWorker;
+
+static int _takeBatchJobIndex(BatchQueue queue) {
+  int jobIndex = -1;
+  mutexLock(queue->mutex);
+  if(queue->nextJobIndex < queue->batchManifest->numJobs) {
+    jobIndex = queue->nextJobIndex++;
+  }
+  mutexUnlock(queue->mutex);
+  return jobIndex;
+}
+
+static ReturnCodes processBatchJobs(BatchWorker worker) {
+  BatchQueue queue = worker->queue;
+  SampleSource inputSource;
+  SampleSource outputSource;
+  ReturnCodes result;
+  int jobIndex;
+
+  while((jobIndex = _takeBatchJobIndex(queue)) >= 0) {
+    if(setupBatchJob(queue->batchManifest->jobs[jobIndex], queue->ioBlocksize, queue->ioQueueDepth,
+      &inputSource, &outputSource) != RETURN_CODE_SUCCESS) {
+      logError("Skipping batch job %d of %d", jobIndex + 1, queue->batchManifest->numJobs);
+      mutexLock(queue->mutex);
+      queue->numFailedJobs++;
+      mutexUnlock(queue->mutex);
+      continue;
+    }
+
+    logInfo("Starting batch job %d of %d", jobIndex + 1, queue->batchManifest->numJobs);
+    if(worker->isChainUsed) {
+      pluginChainReset(worker->pluginChain);
+      audioClockRewind(mrsWatsonContextGetAudioClock(worker->context));
+    }
+    worker->isChainUsed = true;
+    result = processSampleSources(worker->pluginChain, inputSource, outputSource, NULL,
+      worker->inputSampleBuffer, worker->outputSampleBuffer, worker->taskTimer,
+      queue->maxTimeInFrames, queue->tailTimeInFrames, queue->usePipeline);
+    if(result == RETURN_CODE_SUCCESS) {
+      closeSampleSources(inputSource, outputSource, NULL, NULL);
+      runStatisticsAddJob(queue->runStatistics, inputSource, outputSource, getNumChannels());
+    }
+    else {
+      // Sandboxed plugins are restarted when the chain is reset for the next job
+      logError("Batch job %d of %d failed", jobIndex + 1, queue->batchManifest->numJobs);
+      mutexLock(queue->mutex);
+      queue->numFailedJobs++;
+      mutexUnlock(queue->mutex);
+      result = RETURN_CODE_SUCCESS;
+    }
+    freeSampleSource(inputSource);
+    freeSampleSource(outputSource);
+    if(result != RETURN_CODE_SUCCESS) {
+      return result;
+    }
+  }
+
+  return RETURN_CODE_SUCCESS;
+}
+
+static void* _batchWorkerThread(void* workerPtr) {
+  BatchWorker worker = (BatchWorker)workerPtr;
+  setThreadMrsWatsonContext(worker->context);
+  worker->result = processBatchJobs(worker);
+  return NULL;
+}
+
+static void freeBatchWorker(BatchWorker self) {
+  if(self->pluginChain != NULL) {
+    pluginChainShutdown(self->pluginChain);
+    freePluginChain(self->pluginChain);
+  }
+  freeSampleBuffer(self->inputSampleBuffer);
+  freeSampleBuffer(self->outputSampleBuffer);
+  freeTaskTimer(self->taskTimer);
+  freeThread(self->thread);
+  freeMrsWatsonContext(self->context);
+  free(self);
+}
+
+// Plugins are loaded on the calling thread, one chain at a time, since loading
+// VST shell plugins depends on a global variable. Any settings which are changed
+// afterwards by the worker's sample sources only affect that worker.
+static BatchWorker newBatchWorker(BatchQueue queue, const CharString pluginArgument, const CharString pluginSearchRoot) {
+  BatchWorker worker = (BatchWorker)malloc(sizeof(BatchWorkerMembers));
+  ReturnCodes result;
+
+  worker->queue = queue;
+  worker->context = newMrsWatsonContext();
+  worker->isChainUsed = false;
+  worker->thread = newThread(_batchWorkerThread, worker);
+  worker->result = RETURN_CODE_SUCCESS;
+
+  setThreadMrsWatsonContext(worker->context);
+  worker->pluginChain = newPluginChain();
+  pluginChainSetSandboxMode(worker->pluginChain, queue->sandboxMode);
+  worker->inputSampleBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+  worker->outputSampleBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
+  runStatisticsStartPhase(queue->runStatistics, kRunPhasePluginLoad);
+  result = buildPluginChain(worker->pluginChain, pluginArgument, pluginSearchRoot);
+  runStatisticsStartPhase(queue->runStatistics, kRunPhasePluginInitialize);
+  if(result == RETURN_CODE_SUCCESS) {
+    result = pluginChainInitialize(worker->pluginChain);
+  }
+  if(result == RETURN_CODE_SUCCESS) {
+    pluginChainTakeSnapshot(worker->pluginChain);
+  }
+  if(result == RETURN_CODE_SUCCESS) {
+    pluginChainPrepareForProcessing(worker->pluginChain);
+    _reserveSampleBufferChannels(worker->pluginChain, worker->inputSampleBuffer, worker->outputSampleBuffer);
+  }
+  worker->taskTimer = newTaskTimer(worker->pluginChain->numPlugins + 2);
+  setThreadMrsWatsonContext(NULL);
+
+  if(result != RETURN_CODE_SUCCESS) {
+    // Plugins which could not be opened cannot be closed either, so the chain
+    // is freed without shutting it down
+    freePluginChain(worker->pluginChain);
+    worker->pluginChain = NULL;
+    freeBatchWorker(worker);
+    return NULL;
+  }
+  return worker;
+}
+
+/**
+ * Stop handing out jobs, wait for the worker threads which were started and
+ * free all workers along with the queue. This is used both when all jobs are
+ * done and when the run is aborted, in which case workers may still be busy
+ * with the job that they have already taken.
+ * @param queue Batch queue
+ * @param workers Workers, where the first one and any which were not created
+ * are NULL
+ * @param numWorkers Number of workers
+ * @param taskTimer Timer which the time used by the workers is added to, or NULL
+ * @param outNumFailedJobs Set to the number of jobs which failed, or NULL
+ * @return Result of the first worker which did not succeed
+ */
+static ReturnCodes _finishBatchWorkers(BatchQueue queue, BatchWorker* workers, const int numWorkers,
+  TaskTimer taskTimer, int* outNumFailedJobs) {
+  ReturnCodes result = RETURN_CODE_SUCCESS;
+  int i;
+
+  mutexLock(queue->mutex);
+  queue->nextJobIndex = queue->batchManifest->numJobs;
+  mutexUnlock(queue->mutex);
+
+  // The time used by all workers is added up, so the total processing time
+  // may be larger than the actual run time.
+  for(i = 1; i < numWorkers; i++) {
+    if(workers[i] == NULL) {
+      continue;
+    }
+    if(threadJoin(workers[i]->thread) && workers[i]->result != RETURN_CODE_SUCCESS &&
+      result == RETURN_CODE_SUCCESS) {
+      result = workers[i]->result;
+    }
+    if(taskTimer != NULL) {
+      stopTiming(workers[i]->taskTimer);
+      taskTimerMerge(taskTimer, workers[i]->taskTimer);
+    }
+    freeBatchWorker(workers[i]);
+  }
+
+  if(outNumFailedJobs != NULL) {
+    *outNumFailedJobs = queue->numFailedJobs;
+  }
+  free(workers);
+  freeMutex(queue->mutex);
+  free(queue);
+  return result;
+}
+
 int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
   ReturnCodes result;
   // Input/Output sources, plugin chain, and other required objects
   SampleSource inputSource = NULL;
   SampleSource outputSource = NULL;
-  AudioClock audioClock;
   PluginChain pluginChain = newPluginChain();
   CharString pluginSearchRoot = newCharString();
   boolByte shouldDisplayPluginInfo = false;
   MidiSequence midiSequence = NULL;
   MidiSource midiSource = NULL;
+  BatchManifest batchManifest = NULL;
+  BatchJob batchJob;
+  BatchQueue batchQueue = NULL;
+  BatchWorker* batchWorkers = NULL;
+  BatchWorkerMembers mainBatchWorker;
+  ReturnCodes workerResult;
+  int numBatchWorkers = 1;
+  int numFailedJobs = 0;
+  unsigned long ioBlocksize = 0;
+  int ioQueueDepth = 0;
   long maxTimeInMs = 0;
   unsigned long maxTimeInFrames = 0;
   long tailTimeInMs = 0;
@@ -237,21 +676,27 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
   Plugin headPlugin;
   SampleBuffer inputSampleBuffer = NULL;
   SampleBuffer outputSampleBuffer = NULL;
-  SampleBuffer outputSampleBufferResized = NULL;
   TaskTimer taskTimer;
   CharString totalTimeString;
-  boolByte finishedReading = false;
+  CharString timingReportPath = NULL;
+  const char** taskNames;
+  RunStatistics runStatistics = newRunStatistics();
+  CharString statisticsPath = NULL;
+  CharString pluginCachePath = NULL;
+  PluginScanCache pluginScanCache = NULL;
+  unsigned long streamBufferSizeInMs = DEFAULT_STREAM_BUFFER_SIZE_IN_MS;
+  PcmStreamPolicy streamPolicy = kPcmStreamPolicyWait;
+  PluginSandboxMode sandboxMode = kPluginSandboxModeNone;
+  boolByte usePipeline = false;
   int hostTaskId;
-  SampleSource silentSampleInput;
+  int ioTaskId;
   double totalProcessingTime = 0.0;
-  unsigned long stopFrame;
   double timePercentage;
   int i;
 
   initEventLogger();
   initAudioSettings();
   initAudioClock();
-  audioClock = getAudioClock();
   programOptions = newMrsWatsonOptions();
   inputSource = newSampleSource(SAMPLE_SOURCE_TYPE_SILENCE, NULL);
 
@@ -347,12 +792,28 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
   if(programOptions->options[OPTION_LOG_FILE]->enabled) {
     setLogFile(programOptions->options[OPTION_LOG_FILE]->argument);
   }
+  // Must come after the log file is set, and before any other threads are started
+  if(programOptions->options[OPTION_LOG_ASYNC]->enabled) {
+    startAsyncLogging();
+  }
 
   // Parse other options and set up necessary objects
   for(i = 0; i < programOptions->numOptions; i++) {
     option = programOptions->options[i];
     if(option->enabled) {
       switch(option->index) {
+        case OPTION_BATCH:
+          batchManifest = newBatchManifest();
+          if(!batchManifestParseFile(batchManifest, option->argument)) {
+            return RETURN_CODE_INVALID_ARGUMENT;
+          }
+          break;
+        case OPTION_BATCH_WORKERS:
+          numBatchWorkers = (int)strtol(option->argument->data, NULL, 10);
+          break;
+        case OPTION_BIT_DEPTH:
+          setSampleFormat(sampleFormatFromString(option->argument->data));
+          break;
         case OPTION_BLOCKSIZE:
           setBlocksize(strtol(option->argument->data, NULL, 10));
           break;
@@ -366,6 +827,12 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
           freeSampleSource(inputSource);
           inputSource = newSampleSource(sampleSourceGuess(option->argument), option->argument);
           break;
+        case OPTION_IO_BLOCKSIZE:
+          ioBlocksize = strtoul(option->argument->data, NULL, 10);
+          break;
+        case OPTION_IO_QUEUE_DEPTH:
+          ioQueueDepth = (int)strtol(option->argument->data, NULL, 10);
+          break;
         case OPTION_MAX_TIME:
           maxTimeInMs = strtol(option->argument->data, NULL, 10);
           break;
@@ -375,12 +842,49 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
         case OPTION_OUTPUT_SOURCE:
           outputSource = newSampleSource(sampleSourceGuess(option->argument), option->argument);
           break;
+        case OPTION_PIPELINE:
+          usePipeline = true;
+          break;
+        case OPTION_PLUGIN_CACHE:
+          pluginCachePath = newCharString();
+          charStringCopy(pluginCachePath, option->argument);
+          break;
         case OPTION_PLUGIN_ROOT:
           charStringCopy(pluginSearchRoot, option->argument);
           break;
         case OPTION_SAMPLE_RATE:
           setSampleRate(strtod(option->argument->data, NULL));
           break;
+        case OPTION_SANDBOX:
+          if(!pluginSandboxIsSupported()) {
+            logUnsupportedFeature("Plugin sandboxing");
+            return RETURN_CODE_UNSUPPORTED_FEATURE;
+          }
+          else if(charStringIsEmpty(option->argument)) {
+            sandboxMode = kPluginSandboxModePlugin;
+          }
+          else {
+            sandboxMode = pluginSandboxModeFromString(option->argument->data);
+            if(sandboxMode == kNumPluginSandboxModes) {
+              logError("Invalid sandbox mode '%s', must be either 'plugin' or 'chain'", option->argument->data);
+              return RETURN_CODE_INVALID_ARGUMENT;
+            }
+          }
+          break;
+        case OPTION_STATS:
+          statisticsPath = newCharString();
+          charStringCopy(statisticsPath, option->argument);
+          break;
+        case OPTION_STREAM_BUFFER:
+          streamBufferSizeInMs = strtoul(option->argument->data, NULL, 10);
+          break;
+        case OPTION_STREAM_POLICY:
+          streamPolicy = pcmStreamPolicyFromString(option->argument->data);
+          if(streamPolicy == kNumPcmStreamPolicies) {
+            logError("Invalid stream policy '%s', must be either 'wait' or 'realtime'", option->argument->data);
+            return RETURN_CODE_INVALID_ARGUMENT;
+          }
+          break;
         case OPTION_TAIL_TIME:
           tailTimeInMs = strtol(option->argument->data, NULL, 10);
           break;
@@ -396,6 +900,10 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
         case OPTION_TIME_SIGNATURE_BOTTOM:
           setTimeSignatureNoteValue((short)strtol(option->argument->data, NULL, 10));
           break;
+        case OPTION_TIMING_REPORT:
+          timingReportPath = newCharString();
+          charStringCopy(timingReportPath, option->argument);
+          break;
         case OPTION_ZEBRA_SIZE:
           setLoggingZebraSize((int)strtol(option->argument->data, NULL, 10));
           break;
@@ -406,6 +914,15 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
     }
   }
 
+  // Must be set before any plugins are searched for
+  if(pluginCachePath != NULL) {
+    pluginScanCache = newPluginScanCache();
+    if(!pluginScanCacheLoad(pluginScanCache, pluginCachePath)) {
+      logWarn("Plugin cache could not be read, it will be rebuilt");
+    }
+    setPluginScanCache(pluginScanCache);
+  }
+
   if(programOptions->options[OPTION_LIST_PLUGINS]->enabled) {
     listAvailablePlugins(pluginSearchRoot);
     return RETURN_CODE_NOT_RUN;
@@ -415,16 +932,47 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
     return RETURN_CODE_NOT_RUN;
   }
 
+  // The first batch job is opened in place of the regular input and output
+  // sources, so that it is validated along with the plugin chain.
+  if(batchManifest != NULL) {
+    if(programOptions->options[OPTION_INPUT_SOURCE]->enabled ||
+      programOptions->options[OPTION_OUTPUT_SOURCE]->enabled || midiSource != NULL) {
+      logError("Batch mode cannot be combined with an input, output, or MIDI source");
+      return RETURN_CODE_INVALID_ARGUMENT;
+    }
+    if(numBatchWorkers < 1) {
+      logError("Invalid number of batch workers");
+      return RETURN_CODE_INVALID_ARGUMENT;
+    }
+    else if(numBatchWorkers > batchManifest->numJobs) {
+      numBatchWorkers = batchManifest->numJobs;
+    }
+    batchJob = batchManifest->jobs[0];
+    freeSampleSource(inputSource);
+    inputSource = newSampleSource(sampleSourceGuess(batchJob->inputSource), batchJob->inputSource);
+    outputSource = newSampleSource(sampleSourceGuess(batchJob->outputSource), batchJob->outputSource);
+  }
+
+  // Buffering only applies to raw PCM data piped through stdin and stdout
+  if(sampleSourceIsStreaming(inputSource) && inputSource->sampleSourceType == SAMPLE_SOURCE_TYPE_PCM) {
+    sampleSourcePcmSetStreamOptions(inputSource, streamBufferSizeInMs, streamPolicy);
+  }
+  if(sampleSourceIsStreaming(outputSource) && outputSource->sampleSourceType == SAMPLE_SOURCE_TYPE_PCM) {
+    sampleSourcePcmSetStreamOptions(outputSource, streamBufferSizeInMs, streamPolicy);
+  }
+
   printWelcomeMessage(argc, argv);
   if((result = setupInputSource(inputSource)) != RETURN_CODE_SUCCESS) {
     logError("Input source could not be opened, exiting");
     return result;
   }
+  runStatisticsStartPhase(runStatistics, kRunPhasePluginLoad);
   if((result = buildPluginChain(pluginChain, programOptions->options[OPTION_PLUGIN]->argument,
     pluginSearchRoot)) != RETURN_CODE_SUCCESS) {
     logError("Plugin chain could not be constructed, exiting");
     return result;
   }
+  runStatisticsStopPhase(runStatistics);
   if(midiSource != NULL) {
     result = setupMidiSource(midiSource, &midiSequence);
     if(result != RETURN_CODE_SUCCESS) {
@@ -443,17 +991,37 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
   }
 
   // Initialize the plugin chain after the global sample rate has been set
+  runStatisticsStartPhase(runStatistics, kRunPhasePluginInitialize);
+  pluginChainSetSandboxMode(pluginChain, sandboxMode);
   result = pluginChainInitialize(pluginChain);
   if(result != RETURN_CODE_SUCCESS) {
     logError("Could not initialize plugin chain");
     return result;
   }
+  // Each batch job starts with the plugins in the state they are in now
+  if(batchManifest != NULL) {
+    pluginChainTakeSnapshot(pluginChain);
+  }
+  runStatisticsStopPhase(runStatistics);
 
   // Display info for plugins in the chain before checking for valid input/output sources
   if(shouldDisplayPluginInfo) {
     pluginChainInspect(pluginChain);
   }
 
+  // All plugins have been found and loaded at this point, so nothing else will
+  // be added to the cache
+  if(pluginScanCache != NULL && !pluginScanCacheSave(pluginScanCache, pluginCachePath)) {
+    logWarn("Plugin cache could not be saved");
+  }
+
+  // Opening a streaming output source renames it, so this must be checked first
+  if(statisticsPath != NULL && charStringIsEqualToCString(statisticsPath, "-", false) &&
+    sampleSourceIsStreaming(outputSource)) {
+    logError("Statistics cannot be written to stdout when it is used as the output source");
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
   // Setup output source here. Having an invalid output source should not cause the program
   // to exit if the user only wants to list plugins or query info about a chain.
   if((result = setupOutputSource(outputSource)) != RETURN_CODE_SUCCESS) {
@@ -506,18 +1074,61 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
     }
   }
 
+  // Change the I/O blocksize and move reading and writing to separate threads.
+  // This must be done after all checks above, which depend on the type of the
+  // original sources.
+  if(ioBlocksize > 0 && ioBlocksize <= getBlocksize()) {
+    logWarn("I/O blocksize %ld is not larger than the blocksize, ignoring it", ioBlocksize);
+    ioBlocksize = 0;
+  }
+  else if(ioBlocksize > 0) {
+    logDebug("Using I/O blocksize of %ld frames", ioBlocksize);
+  }
+  if(ioQueueDepth > 0) {
+    logDebug("Using I/O queue depth of %d blocks", ioQueueDepth);
+  }
+  _setupSampleSourceIo(&inputSource, &outputSource, ioBlocksize, ioQueueDepth);
+
   inputSampleBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
   // By default, the output buffer has the same channel count as the input buffer,
   // but if a plugin requests a larger I/O configuration this buffer will be resized.
   outputSampleBuffer = newSampleBuffer(getNumChannels(), getBlocksize());
 
   // Initialize task timer to record how much time was used by each plugin (and us). The
-  // last index in the task timer will be reserved for the host.
-  taskTimer = newTaskTimer(pluginChain->numPlugins + 1);
+  // last two indexes in the task timer are reserved for I/O and the host.
+  taskTimer = newTaskTimer(pluginChain->numPlugins + 2);
   hostTaskId = taskTimer->numTasks - 1;
+  ioTaskId = taskTimer->numTasks - 2;
+
+  // The main thread renders the first batch job, and every other worker thread
+  // gets its own plugin chain. Other jobs go to whichever worker is free first.
+  if(batchManifest != NULL) {
+    batchQueue = (BatchQueue)malloc(sizeof(BatchQueueMembers));
+    batchQueue->batchManifest = batchManifest;
+    batchQueue->mutex = newMutex();
+    batchQueue->nextJobIndex = 1;
+    batchQueue->numFailedJobs = 0;
+    batchQueue->ioBlocksize = ioBlocksize;
+    batchQueue->ioQueueDepth = ioQueueDepth;
+    batchQueue->usePipeline = usePipeline;
+    batchQueue->sandboxMode = sandboxMode;
+    batchQueue->runStatistics = runStatistics;
+    batchWorkers = (BatchWorker*)calloc((size_t)numBatchWorkers, sizeof(BatchWorker));
+    for(i = 1; i < numBatchWorkers; i++) {
+      logInfo("Creating plugin chain for batch worker %d", i + 1);
+      batchWorkers[i] = newBatchWorker(batchQueue, programOptions->options[OPTION_PLUGIN]->argument, pluginSearchRoot);
+      if(batchWorkers[i] == NULL) {
+        logError("Could not create batch worker, exiting");
+        _finishBatchWorkers(batchQueue, batchWorkers, numBatchWorkers, NULL, NULL);
+        return RETURN_CODE_INVALID_PLUGIN_CHAIN;
+      }
+    }
+    runStatisticsStopPhase(runStatistics);
+  }
 
   // Initialization is finished, we should be able to free this memory now
   freeProgramOptions(programOptions);
+  freeCharString(pluginSearchRoot);
 
   // If a maximum time was given, figure it out here
   if(maxTimeInMs > 0) {
@@ -527,7 +1138,22 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
   // Get largest tail time requested by any plugin in the chain
   tailTimeInMs += pluginChainGetMaximumTailTimeInMs(pluginChain);
   tailTimeInFrames = (unsigned long)(tailTimeInMs * getSampleRate()) / 1000l;
+  runStatisticsStartPhase(runStatistics, kRunPhasePluginInitialize);
   pluginChainPrepareForProcessing(pluginChain);
+  _reserveSampleBufferChannels(pluginChain, inputSampleBuffer, outputSampleBuffer);
+  runStatisticsStartPhase(runStatistics, kRunPhaseProcessing);
+  runStatistics->sampleRate = getSampleRate();
+  if(batchQueue != NULL) {
+    batchQueue->maxTimeInFrames = maxTimeInFrames;
+    batchQueue->tailTimeInFrames = tailTimeInFrames;
+    for(i = 1; i < numBatchWorkers; i++) {
+      if(!threadStart(batchWorkers[i]->thread)) {
+        logError("Could not start batch worker thread");
+        _finishBatchWorkers(batchQueue, batchWorkers, numBatchWorkers, NULL, NULL);
+        return RETURN_CODE_INTERNAL_ERROR;
+      }
+    }
+  }
 
   // Update sample rate on the event logger
   setLoggingZebraSize((long)getSampleRate());
@@ -538,93 +1164,69 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
   logDebug("Tempo: %.2f", getTempo());
   logDebug("Time signature: %d/%d", getTimeSignatureBeatsPerMeasure(), getTimeSignatureNoteValue());
 
-  // Main processing loop
-  while(!finishedReading) {
-    startTimingTask(taskTimer, hostTaskId);
-    finishedReading = !inputSource->readSampleBlock(inputSource, inputSampleBuffer);
-
-    // TODO: For streaming MIDI, we would need to read in events from source here
-    if(midiSequence != NULL) {
-      LinkedList midiEventsForBlock = newLinkedList();
-      // MIDI source overrides the value set to finishedReading by the input source
-      finishedReading = !fillMidiEventsFromRange(midiSequence, audioClock->currentFrame, getBlocksize(), midiEventsForBlock);
-      linkedListForeach(midiEventsForBlock, _processMidiMetaEvent, &finishedReading);
-      pluginChainProcessMidi(pluginChain, midiEventsForBlock, taskTimer);
-      startTimingTask(taskTimer, hostTaskId);
-      freeLinkedList(midiEventsForBlock);
-    }
-
-    if(maxTimeInFrames > 0 && audioClock->currentFrame >= maxTimeInFrames) {
-      logInfo("Maximum time reached, stopping processing after this block");
-      finishedReading = true;
-    }
-
-    pluginChainProcessAudio(pluginChain, inputSampleBuffer, outputSampleBuffer, taskTimer);
-    startTimingTask(taskTimer, hostTaskId);
-
-    if(finishedReading) {
-      logInfo("Finished processing input source");
-      // Tail time is given to process, but it will fill up this entire block.
-      // In this case, we re-extend the input buffer to the end of the block,
-      // and subtract that length from the total amount of tail time to process.
-      if(inputSampleBuffer->blocksize + (long)tailTimeInFrames > outputSampleBuffer->blocksize) {
-        tailTimeInFrames -= inputSampleBuffer->blocksize;
-        inputSampleBuffer->blocksize = outputSampleBuffer->blocksize;
-      }
-      // Otherwise re-adjust the blocksize of the output sample buffer to match
-      // the input's size and the tail time (if given).
-      else {
-        outputSampleBuffer->blocksize = inputSampleBuffer->blocksize + tailTimeInFrames;
-        inputSampleBuffer->blocksize += tailTimeInFrames;
-      }
-      logDebug("Using buffer size of %d for final block", outputSampleBuffer->blocksize);
-    }
+  result = processSampleSources(pluginChain, inputSource, outputSource, midiSequence,
+    inputSampleBuffer, outputSampleBuffer, taskTimer, maxTimeInFrames, tailTimeInFrames, usePipeline);
+  if(batchQueue != NULL && result != RETURN_CODE_SUCCESS) {
+    // The same as a failed job on any other worker, the remaining jobs are
+    // still processed
+    logError("Batch job 1 of %d failed", batchManifest->numJobs);
+    mutexLock(batchQueue->mutex);
+    batchQueue->numFailedJobs++;
+    mutexUnlock(batchQueue->mutex);
+  }
+  else if(result != RETURN_CODE_SUCCESS) {
+    return result;
+  }
+  else {
+    closeSampleSources(inputSource, outputSource, midiSource, midiSequence);
+    runStatisticsAddJob(runStatistics, inputSource, outputSource, getNumChannels());
+  }
 
-    // Before writing the output source, see if one of the plugins in the chain
-    // has expanded the channel count. If so, we need to allocate a new buffer
-    // which will hold only the channels needed.
-    if(outputSampleBuffer->numChannels > getNumChannels()) {
-      if(outputSampleBufferResized == NULL) {
-        outputSampleBufferResized = newSampleBuffer(getNumChannels(), getBlocksize());
-      }
-      sampleBufferCopy(outputSampleBufferResized, outputSampleBuffer);
-      //outputSource->writeSampleBlock(outputSource, outputSampleBufferResized);
+  // In batch mode, the main thread keeps rendering jobs with its plugin chain,
+  // which only needs to be reset between input sources.
+  if(batchQueue != NULL) {
+    freeSampleSource(inputSource);
+    freeSampleSource(outputSource);
+    inputSource = NULL;
+    outputSource = NULL;
+
+    mainBatchWorker.queue = batchQueue;
+    mainBatchWorker.pluginChain = pluginChain;
+    mainBatchWorker.inputSampleBuffer = inputSampleBuffer;
+    mainBatchWorker.outputSampleBuffer = outputSampleBuffer;
+    mainBatchWorker.taskTimer = taskTimer;
+    mainBatchWorker.isChainUsed = true;
+    mainBatchWorker.context = NULL;
+    mainBatchWorker.thread = NULL;
+    mainBatchWorker.result = RETURN_CODE_SUCCESS;
+    result = processBatchJobs(&mainBatchWorker);
+    workerResult = _finishBatchWorkers(batchQueue, batchWorkers, numBatchWorkers, taskTimer, &numFailedJobs);
+    if(result == RETURN_CODE_SUCCESS) {
+      result = workerResult;
     }
-    else {
-      outputSource->writeSampleBlock(outputSource, outputSampleBuffer);
+    if(result != RETURN_CODE_SUCCESS) {
+      return result;
     }
-    advanceAudioClock(audioClock, getBlocksize());
-  }
-
-  // Process tail time
-  if(tailTimeInMs > 0) {
-    stopFrame = audioClock->currentFrame + tailTimeInFrames;
-    logInfo("Adding %d extra frames", stopFrame - audioClock->currentFrame);
-    silentSampleInput = newSampleSource(SAMPLE_SOURCE_TYPE_SILENCE, NULL);
-    while(audioClock->currentFrame < stopFrame) {
-      startTimingTask(taskTimer, hostTaskId);
-      silentSampleInput->readSampleBlock(silentSampleInput, inputSampleBuffer);
-
-      pluginChainProcessAudio(pluginChain, inputSampleBuffer, outputSampleBuffer, taskTimer);
 
-      startTimingTask(taskTimer, hostTaskId);
-      outputSource->writeSampleBlock(outputSource, outputSampleBuffer);
-      advanceAudioClock(audioClock, getBlocksize());
+    if(numFailedJobs > 0) {
+      logError("%d of %d batch jobs could not be processed", numFailedJobs, batchManifest->numJobs);
+      result = RETURN_CODE_IO_ERROR;
     }
+    freeBatchManifest(batchManifest);
   }
 
-  // Close file handles for input/output sources
-  inputSource->closeSampleSource(inputSource);
-  outputSource->closeSampleSource(outputSource);
-
   // Print out statistics about each plugin's time usage
-  // TODO: On windows, the total processing time is stored in clocks and not milliseconds
-  // These values must be converted using the QueryPerformanceFrequency() function
-  audioClockStop(audioClock);
+  runStatisticsStopPhase(runStatistics);
   stopTiming(taskTimer);
   for(i = 0; i < taskTimer->numTasks; i++) {
     totalProcessingTime += taskTimer->totalTaskTimes[i];
   }
+  for(i = 0; i < pluginChain->numPlugins; i++) {
+    runStatistics->pluginTimeInMs += taskTimer->totalTaskTimes[i];
+  }
+  runStatistics->ioTimeInMs = taskTimer->totalTaskTimes[ioTaskId];
+  runStatistics->hostTimeInMs = taskTimer->totalTaskTimes[hostTaskId];
+  runStatistics->numBlocks = taskTimer->blockHistogram->count;
 
   totalTimeString = newCharString();
   if(totalProcessingTime > 0) {
@@ -635,6 +1237,9 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
       prettyPrintTime(totalTimeString, taskTimer->totalTaskTimes[i]); 
       logInfo("%s: %s, %2.1f%%", pluginChain->plugins[i]->pluginName->data, totalTimeString->data, timePercentage);
     }
+    timePercentage = 100.0f * taskTimer->totalTaskTimes[ioTaskId] / totalProcessingTime;
+    prettyPrintTime(totalTimeString, taskTimer->totalTaskTimes[ioTaskId]);
+    logInfo("I/O: %s, %2.1f%%", totalTimeString->data, timePercentage);
     timePercentage = 100.0f * taskTimer->totalTaskTimes[hostTaskId] / totalProcessingTime;
     prettyPrintTime(totalTimeString, taskTimer->totalTaskTimes[hostTaskId]);
     logInfo("%s: %s, %2.1f%%", PROGRAM_NAME, totalTimeString->data, timePercentage);
@@ -642,31 +1247,58 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
   else {
     logInfo("Total processing time <1ms. Either something went wrong, or your computer is smokin' fast!");
   }
-  freeTaskTimer(taskTimer);
-  freeCharString(totalTimeString);
-
-  if(midiSequence != NULL) {
-    logInfo("Read %ld MIDI events from %s",
-      midiSequence->numMidiEventsProcessed,
-      midiSource->sourceName->data);
+  if(taskTimer->numMissedBlockDeadlines > 0) {
+    logInfo("%lu of %lu blocks took longer to process than their duration",
+      taskTimer->numMissedBlockDeadlines, taskTimer->blockHistogram->count);
   }
-  else {
-    logInfo("Read %ld frames from %s",
-      inputSource->numSamplesProcessed / getNumChannels(),
-      inputSource->sourceName->data);
+
+  if(timingReportPath != NULL) {
+    taskNames = (const char**)malloc(sizeof(const char*) * taskTimer->numTasks);
+    for(i = 0; i < pluginChain->numPlugins; i++) {
+      taskNames[i] = pluginChain->plugins[i]->pluginName->data;
+    }
+    taskNames[ioTaskId] = "I/O";
+    taskNames[hostTaskId] = PROGRAM_NAME;
+    if(taskTimerWriteReport(taskTimer, timingReportPath, taskNames, (double)getBlocksize() * 1000.0 / getSampleRate())) {
+      logInfo("Wrote timing report to '%s'", timingReportPath->data);
+    }
+    else if(result == RETURN_CODE_SUCCESS) {
+      result = RETURN_CODE_IO_ERROR;
+    }
+    free(taskNames);
+    freeCharString(timingReportPath);
   }
-  logInfo("Wrote %ld frames to %s",
-    outputSource->numSamplesProcessed / getNumChannels(),
-    outputSource->sourceName->data);
+  freeTaskTimer(taskTimer);
+  freeCharString(totalTimeString);
 
   // Shut down and free data (will also close open files, plugins, etc)
   logInfo("Shutting down");
-  freeSampleSource(inputSource);
-  freeSampleSource(outputSource);
+  if(inputSource != NULL) {
+    freeSampleSource(inputSource);
+  }
+  if(outputSource != NULL) {
+    freeSampleSource(outputSource);
+  }
   freeSampleBuffer(inputSampleBuffer);
   freeSampleBuffer(outputSampleBuffer);
+  runStatisticsStartPhase(runStatistics, kRunPhaseShutdown);
   pluginChainShutdown(pluginChain);
   freePluginChain(pluginChain);
+  runStatisticsStopPhase(runStatistics);
+
+  if(pluginScanCache != NULL) {
+    setPluginScanCache(NULL);
+    freePluginScanCache(pluginScanCache);
+    freeCharString(pluginCachePath);
+  }
+
+  if(statisticsPath != NULL) {
+    if(!runStatisticsWriteReport(runStatistics, statisticsPath) && result == RETURN_CODE_SUCCESS) {
+      result = RETURN_CODE_IO_ERROR;
+    }
+    freeCharString(statisticsPath);
+  }
+  freeRunStatistics(runStatistics);
 
   if(midiSource != NULL) {
     freeMidiSource(midiSource);
@@ -684,5 +1316,5 @@ int mrsWatsonMain(ErrorReporter errorReporter, int argc, char** argv) {
     freeErrorReporter(errorReporter);
   }
 
-  return RETURN_CODE_SUCCESS;
+  return result;
 }
@@ -30,12 +30,31 @@
 
 #include "audio/AudioSettings.h"
 #include "base/FileUtilities.h"
+#include "io/SampleSourcePcm.h"
 
 #include "MrsWatsonOptions.h"
 
 ProgramOptions newMrsWatsonOptions(void) {
   ProgramOptions options = newProgramOptions(NUM_OPTIONS);
 
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_BATCH, "batch",
+    "Process several files with the same plugin chain, which is only loaded once. <argument> is a manifest \
+file where each line contains an input and output source separated by whitespace. Paths which contain spaces \
+must be enclosed in double quotes, and lines starting with '#' are ignored. Plugins are reset (suspended and \
+resumed) between files, but parameters and programs are kept.",
+    false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_BATCH_WORKERS, "batch-workers",
+    "Number of threads to use with --batch. Each thread loads its own copy of the plugin chain and takes the \
+next job from the manifest when it is done with the previous one, so files may finish in any order. Default \
+value is 1, which processes the files in sequence.",
+    false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_BIT_DEPTH, "bit-depth",
+    "Sample format for WAVE output files. Can be 16, 24 or 32 for integer samples, or 32f or 64f for floating \
+point samples. Floating point output is not clipped.",
+    false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+
   programOptionsAdd(options, newProgramOptionWithValues(OPTION_BLOCKSIZE, "blocksize",
     "Blocksize in frames to use for processing. If input source is not an even multiple of the blocksize, then \
 empty frames will be added to the last block.",
@@ -87,10 +106,28 @@ like so:\n\n\
 --list-file-types to see a list of supported types. Use '-' to read from stdin.",
     true, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
 
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_IO_BLOCKSIZE, "io-blocksize",
+    "Read the input source and write the output source in blocks of <argument> frames, while plugins and MIDI \
+events are still processed with --blocksize. Large I/O blocks (ie, 65536 frames) reduce the overhead of file \
+access and sample conversion, without changing the blocksize which plugins see. Must be larger than --blocksize.",
+    false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_IO_QUEUE_DEPTH, "io-queue-depth",
+    "Read the input source and write the output source on separate threads, keeping up to <argument> blocks \
+queued for each of them. This allows disk access and sample conversion to overlap with plugin processing, \
+which is mostly useful for large files or slow (ie, network) storage.",
+    false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+
   programOptionsAdd(options, newProgramOptionWithValues(OPTION_LIST_PLUGINS, "list-plugins",
     "List available plugins. Useful for determining if a plugin can be 'seen'.",
     false, kProgramOptionArgumentTypeNone, NO_DEFAULT_VALUE));
 
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_LOG_ASYNC, "log-async",
+    "Write log messages from a background thread, so that logging (even with --verbose) does not slow down \
+processing. Messages are written in batches, and may be dropped if they are logged faster than they can be \
+written, in which case a warning is printed at exit.",
+    false, kProgramOptionArgumentTypeNone, NO_DEFAULT_VALUE));
+
   programOptionsAdd(options, newProgramOptionWithValues(OPTION_LOG_FILE, "log-file",
     "Save logging output to the given file instead of the terminal's standard error.",
     false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
@@ -116,19 +153,36 @@ from the extension. Run with --list-file-types to see a list of supported types.
 Use '-' to write to stdout. If not given, then defaults to 'out.wav'.",
     true, kProgramOptionArgumentTypeOptional, NO_DEFAULT_VALUE));
 
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_PIPELINE, "pipeline",
+    "Process each plugin in the chain on a separate thread. This can greatly improve the processing speed \
+of chains with several plugins on multi-core machines, as the total time approaches that of the slowest plugin \
+rather than the sum of all plugins. Plugins which depend on the transport position may not work correctly \
+in this mode, since each plugin processes a different block at any given time.",
+    false, kProgramOptionArgumentTypeNone, NO_DEFAULT_VALUE));
+
   programOptionsAdd(options, newProgramOptionWithValues(OPTION_PLUGIN, "plugin",
     "Plugin(s) to process. Multiple plugins can given in a semicolon-separated list, in which case they will be \
 placed into a chain in the order specified. Instrument plugins must appear first in any chains. Plugins are searched \
 for in the --plugin-root directory, the current directory, and the standard locations for the OS. File extensions are \
 added automatically to plugin names. Each plugin may be followed by a comma with a program to be loaded, which should \
 be of the corresponding file format for the respective plugin. For shell plugins (like Waves), use --display-info to \
-get a list of sub-plugin ID's and then use a colon to indicate which plugin to load. Examples:\n\n\
+get a list of sub-plugin ID's and then use a colon to indicate which plugin to load. Plugins can also be split into \
+parallel branches by placing the branches in square brackets separated by pipes. Each branch receives the same input, \
+and the outputs of the branches are summed. Empty branches pass the input through unchanged. Examples:\n\n\
 \t--plugin LFX-1310\n\
 \t--plugin 'AutoTune,KayneWest.fxp;Compressor,SoftKnee.fxp;Limiter'\n\
+\t--plugin 'Crossover;[LowComp|MidComp;Exciter|HighComp];Limiter'\n\
 \t--plugin 'WavesShell-VST' --display-info (list shell sub-plugins)\n\
 \t--plugin 'WavesShell-VST:IDFX' (load a shell plugins)",
     true, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
 
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_PLUGIN_CACHE, "plugin-cache",
+    "Remember where plugins were found, along with their type, I/O configuration and unique ID, in the \
+given file. On subsequent runs, plugins in the cache are found without searching all plugin locations, and \
+--list-plugins shows the cached information. Entries are refreshed whenever a plugin's file changes. The \
+file is created if it does not exist.",
+    false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+
   programOptionsAdd(options, newProgramOptionWithValues(OPTION_PLUGIN_ROOT, "plugin-root",
     "Custom non-system directory to use when searching for plugins. Will be searched \
   before system directories if given.",
@@ -143,6 +197,33 @@ get a list of sub-plugin ID's and then use a colon to indicate which plugin to l
 the one set by this option.",
     true, kProgramOptionArgumentTypeRequired, (int)getSampleRate()));
 
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_SANDBOX, "sandbox",
+    "Run plugins in separate processes, so that a plugin which crashes does not take down the whole program. \
+Audio is passed to the plugins through shared memory. With 'plugin', which is the default, each plugin gets its \
+own process. With 'chain', all plugins share a single process. If a plugin crashes, processing stops and the \
+crash is reported for that plugin. In batch mode, only the job which was being processed fails, and the plugin \
+is loaded again for the next job. Not supported on Windows.",
+    false, kProgramOptionArgumentTypeOptional, NO_DEFAULT_VALUE));
+
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_STATS, "stats",
+    "Save statistics about the run to the given file as JSON, or print them to stdout if <argument> \
+is '-'. The statistics include the realtime factor, throughput, amount of audio read and written, time used \
+for loading plugins, processing and I/O, and peak memory usage.",
+    false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_STREAM_BUFFER, "stream-buffer",
+    "Milliseconds of audio to buffer when reading PCM data from stdin or writing it to stdout. The pipe is \
+serviced by a separate thread, so that processing continues while the other end of the pipe is busy. Set this \
+to 0 to access the pipe directly from the processing thread.",
+    false, kProgramOptionArgumentTypeRequired, DEFAULT_STREAM_BUFFER_SIZE_IN_MS));
+
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_STREAM_POLICY, "stream-policy",
+    "What to do when stdin does not deliver audio in time, or stdout does not accept it in time. With 'wait', \
+processing waits for the pipe and no audio is lost. With 'realtime', processing never waits after the stream \
+buffer has been filled once; missing input is replaced by silence and output which does not fit into the \
+buffer is dropped. The number of such underruns and overruns is logged when processing is finished.",
+    false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+
   programOptionsAdd(options, newProgramOptionWithValues(OPTION_TAIL_TIME, "tail-time",
     "Continue processing for up to <argument> extra milliseconds after input source is finished, in addition \
 to any tail time requested by plugins in the chain. If any plugins in chain the require tail time, the largest \
@@ -165,6 +246,12 @@ value will be used and added to <argument>.",
     "Set the denominator of the time signature, which determines the value of a quarter note.",
     false, kProgramOptionArgumentTypeRequired, getTimeSignatureNoteValue()));
 
+  programOptionsAdd(options, newProgramOptionWithValues(OPTION_TIMING_REPORT, "timing-report",
+    "Save a JSON report of the time used by each plugin to the given file. For each plugin, the time \
+used per block is reported as median, 99th and 99.9th percentile and maximum, along with the number of \
+blocks where the plugin took longer than the block's duration (ie, would not have kept up in realtime).",
+    false, kProgramOptionArgumentTypeRequired, NO_DEFAULT_VALUE));
+
   programOptionsAdd(options, newProgramOptionWithValues(OPTION_VERBOSE, "verbose",
     "Verbose logging. Logging output is printed in the following form:\n\
 (Level) (Frames processed) (Elapsed time in ms) (Logging message)",
@@ -32,6 +32,9 @@
 
 // Runtime options
 typedef enum {
+  OPTION_BATCH,
+  OPTION_BATCH_WORKERS,
+  OPTION_BIT_DEPTH,
   OPTION_BLOCKSIZE,
   OPTION_CHANNELS,
   OPTION_COLOR_LOGGING,
@@ -41,22 +44,32 @@ typedef enum {
   OPTION_ERROR_REPORT,
   OPTION_HELP,
   OPTION_INPUT_SOURCE,
+  OPTION_IO_BLOCKSIZE,
+  OPTION_IO_QUEUE_DEPTH,
   OPTION_LIST_FILE_TYPES,
   OPTION_LIST_PLUGINS,
+  OPTION_LOG_ASYNC,
   OPTION_LOG_FILE,
   OPTION_LOG_LEVEL,
   OPTION_MAX_TIME,
   OPTION_MIDI_SOURCE,
   OPTION_OUTPUT_SOURCE,
+  OPTION_PIPELINE,
   OPTION_PLUGIN,
+  OPTION_PLUGIN_CACHE,
   OPTION_PLUGIN_ROOT,
   OPTION_QUIET,
   OPTION_SAMPLE_RATE,
+  OPTION_SANDBOX,
+  OPTION_STATS,
+  OPTION_STREAM_BUFFER,
+  OPTION_STREAM_POLICY,
   OPTION_TAIL_TIME,
   OPTION_TEMPO,
   OPTION_TIME_DIVISION,
   OPTION_TIME_SIGNATURE_TOP,
   OPTION_TIME_SIGNATURE_BOTTOM,
+  OPTION_TIMING_REPORT,
   OPTION_VERBOSE,
   OPTION_VERSION,
   OPTION_ZEBRA_SIZE,
@@ -0,0 +1,323 @@
+//
+// MrsWatsonRenderer.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/AudioSettings.h"
+#include "audio/SampleConversion.h"
+#include "base/CharString.h"
+#include "logging/EventLogger.h"
+#include "sequencer/AudioClock.h"
+
+#include "MrsWatsonRenderer.h"
+
+// Every call binds the renderer's context to the calling thread, so that the
+// plugins and the settings getters see the renderer's settings and clock. The
+// caller's own context is restored afterwards.
+static MrsWatsonContext _bindRendererContext(MrsWatsonRenderer self) {
+  MrsWatsonContext callerContext = getMrsWatsonContext();
+  setThreadMrsWatsonContext(self->context);
+  return callerContext;
+}
+
+static boolByte _checkNotPrepared(MrsWatsonRenderer self, const char* settingName) {
+  if(self->isPrepared) {
+    logError("Cannot change %s after the renderer has been prepared", settingName);
+    return false;
+  }
+  return true;
+}
+
+MrsWatsonRenderer newMrsWatsonRenderer(void) {
+  MrsWatsonRenderer renderer = (MrsWatsonRenderer)malloc(sizeof(MrsWatsonRendererMembers));
+  MrsWatsonContext callerContext;
+
+  renderer->context = newMrsWatsonContext();
+  callerContext = _bindRendererContext(renderer);
+  renderer->pluginChain = newPluginChain();
+  setThreadMrsWatsonContext(callerContext);
+  renderer->inputSampleBuffer = NULL;
+  renderer->outputSampleBuffer = NULL;
+  renderer->taskTimer = NULL;
+  renderer->isPrepared = false;
+
+  return renderer;
+}
+
+ReturnCodes mrsWatsonRendererSetSampleRate(MrsWatsonRenderer self, const double sampleRate) {
+  MrsWatsonContext callerContext;
+  if(!_checkNotPrepared(self, "sample rate")) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+  callerContext = _bindRendererContext(self);
+  setSampleRate(sampleRate);
+  setThreadMrsWatsonContext(callerContext);
+  return self->context->audioSettings->sampleRate == sampleRate ? RETURN_CODE_SUCCESS : RETURN_CODE_INVALID_ARGUMENT;
+}
+
+ReturnCodes mrsWatsonRendererSetNumChannels(MrsWatsonRenderer self, const unsigned int numChannels) {
+  MrsWatsonContext callerContext;
+  if(!_checkNotPrepared(self, "channel count")) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+  callerContext = _bindRendererContext(self);
+  setNumChannels(numChannels);
+  setThreadMrsWatsonContext(callerContext);
+  return self->context->audioSettings->numChannels == numChannels ? RETURN_CODE_SUCCESS : RETURN_CODE_INVALID_ARGUMENT;
+}
+
+ReturnCodes mrsWatsonRendererSetBlocksize(MrsWatsonRenderer self, const unsigned long blocksize) {
+  MrsWatsonContext callerContext;
+  if(!_checkNotPrepared(self, "blocksize")) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+  callerContext = _bindRendererContext(self);
+  setBlocksize(blocksize);
+  setThreadMrsWatsonContext(callerContext);
+  return self->context->audioSettings->blocksize == blocksize ? RETURN_CODE_SUCCESS : RETURN_CODE_INVALID_ARGUMENT;
+}
+
+ReturnCodes mrsWatsonRendererSetTempo(MrsWatsonRenderer self, const double tempo) {
+  MrsWatsonContext callerContext = _bindRendererContext(self);
+  setTempo(tempo);
+  setThreadMrsWatsonContext(callerContext);
+  return self->context->audioSettings->tempo == tempo ? RETURN_CODE_SUCCESS : RETURN_CODE_INVALID_ARGUMENT;
+}
+
+ReturnCodes mrsWatsonRendererAddPlugins(MrsWatsonRenderer self, const char* pluginChainString, const char* pluginSearchRoot) {
+  MrsWatsonContext callerContext;
+  CharString argument;
+  CharString searchRoot;
+  boolByte result;
+
+  if(!_checkNotPrepared(self, "plugin chain")) {
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+  if(pluginChainString == NULL) {
+    logError("No plugins given");
+    return RETURN_CODE_INVALID_PLUGIN_CHAIN;
+  }
+
+  argument = newCharStringWithCString(pluginChainString);
+  searchRoot = pluginSearchRoot != NULL ? newCharStringWithCString(pluginSearchRoot) : newCharString();
+  callerContext = _bindRendererContext(self);
+  result = pluginChainAddFromArgumentString(self->pluginChain, argument, searchRoot);
+  setThreadMrsWatsonContext(callerContext);
+  freeCharString(argument);
+  freeCharString(searchRoot);
+
+  return result ? RETURN_CODE_SUCCESS : RETURN_CODE_INVALID_PLUGIN_CHAIN;
+}
+
+ReturnCodes mrsWatsonRendererPrepare(MrsWatsonRenderer self) {
+  MrsWatsonContext callerContext;
+  unsigned int maxNumChannels;
+  ReturnCodes result;
+
+  if(self->isPrepared) {
+    return RETURN_CODE_SUCCESS;
+  }
+  if(self->pluginChain->numPlugins == 0) {
+    logError("No plugins loaded");
+    return RETURN_CODE_INVALID_PLUGIN_CHAIN;
+  }
+
+  callerContext = _bindRendererContext(self);
+  result = pluginChainInitialize(self->pluginChain);
+  if(result == RETURN_CODE_SUCCESS) {
+    pluginChainPrepareForProcessing(self->pluginChain);
+
+    // The buffers are created with enough channels for every plugin, so that
+    // the chain never has to expand them while rendering.
+    maxNumChannels = pluginChainGetMaxNumChannels(self->pluginChain, getNumChannels());
+    self->inputSampleBuffer = newSampleBuffer(maxNumChannels, getBlocksize());
+    self->outputSampleBuffer = newSampleBuffer(maxNumChannels, getBlocksize());
+    self->taskTimer = newTaskTimer(self->pluginChain->numPlugins + 1);
+    self->isPrepared = true;
+  }
+  setThreadMrsWatsonContext(callerContext);
+
+  return result;
+}
+
+ReturnCodes mrsWatsonRendererSetParameter(MrsWatsonRenderer self, const int pluginIndex,
+  const int parameterIndex, const float value) {
+  MrsWatsonContext callerContext;
+  Plugin plugin;
+
+  if(!self->isPrepared) {
+    logError("Plugin parameters cannot be set before the renderer has been prepared");
+    return RETURN_CODE_NOT_RUN;
+  }
+  if(pluginIndex < 0 || pluginIndex >= self->pluginChain->numPlugins) {
+    logError("Invalid plugin index %d", pluginIndex);
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+  if(parameterIndex < 0) {
+    logError("Invalid parameter index %d", parameterIndex);
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  plugin = self->pluginChain->plugins[pluginIndex];
+  callerContext = _bindRendererContext(self);
+  plugin->setParameter(plugin, parameterIndex, value);
+  setThreadMrsWatsonContext(callerContext);
+  return RETURN_CODE_SUCCESS;
+}
+
+// Extra channels in the renderer's buffers are filled in the same way as
+// sampleBufferCopy() does, by repeating the input channels.
+static void _fillExtraChannels(SampleBuffer sampleBuffer, const unsigned int numChannels, const unsigned long numFrames) {
+  unsigned int i;
+  for(i = numChannels; i < sampleBuffer->numChannels; i++) {
+    memcpy(sampleBuffer->samples[i], sampleBuffer->samples[i % numChannels], sizeof(Sample) * numFrames);
+  }
+}
+
+static void _processRendererBlock(MrsWatsonRenderer self, const unsigned long numFrames) {
+  self->inputSampleBuffer->blocksize = numFrames;
+  self->outputSampleBuffer->blocksize = numFrames;
+  pluginChainProcessAudio(self->pluginChain, self->inputSampleBuffer, self->outputSampleBuffer, self->taskTimer);
+  advanceAudioClock(self->context->audioClock, numFrames);
+  self->inputSampleBuffer->blocksize = self->context->audioSettings->blocksize;
+  self->outputSampleBuffer->blocksize = self->context->audioSettings->blocksize;
+}
+
+static boolByte _checkPrepared(MrsWatsonRenderer self) {
+  if(!self->isPrepared) {
+    logError("Audio cannot be processed before the renderer has been prepared");
+    return false;
+  }
+  return true;
+}
+
+ReturnCodes mrsWatsonRendererProcess(MrsWatsonRenderer self, const SampleBuffer inBuffer, SampleBuffer outBuffer) {
+  const unsigned int numChannels = self->context->audioSettings->numChannels;
+  const unsigned long blocksize = self->context->audioSettings->blocksize;
+  MrsWatsonContext callerContext;
+  unsigned long currentFrame;
+  unsigned long numFrames;
+  unsigned int i;
+
+  if(!_checkPrepared(self)) {
+    return RETURN_CODE_NOT_RUN;
+  }
+  if(inBuffer->numChannels != numChannels || outBuffer->numChannels != numChannels) {
+    logError("Sample buffers must have %d channels", numChannels);
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+  if(inBuffer->blocksize != outBuffer->blocksize) {
+    logError("Input and output sample buffers must have the same blocksize");
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  callerContext = _bindRendererContext(self);
+  for(currentFrame = 0; currentFrame < inBuffer->blocksize; currentFrame += numFrames) {
+    numFrames = inBuffer->blocksize - currentFrame < blocksize ? inBuffer->blocksize - currentFrame : blocksize;
+    for(i = 0; i < numChannels; i++) {
+      memcpy(self->inputSampleBuffer->samples[i], inBuffer->samples[i] + currentFrame, sizeof(Sample) * numFrames);
+    }
+    _fillExtraChannels(self->inputSampleBuffer, numChannels, numFrames);
+    _processRendererBlock(self, numFrames);
+    for(i = 0; i < numChannels; i++) {
+      memcpy(outBuffer->samples[i] + currentFrame, self->outputSampleBuffer->samples[i], sizeof(Sample) * numFrames);
+    }
+  }
+  setThreadMrsWatsonContext(callerContext);
+
+  return RETURN_CODE_SUCCESS;
+}
+
+ReturnCodes mrsWatsonRendererProcessInterleaved(MrsWatsonRenderer self, const float* inSamples,
+  float* outSamples, const unsigned long numFrames) {
+  const unsigned int numChannels = self->context->audioSettings->numChannels;
+  const unsigned long blocksize = self->context->audioSettings->blocksize;
+  MrsWatsonContext callerContext;
+  unsigned long currentFrame;
+  unsigned long numBlockFrames;
+
+  if(!_checkPrepared(self)) {
+    return RETURN_CODE_NOT_RUN;
+  }
+  if(inSamples == NULL || outSamples == NULL) {
+    logError("Cannot process NULL sample arrays");
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+
+  callerContext = _bindRendererContext(self);
+  for(currentFrame = 0; currentFrame < numFrames; currentFrame += numBlockFrames) {
+    numBlockFrames = numFrames - currentFrame < blocksize ? numFrames - currentFrame : blocksize;
+    // Interlaced floats are converted with the same kernels as float PCM files
+    convertPcmDataToSamples(inSamples + currentFrame * numChannels, kSampleFormatFloat32,
+      self->inputSampleBuffer->samples, numChannels, numBlockFrames, false);
+    _fillExtraChannels(self->inputSampleBuffer, numChannels, numBlockFrames);
+    _processRendererBlock(self, numBlockFrames);
+    convertSamplesToPcmData((const Samples*)self->outputSampleBuffer->samples, outSamples + currentFrame * numChannels,
+      kSampleFormatFloat32, numChannels, numBlockFrames, false);
+  }
+  setThreadMrsWatsonContext(callerContext);
+
+  return RETURN_CODE_SUCCESS;
+}
+
+void mrsWatsonRendererReset(MrsWatsonRenderer self) {
+  MrsWatsonContext callerContext = _bindRendererContext(self);
+  if(self->isPrepared) {
+    pluginChainReset(self->pluginChain);
+  }
+  audioClockRewind(self->context->audioClock);
+  setThreadMrsWatsonContext(callerContext);
+}
+
+void freeMrsWatsonRenderer(MrsWatsonRenderer self) {
+  MrsWatsonContext callerContext;
+
+  if(self == NULL) {
+    return;
+  }
+
+  callerContext = _bindRendererContext(self);
+  // Plugins which could not be opened cannot be closed either
+  if(self->isPrepared) {
+    pluginChainShutdown(self->pluginChain);
+  }
+  freePluginChain(self->pluginChain);
+  setThreadMrsWatsonContext(callerContext);
+
+  if(self->inputSampleBuffer != NULL) {
+    freeSampleBuffer(self->inputSampleBuffer);
+  }
+  if(self->outputSampleBuffer != NULL) {
+    freeSampleBuffer(self->outputSampleBuffer);
+  }
+  if(self->taskTimer != NULL) {
+    freeTaskTimer(self->taskTimer);
+  }
+  freeMrsWatsonContext(self->context);
+  free(self);
+}
@@ -0,0 +1,173 @@
+//
+// MrsWatsonRenderer.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_MrsWatsonRenderer_h
+#define MrsWatson_MrsWatsonRenderer_h
+
+#include "app/MrsWatsonContext.h"
+#include "app/ReturnCodes.h"
+#include "audio/SampleBuffer.h"
+#include "plugin/PluginChain.h"
+#include "time/TaskTimer.h"
+
+/**
+ * The renderer is the entry point for programs which link against the
+ * mrswatsoncore library to process audio in memory, rather than running the
+ * mrswatson executable on files. A typical session looks like this:
+ *
+ *   MrsWatsonRenderer renderer = newMrsWatsonRenderer();
+ *   mrsWatsonRendererSetSampleRate(renderer, 48000.0);
+ *   mrsWatsonRendererAddPlugins(renderer, "mrs_passthru", NULL);
+ *   mrsWatsonRendererPrepare(renderer);
+ *   mrsWatsonRendererProcessInterleaved(renderer, input, output, numFrames);
+ *   freeMrsWatsonRenderer(renderer);
+ *
+ * Each renderer has its own MrsWatsonContext, so several renderers may be used
+ * at once from different threads. A single renderer must not be used from more
+ * than one thread at a time. Nothing is logged unless the program calls
+ * initEventLogger() first.
+ */
+typedef struct {
+  MrsWatsonContext context;
+  PluginChain pluginChain;
+  SampleBuffer inputSampleBuffer;
+  SampleBuffer outputSampleBuffer;
+  TaskTimer taskTimer;
+  boolByte isPrepared;
+} MrsWatsonRendererMembers;
+typedef MrsWatsonRendererMembers* MrsWatsonRenderer;
+
+/**
+ * Create a new renderer with default audio settings and no plugins
+ * @return New renderer instance
+ */
+MrsWatsonRenderer newMrsWatsonRenderer(void);
+
+/**
+ * Set the sample rate. Must be called before mrsWatsonRendererPrepare().
+ * @param self
+ * @param sampleRate Sample rate in Hz
+ * @return RETURN_CODE_SUCCESS, or an error code if the value could not be set
+ */
+ReturnCodes mrsWatsonRendererSetSampleRate(MrsWatsonRenderer self, const double sampleRate);
+
+/**
+ * Set the number of channels of the audio passed to the process functions.
+ * Must be called before mrsWatsonRendererPrepare().
+ * @param self
+ * @param numChannels Channel count
+ * @return RETURN_CODE_SUCCESS, or an error code if the value could not be set
+ */
+ReturnCodes mrsWatsonRendererSetNumChannels(MrsWatsonRenderer self, const unsigned int numChannels);
+
+/**
+ * Set the largest number of frames which are sent to the plugins at once.
+ * Longer input is split into blocks of this size. Must be called before
+ * mrsWatsonRendererPrepare().
+ * @param self
+ * @param blocksize Blocksize in frames
+ * @return RETURN_CODE_SUCCESS, or an error code if the value could not be set
+ */
+ReturnCodes mrsWatsonRendererSetBlocksize(MrsWatsonRenderer self, const unsigned long blocksize);
+
+/**
+ * Set the tempo reported to the plugins. Unlike the other settings, this may
+ * be changed at any time.
+ * @param self
+ * @param tempo Tempo in beats per minute
+ * @return RETURN_CODE_SUCCESS, or an error code if the value could not be set
+ */
+ReturnCodes mrsWatsonRendererSetTempo(MrsWatsonRenderer self, const double tempo);
+
+/**
+ * Append plugins to the renderer's chain. Must be called before
+ * mrsWatsonRendererPrepare().
+ * @param self
+ * @param pluginChainString Plugins in the same format as the --plugin option,
+ * for example "plugin1,preset1;plugin2"
+ * @param pluginSearchRoot Extra directory to search for plugins, or NULL
+ * @return RETURN_CODE_SUCCESS, or an error code if the plugins could not be added
+ */
+ReturnCodes mrsWatsonRendererAddPlugins(MrsWatsonRenderer self, const char* pluginChainString, const char* pluginSearchRoot);
+
+/**
+ * Open all plugins, load their presets, and prepare them for processing
+ * @param self
+ * @return RETURN_CODE_SUCCESS, or an error code if a plugin could not be opened
+ */
+ReturnCodes mrsWatsonRendererPrepare(MrsWatsonRenderer self);
+
+/**
+ * Set a parameter of a plugin in the chain. Must be called after
+ * mrsWatsonRendererPrepare().
+ * @param self
+ * @param pluginIndex Index of the plugin in the chain, starting at 0
+ * @param parameterIndex Index of the parameter
+ * @param value New value, usually in the range {0.0, 1.0}
+ * @return RETURN_CODE_SUCCESS, or an error code if there is no such plugin
+ */
+ReturnCodes mrsWatsonRendererSetParameter(MrsWatsonRenderer self, const int pluginIndex,
+  const int parameterIndex, const float value);
+
+/**
+ * Process audio through the plugin chain. Both buffers must have the
+ * renderer's channel count and the same blocksize, which may be larger than
+ * the renderer's blocksize.
+ * @param self
+ * @param inBuffer Input samples
+ * @param outBuffer Output samples
+ * @return RETURN_CODE_SUCCESS, or an error code if the audio could not be processed
+ */
+ReturnCodes mrsWatsonRendererProcess(MrsWatsonRenderer self, const SampleBuffer inBuffer, SampleBuffer outBuffer);
+
+/**
+ * Process interlaced floating point audio through the plugin chain, which is
+ * the format most other languages and audio libraries use
+ * @param self
+ * @param inSamples Input samples, numChannels * numFrames long
+ * @param outSamples Output samples, numChannels * numFrames long. This may be
+ * the same array as inSamples.
+ * @param numFrames Number of frames to process
+ * @return RETURN_CODE_SUCCESS, or an error code if the audio could not be processed
+ */
+ReturnCodes mrsWatsonRendererProcessInterleaved(MrsWatsonRenderer self, const float* inSamples,
+  float* outSamples, const unsigned long numFrames);
+
+/**
+ * Reset the plugins and move the clock back to the start, so that the next
+ * call to a process function starts a new, unrelated piece of audio.
+ * @param self
+ */
+void mrsWatsonRendererReset(MrsWatsonRenderer self);
+
+/**
+ * Close all plugins and free the renderer
+ * @param self
+ */
+void freeMrsWatsonRenderer(MrsWatsonRenderer self);
+
+#endif
@@ -0,0 +1,178 @@
+//
+// BatchManifest.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app/BatchManifest.h"
+#include "base/FileUtilities.h"
+#include "logging/EventLogger.h"
+
+BatchManifest newBatchManifest(void) {
+  BatchManifest batchManifest = (BatchManifest)malloc(sizeof(BatchManifestMembers));
+  batchManifest->numJobs = 0;
+  batchManifest->jobs = NULL;
+  return batchManifest;
+}
+
+static boolByte _isManifestSpace(const char c) {
+  return (boolByte)(c == ' ' || c == '\t' || c == '\r' || c == '\n');
+}
+
+// Copy the next whitespace-delimited or quoted field into outField, and return
+// a pointer to the character after it. Returns NULL if no field was found or
+// if a quoted field was not terminated.
+static const char* _readManifestField(const char* position, CharString outField) {
+  const char* fieldStart;
+  size_t fieldLength;
+
+  while(_isManifestSpace(*position)) {
+    position++;
+  }
+  if(*position == '\0') {
+    return NULL;
+  }
+
+  if(*position == '"') {
+    fieldStart = ++position;
+    while(*position != '"') {
+      if(*position == '\0') {
+        return NULL;
+      }
+      position++;
+    }
+    fieldLength = position - fieldStart;
+    // Skip closing quote
+    position++;
+  }
+  else {
+    fieldStart = position;
+    while(*position != '\0' && !_isManifestSpace(*position)) {
+      position++;
+    }
+    fieldLength = position - fieldStart;
+  }
+
+  if(fieldLength == 0 || fieldLength >= outField->length) {
+    return NULL;
+  }
+  charStringClear(outField);
+  strncpy(outField->data, fieldStart, fieldLength);
+  return position;
+}
+
+boolByte batchManifestParseLine(BatchManifest self, const char* line) {
+  BatchJob job;
+  const char* position = line;
+
+  while(_isManifestSpace(*position)) {
+    position++;
+  }
+  if(*position == '\0' || *position == BATCH_MANIFEST_COMMENT_CHAR) {
+    return true;
+  }
+
+  job = (BatchJob)malloc(sizeof(BatchJobMembers));
+  job->inputSource = newCharStringWithCapacity(kCharStringLengthLong);
+  job->outputSource = newCharStringWithCapacity(kCharStringLengthLong);
+  position = _readManifestField(position, job->inputSource);
+  if(position != NULL) {
+    position = _readManifestField(position, job->outputSource);
+  }
+  if(position != NULL) {
+    while(_isManifestSpace(*position)) {
+      position++;
+    }
+  }
+  // Each line must have exactly two fields
+  if(position == NULL || *position != '\0') {
+    freeCharString(job->inputSource);
+    freeCharString(job->outputSource);
+    free(job);
+    return false;
+  }
+
+  self->jobs = (BatchJob*)realloc(self->jobs, sizeof(BatchJob) * (self->numJobs + 1));
+  self->jobs[self->numJobs] = job;
+  self->numJobs++;
+  return true;
+}
+
+boolByte batchManifestParseFile(BatchManifest self, const CharString filename) {
+  boolByte result = true;
+  FILE* manifestFile;
+  CharString line;
+  int lineNumber = 0;
+
+  if(filename == NULL || charStringIsEmpty(filename)) {
+    logError("Cannot read batch manifest from empty filename");
+    return false;
+  }
+  else if(!fileExists(filename->data)) {
+    logError("Cannot read batch manifest '%s', file does not exist", filename->data);
+    return false;
+  }
+
+  manifestFile = fopen(filename->data, "r");
+  if(manifestFile == NULL) {
+    logError("Could not open batch manifest '%s' for reading", filename->data);
+    return false;
+  }
+
+  line = newCharStringWithCapacity(kCharStringLengthLong);
+  while(fgets(line->data, (int)line->length, manifestFile) != NULL) {
+    lineNumber++;
+    if(!batchManifestParseLine(self, line->data)) {
+      logError("Invalid job on line %d of batch manifest '%s', expected an input and output source",
+        lineNumber, filename->data);
+      result = false;
+    }
+  }
+  freeCharString(line);
+  fclose(manifestFile);
+
+  if(result && self->numJobs == 0) {
+    logError("Batch manifest '%s' does not contain any jobs", filename->data);
+    result = false;
+  }
+  else if(result) {
+    logDebug("Read %d jobs from batch manifest '%s'", self->numJobs, filename->data);
+  }
+  return result;
+}
+
+void freeBatchManifest(BatchManifest self) {
+  int i;
+  for(i = 0; i < self->numJobs; i++) {
+    freeCharString(self->jobs[i]->inputSource);
+    freeCharString(self->jobs[i]->outputSource);
+    free(self->jobs[i]);
+  }
+  free(self->jobs);
+  free(self);
+}
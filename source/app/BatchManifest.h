@@ -0,0 +1,86 @@
+//
+// BatchManifest.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_BatchManifest_h
+#define MrsWatson_BatchManifest_h
+
+#include "base/CharString.h"
+#include "base/Types.h"
+
+#define BATCH_MANIFEST_COMMENT_CHAR '#'
+
+/**
+ * A single input/output pair to be rendered in batch mode
+ */
+typedef struct {
+  CharString inputSource;
+  CharString outputSource;
+} BatchJobMembers;
+typedef BatchJobMembers* BatchJob;
+
+/**
+ * List of jobs to render with the same plugin chain. In a manifest file, each
+ * line contains an input and output source separated by whitespace, and paths
+ * containing spaces may be enclosed in double quotes. Empty lines and lines
+ * starting with '#' are ignored.
+ */
+typedef struct {
+  int numJobs;
+  BatchJob* jobs;
+} BatchManifestMembers;
+typedef BatchManifestMembers* BatchManifest;
+
+/**
+ * @return New empty batch manifest
+ */
+BatchManifest newBatchManifest(void);
+
+/**
+ * Parse a single manifest line and add it as a job
+ * @param self
+ * @param line Line to parse, without the trailing newline
+ * @return False if the line was not a valid job. Empty lines and comments are
+ * valid, but do not add any jobs.
+ */
+boolByte batchManifestParseLine(BatchManifest self, const char* line);
+
+/**
+ * Read all jobs from a manifest file
+ * @param self
+ * @param filename Manifest file to read
+ * @return True if the file could be read, all lines were valid, and at least
+ * one job was found
+ */
+boolByte batchManifestParseFile(BatchManifest self, const CharString filename);
+
+/**
+ * Free a batch manifest and all of its jobs
+ * @param self
+ */
+void freeBatchManifest(BatchManifest self);
+
+#endif
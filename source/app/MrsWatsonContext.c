@@ -0,0 +1,72 @@
+//
+// MrsWatsonContext.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+
+#include "app/MrsWatsonContext.h"
+#include "base/PlatformUtilities.h"
+
+static THREAD_LOCAL MrsWatsonContext threadMrsWatsonContext = NULL;
+
+MrsWatsonContext newMrsWatsonContext(void) {
+  MrsWatsonContext context = (MrsWatsonContext)malloc(sizeof(MrsWatsonContextMembers));
+  context->audioSettings = newAudioSettingsCopy();
+  context->audioClock = newAudioClock();
+  context->eventLogger = getEventLogger();
+  return context;
+}
+
+MrsWatsonContext getMrsWatsonContext(void) {
+  return threadMrsWatsonContext;
+}
+
+void setThreadMrsWatsonContext(MrsWatsonContext context) {
+  threadMrsWatsonContext = context;
+  setThreadAudioSettings(context != NULL ? context->audioSettings : NULL);
+  setThreadAudioClock(context != NULL ? context->audioClock : NULL);
+  setThreadEventLogger(context != NULL ? context->eventLogger : NULL);
+}
+
+AudioSettings mrsWatsonContextGetAudioSettings(MrsWatsonContext self) {
+  return self != NULL ? self->audioSettings : audioSettingsInstance;
+}
+
+AudioClock mrsWatsonContextGetAudioClock(MrsWatsonContext self) {
+  return self != NULL ? self->audioClock : audioClockInstance;
+}
+
+void freeMrsWatsonContext(MrsWatsonContext self) {
+  if(self == NULL) {
+    return;
+  }
+  if(threadMrsWatsonContext == self) {
+    setThreadMrsWatsonContext(NULL);
+  }
+  freeAudioSettingsCopy(self->audioSettings);
+  freeAudioClock(self->audioClock);
+  free(self);
+}
@@ -0,0 +1,93 @@
+//
+// MrsWatsonContext.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_MrsWatsonContext_h
+#define MrsWatson_MrsWatsonContext_h
+
+#include "audio/AudioSettings.h"
+#include "logging/EventLogger.h"
+#include "sequencer/AudioClock.h"
+
+/**
+ * A context holds the state which is needed to render one job: the audio
+ * settings (sample rate, blocksize, tempo, etc.), the audio clock, and the
+ * event logger. Objects which run code on other threads or receive calls
+ * from plugins (sample sources, plugin chains, and VST plugins) remember the
+ * context they were created in, so that several jobs can be rendered in one
+ * process without sharing a clock or settings.
+ *
+ * A NULL context refers to the global instances of these classes, which is
+ * what the program uses when it only renders a single job.
+ */
+typedef struct {
+  AudioSettings audioSettings;
+  AudioClock audioClock;
+  EventLogger eventLogger;
+} MrsWatsonContextMembers;
+typedef MrsWatsonContextMembers* MrsWatsonContext;
+
+/**
+ * Create a new context with a copy of the calling thread's audio settings (or
+ * the default settings if there are none), a stopped audio clock, and the calling thread's event logger. The logger is
+ * shared and will not be freed with the context.
+ * @return New context instance
+ */
+MrsWatsonContext newMrsWatsonContext(void);
+
+/**
+ * @return Context bound to the calling thread, or NULL if the thread uses the
+ * global instances
+ */
+MrsWatsonContext getMrsWatsonContext(void);
+
+/**
+ * Bind a context to the calling thread, so that the audio settings, audio
+ * clock, and event logger getters return the context's instances.
+ * @param context Context to use, or NULL to use the global instances again
+ */
+void setThreadMrsWatsonContext(MrsWatsonContext context);
+
+/**
+ * @param self Context, or NULL for the global context
+ * @return Audio settings of the context
+ */
+AudioSettings mrsWatsonContextGetAudioSettings(MrsWatsonContext self);
+
+/**
+ * @param self Context, or NULL for the global context
+ * @return Audio clock of the context
+ */
+AudioClock mrsWatsonContextGetAudioClock(MrsWatsonContext self);
+
+/**
+ * Free a context and its settings and clock. If the context is bound to the
+ * calling thread, the thread will use the global instances afterwards.
+ * @param self
+ */
+void freeMrsWatsonContext(MrsWatsonContext self);
+
+#endif
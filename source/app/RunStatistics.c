@@ -0,0 +1,127 @@
+//
+// RunStatistics.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "app/RunStatistics.h"
+#include "base/PlatformUtilities.h"
+#include "logging/EventLogger.h"
+
+RunStatistics newRunStatistics(void) {
+  RunStatistics runStatistics = (RunStatistics)malloc(sizeof(RunStatisticsMembers));
+
+  runStatistics->phaseTimer = newTaskTimer(kNumRunPhases);
+  runStatistics->mutex = newMutex();
+  runStatistics->sampleRate = 0.0;
+  runStatistics->numJobs = 0;
+  runStatistics->numFramesRead = 0;
+  runStatistics->numFramesWritten = 0;
+  runStatistics->numBytesRead = 0;
+  runStatistics->numBytesWritten = 0;
+  runStatistics->numBlocks = 0;
+  runStatistics->pluginTimeInMs = 0.0;
+  runStatistics->ioTimeInMs = 0.0;
+  runStatistics->hostTimeInMs = 0.0;
+
+  return runStatistics;
+}
+
+void runStatisticsStartPhase(RunStatistics self, const RunPhase phase) {
+  startTimingTask(self->phaseTimer, phase);
+}
+
+void runStatisticsStopPhase(RunStatistics self) {
+  stopTiming(self->phaseTimer);
+}
+
+void runStatisticsAddJob(RunStatistics self, const SampleSource inputSource,
+  const SampleSource outputSource, const unsigned int numChannels) {
+  mutexLock(self->mutex);
+  self->numJobs++;
+  self->numFramesRead += inputSource->numSamplesProcessed / numChannels;
+  self->numFramesWritten += outputSource->numSamplesProcessed / numChannels;
+  self->numBytesRead += inputSource->numBytesProcessed;
+  self->numBytesWritten += outputSource->numBytesProcessed;
+  mutexUnlock(self->mutex);
+}
+
+boolByte runStatisticsWriteReport(RunStatistics self, const CharString filename) {
+  const boolByte useStdout = charStringIsEqualToCString(filename, "-", false);
+  const double* phaseTimes = self->phaseTimer->totalTaskTimes;
+  double wallSeconds;
+  double audioSeconds;
+  FILE* file;
+
+  runStatisticsStopPhase(self);
+  wallSeconds = phaseTimes[kRunPhaseProcessing] / 1000.0;
+  audioSeconds = self->sampleRate > 0.0 ? (double)self->numFramesWritten / self->sampleRate : 0.0;
+  file = useStdout ? stdout : fopen(filename->data, "w");
+  if(file == NULL) {
+    logError("Could not open statistics file '%s' for writing", filename->data);
+    return false;
+  }
+
+  fprintf(file, "{\n");
+  fprintf(file, "  \"jobs\": %lu,\n", self->numJobs);
+  fprintf(file, "  \"blocks\": %lu,\n", self->numBlocks);
+  fprintf(file, "  \"sampleRate\": %.1f,\n", self->sampleRate);
+  fprintf(file, "  \"audioSeconds\": %.6f,\n", audioSeconds);
+  fprintf(file, "  \"wallSeconds\": %.6f,\n", wallSeconds);
+  fprintf(file, "  \"realtimeFactor\": %.3f,\n", wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0);
+  fprintf(file, "  \"framesPerSecond\": %.1f,\n", wallSeconds > 0.0 ? (double)self->numFramesWritten / wallSeconds : 0.0);
+  fprintf(file, "  \"framesRead\": %llu,\n", self->numFramesRead);
+  fprintf(file, "  \"framesWritten\": %llu,\n", self->numFramesWritten);
+  fprintf(file, "  \"bytesRead\": %llu,\n", self->numBytesRead);
+  fprintf(file, "  \"bytesWritten\": %llu,\n", self->numBytesWritten);
+  fprintf(file, "  \"pluginLoadMs\": %.3f,\n", phaseTimes[kRunPhasePluginLoad]);
+  fprintf(file, "  \"pluginInitializeMs\": %.3f,\n", phaseTimes[kRunPhasePluginInitialize]);
+  fprintf(file, "  \"processingMs\": %.3f,\n", phaseTimes[kRunPhaseProcessing]);
+  fprintf(file, "  \"shutdownMs\": %.3f,\n", phaseTimes[kRunPhaseShutdown]);
+  fprintf(file, "  \"pluginProcessingMs\": %.3f,\n", self->pluginTimeInMs);
+  fprintf(file, "  \"ioWaitMs\": %.3f,\n", self->ioTimeInMs);
+  fprintf(file, "  \"hostMs\": %.3f,\n", self->hostTimeInMs);
+  fprintf(file, "  \"peakMemoryBytes\": %llu\n", getPeakMemoryUsage());
+  fprintf(file, "}\n");
+
+  if(useStdout) {
+    fflush(stdout);
+  }
+  else if(fclose(file) != 0) {
+    logError("Could not write statistics file '%s'", filename->data);
+    return false;
+  }
+  return true;
+}
+
+void freeRunStatistics(RunStatistics self) {
+  if(self != NULL) {
+    freeTaskTimer(self->phaseTimer);
+    freeMutex(self->mutex);
+    free(self);
+  }
+}
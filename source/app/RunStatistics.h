@@ -0,0 +1,116 @@
+//
+// RunStatistics.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_RunStatistics_h
+#define MrsWatson_RunStatistics_h
+
+#include "base/CharString.h"
+#include "base/Thread.h"
+#include "base/Types.h"
+#include "io/SampleSource.h"
+#include "time/TaskTimer.h"
+
+/**
+ * Phases of a run, which are timed separately so that the time needed to
+ * load plugins is not counted as processing time
+ */
+typedef enum {
+  kRunPhasePluginLoad,
+  kRunPhasePluginInitialize,
+  kRunPhaseProcessing,
+  kRunPhaseShutdown,
+  kNumRunPhases
+} RunPhase;
+
+/**
+ * Statistics about a complete run, which may include several batch jobs. The
+ * time used by plugins, I/O and the host is filled in from the processing task
+ * timer when the run is finished, and is the sum over all threads.
+ */
+typedef struct {
+  TaskTimer phaseTimer;
+  Mutex mutex;
+
+  double sampleRate;
+  unsigned long numJobs;
+  unsigned long long numFramesRead;
+  unsigned long long numFramesWritten;
+  unsigned long long numBytesRead;
+  unsigned long long numBytesWritten;
+
+  unsigned long numBlocks;
+  double pluginTimeInMs;
+  double ioTimeInMs;
+  double hostTimeInMs;
+} RunStatisticsMembers;
+typedef RunStatisticsMembers* RunStatistics;
+
+/**
+ * @return New run statistics, with all counters set to zero
+ */
+RunStatistics newRunStatistics(void);
+
+/**
+ * Start timing a phase of the run, which stops timing of the previous phase.
+ * This must always be called from the same thread.
+ * @param self
+ * @param phase Phase to start
+ */
+void runStatisticsStartPhase(RunStatistics self, const RunPhase phase);
+
+/**
+ * Stop timing the current phase
+ * @param self
+ */
+void runStatisticsStopPhase(RunStatistics self);
+
+/**
+ * Add the amount of audio read and written by a finished job. May be called
+ * from any thread.
+ * @param self
+ * @param inputSource Input source of the job, which should be closed
+ * @param outputSource Output source of the job, which should be closed
+ * @param numChannels Number of channels of the job's audio
+ */
+void runStatisticsAddJob(RunStatistics self, const SampleSource inputSource,
+  const SampleSource outputSource, const unsigned int numChannels);
+
+/**
+ * Write all statistics as JSON
+ * @param self
+ * @param filename File to write, or "-" for standard output
+ * @return True if the statistics were written
+ */
+boolByte runStatisticsWriteReport(RunStatistics self, const CharString filename);
+
+/**
+ * Free run statistics
+ * @param self
+ */
+void freeRunStatistics(RunStatistics self);
+
+#endif
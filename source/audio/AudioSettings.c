@@ -29,24 +29,53 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include <string.h>
+
 #include "audio/AudioSettings.h"
+#include "base/PlatformUtilities.h"
 #include "logging/EventLogger.h"
 
 AudioSettings audioSettingsInstance = NULL;
+static THREAD_LOCAL AudioSettings threadAudioSettings = NULL;
 
 void initAudioSettings(void) {
-  audioSettingsInstance = malloc(sizeof(AudioSettingsMembers));
-  audioSettingsInstance->sampleRate = DEFAULT_SAMPLE_RATE;
-  audioSettingsInstance->numChannels = DEFAULT_NUM_CHANNELS;
-  audioSettingsInstance->blocksize = DEFAULT_BLOCKSIZE;
-  audioSettingsInstance->timeDivision = DEFAULT_TIME_DIVISION;
-  audioSettingsInstance->tempo = DEFAULT_TEMPO;
-  audioSettingsInstance->timeSignatureBeatsPerMeasure = DEFAULT_TIMESIG_BEATS_PER_MEASURE;
-  audioSettingsInstance->timeSignatureNoteValue = DEFAULT_TIMESIG_NOTE_VALUE;
+  audioSettingsInstance = newAudioSettings();
+}
+
+AudioSettings newAudioSettings(void) {
+  AudioSettings audioSettings = (AudioSettings)malloc(sizeof(AudioSettingsMembers));
+  audioSettings->sampleRate = DEFAULT_SAMPLE_RATE;
+  audioSettings->numChannels = DEFAULT_NUM_CHANNELS;
+  audioSettings->blocksize = DEFAULT_BLOCKSIZE;
+  audioSettings->timeDivision = DEFAULT_TIME_DIVISION;
+  audioSettings->tempo = DEFAULT_TEMPO;
+  audioSettings->timeSignatureBeatsPerMeasure = DEFAULT_TIMESIG_BEATS_PER_MEASURE;
+  audioSettings->timeSignatureNoteValue = DEFAULT_TIMESIG_NOTE_VALUE;
+  audioSettings->sampleFormat = DEFAULT_SAMPLE_FORMAT;
+  return audioSettings;
 }
 
 static AudioSettings _getAudioSettings(void) {
-  return audioSettingsInstance;
+  return threadAudioSettings != NULL ? threadAudioSettings : audioSettingsInstance;
+}
+
+AudioSettings getAudioSettings(void) {
+  return _getAudioSettings();
+}
+
+AudioSettings newAudioSettingsCopy(void) {
+  AudioSettings audioSettings;
+  // Programs which embed MrsWatson may never initialize the global instance
+  if(_getAudioSettings() == NULL) {
+    return newAudioSettings();
+  }
+  audioSettings = (AudioSettings)malloc(sizeof(AudioSettingsMembers));
+  memcpy(audioSettings, _getAudioSettings(), sizeof(AudioSettingsMembers));
+  return audioSettings;
+}
+
+void setThreadAudioSettings(AudioSettings audioSettings) {
+  threadAudioSettings = audioSettings;
 }
 
 double getSampleRate(void) {
@@ -77,6 +106,10 @@ short getTimeSignatureNoteValue(void) {
   return _getAudioSettings()->timeSignatureNoteValue;
 }
 
+SampleFormat getSampleFormat(void) {
+  return _getAudioSettings()->sampleFormat;
+}
+
 
 void setSampleRate(const double sampleRate) {
   if(sampleRate <= 0.0f) {
@@ -164,7 +197,23 @@ void setTimeSignatureFromMidiBytes(const byte* bytes) {
   }
 }
 
+void setSampleFormat(const SampleFormat sampleFormat) {
+  if(sampleFormat >= kNumSampleFormats) {
+    logError("Ignoring attempt to set invalid sample format");
+    return;
+  }
+  logInfo("Setting sample format to %s", sampleFormatGetName(sampleFormat));
+  _getAudioSettings()->sampleFormat = sampleFormat;
+}
+
 void freeAudioSettings(void) {
   free(audioSettingsInstance);
   audioSettingsInstance = NULL;
 }
+
+void freeAudioSettingsCopy(AudioSettings self) {
+  if(threadAudioSettings == self) {
+    threadAudioSettings = NULL;
+  }
+  free(self);
+}
@@ -28,6 +28,7 @@
 #ifndef MrsWatson_AudioSettings_h
 #define MrsWatson_AudioSettings_h
 
+#include "audio/SampleConversion.h"
 #include "base/Types.h"
 
 #define DEFAULT_SAMPLE_RATE 44100.0f
@@ -35,6 +36,7 @@
 #define DEFAULT_BLOCKSIZE 512l
 #define DEFAULT_TIME_DIVISION 96
 #define DEFAULT_BITRATE 16
+#define DEFAULT_SAMPLE_FORMAT kSampleFormatInt16
 #define DEFAULT_TEMPO 120.0f
 #define DEFAULT_TIMESIG_BEATS_PER_MEASURE 4
 #define DEFAULT_TIMESIG_NOTE_VALUE 4
@@ -47,6 +49,7 @@ typedef struct {
   double tempo;
   short timeSignatureBeatsPerMeasure;
   short timeSignatureNoteValue;
+  SampleFormat sampleFormat;
 } AudioSettingsMembers;
 
 typedef AudioSettingsMembers* AudioSettings;
@@ -54,6 +57,35 @@ extern AudioSettings audioSettingsInstance;
 
 void initAudioSettings(void);
 
+/**
+ * @return New settings instance with default values, which must be freed with
+ * freeAudioSettingsCopy()
+ */
+AudioSettings newAudioSettings(void);
+
+/**
+ * Get the settings used by the calling thread. Unless the thread has been
+ * given its own settings with setThreadAudioSettings(), this is the global
+ * instance.
+ * @return Audio settings for this thread
+ */
+AudioSettings getAudioSettings(void);
+
+/**
+ * Create a copy of the settings used by the calling thread. This allows
+ * several plugin chains to run in one process, each with their own settings.
+ * If there are no current settings, the default values are used instead.
+ * @return New settings instance, which must be freed with freeAudioSettingsCopy()
+ */
+AudioSettings newAudioSettingsCopy(void);
+
+/**
+ * Make all getters and setters called from this thread use another settings
+ * instance than the global one.
+ * @param audioSettings Settings to use, or NULL to use the global settings again
+ */
+void setThreadAudioSettings(AudioSettings audioSettings);
+
 double getSampleRate(void);
 unsigned int getNumChannels(void);
 unsigned long getBlocksize(void);
@@ -61,6 +93,7 @@ double getTimeDivision(void);
 double getTempo(void);
 short getTimeSignatureBeatsPerMeasure(void);
 short getTimeSignatureNoteValue(void);
+SampleFormat getSampleFormat(void);
 
 void setSampleRate(const double sampleRate);
 void setNumChannels(const unsigned int numChannels);
@@ -71,7 +104,14 @@ void setTempoFromMidiBytes(const byte* bytes);
 void setTimeSignatureBeatsPerMeasure(const short beatsPerMeasure);
 void setTimeSignatureNoteValue(const short noteValue);
 void setTimeSignatureFromMidiBytes(const byte* bytes);
+void setSampleFormat(const SampleFormat sampleFormat);
 
 void freeAudioSettings(void);
 
+/**
+ * Free a settings instance created by newAudioSettingsCopy()
+ * @param self
+ */
+void freeAudioSettingsCopy(AudioSettings self);
+
 #endif
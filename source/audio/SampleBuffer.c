@@ -29,12 +29,74 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if WINDOWS
+#include <malloc.h>
+#endif
+
 #include "audio/SampleBuffer.h"
 #include "logging/EventLogger.h"
 
+// Each channel is padded to a multiple of the alignment, so that every channel
+// starts on an aligned address.
+static unsigned long _getChannelStride(const unsigned long maxBlocksize) {
+  const unsigned long samplesPerAlignment = SAMPLE_BUFFER_ALIGNMENT / sizeof(Sample);
+  return ((maxBlocksize + samplesPerAlignment - 1) / samplesPerAlignment) * samplesPerAlignment;
+}
+
+static Sample* _allocateAlignedSamples(const size_t numSamples) {
+#if WINDOWS
+  return (Sample*)_aligned_malloc(sizeof(Sample) * numSamples, SAMPLE_BUFFER_ALIGNMENT);
+#else
+  void* data = NULL;
+  if(posix_memalign(&data, SAMPLE_BUFFER_ALIGNMENT, sizeof(Sample) * numSamples) != 0) {
+    return NULL;
+  }
+  return (Sample*)data;
+#endif
+}
+
+static void _freeAlignedSamples(Sample* data) {
+#if WINDOWS
+  _aligned_free(data);
+#else
+  free(data);
+#endif
+}
+
+// Move the buffer's samples to a new block of memory with the given size. The
+// active channels are copied, and everything else is set to zero.
+static boolByte _sampleBufferAllocate(SampleBuffer self, const unsigned int maxNumChannels, const unsigned long maxBlocksize) {
+  const unsigned long channelStride = _getChannelStride(maxBlocksize);
+  Sample* data = _allocateAlignedSamples(channelStride * maxNumChannels);
+  Samples* samples = (Samples*)malloc(sizeof(Samples) * maxNumChannels);
+  unsigned int i;
+
+  if(data == NULL || samples == NULL) {
+    logError("Could not allocate sample buffer with %d channels and blocksize %ld", maxNumChannels, maxBlocksize);
+    _freeAlignedSamples(data);
+    free(samples);
+    return false;
+  }
+
+  memset(data, 0, sizeof(Sample) * channelStride * maxNumChannels);
+  for(i = 0; i < maxNumChannels; i++) {
+    samples[i] = data + i * channelStride;
+    if(self->_data != NULL && i < self->numChannels) {
+      memcpy(samples[i], self->samples[i], sizeof(Sample) * self->maxBlocksize);
+    }
+  }
+
+  _freeAlignedSamples(self->_data);
+  free(self->samples);
+  self->_data = data;
+  self->samples = samples;
+  self->maxNumChannels = maxNumChannels;
+  self->maxBlocksize = maxBlocksize;
+  return true;
+}
+
 SampleBuffer newSampleBuffer(unsigned int numChannels, unsigned long blocksize) {
   SampleBuffer sampleBuffer = NULL;
-  unsigned int i;
 
   if(numChannels <= 0) {
     logError("Cannot create sample buffer with channel count %d", numChannels);
@@ -48,16 +110,76 @@ SampleBuffer newSampleBuffer(unsigned int numChannels, unsigned long blocksize)
   sampleBuffer = (SampleBuffer)malloc(sizeof(SampleBufferMembers));
   sampleBuffer->numChannels = numChannels;
   sampleBuffer->blocksize = blocksize;
+  sampleBuffer->samples = NULL;
+  sampleBuffer->maxNumChannels = 0;
+  sampleBuffer->maxBlocksize = 0;
+  sampleBuffer->_data = NULL;
 
-  sampleBuffer->samples = (Samples*)malloc(sizeof(Samples) * numChannels);
-  for(i = 0; i < numChannels; i++) {
-    sampleBuffer->samples[i] = (Samples)malloc(sizeof(Sample) * blocksize);
+  if(!_sampleBufferAllocate(sampleBuffer, numChannels, blocksize)) {
+    free(sampleBuffer);
+    return NULL;
   }
-  sampleBufferClear(sampleBuffer);
 
   return sampleBuffer;
 }
 
+SampleBuffer newSampleBufferView(const SampleBuffer buffer) {
+  SampleBuffer view = (SampleBuffer)malloc(sizeof(SampleBufferMembers));
+
+  // The view's maxNumChannels is the size of its channel array, since it has
+  // no samples of its own.
+  view->numChannels = 0;
+  view->blocksize = 0;
+  view->samples = (Samples*)malloc(sizeof(Samples) * buffer->maxNumChannels);
+  view->maxNumChannels = buffer->maxNumChannels;
+  view->maxBlocksize = 0;
+  view->_data = NULL;
+  sampleBufferSetViewRange(view, buffer, 0, buffer->blocksize);
+
+  return view;
+}
+
+boolByte sampleBufferSetViewRange(SampleBuffer self, const SampleBuffer buffer,
+  const unsigned long offset, const unsigned long numFrames) {
+  unsigned int i;
+
+  if(self->_data != NULL) {
+    logInternalError("Sample buffer is not a view");
+    return false;
+  }
+  if(buffer->numChannels > self->maxNumChannels) {
+    logInternalError("Sample buffer view cannot refer to %d channels", buffer->numChannels);
+    return false;
+  }
+  if(offset + numFrames > buffer->maxBlocksize) {
+    logInternalError("Sample buffer view range %ld-%ld is out of bounds", offset, offset + numFrames);
+    return false;
+  }
+
+  for(i = 0; i < buffer->numChannels; i++) {
+    self->samples[i] = buffer->samples[i] + offset;
+  }
+  self->numChannels = buffer->numChannels;
+  self->blocksize = numFrames;
+  self->maxBlocksize = numFrames;
+  return true;
+}
+
+boolByte sampleBufferReserve(SampleBuffer self, const unsigned int maxNumChannels, const unsigned long maxBlocksize) {
+  if(self->_data == NULL) {
+    logInternalError("Cannot reserve memory for a sample buffer view");
+    return false;
+  }
+  if(maxNumChannels <= self->maxNumChannels && maxBlocksize <= self->maxBlocksize) {
+    return true;
+  }
+
+  logDebug("Enlarging sample buffer to %d channels, blocksize %ld", maxNumChannels, maxBlocksize);
+  return _sampleBufferAllocate(self,
+    maxNumChannels > self->maxNumChannels ? maxNumChannels : self->maxNumChannels,
+    maxBlocksize > self->maxBlocksize ? maxBlocksize : self->maxBlocksize);
+}
+
 void sampleBufferClear(SampleBuffer self) {
   unsigned int i;
   for(i = 0; i < self->numChannels; i++) {
@@ -101,43 +223,38 @@ boolByte sampleBufferResize(SampleBuffer self, const unsigned int numChannels, b
     return false;
   }
   else if(numChannels < self->numChannels) {
-    for(i = self->numChannels - 1; i >= numChannels; i--) {
-      free(self->samples[i]);
-    }
+    // The memory of the removed channels is kept for when the buffer is expanded again
     self->numChannels = numChannels;
     return true;
   }
-  else if(numChannels > self->numChannels) {
-    self->samples = realloc(self->samples, sizeof(Samples) * numChannels);
+  else if(self->_data == NULL) {
+    logInternalError("Cannot expand a sample buffer view from %d to %d channels", self->numChannels, numChannels);
+    return false;
+  }
+  else {
+    if(!sampleBufferReserve(self, numChannels, self->maxBlocksize)) {
+      return false;
+    }
+    // Fill the entire channel, since the blocksize may be shorter than usual
+    // for the last block of the input
     for(i = self->numChannels; i < numChannels; i++) {
-      self->samples[i] = (Samples)malloc(sizeof(Sample) * self->blocksize);
       if(copy) {
-        memcpy(self->samples[i], self->samples[0], sizeof(Sample) * self->blocksize);
+        memcpy(self->samples[i], self->samples[0], sizeof(Sample) * self->maxBlocksize);
       }
       else {
-        memset(self->samples[i], 0, sizeof(Sample) * self->blocksize);
+        memset(self->samples[i], 0, sizeof(Sample) * self->maxBlocksize);
       }
     }
     self->numChannels = numChannels;
     return true;
   }
-  else {
-    // Invalid state, probably shouldn't happen...
-  }
-
-  return false;
 }
 
 void freeSampleBuffer(SampleBuffer sampleBuffer) {
-  unsigned int i;
   if(sampleBuffer == NULL) {
     return;
   }
-  if(sampleBuffer->samples != NULL) {
-    for(i = 0; i < sampleBuffer->numChannels; i++) {
-      free(sampleBuffer->samples[i]);
-    }
-    free(sampleBuffer->samples);
-  }
+  _freeAlignedSamples(sampleBuffer->_data);
+  free(sampleBuffer->samples);
   free(sampleBuffer);
 }
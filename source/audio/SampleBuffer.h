@@ -33,10 +33,24 @@
 typedef float Sample;
 typedef Sample* Samples;
 
+// Alignment of each channel's samples in bytes, which is enough for any SIMD load
+#define SAMPLE_BUFFER_ALIGNMENT 64
+
+/**
+ * Deinterlaced audio samples. All channels are stored back to back in a single
+ * block of memory, and each channel starts on an aligned address. The memory
+ * has room for maxNumChannels channels of maxBlocksize frames, and the active
+ * channel count and blocksize may be changed within those limits without
+ * allocating anything.
+ */
 typedef struct {
   unsigned int numChannels;
   unsigned long blocksize;
   Samples* samples;
+  unsigned int maxNumChannels;
+  unsigned long maxBlocksize;
+  // Memory which holds the samples of all channels, or NULL for views
+  Sample* _data;
 } SampleBufferMembers;
 typedef SampleBufferMembers* SampleBuffer;
 
@@ -48,6 +62,38 @@ typedef SampleBufferMembers* SampleBuffer;
  */
 SampleBuffer newSampleBuffer(unsigned int numChannels, unsigned long blocksize);
 
+/**
+ * Create a view which refers to the samples of another buffer rather than
+ * having its own. Initially the view covers the entire buffer, and it can be
+ * moved to other parts of it with sampleBufferSetViewRange().
+ * @param buffer Buffer to refer to, which must outlive the view
+ * @return An initialized SampleBuffer instance
+ */
+SampleBuffer newSampleBufferView(const SampleBuffer buffer);
+
+/**
+ * Make a view refer to a range of frames of another buffer. This does not
+ * allocate anything, so it can be used to split blocks while processing.
+ * @param self View created with newSampleBufferView()
+ * @param buffer Buffer to refer to, which must not have more channels than the
+ * buffer that the view was created with
+ * @param offset First frame of the range
+ * @param numFrames Number of frames in the range
+ * @return True on success, false if self is not a view or the range is invalid
+ */
+boolByte sampleBufferSetViewRange(SampleBuffer self, const SampleBuffer buffer,
+  const unsigned long offset, const unsigned long numFrames);
+
+/**
+ * Make sure that the buffer has room for a given number of channels and
+ * frames. Samples in the active channels are kept.
+ * @param self
+ * @param maxNumChannels Number of channels to reserve
+ * @param maxBlocksize Number of frames per channel to reserve
+ * @return True on success, false if the buffer is a view
+ */
+boolByte sampleBufferReserve(SampleBuffer self, const unsigned int maxNumChannels, const unsigned long maxBlocksize);
+
 /**
  * Set all samples to zero
  * @param self
@@ -64,7 +110,8 @@ boolByte sampleBufferCopy(SampleBuffer self, const SampleBuffer buffer);
 
 /**
  * Expand or shrink the channel count of a sample buffer. Useful for copying
- * between stereo/mono and such.
+ * between stereo/mono and such. Memory is only allocated when expanding past
+ * the buffer's maxNumChannels.
  * @param self
  * @param numChannels New channel count
  * @param copy Clone data from channel 0 to new channels if expanding the SampleBuffer
@@ -73,7 +120,8 @@ boolByte sampleBufferCopy(SampleBuffer self, const SampleBuffer buffer);
 boolByte sampleBufferResize(SampleBuffer self, const unsigned int numChannels, boolByte copy);
 
 /**
- * Free all memory used by a SampleBuffer instance
+ * Free all memory used by a SampleBuffer instance. Freeing a view does not
+ * affect the buffer that it refers to.
  * @param sampleBuffer
  */
 void freeSampleBuffer(SampleBuffer sampleBuffer);
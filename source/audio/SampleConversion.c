@@ -0,0 +1,779 @@
+//
+// SampleConversion.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/SampleConversion.h"
+#include "base/PlatformUtilities.h"
+#include "io/SampleSource.h"
+#include "logging/EventLogger.h"
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define HAVE_X86_KERNELS 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define HAVE_NEON_KERNELS 1
+#include <arm_neon.h>
+#endif
+
+// GCC and clang need to be told that a function may use instructions which are
+// newer than the target architecture. MSVC allows intrinsics in any function.
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+// All kernels divide by (rather than multiply with the reciprocal of) this value
+// when reading PCM data, so that they give exactly the same results.
+static const float kPcm16Scale = 32767.0f;
+static const float kPcm16Max = 32767.0f;
+static const float kPcm16Min = -32768.0f;
+static const float kPcm24Scale = 8388607.0f;
+static const float kPcm24Max = 8388607.0f;
+static const float kPcm24Min = -8388608.0f;
+static const double kPcm32Scale = 2147483647.0;
+static const double kPcm32Max = 2147483647.0;
+static const double kPcm32Min = -2147483648.0;
+
+static SampleConversionKernel _sampleConversionKernel = kNumSampleConversionKernels;
+
+static void _convertPcm16ToSamplesScalar(const short* inPcmSamples, Samples* outSamples,
+  const unsigned int numChannels, const unsigned long startFrame, const unsigned long numFrames,
+  const boolByte flipEndian) {
+  unsigned long currentInterlacedSample = startFrame * numChannels;
+  unsigned long currentFrame;
+  unsigned int currentChannel;
+  short shortValue;
+  Sample convertedSample;
+
+  for(currentFrame = startFrame; currentFrame < numFrames; ++currentFrame) {
+    for(currentChannel = 0; currentChannel < numChannels; ++currentChannel) {
+      shortValue = inPcmSamples[currentInterlacedSample++];
+      if(flipEndian) {
+        shortValue = flipShortEndian(shortValue);
+      }
+      convertedSample = (Sample)shortValue / kPcm16Scale;
+#if USE_BRICKWALL_LIMITER
+      // Only -32768 can fall outside of the allowed range
+      if(convertedSample < -1.0f) {
+        convertedSample = -1.0f;
+      }
+#endif
+      outSamples[currentChannel][currentFrame] = convertedSample;
+    }
+  }
+}
+
+static void _convertSamplesToPcm16Scalar(const Samples* inSamples, short* outPcmSamples,
+  const unsigned int numChannels, const unsigned long startFrame, const unsigned long numFrames,
+  const boolByte flipEndian) {
+  unsigned long currentInterlacedSample = startFrame * numChannels;
+  unsigned long currentFrame;
+  unsigned int currentChannel;
+  short shortValue;
+  Sample sample;
+
+  for(currentFrame = startFrame; currentFrame < numFrames; ++currentFrame) {
+    for(currentChannel = 0; currentChannel < numChannels; ++currentChannel) {
+      sample = inSamples[currentChannel][currentFrame];
+#if USE_BRICKWALL_LIMITER
+      if(sample > 1.0f) {
+        sample = 1.0f;
+      }
+      else if(sample < -1.0f) {
+        sample = -1.0f;
+      }
+#endif
+      // Assigning the product to a float variable forces it to be rounded to
+      // single precision, even when the FPU computes with extended precision
+      sample = sample * kPcm16Scale;
+      if(sample > kPcm16Max) {
+        sample = kPcm16Max;
+      }
+      else if(sample < kPcm16Min) {
+        sample = kPcm16Min;
+      }
+      shortValue = (short)sample;
+      if(flipEndian) {
+        shortValue = flipShortEndian(shortValue);
+      }
+      outPcmSamples[currentInterlacedSample++] = shortValue;
+    }
+  }
+}
+
+#if HAVE_X86_KERNELS
+TARGET_SSE2
+static __m128 _pcm16ToSamplesSse2(const __m128i values) {
+  __m128 result = _mm_div_ps(_mm_cvtepi32_ps(values), _mm_set1_ps(kPcm16Scale));
+#if USE_BRICKWALL_LIMITER
+  result = _mm_max_ps(result, _mm_set1_ps(-1.0f));
+#endif
+  return result;
+}
+
+TARGET_SSE2
+static __m128i _samplesToPcm16Sse2(__m128 samples) {
+#if USE_BRICKWALL_LIMITER
+  samples = _mm_min_ps(_mm_max_ps(samples, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+#endif
+  samples = _mm_mul_ps(samples, _mm_set1_ps(kPcm16Scale));
+  samples = _mm_min_ps(_mm_max_ps(samples, _mm_set1_ps(kPcm16Min)), _mm_set1_ps(kPcm16Max));
+  return _mm_cvttps_epi32(samples);
+}
+
+TARGET_SSE2
+static __m128i _flipEndianSse2(const __m128i values) {
+  return _mm_or_si128(_mm_slli_epi16(values, 8), _mm_srli_epi16(values, 8));
+}
+
+TARGET_SSE2
+static unsigned long _convertPcm16ToSamplesSse2(const short* inPcmSamples, Samples* outSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  unsigned long currentFrame = 0;
+  __m128i pcmValues;
+
+  if(numChannels == 1) {
+    for(; currentFrame + 8 <= numFrames; currentFrame += 8) {
+      pcmValues = _mm_loadu_si128((const __m128i*)(inPcmSamples + currentFrame));
+      if(flipEndian) {
+        pcmValues = _flipEndianSse2(pcmValues);
+      }
+      // Unpacking each value with itself and then shifting sign-extends it to 32 bits
+      _mm_storeu_ps(outSamples[0] + currentFrame,
+        _pcm16ToSamplesSse2(_mm_srai_epi32(_mm_unpacklo_epi16(pcmValues, pcmValues), 16)));
+      _mm_storeu_ps(outSamples[0] + currentFrame + 4,
+        _pcm16ToSamplesSse2(_mm_srai_epi32(_mm_unpackhi_epi16(pcmValues, pcmValues), 16)));
+    }
+  }
+  else if(numChannels == 2) {
+    for(; currentFrame + 4 <= numFrames; currentFrame += 4) {
+      pcmValues = _mm_loadu_si128((const __m128i*)(inPcmSamples + currentFrame * 2));
+      if(flipEndian) {
+        pcmValues = _flipEndianSse2(pcmValues);
+      }
+      // Each 32-bit lane holds one frame, with the left channel in the low half
+      _mm_storeu_ps(outSamples[0] + currentFrame,
+        _pcm16ToSamplesSse2(_mm_srai_epi32(_mm_slli_epi32(pcmValues, 16), 16)));
+      _mm_storeu_ps(outSamples[1] + currentFrame,
+        _pcm16ToSamplesSse2(_mm_srai_epi32(pcmValues, 16)));
+    }
+  }
+
+  return currentFrame;
+}
+
+TARGET_SSE2
+static unsigned long _convertSamplesToPcm16Sse2(const Samples* inSamples, short* outPcmSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  unsigned long currentFrame = 0;
+  __m128i pcmValues;
+
+  if(numChannels == 1) {
+    for(; currentFrame + 8 <= numFrames; currentFrame += 8) {
+      // Values are already clipped to the 16-bit range, so the saturation here does nothing
+      pcmValues = _mm_packs_epi32(_samplesToPcm16Sse2(_mm_loadu_ps(inSamples[0] + currentFrame)),
+        _samplesToPcm16Sse2(_mm_loadu_ps(inSamples[0] + currentFrame + 4)));
+      if(flipEndian) {
+        pcmValues = _flipEndianSse2(pcmValues);
+      }
+      _mm_storeu_si128((__m128i*)(outPcmSamples + currentFrame), pcmValues);
+    }
+  }
+  else if(numChannels == 2) {
+    for(; currentFrame + 4 <= numFrames; currentFrame += 4) {
+      pcmValues = _mm_or_si128(
+        _mm_and_si128(_samplesToPcm16Sse2(_mm_loadu_ps(inSamples[0] + currentFrame)), _mm_set1_epi32(0xffff)),
+        _mm_slli_epi32(_samplesToPcm16Sse2(_mm_loadu_ps(inSamples[1] + currentFrame)), 16));
+      if(flipEndian) {
+        pcmValues = _flipEndianSse2(pcmValues);
+      }
+      _mm_storeu_si128((__m128i*)(outPcmSamples + currentFrame * 2), pcmValues);
+    }
+  }
+
+  return currentFrame;
+}
+
+TARGET_AVX2
+static __m256 _pcm16ToSamplesAvx2(const __m256i values) {
+  __m256 result = _mm256_div_ps(_mm256_cvtepi32_ps(values), _mm256_set1_ps(kPcm16Scale));
+#if USE_BRICKWALL_LIMITER
+  result = _mm256_max_ps(result, _mm256_set1_ps(-1.0f));
+#endif
+  return result;
+}
+
+TARGET_AVX2
+static __m256i _samplesToPcm16Avx2(__m256 samples) {
+#if USE_BRICKWALL_LIMITER
+  samples = _mm256_min_ps(_mm256_max_ps(samples, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+#endif
+  samples = _mm256_mul_ps(samples, _mm256_set1_ps(kPcm16Scale));
+  samples = _mm256_min_ps(_mm256_max_ps(samples, _mm256_set1_ps(kPcm16Min)), _mm256_set1_ps(kPcm16Max));
+  return _mm256_cvttps_epi32(samples);
+}
+
+TARGET_AVX2
+static __m256i _flipEndianAvx2(const __m256i values) {
+  return _mm256_or_si256(_mm256_slli_epi16(values, 8), _mm256_srli_epi16(values, 8));
+}
+
+TARGET_AVX2
+static unsigned long _convertPcm16ToSamplesAvx2(const short* inPcmSamples, Samples* outSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  unsigned long currentFrame = 0;
+  __m128i monoPcmValues;
+  __m256i pcmValues;
+
+  if(numChannels == 1) {
+    for(; currentFrame + 8 <= numFrames; currentFrame += 8) {
+      monoPcmValues = _mm_loadu_si128((const __m128i*)(inPcmSamples + currentFrame));
+      if(flipEndian) {
+        monoPcmValues = _mm_or_si128(_mm_slli_epi16(monoPcmValues, 8), _mm_srli_epi16(monoPcmValues, 8));
+      }
+      _mm256_storeu_ps(outSamples[0] + currentFrame, _pcm16ToSamplesAvx2(_mm256_cvtepi16_epi32(monoPcmValues)));
+    }
+  }
+  else if(numChannels == 2) {
+    for(; currentFrame + 8 <= numFrames; currentFrame += 8) {
+      pcmValues = _mm256_loadu_si256((const __m256i*)(inPcmSamples + currentFrame * 2));
+      if(flipEndian) {
+        pcmValues = _flipEndianAvx2(pcmValues);
+      }
+      _mm256_storeu_ps(outSamples[0] + currentFrame,
+        _pcm16ToSamplesAvx2(_mm256_srai_epi32(_mm256_slli_epi32(pcmValues, 16), 16)));
+      _mm256_storeu_ps(outSamples[1] + currentFrame,
+        _pcm16ToSamplesAvx2(_mm256_srai_epi32(pcmValues, 16)));
+    }
+  }
+
+  return currentFrame;
+}
+
+TARGET_AVX2
+static unsigned long _convertSamplesToPcm16Avx2(const Samples* inSamples, short* outPcmSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  unsigned long currentFrame = 0;
+  __m256i pcmValues;
+
+  if(numChannels == 1) {
+    for(; currentFrame + 16 <= numFrames; currentFrame += 16) {
+      pcmValues = _mm256_packs_epi32(_samplesToPcm16Avx2(_mm256_loadu_ps(inSamples[0] + currentFrame)),
+        _samplesToPcm16Avx2(_mm256_loadu_ps(inSamples[0] + currentFrame + 8)));
+      // Packing works within each 128-bit lane, so the middle two quarters are swapped
+      pcmValues = _mm256_permute4x64_epi64(pcmValues, _MM_SHUFFLE(3, 1, 2, 0));
+      if(flipEndian) {
+        pcmValues = _flipEndianAvx2(pcmValues);
+      }
+      _mm256_storeu_si256((__m256i*)(outPcmSamples + currentFrame), pcmValues);
+    }
+  }
+  else if(numChannels == 2) {
+    for(; currentFrame + 8 <= numFrames; currentFrame += 8) {
+      pcmValues = _mm256_or_si256(
+        _mm256_and_si256(_samplesToPcm16Avx2(_mm256_loadu_ps(inSamples[0] + currentFrame)), _mm256_set1_epi32(0xffff)),
+        _mm256_slli_epi32(_samplesToPcm16Avx2(_mm256_loadu_ps(inSamples[1] + currentFrame)), 16));
+      if(flipEndian) {
+        pcmValues = _flipEndianAvx2(pcmValues);
+      }
+      _mm256_storeu_si256((__m256i*)(outPcmSamples + currentFrame * 2), pcmValues);
+    }
+  }
+
+  return currentFrame;
+}
+#endif
+
+#if HAVE_NEON_KERNELS
+static float32x4_t _pcm16ToSamplesNeon(const int32x4_t values) {
+  float32x4_t result = vdivq_f32(vcvtq_f32_s32(values), vdupq_n_f32(kPcm16Scale));
+#if USE_BRICKWALL_LIMITER
+  result = vmaxq_f32(result, vdupq_n_f32(-1.0f));
+#endif
+  return result;
+}
+
+static int16x8_t _samplesToPcm16Neon(const Sample* inSamples) {
+  float32x4_t low = vld1q_f32(inSamples);
+  float32x4_t high = vld1q_f32(inSamples + 4);
+#if USE_BRICKWALL_LIMITER
+  low = vminq_f32(vmaxq_f32(low, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+  high = vminq_f32(vmaxq_f32(high, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+#endif
+  low = vminq_f32(vmaxq_f32(vmulq_f32(low, vdupq_n_f32(kPcm16Scale)), vdupq_n_f32(kPcm16Min)), vdupq_n_f32(kPcm16Max));
+  high = vminq_f32(vmaxq_f32(vmulq_f32(high, vdupq_n_f32(kPcm16Scale)), vdupq_n_f32(kPcm16Min)), vdupq_n_f32(kPcm16Max));
+  return vcombine_s16(vqmovn_s32(vcvtq_s32_f32(low)), vqmovn_s32(vcvtq_s32_f32(high)));
+}
+
+static int16x8_t _flipEndianNeon(const int16x8_t values) {
+  return vreinterpretq_s16_u8(vrev16q_u8(vreinterpretq_u8_s16(values)));
+}
+
+static void _storePcm16ValuesNeon(const int16x8_t pcmValues, Sample* outSamples) {
+  vst1q_f32(outSamples, _pcm16ToSamplesNeon(vmovl_s16(vget_low_s16(pcmValues))));
+  vst1q_f32(outSamples + 4, _pcm16ToSamplesNeon(vmovl_s16(vget_high_s16(pcmValues))));
+}
+
+static unsigned long _convertPcm16ToSamplesNeon(const short* inPcmSamples, Samples* outSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  unsigned long currentFrame = 0;
+  int16x8_t pcmValues;
+  int16x8x2_t stereoPcmValues;
+
+  if(numChannels == 1) {
+    for(; currentFrame + 8 <= numFrames; currentFrame += 8) {
+      pcmValues = vld1q_s16(inPcmSamples + currentFrame);
+      if(flipEndian) {
+        pcmValues = _flipEndianNeon(pcmValues);
+      }
+      _storePcm16ValuesNeon(pcmValues, outSamples[0] + currentFrame);
+    }
+  }
+  else if(numChannels == 2) {
+    for(; currentFrame + 8 <= numFrames; currentFrame += 8) {
+      // vld2 deinterlaces the channels while loading
+      stereoPcmValues = vld2q_s16(inPcmSamples + currentFrame * 2);
+      if(flipEndian) {
+        stereoPcmValues.val[0] = _flipEndianNeon(stereoPcmValues.val[0]);
+        stereoPcmValues.val[1] = _flipEndianNeon(stereoPcmValues.val[1]);
+      }
+      _storePcm16ValuesNeon(stereoPcmValues.val[0], outSamples[0] + currentFrame);
+      _storePcm16ValuesNeon(stereoPcmValues.val[1], outSamples[1] + currentFrame);
+    }
+  }
+
+  return currentFrame;
+}
+
+static unsigned long _convertSamplesToPcm16Neon(const Samples* inSamples, short* outPcmSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  unsigned long currentFrame = 0;
+  int16x8_t pcmValues;
+  int16x8x2_t stereoPcmValues;
+
+  if(numChannels == 1) {
+    for(; currentFrame + 8 <= numFrames; currentFrame += 8) {
+      pcmValues = _samplesToPcm16Neon(inSamples[0] + currentFrame);
+      if(flipEndian) {
+        pcmValues = _flipEndianNeon(pcmValues);
+      }
+      vst1q_s16(outPcmSamples + currentFrame, pcmValues);
+    }
+  }
+  else if(numChannels == 2) {
+    for(; currentFrame + 8 <= numFrames; currentFrame += 8) {
+      stereoPcmValues.val[0] = _samplesToPcm16Neon(inSamples[0] + currentFrame);
+      stereoPcmValues.val[1] = _samplesToPcm16Neon(inSamples[1] + currentFrame);
+      if(flipEndian) {
+        stereoPcmValues.val[0] = _flipEndianNeon(stereoPcmValues.val[0]);
+        stereoPcmValues.val[1] = _flipEndianNeon(stereoPcmValues.val[1]);
+      }
+      // vst2 interlaces the channels while storing
+      vst2q_s16(outPcmSamples + currentFrame * 2, stereoPcmValues);
+    }
+  }
+
+  return currentFrame;
+}
+#endif
+
+unsigned int sampleFormatGetBytesPerSample(const SampleFormat format) {
+  switch(format) {
+    case kSampleFormatInt16: return 2;
+    case kSampleFormatInt24: return 3;
+    case kSampleFormatInt32: return 4;
+    case kSampleFormatFloat32: return 4;
+    case kSampleFormatFloat64: return 8;
+    default: return 0;
+  }
+}
+
+boolByte sampleFormatIsFloat(const SampleFormat format) {
+  return (boolByte)(format == kSampleFormatFloat32 || format == kSampleFormatFloat64);
+}
+
+const char* sampleFormatGetName(const SampleFormat format) {
+  switch(format) {
+    case kSampleFormatInt16: return "16-bit int";
+    case kSampleFormatInt24: return "24-bit int";
+    case kSampleFormatInt32: return "32-bit int";
+    case kSampleFormatFloat32: return "32-bit float";
+    case kSampleFormatFloat64: return "64-bit float";
+    default: return "invalid";
+  }
+}
+
+SampleFormat sampleFormatFromBitDepth(const unsigned int bitsPerSample, const boolByte isFloat) {
+  SampleFormat format;
+  for(format = kSampleFormatInt16; format < kNumSampleFormats; format++) {
+    if(sampleFormatGetBytesPerSample(format) * 8 == bitsPerSample && sampleFormatIsFloat(format) == isFloat) {
+      return format;
+    }
+  }
+  return kNumSampleFormats;
+}
+
+SampleFormat sampleFormatFromString(const char* string) {
+  char* endPtr = NULL;
+  long bitsPerSample;
+
+  if(string == NULL) {
+    return kNumSampleFormats;
+  }
+  bitsPerSample = strtol(string, &endPtr, 10);
+  if(endPtr == string) {
+    return kNumSampleFormats;
+  }
+  else if(*endPtr == '\0') {
+    return sampleFormatFromBitDepth((unsigned int)bitsPerSample, false);
+  }
+  else if((*endPtr == 'f' || *endPtr == 'F') && *(endPtr + 1) == '\0') {
+    return sampleFormatFromBitDepth((unsigned int)bitsPerSample, true);
+  }
+  return kNumSampleFormats;
+}
+
+const char* sampleConversionKernelGetName(const SampleConversionKernel kernel) {
+  switch(kernel) {
+    case kSampleConversionKernelScalar: return "scalar";
+    case kSampleConversionKernelSse2: return "SSE2";
+    case kSampleConversionKernelAvx2: return "AVX2";
+    case kSampleConversionKernelNeon: return "NEON";
+    default: return "invalid";
+  }
+}
+
+#if HAVE_X86_KERNELS && defined(_MSC_VER)
+static boolByte _isCpuFeatureSupportedMsvc(const SampleConversionKernel kernel) {
+  int cpuInfo[4];
+  int extendedCpuInfo[4];
+
+  __cpuid(cpuInfo, 1);
+  if(kernel == kSampleConversionKernelSse2) {
+    return (boolByte)((cpuInfo[3] & (1 << 26)) != 0);
+  }
+
+  // AVX2 also needs the OS to save the upper halves of the YMM registers
+  if((cpuInfo[2] & (1 << 27)) == 0 || (cpuInfo[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuid(extendedCpuInfo, 0);
+  if(extendedCpuInfo[0] < 7) {
+    return false;
+  }
+  __cpuidex(extendedCpuInfo, 7, 0);
+  return (boolByte)((extendedCpuInfo[1] & (1 << 5)) != 0);
+}
+#endif
+
+boolByte sampleConversionIsKernelSupported(const SampleConversionKernel kernel) {
+  switch(kernel) {
+    case kSampleConversionKernelScalar:
+      return true;
+#if HAVE_X86_KERNELS
+    case kSampleConversionKernelSse2:
+    case kSampleConversionKernelAvx2:
+#if defined(__GNUC__)
+      __builtin_cpu_init();
+      if(kernel == kSampleConversionKernelSse2) {
+        return (boolByte)(__builtin_cpu_supports("sse2") != 0);
+      }
+      return (boolByte)(__builtin_cpu_supports("avx2") != 0);
+#elif defined(_MSC_VER)
+      return _isCpuFeatureSupportedMsvc(kernel);
+#else
+      return false;
+#endif
+#endif
+#if HAVE_NEON_KERNELS
+    case kSampleConversionKernelNeon:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+SampleConversionKernel sampleConversionGetKernel(void) {
+  if(_sampleConversionKernel == kNumSampleConversionKernels) {
+    if(sampleConversionIsKernelSupported(kSampleConversionKernelAvx2)) {
+      _sampleConversionKernel = kSampleConversionKernelAvx2;
+    }
+    else if(sampleConversionIsKernelSupported(kSampleConversionKernelSse2)) {
+      _sampleConversionKernel = kSampleConversionKernelSse2;
+    }
+    else if(sampleConversionIsKernelSupported(kSampleConversionKernelNeon)) {
+      _sampleConversionKernel = kSampleConversionKernelNeon;
+    }
+    else {
+      _sampleConversionKernel = kSampleConversionKernelScalar;
+    }
+    logDebug("Using %s sample conversion", sampleConversionKernelGetName(_sampleConversionKernel));
+  }
+
+  return _sampleConversionKernel;
+}
+
+boolByte sampleConversionSetKernel(const SampleConversionKernel kernel) {
+  if(!sampleConversionIsKernelSupported(kernel)) {
+    logWarn("Sample conversion kernel '%s' is not supported on this machine", sampleConversionKernelGetName(kernel));
+    return false;
+  }
+
+  _sampleConversionKernel = kernel;
+  return true;
+}
+
+void convertPcm16ToSamples(const short* inPcmSamples, Samples* outSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  unsigned long framesConverted = 0;
+
+  switch(sampleConversionGetKernel()) {
+#if HAVE_X86_KERNELS
+    case kSampleConversionKernelSse2:
+      framesConverted = _convertPcm16ToSamplesSse2(inPcmSamples, outSamples, numChannels, numFrames, flipEndian);
+      break;
+    case kSampleConversionKernelAvx2:
+      framesConverted = _convertPcm16ToSamplesAvx2(inPcmSamples, outSamples, numChannels, numFrames, flipEndian);
+      break;
+#endif
+#if HAVE_NEON_KERNELS
+    case kSampleConversionKernelNeon:
+      framesConverted = _convertPcm16ToSamplesNeon(inPcmSamples, outSamples, numChannels, numFrames, flipEndian);
+      break;
+#endif
+    default:
+      break;
+  }
+
+  _convertPcm16ToSamplesScalar(inPcmSamples, outSamples, numChannels, framesConverted, numFrames, flipEndian);
+}
+
+void convertSamplesToPcm16(const Samples* inSamples, short* outPcmSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  unsigned long framesConverted = 0;
+
+  switch(sampleConversionGetKernel()) {
+#if HAVE_X86_KERNELS
+    case kSampleConversionKernelSse2:
+      framesConverted = _convertSamplesToPcm16Sse2(inSamples, outPcmSamples, numChannels, numFrames, flipEndian);
+      break;
+    case kSampleConversionKernelAvx2:
+      framesConverted = _convertSamplesToPcm16Avx2(inSamples, outPcmSamples, numChannels, numFrames, flipEndian);
+      break;
+#endif
+#if HAVE_NEON_KERNELS
+    case kSampleConversionKernelNeon:
+      framesConverted = _convertSamplesToPcm16Neon(inSamples, outPcmSamples, numChannels, numFrames, flipEndian);
+      break;
+#endif
+    default:
+      break;
+  }
+
+  _convertSamplesToPcm16Scalar(inSamples, outPcmSamples, numChannels, framesConverted, numFrames, flipEndian);
+}
+
+static void _flipBytes(byte* bytes, const unsigned int numBytes) {
+  unsigned int i;
+  byte swap;
+  for(i = 0; i < numBytes / 2; i++) {
+    swap = bytes[i];
+    bytes[i] = bytes[numBytes - i - 1];
+    bytes[numBytes - i - 1] = swap;
+  }
+}
+
+// Formats other than 16-bit are read through memcpy, since the data may not be
+// aligned to the size of a sample (ie, in a memory mapped file).
+static Sample _convertPcmValueToSample(const byte* pcmValue, const SampleFormat format, const boolByte flipEndian) {
+  byte bytes[8];
+  unsigned long unsignedValue;
+  int intValue;
+  float floatValue;
+  double doubleValue;
+  const unsigned int bytesPerSample = sampleFormatGetBytesPerSample(format);
+
+  memcpy(bytes, pcmValue, bytesPerSample);
+  if(flipEndian) {
+    _flipBytes(bytes, bytesPerSample);
+  }
+
+  switch(format) {
+    case kSampleFormatInt24:
+      // See _getFlipEndianForFormat() for the byte order of 24-bit values
+      unsignedValue = (unsigned long)bytes[0] | ((unsigned long)bytes[1] << 8) | ((unsigned long)bytes[2] << 16);
+      intValue = (unsignedValue & 0x800000) ? (int)unsignedValue - 0x1000000 : (int)unsignedValue;
+      return (Sample)intValue / kPcm24Scale;
+    case kSampleFormatInt32:
+      memcpy(&intValue, bytes, sizeof(int));
+      return (Sample)((double)intValue / kPcm32Scale);
+    case kSampleFormatFloat32:
+      memcpy(&floatValue, bytes, sizeof(float));
+      return floatValue;
+    case kSampleFormatFloat64:
+      memcpy(&doubleValue, bytes, sizeof(double));
+      return (Sample)doubleValue;
+    default:
+      return 0.0f;
+  }
+}
+
+static void _convertSampleToPcmValue(Sample sample, byte* outPcmValue, const SampleFormat format, const boolByte flipEndian) {
+  byte bytes[8];
+  int intValue;
+  double doubleValue;
+  const unsigned int bytesPerSample = sampleFormatGetBytesPerSample(format);
+
+  switch(format) {
+    case kSampleFormatInt24:
+      sample = sample * kPcm24Scale;
+      if(sample > kPcm24Max) {
+        sample = kPcm24Max;
+      }
+      else if(sample < kPcm24Min) {
+        sample = kPcm24Min;
+      }
+      intValue = (int)sample;
+      bytes[0] = (byte)(intValue & 0xff);
+      bytes[1] = (byte)((intValue >> 8) & 0xff);
+      bytes[2] = (byte)((intValue >> 16) & 0xff);
+      break;
+    case kSampleFormatInt32:
+      doubleValue = (double)sample * kPcm32Scale;
+      if(doubleValue > kPcm32Max) {
+        doubleValue = kPcm32Max;
+      }
+      else if(doubleValue < kPcm32Min) {
+        doubleValue = kPcm32Min;
+      }
+      intValue = (int)doubleValue;
+      memcpy(bytes, &intValue, sizeof(int));
+      break;
+    case kSampleFormatFloat32:
+      memcpy(bytes, &sample, sizeof(float));
+      break;
+    case kSampleFormatFloat64:
+      doubleValue = (double)sample;
+      memcpy(bytes, &doubleValue, sizeof(double));
+      break;
+    default:
+      return;
+  }
+
+  if(flipEndian) {
+    _flipBytes(bytes, bytesPerSample);
+  }
+  memcpy(outPcmValue, bytes, bytesPerSample);
+}
+
+static boolByte _getFlipEndianForFormat(const SampleFormat format, const boolByte flipEndian) {
+  // There is no native 24-bit type, so those values are always assembled in
+  // little-endian order. On big-endian hosts, the meaning of the flag is reversed.
+  if(format == kSampleFormatInt24 && !isHostLittleEndian()) {
+    return (boolByte)!flipEndian;
+  }
+  return flipEndian;
+}
+
+void convertPcmDataToSamples(const void* inPcmData, const SampleFormat format, Samples* outSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  const byte* pcmBytes = (const byte*)inPcmData;
+  const unsigned int bytesPerSample = sampleFormatGetBytesPerSample(format);
+  const boolByte flipValues = _getFlipEndianForFormat(format, flipEndian);
+  unsigned long currentFrame;
+  unsigned int currentChannel;
+
+  if(format == kSampleFormatInt16) {
+    convertPcm16ToSamples((const short*)inPcmData, outSamples, numChannels, numFrames, flipEndian);
+  }
+  else if(format == kSampleFormatFloat32 && !flipEndian) {
+    // Native float data needs no conversion at all, only deinterlacing
+    if(numChannels == 1) {
+      memcpy(outSamples[0], inPcmData, sizeof(Sample) * numFrames);
+    }
+    else {
+      for(currentFrame = 0; currentFrame < numFrames; ++currentFrame) {
+        for(currentChannel = 0; currentChannel < numChannels; ++currentChannel) {
+          memcpy(outSamples[currentChannel] + currentFrame, pcmBytes, sizeof(Sample));
+          pcmBytes += sizeof(Sample);
+        }
+      }
+    }
+  }
+  else {
+    for(currentFrame = 0; currentFrame < numFrames; ++currentFrame) {
+      for(currentChannel = 0; currentChannel < numChannels; ++currentChannel) {
+        outSamples[currentChannel][currentFrame] = _convertPcmValueToSample(pcmBytes, format, flipValues);
+        pcmBytes += bytesPerSample;
+      }
+    }
+  }
+}
+
+void convertSamplesToPcmData(const Samples* inSamples, void* outPcmData, const SampleFormat format,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian) {
+  byte* pcmBytes = (byte*)outPcmData;
+  const unsigned int bytesPerSample = sampleFormatGetBytesPerSample(format);
+  const boolByte flipValues = _getFlipEndianForFormat(format, flipEndian);
+  unsigned long currentFrame;
+  unsigned int currentChannel;
+
+  if(format == kSampleFormatInt16) {
+    convertSamplesToPcm16(inSamples, (short*)outPcmData, numChannels, numFrames, flipEndian);
+  }
+  else if(format == kSampleFormatFloat32 && !flipEndian) {
+    if(numChannels == 1) {
+      memcpy(outPcmData, inSamples[0], sizeof(Sample) * numFrames);
+    }
+    else {
+      for(currentFrame = 0; currentFrame < numFrames; ++currentFrame) {
+        for(currentChannel = 0; currentChannel < numChannels; ++currentChannel) {
+          memcpy(pcmBytes, inSamples[currentChannel] + currentFrame, sizeof(Sample));
+          pcmBytes += sizeof(Sample);
+        }
+      }
+    }
+  }
+  else {
+    for(currentFrame = 0; currentFrame < numFrames; ++currentFrame) {
+      for(currentChannel = 0; currentChannel < numChannels; ++currentChannel) {
+        _convertSampleToPcmValue(inSamples[currentChannel][currentFrame], pcmBytes, format, flipValues);
+        pcmBytes += bytesPerSample;
+      }
+    }
+  }
+}
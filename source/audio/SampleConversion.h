@@ -0,0 +1,173 @@
+//
+// SampleConversion.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_SampleConversion_h
+#define MrsWatson_SampleConversion_h
+
+#include "audio/SampleBuffer.h"
+#include "base/Types.h"
+
+/**
+ * Conversion between interlaced 16-bit PCM data and the deinterlaced float
+ * samples used by SampleBuffer. Vectorized kernels are used when the CPU
+ * supports them, and mono and stereo data take the vectorized paths. Other
+ * channel counts, and any frames left over at the end of a vector, use the
+ * scalar code. All kernels produce bit-identical results.
+ */
+typedef enum {
+  kSampleConversionKernelScalar,
+  kSampleConversionKernelSse2,
+  kSampleConversionKernelAvx2,
+  kSampleConversionKernelNeon,
+  kNumSampleConversionKernels
+} SampleConversionKernel;
+
+/**
+ * Formats of sample data in audio files. All formats are signed, and the
+ * integer formats are full-scale at their maximum positive value.
+ */
+typedef enum {
+  kSampleFormatInt16,
+  kSampleFormatInt24,
+  kSampleFormatInt32,
+  kSampleFormatFloat32,
+  kSampleFormatFloat64,
+  kNumSampleFormats
+} SampleFormat;
+
+/**
+ * @param format Sample format
+ * @return Size of a single sample in bytes
+ */
+unsigned int sampleFormatGetBytesPerSample(const SampleFormat format);
+
+/**
+ * @param format Sample format
+ * @return True if samples are stored as IEEE floating point numbers
+ */
+boolByte sampleFormatIsFloat(const SampleFormat format);
+
+/**
+ * @param format Sample format
+ * @return Human-readable name of the format, ie "24-bit int"
+ */
+const char* sampleFormatGetName(const SampleFormat format);
+
+/**
+ * Find the sample format which matches a file's header information
+ * @param bitsPerSample Number of bits per sample
+ * @param isFloat True if the samples are floating point
+ * @return Matching format, or kNumSampleFormats if the combination is not supported
+ */
+SampleFormat sampleFormatFromBitDepth(const unsigned int bitsPerSample, const boolByte isFloat);
+
+/**
+ * Parse a sample format given by the user. The bit depth may be followed by
+ * the letter 'f' to request floating point samples, so "16", "24", "32",
+ * "32f" and "64f" are accepted.
+ * @param string String to parse
+ * @return Parsed format, or kNumSampleFormats if the string is invalid
+ */
+SampleFormat sampleFormatFromString(const char* string);
+
+/**
+ * @param kernel Kernel type
+ * @return Human-readable name of the kernel
+ */
+const char* sampleConversionKernelGetName(const SampleConversionKernel kernel);
+
+/**
+ * @param kernel Kernel type
+ * @return True if the kernel was compiled into this build and the host CPU supports it
+ */
+boolByte sampleConversionIsKernelSupported(const SampleConversionKernel kernel);
+
+/**
+ * Get the kernel used for conversion. The first call picks the fastest
+ * supported kernel.
+ * @return Current kernel
+ */
+SampleConversionKernel sampleConversionGetKernel(void);
+
+/**
+ * Override the automatically selected kernel. This is mostly useful for
+ * testing and benchmarking.
+ * @param kernel Kernel to use
+ * @return True if the kernel is supported and was selected
+ */
+boolByte sampleConversionSetKernel(const SampleConversionKernel kernel);
+
+/**
+ * Convert interlaced 16-bit PCM data to deinterlaced samples
+ * @param inPcmSamples Interlaced PCM data, numChannels * numFrames items long
+ * @param outSamples Array of numChannels sample arrays, each at least numFrames long
+ * @param numChannels Number of channels
+ * @param numFrames Number of frames to convert
+ * @param flipEndian Swap the byte order of each PCM sample before converting it
+ */
+void convertPcm16ToSamples(const short* inPcmSamples, Samples* outSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian);
+
+/**
+ * Convert deinterlaced samples to interlaced 16-bit PCM data. Samples outside
+ * of the 16-bit range are clipped.
+ * @param inSamples Array of numChannels sample arrays, each at least numFrames long
+ * @param outPcmSamples Interlaced PCM data, numChannels * numFrames items long
+ * @param numChannels Number of channels
+ * @param numFrames Number of frames to convert
+ * @param flipEndian Swap the byte order of each PCM sample after converting it
+ */
+void convertSamplesToPcm16(const Samples* inSamples, short* outPcmSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian);
+
+/**
+ * Convert interlaced PCM data of any format to deinterlaced samples. 16-bit
+ * data is converted with the vectorized kernels.
+ * @param inPcmData Interlaced PCM data, numChannels * numFrames samples long
+ * @param format Format of the PCM data
+ * @param outSamples Array of numChannels sample arrays, each at least numFrames long
+ * @param numChannels Number of channels
+ * @param numFrames Number of frames to convert
+ * @param flipEndian Swap the byte order of each PCM sample before converting it
+ */
+void convertPcmDataToSamples(const void* inPcmData, const SampleFormat format, Samples* outSamples,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian);
+
+/**
+ * Convert deinterlaced samples to interlaced PCM data of any format. Integer
+ * formats are clipped to their range, but floating point data is written as-is.
+ * @param inSamples Array of numChannels sample arrays, each at least numFrames long
+ * @param outPcmData Interlaced PCM data, numChannels * numFrames samples long
+ * @param format Format of the PCM data
+ * @param numChannels Number of channels
+ * @param numFrames Number of frames to convert
+ * @param flipEndian Swap the byte order of each PCM sample after converting it
+ */
+void convertSamplesToPcmData(const Samples* inSamples, void* outPcmData, const SampleFormat format,
+  const unsigned int numChannels, const unsigned long numFrames, const boolByte flipEndian);
+
+#endif
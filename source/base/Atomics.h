@@ -0,0 +1,55 @@
+//
+// Atomics.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_Atomics_h
+#define MrsWatson_Atomics_h
+
+#include "base/PlatformUtilities.h"
+
+// Memory ordering primitives shared by the lock-free queues. A value stored
+// with atomicStoreRelease() makes every write which happened before it visible
+// to a thread which reads the value with atomicLoadAcquire(). This is enough to
+// publish data through an index, but it does not order a store before a later
+// load; code which needs that (for instance to check a waiting flag after
+// publishing an index) must put an atomicFullBarrier() in between.
+#if WINDOWS
+#define atomicLoadAcquire(value) (MemoryBarrier(), (value))
+#define atomicStoreRelease(value, newValue) do { MemoryBarrier(); (value) = (newValue); } while(0)
+#define atomicFullBarrier() MemoryBarrier()
+#define atomicCompareAndSwap(value, expected, desired) \
+  ((unsigned long)InterlockedCompareExchange((volatile LONG*)&(value), (LONG)(desired), (LONG)(expected)) == (expected))
+#define atomicIncrement(value) InterlockedIncrement((volatile LONG*)&(value))
+#else
+#define atomicLoadAcquire(value) __atomic_load_n(&(value), __ATOMIC_ACQUIRE)
+#define atomicStoreRelease(value, newValue) __atomic_store_n(&(value), (newValue), __ATOMIC_RELEASE)
+#define atomicFullBarrier() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define atomicCompareAndSwap(value, expected, desired) \
+  __atomic_compare_exchange_n(&(value), &(expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#define atomicIncrement(value) __atomic_add_fetch(&(value), 1, __ATOMIC_RELAXED)
+#endif
+
+#endif
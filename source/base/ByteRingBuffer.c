@@ -0,0 +1,262 @@
+//
+// ByteRingBuffer.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/Atomics.h"
+#include "base/ByteRingBuffer.h"
+#include "logging/EventLogger.h"
+
+// Same memory ordering as in RingBuffer, the data is always written before the
+// index which makes it visible to the other thread. The closed flag is also
+// stored with release semantics, so that all data written before closing the
+// buffer can be read once the flag is seen.
+//
+// A thread which is about to wait sets its waiting flag before reading the
+// signal count and checking the buffer again. The other thread publishes its
+// index before checking the flag, and the full barriers on both sides ensure
+// that at least one of them sees the other's store, so no wakeup is lost.
+static void _setWaiting(volatile boolByte* waitingFlag, const boolByte isWaiting) {
+  atomicStoreRelease(*waitingFlag, isWaiting);
+  atomicFullBarrier();
+}
+
+static void _notifyIfWaiting(ThreadSignal signal, volatile boolByte* waitingFlag) {
+  atomicFullBarrier();
+  if(atomicLoadAcquire(*waitingFlag)) {
+    threadSignalNotify(signal);
+  }
+}
+
+ByteRingBuffer newByteRingBuffer(unsigned long capacity) {
+  ByteRingBuffer ringBuffer;
+  unsigned long roundedCapacity = 1;
+
+  if(capacity == 0) {
+    logError("Cannot create byte ring buffer with capacity %ld", capacity);
+    return NULL;
+  }
+  while(roundedCapacity < capacity) {
+    roundedCapacity <<= 1;
+  }
+
+  ringBuffer = (ByteRingBuffer)malloc(sizeof(ByteRingBufferMembers));
+  ringBuffer->capacity = roundedCapacity;
+  ringBuffer->mask = roundedCapacity - 1;
+  ringBuffer->data = (byte*)malloc(roundedCapacity);
+  ringBuffer->_writeIndex = 0;
+  ringBuffer->_readIndex = 0;
+  ringBuffer->_isClosed = false;
+  ringBuffer->_consumerWaiting = false;
+  ringBuffer->_producerWaiting = false;
+  ringBuffer->notEmpty = newThreadSignal();
+  ringBuffer->notFull = newThreadSignal();
+
+  return ringBuffer;
+}
+
+size_t byteRingBufferWrite(ByteRingBuffer self, const byte* data, const size_t numBytes) {
+  const unsigned long writeIndex = self->_writeIndex;
+  const unsigned long offset = writeIndex & self->mask;
+  unsigned long numFree;
+  size_t numToWrite;
+  size_t numBeforeWrap;
+
+  if(atomicLoadAcquire(self->_isClosed)) {
+    return 0;
+  }
+  numFree = self->capacity - (writeIndex - atomicLoadAcquire(self->_readIndex));
+  numToWrite = numBytes < numFree ? numBytes : (size_t)numFree;
+  if(numToWrite == 0) {
+    return 0;
+  }
+
+  numBeforeWrap = self->capacity - offset;
+  if(numToWrite <= numBeforeWrap) {
+    memcpy(self->data + offset, data, numToWrite);
+  }
+  else {
+    memcpy(self->data + offset, data, numBeforeWrap);
+    memcpy(self->data, data + numBeforeWrap, numToWrite - numBeforeWrap);
+  }
+  atomicStoreRelease(self->_writeIndex, writeIndex + (unsigned long)numToWrite);
+  _notifyIfWaiting(self->notEmpty, &(self->_consumerWaiting));
+  return numToWrite;
+}
+
+size_t byteRingBufferRead(ByteRingBuffer self, byte* data, const size_t numBytes) {
+  const unsigned long readIndex = self->_readIndex;
+  const unsigned long offset = readIndex & self->mask;
+  const unsigned long numAvailable = atomicLoadAcquire(self->_writeIndex) - readIndex;
+  const size_t numToRead = numBytes < numAvailable ? numBytes : (size_t)numAvailable;
+  const size_t numBeforeWrap = self->capacity - offset;
+
+  if(numToRead == 0) {
+    return 0;
+  }
+
+  if(numToRead <= numBeforeWrap) {
+    memcpy(data, self->data + offset, numToRead);
+  }
+  else {
+    memcpy(data, self->data + offset, numBeforeWrap);
+    memcpy(data + numBeforeWrap, self->data, numToRead - numBeforeWrap);
+  }
+  atomicStoreRelease(self->_readIndex, readIndex + (unsigned long)numToRead);
+  _notifyIfWaiting(self->notFull, &(self->_producerWaiting));
+  return numToRead;
+}
+
+size_t byteRingBufferWriteBlocking(ByteRingBuffer self, const byte* data, const size_t numBytes) {
+  size_t numWritten = byteRingBufferWrite(self, data, numBytes);
+  unsigned long signalCount;
+
+  if(numWritten == numBytes || byteRingBufferIsClosed(self)) {
+    return numWritten;
+  }
+
+  _setWaiting(&(self->_producerWaiting), true);
+  while(true) {
+    signalCount = threadSignalGetCount(self->notFull);
+    numWritten += byteRingBufferWrite(self, data + numWritten, numBytes - numWritten);
+    if(numWritten == numBytes || byteRingBufferIsClosed(self)) {
+      break;
+    }
+    threadSignalWait(self->notFull, signalCount);
+  }
+  _setWaiting(&(self->_producerWaiting), false);
+  return numWritten;
+}
+
+size_t byteRingBufferReadBlocking(ByteRingBuffer self, byte* data, const size_t numBytes) {
+  size_t numRead = byteRingBufferRead(self, data, numBytes);
+  unsigned long signalCount;
+
+  if(numRead == numBytes) {
+    return numRead;
+  }
+
+  _setWaiting(&(self->_consumerWaiting), true);
+  while(true) {
+    signalCount = threadSignalGetCount(self->notEmpty);
+    numRead += byteRingBufferRead(self, data + numRead, numBytes - numRead);
+    if(numRead == numBytes) {
+      break;
+    }
+    if(byteRingBufferIsClosed(self)) {
+      // Anything written before the buffer was closed is visible now
+      numRead += byteRingBufferRead(self, data + numRead, numBytes - numRead);
+      break;
+    }
+    threadSignalWait(self->notEmpty, signalCount);
+  }
+  _setWaiting(&(self->_consumerWaiting), false);
+  return numRead;
+}
+
+size_t byteRingBufferReadAvailable(ByteRingBuffer self, byte* data, const size_t numBytes) {
+  size_t numRead = byteRingBufferRead(self, data, numBytes);
+  unsigned long signalCount;
+
+  if(numRead > 0) {
+    return numRead;
+  }
+
+  _setWaiting(&(self->_consumerWaiting), true);
+  while(true) {
+    signalCount = threadSignalGetCount(self->notEmpty);
+    numRead = byteRingBufferRead(self, data, numBytes);
+    if(numRead > 0) {
+      break;
+    }
+    if(byteRingBufferIsClosed(self)) {
+      numRead = byteRingBufferRead(self, data, numBytes);
+      break;
+    }
+    threadSignalWait(self->notEmpty, signalCount);
+  }
+  _setWaiting(&(self->_consumerWaiting), false);
+  return numRead;
+}
+
+unsigned long byteRingBufferWaitForReadable(ByteRingBuffer self, unsigned long numBytes) {
+  unsigned long numReadable;
+  unsigned long signalCount;
+
+  if(numBytes > self->capacity) {
+    numBytes = self->capacity;
+  }
+  numReadable = byteRingBufferGetNumReadable(self);
+  if(numReadable >= numBytes) {
+    return numReadable;
+  }
+
+  _setWaiting(&(self->_consumerWaiting), true);
+  while(true) {
+    signalCount = threadSignalGetCount(self->notEmpty);
+    numReadable = byteRingBufferGetNumReadable(self);
+    if(numReadable >= numBytes) {
+      break;
+    }
+    if(byteRingBufferIsClosed(self)) {
+      numReadable = byteRingBufferGetNumReadable(self);
+      break;
+    }
+    threadSignalWait(self->notEmpty, signalCount);
+  }
+  _setWaiting(&(self->_consumerWaiting), false);
+  return numReadable;
+}
+
+void byteRingBufferClose(ByteRingBuffer self) {
+  atomicStoreRelease(self->_isClosed, true);
+  threadSignalNotify(self->notEmpty);
+  threadSignalNotify(self->notFull);
+}
+
+boolByte byteRingBufferIsClosed(ByteRingBuffer self) {
+  return (boolByte)(atomicLoadAcquire(self->_isClosed) != 0);
+}
+
+unsigned long byteRingBufferGetNumReadable(ByteRingBuffer self) {
+  return atomicLoadAcquire(self->_writeIndex) - atomicLoadAcquire(self->_readIndex);
+}
+
+unsigned long byteRingBufferGetNumWritable(ByteRingBuffer self) {
+  return self->capacity - byteRingBufferGetNumReadable(self);
+}
+
+void freeByteRingBuffer(ByteRingBuffer self) {
+  if(self == NULL) {
+    return;
+  }
+  freeThreadSignal(self->notEmpty);
+  freeThreadSignal(self->notFull);
+  free(self->data);
+  free(self);
+}
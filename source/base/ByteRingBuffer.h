@@ -0,0 +1,166 @@
+//
+// ByteRingBuffer.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_ByteRingBuffer_h
+#define MrsWatson_ByteRingBuffer_h
+
+#include <stddef.h>
+
+#include "base/Thread.h"
+#include "base/Types.h"
+
+/**
+ * Lock-free buffer of bytes with a single producer thread and a single
+ * consumer thread. This works like RingBuffer, except that any number of bytes
+ * may be written or read at once, and that either side may close the buffer.
+ * Closing wakes up the other thread, after which no more data can be written,
+ * but data which is still in the buffer can be read.
+ */
+typedef struct {
+  byte* data;
+  unsigned long capacity;
+  unsigned long mask;
+  // These fields should be considered private, as they are only updated
+  // atomically by the producer (writeIndex) and consumer (readIndex).
+  volatile unsigned long _writeIndex;
+  volatile unsigned long _readIndex;
+  volatile int _isClosed;
+  // Set by the blocking calls while the consumer (or producer) is waiting on
+  // notEmpty (or notFull), so that the other side only signals when needed.
+  volatile boolByte _consumerWaiting;
+  volatile boolByte _producerWaiting;
+  ThreadSignal notEmpty;
+  ThreadSignal notFull;
+} ByteRingBufferMembers;
+typedef ByteRingBufferMembers* ByteRingBuffer;
+
+/**
+ * Create a new byte ring buffer
+ * @param capacity Number of bytes which can be buffered. Will be rounded up to
+ * the next power of two.
+ * @return New buffer, or NULL if capacity is zero
+ */
+ByteRingBuffer newByteRingBuffer(unsigned long capacity);
+
+/**
+ * Write as many bytes as fit into the buffer without blocking. Must only be
+ * called from the producer thread.
+ * @param self
+ * @param data Data to write
+ * @param numBytes Number of bytes to write
+ * @return Number of bytes written, which is 0 if the buffer is full or closed
+ */
+size_t byteRingBufferWrite(ByteRingBuffer self, const byte* data, const size_t numBytes);
+
+/**
+ * Read as many bytes as are available without blocking. Must only be called
+ * from the consumer thread.
+ * @param self
+ * @param data Buffer to read into
+ * @param numBytes Maximum number of bytes to read
+ * @return Number of bytes read
+ */
+size_t byteRingBufferRead(ByteRingBuffer self, byte* data, const size_t numBytes);
+
+/**
+ * Write all bytes, waiting for the consumer whenever the buffer is full.
+ * @param self
+ * @param data Data to write
+ * @param numBytes Number of bytes to write
+ * @return Number of bytes written, which is less than numBytes only if the
+ * buffer was closed
+ */
+size_t byteRingBufferWriteBlocking(ByteRingBuffer self, const byte* data, const size_t numBytes);
+
+/**
+ * Read exactly numBytes bytes, waiting for the producer whenever the buffer is
+ * empty.
+ * @param self
+ * @param data Buffer to read into
+ * @param numBytes Number of bytes to read
+ * @return Number of bytes read, which is less than numBytes only if the buffer
+ * was closed and all remaining data has been read
+ */
+size_t byteRingBufferReadBlocking(ByteRingBuffer self, byte* data, const size_t numBytes);
+
+/**
+ * Wait until there is data to read, then read as much as is available.
+ * @param self
+ * @param data Buffer to read into
+ * @param numBytes Maximum number of bytes to read
+ * @return Number of bytes read, which is 0 only if the buffer was closed and
+ * all remaining data has been read
+ */
+size_t byteRingBufferReadAvailable(ByteRingBuffer self, byte* data, const size_t numBytes);
+
+/**
+ * Wait until at least numBytes bytes can be read, without reading them. Must
+ * only be called from the consumer thread.
+ * @param self
+ * @param numBytes Number of bytes to wait for, which is limited to the
+ * capacity of the buffer
+ * @return Number of bytes which can be read, which is less than numBytes only
+ * if the buffer was closed
+ */
+unsigned long byteRingBufferWaitForReadable(ByteRingBuffer self, unsigned long numBytes);
+
+/**
+ * Close the buffer and wake up any waiting thread. May be called from either
+ * thread.
+ * @param self
+ */
+void byteRingBufferClose(ByteRingBuffer self);
+
+/**
+ * @param self
+ * @return True if the buffer has been closed
+ */
+boolByte byteRingBufferIsClosed(ByteRingBuffer self);
+
+/**
+ * Get the number of bytes which can be read. When called from a thread other
+ * than the consumer, the result is only approximate.
+ * @param self
+ * @return Number of buffered bytes
+ */
+unsigned long byteRingBufferGetNumReadable(ByteRingBuffer self);
+
+/**
+ * Get the number of bytes which can be written. When called from a thread
+ * other than the producer, the result is only approximate.
+ * @param self
+ * @return Number of free bytes
+ */
+unsigned long byteRingBufferGetNumWritable(ByteRingBuffer self);
+
+/**
+ * Free a byte ring buffer
+ * @param self
+ */
+void freeByteRingBuffer(ByteRingBuffer self);
+
+#endif
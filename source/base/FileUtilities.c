@@ -73,6 +73,36 @@ boolByte fileExists(const char* path) {
 #endif
 }
 
+boolByte getFileInfo(const char* path, unsigned long long* outSize, long long* outModificationTime) {
+#if UNIX
+  struct stat fileStatus;
+#elif WINDOWS
+  WIN32_FILE_ATTRIBUTE_DATA fileAttributes;
+#endif
+  if(path == NULL) {
+    return false;
+  }
+
+#if UNIX
+  if(stat(path, &fileStatus) != 0) {
+    return false;
+  }
+  *outSize = (unsigned long long)fileStatus.st_size;
+  *outModificationTime = (long long)fileStatus.st_mtime;
+  return true;
+#elif WINDOWS
+  if(!GetFileAttributesExA((LPCSTR)path, GetFileExInfoStandard, &fileAttributes)) {
+    return false;
+  }
+  *outSize = ((unsigned long long)fileAttributes.nFileSizeHigh << 32) | fileAttributes.nFileSizeLow;
+  *outModificationTime = (long long)(((unsigned long long)fileAttributes.ftLastWriteTime.dwHighDateTime << 32) |
+    fileAttributes.ftLastWriteTime.dwLowDateTime);
+  return true;
+#else
+  return false;
+#endif
+}
+
 boolByte copyFileToDirectory(const CharString fileAbsolutePath, const CharString directoryAbsolutePath) {
   boolByte result = false;
   CharString fileOutPath = newCharStringWithCapacity(kCharStringLengthLong);
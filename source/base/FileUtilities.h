@@ -42,6 +42,16 @@
 
 // File operations
 boolByte fileExists(const char* path);
+/**
+ * Get the size and modification time of a file, which can be used to tell if
+ * the file has changed since it was last seen.
+ * @param path File or directory to check
+ * @param outSize Size of the file in bytes
+ * @param outModificationTime Time of the last modification, in seconds since
+ * the epoch on Unix, or in 100-nanosecond intervals since 1601 on Windows
+ * @return False if the file does not exist
+ */
+boolByte getFileInfo(const char* path, unsigned long long* outSize, long long* outModificationTime);
 boolByte copyFileToDirectory(const CharString fileAbsolutePath, const CharString directoryAbsolutePath);
 
 // Directory operations
@@ -38,39 +38,49 @@ LinkedList newLinkedList(void) {
   list->item = NULL;
   list->nextItem = NULL;
   list->_numItems = 0;
+  list->_lastNode = NULL;
 
   return list;
 }
 
 void linkedListAppend(LinkedList self, void* item) {
-  LinkedListIterator iterator = self;
-  LinkedListIterator headNode;
-  LinkedList nextItem;
+  LinkedListIterator lastNode;
 
   if(self == NULL || item == NULL) {
     return;
   }
 
   // First item in the list
-  if(iterator->item == NULL) {
-    iterator->item = item;
-    iterator->_numItems = 1;
+  if(self->item == NULL) {
+    self->item = item;
+    self->_numItems = 1;
+    self->_lastNode = self;
     return;
   }
 
-  headNode = self;
-  while(true) {
-    if(iterator->nextItem == NULL) {
-      nextItem = newLinkedList();
-      nextItem->item = item;
-      iterator->nextItem = nextItem;
-      headNode->_numItems++;
-      break;
-    }
-    else {
-      iterator = (LinkedListIterator)(iterator->nextItem);
-    }
+  // Nodes which were kept when the list was cleared are used before allocating new ones
+  lastNode = (LinkedListIterator)self->_lastNode;
+  if(lastNode->nextItem == NULL) {
+    lastNode->nextItem = newLinkedList();
+  }
+  lastNode = (LinkedListIterator)lastNode->nextItem;
+  lastNode->item = item;
+  self->_lastNode = lastNode;
+  self->_numItems++;
+}
+
+void linkedListClear(LinkedList self) {
+  LinkedListIterator iterator = self;
+
+  if(self == NULL) {
+    return;
   }
+  while(iterator != NULL && iterator->item != NULL) {
+    iterator->item = NULL;
+    iterator = (LinkedListIterator)iterator->nextItem;
+  }
+  self->_numItems = 0;
+  self->_lastNode = NULL;
 }
 
 int linkedListLength(LinkedList self) {
@@ -128,19 +138,20 @@ void freeLinkedListAndItems(LinkedList self, LinkedListFreeItemFunc freeItem) {
   LinkedListIterator iterator = self;
   LinkedList current;
 
-  if(iterator->item == NULL){
-    free(iterator);
-    return;
-  }
-
   while(true) {
+    // Nodes which were kept by linkedListClear() have no item, and an empty
+    // list may still have such nodes after the head
     if(iterator->nextItem == NULL) {
-      freeItem(iterator->item);
+      if(iterator->item != NULL) {
+        freeItem(iterator->item);
+      }
       free(iterator);
       break;
     }
     else {
-      freeItem(iterator->item);
+      if(iterator->item != NULL) {
+        freeItem(iterator->item);
+      }
       current = iterator;
       iterator = (LinkedListIterator)(iterator->nextItem);
       free(current);
@@ -32,8 +32,10 @@ typedef struct {
   void* item;
   void* nextItem;
 
-  // This field should be considered private, and is only valid for the head node
+  // These fields should be considered private, and are only valid for the head node
   int _numItems;
+  // Last node which holds an item, so that items can be appended in constant time
+  void* _lastNode;
 } LinkedListMembers;
 
 typedef LinkedListMembers *LinkedList;
@@ -57,6 +59,15 @@ LinkedList newLinkedList(void);
  */
 void linkedListAppend(LinkedList self, void* item);
 
+/**
+ * Remove all items from a list without freeing them. The list keeps its nodes,
+ * which are reused by the next calls to linkedListAppend(), so a list which is
+ * cleared and refilled for each block of audio does not allocate any memory
+ * once it has grown to its largest size.
+ * @param self
+ */
+void linkedListClear(LinkedList self);
+
 /**
  * Get the number of items in a list. Use this function instead of accessing
  * the fields of the list, as the field names or use may change in the future.
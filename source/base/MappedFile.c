@@ -0,0 +1,141 @@
+//
+// MappedFile.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+
+#include "base/MappedFile.h"
+#include "logging/EventLogger.h"
+
+#if UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile newMappedFile(void) {
+  MappedFile mappedFile = (MappedFile)malloc(sizeof(MappedFileMembers));
+  mappedFile->data = NULL;
+  mappedFile->size = 0;
+  return mappedFile;
+}
+
+boolByte mappedFileOpen(MappedFile self, const char* filename) {
+#if UNIX
+  struct stat fileStat;
+  void* data;
+  int fd;
+#elif WINDOWS
+  HANDLE fileHandle;
+  HANDLE mappingHandle;
+  LARGE_INTEGER fileSize;
+  void* data;
+#endif
+
+  if(self->data != NULL) {
+    logInternalError("File is already mapped");
+    return false;
+  }
+
+#if UNIX
+  fd = open(filename, O_RDONLY);
+  if(fd < 0) {
+    return false;
+  }
+  if(fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size <= 0 ||
+     (unsigned long long)fileStat.st_size > (unsigned long long)((size_t)-1)) {
+    close(fd);
+    return false;
+  }
+
+  data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping holds its own reference to the file, so the descriptor is no longer needed
+  close(fd);
+  if(data == MAP_FAILED) {
+    logDebug("Could not map file '%s'", filename);
+    return false;
+  }
+  posix_madvise(data, (size_t)fileStat.st_size, POSIX_MADV_SEQUENTIAL);
+
+  self->data = (byte*)data;
+  self->size = (size_t)fileStat.st_size;
+  return true;
+#elif WINDOWS
+  fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if(fileHandle == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  if(GetFileType(fileHandle) != FILE_TYPE_DISK || !GetFileSizeEx(fileHandle, &fileSize) ||
+     fileSize.QuadPart <= 0 || (unsigned long long)fileSize.QuadPart > (unsigned long long)((size_t)-1)) {
+    CloseHandle(fileHandle);
+    return false;
+  }
+
+  mappingHandle = CreateFileMapping(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(fileHandle);
+  if(mappingHandle == NULL) {
+    logDebug("Could not map file '%s', error %d", filename, GetLastError());
+    return false;
+  }
+  // Like on unix, the view keeps the mapping alive after its handle is closed
+  data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mappingHandle);
+  if(data == NULL) {
+    logDebug("Could not map file '%s', error %d", filename, GetLastError());
+    return false;
+  }
+
+  self->data = (byte*)data;
+  self->size = (size_t)fileSize.QuadPart;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void mappedFileClose(MappedFile self) {
+  if(self->data == NULL) {
+    return;
+  }
+
+#if UNIX
+  munmap(self->data, self->size);
+#elif WINDOWS
+  UnmapViewOfFile(self->data);
+#endif
+
+  self->data = NULL;
+  self->size = 0;
+}
+
+void freeMappedFile(MappedFile self) {
+  if(self != NULL) {
+    mappedFileClose(self);
+    free(self);
+  }
+}
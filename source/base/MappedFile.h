@@ -0,0 +1,77 @@
+//
+// MappedFile.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_MappedFile_h
+#define MrsWatson_MappedFile_h
+
+#include <stdlib.h>
+
+#include "base/PlatformUtilities.h"
+#include "base/Types.h"
+
+/**
+ * A read-only view of an entire file in memory. Pages are loaded on demand
+ * by the operating system, so reading from the mapping avoids copying the
+ * data through stdio buffers first.
+ */
+typedef struct {
+  byte* data;
+  size_t size;
+} MappedFileMembers;
+typedef MappedFileMembers* MappedFile;
+
+/**
+ * Create a new mapped file object. No file is mapped until mappedFileOpen()
+ * is called.
+ * @return New mapped file object
+ */
+MappedFile newMappedFile(void);
+
+/**
+ * Map a file into memory for reading. Only non-empty regular files can be
+ * mapped, so callers should fall back to regular file I/O when this fails.
+ * The kernel is also told that the file will be read sequentially, so that it
+ * reads ahead aggressively and drops pages behind the read position early.
+ * @param self
+ * @param filename File to map
+ * @return True if the file was mapped
+ */
+boolByte mappedFileOpen(MappedFile self, const char* filename);
+
+/**
+ * Unmap the file. Does nothing if no file is mapped.
+ * @param self
+ */
+void mappedFileClose(MappedFile self);
+
+/**
+ * Unmap the file (if needed) and free the object
+ * @param self
+ */
+void freeMappedFile(MappedFile self);
+
+#endif
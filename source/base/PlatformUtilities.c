@@ -36,9 +36,11 @@
 
 #if WINDOWS
 #include <Windows.h>
+#include <Psapi.h>
 #elif UNIX
 #include <dirent.h>
 #include <unistd.h>
+#include <sys/resource.h>
 #if MACOSX
 #include <CoreServices/CoreServices.h>
 #include <mach-o/dyld.h>
@@ -246,6 +248,43 @@ boolByte isHost64Bit(void) {
   return result;
 }
 
+unsigned long long getPeakMemoryUsage(void) {
+  unsigned long long result = 0;
+
+#if UNIX
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0) {
+    logError("Could not get resource usage of process");
+  }
+  else {
+    // Linux reports the maximum resident set size in kilobytes, but Mac OS X
+    // uses bytes.
+#if MACOSX
+    result = (unsigned long long)usage.ru_maxrss;
+#else
+    result = (unsigned long long)usage.ru_maxrss * 1024;
+#endif
+  }
+#elif WINDOWS
+  typedef BOOL (WINAPI *GetProcessMemoryInfoFuncPtr)(HANDLE, PPROCESS_MEMORY_COUNTERS, DWORD);
+  PROCESS_MEMORY_COUNTERS memoryCounters;
+  GetProcessMemoryInfoFuncPtr getProcessMemoryInfoFunc = NULL;
+
+  // Newer versions of Windows have this function in kernel32, so it is looked
+  // up there instead of linking against psapi.
+  getProcessMemoryInfoFunc = (GetProcessMemoryInfoFuncPtr)GetProcAddress(GetModuleHandle(TEXT("kernel32")), "K32GetProcessMemoryInfo");
+  if(getProcessMemoryInfoFunc != NULL) {
+    if(getProcessMemoryInfoFunc(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters))) {
+      result = (unsigned long long)memoryCounters.PeakWorkingSetSize;
+    }
+  }
+#else
+  logUnsupportedFeature("Get peak memory usage");
+#endif
+
+  return result;
+}
+
 boolByte isHostLittleEndian(void) {
   int num = 1;
   boolByte result = (*(char*)&num == 1);
@@ -253,7 +292,9 @@ boolByte isHostLittleEndian(void) {
 }
 
 short flipShortEndian(const short value) {
-  return (value << 8) | (value >> 8);
+  // Shift as unsigned, otherwise the sign bit is smeared over the low byte of negative values
+  const unsigned short unsignedValue = (unsigned short)value;
+  return (short)((unsignedValue << 8) | (unsignedValue >> 8));
 }
 
 unsigned short convertBigEndianShortToPlatform(const unsigned short value) {
@@ -50,6 +50,13 @@
 #define unlink _unlink
 #endif
 
+// Storage class for static variables which have a separate value in each thread
+#if WINDOWS
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
 // Type definitions
 #if MACOSX
 #include <CoreFoundation/CFBundle.h>
@@ -81,6 +88,13 @@ boolByte isExecutable64Bit(void);
 boolByte isHost64Bit(void);
 boolByte isHostLittleEndian(void);
 
+/**
+ * Get the largest amount of physical memory which has been used by this process
+ * at any time since it was started.
+ * @return Peak resident set size in bytes, or 0 if it is not known
+ */
+unsigned long long getPeakMemoryUsage(void);
+
 short flipShortEndian(const short value);
 unsigned short convertBigEndianShortToPlatform(const unsigned short value);
 unsigned int convertBigEndianIntToPlatform(const unsigned int value);
@@ -0,0 +1,156 @@
+//
+// RecordQueue.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+
+#include "base/Atomics.h"
+#include "base/RecordQueue.h"
+#include "logging/EventLogger.h"
+
+// Each record is preceded by a header. The sequence number tells whose turn it
+// is to use the record: it equals the record's position when the record is free
+// for the producer writing that position, and the position plus one when the
+// record has been published and is waiting for the consumer.
+typedef struct {
+  volatile unsigned long sequence;
+  unsigned long position;
+} RecordHeader;
+
+// Records are aligned to this many bytes, which is enough for any type
+#define RECORD_QUEUE_ALIGNMENT 16
+#define RECORD_QUEUE_HEADER_SIZE (((sizeof(RecordHeader) + RECORD_QUEUE_ALIGNMENT - 1) / RECORD_QUEUE_ALIGNMENT) * RECORD_QUEUE_ALIGNMENT)
+
+static RecordHeader* _getRecordHeader(RecordQueue self, const unsigned long position) {
+  return (RecordHeader*)(self->records + (position & self->mask) * self->recordStride);
+}
+
+RecordQueue newRecordQueue(unsigned long capacity, size_t recordSize) {
+  RecordQueue recordQueue;
+  unsigned long roundedCapacity = 1;
+  unsigned long i;
+
+  if(capacity == 0 || recordSize == 0) {
+    logError("Cannot create record queue with capacity %lu and record size %lu", capacity, (unsigned long)recordSize);
+    return NULL;
+  }
+  while(roundedCapacity < capacity) {
+    roundedCapacity <<= 1;
+  }
+
+  recordQueue = (RecordQueue)malloc(sizeof(RecordQueueMembers));
+  recordQueue->recordSize = recordSize;
+  recordQueue->recordStride = RECORD_QUEUE_HEADER_SIZE +
+    ((recordSize + RECORD_QUEUE_ALIGNMENT - 1) / RECORD_QUEUE_ALIGNMENT) * RECORD_QUEUE_ALIGNMENT;
+  recordQueue->capacity = roundedCapacity;
+  recordQueue->mask = roundedCapacity - 1;
+  recordQueue->records = (byte*)malloc(recordQueue->recordStride * roundedCapacity);
+  recordQueue->_enqueueIndex = 0;
+  recordQueue->_dequeueIndex = 0;
+  recordQueue->_numFailedReservations = 0;
+  for(i = 0; i < roundedCapacity; i++) {
+    _getRecordHeader(recordQueue, i)->sequence = i;
+  }
+
+  return recordQueue;
+}
+
+void* recordQueueReserve(RecordQueue self) {
+  unsigned long position = atomicLoadAcquire(self->_enqueueIndex);
+  RecordHeader* header;
+  long difference;
+
+  while(true) {
+    header = _getRecordHeader(self, position);
+    difference = (long)(atomicLoadAcquire(header->sequence) - position);
+    if(difference == 0) {
+      // The record is free, so try to claim this position. On failure another
+      // producer got here first.
+      if(atomicCompareAndSwap(self->_enqueueIndex, position, position + 1)) {
+        break;
+      }
+      position = atomicLoadAcquire(self->_enqueueIndex);
+    }
+    else if(difference < 0) {
+      // The consumer has not yet released the record from the previous lap
+      atomicIncrement(self->_numFailedReservations);
+      return NULL;
+    }
+    else {
+      // Another producer claimed this position, try the next one
+      position = atomicLoadAcquire(self->_enqueueIndex);
+    }
+  }
+
+  header->position = position;
+  return (byte*)header + RECORD_QUEUE_HEADER_SIZE;
+}
+
+void recordQueuePublish(RecordQueue self, void* record) {
+  RecordHeader* header = (RecordHeader*)((byte*)record - RECORD_QUEUE_HEADER_SIZE);
+  atomicStoreRelease(header->sequence, header->position + 1);
+}
+
+void* recordQueuePeek(RecordQueue self, const unsigned long offset) {
+  const unsigned long position = self->_dequeueIndex + offset;
+  RecordHeader* header = _getRecordHeader(self, position);
+
+  if(offset >= self->capacity || atomicLoadAcquire(header->sequence) != position + 1) {
+    return NULL;
+  }
+  return (byte*)header + RECORD_QUEUE_HEADER_SIZE;
+}
+
+void recordQueueRelease(RecordQueue self, const unsigned long numRecords) {
+  const unsigned long position = self->_dequeueIndex;
+  unsigned long i;
+
+  // Hand each record over to the producer which will write it on the next lap
+  for(i = 0; i < numRecords; i++) {
+    atomicStoreRelease(_getRecordHeader(self, position + i)->sequence, position + i + self->capacity);
+  }
+  atomicStoreRelease(self->_dequeueIndex, position + numRecords);
+}
+
+unsigned long recordQueueGetNumReserved(RecordQueue self) {
+  return atomicLoadAcquire(self->_enqueueIndex);
+}
+
+unsigned long recordQueueGetNumReleased(RecordQueue self) {
+  return atomicLoadAcquire(self->_dequeueIndex);
+}
+
+unsigned long recordQueueGetNumFailedReservations(RecordQueue self) {
+  return atomicLoadAcquire(self->_numFailedReservations);
+}
+
+void freeRecordQueue(RecordQueue self) {
+  if(self == NULL) {
+    return;
+  }
+  free(self->records);
+  free(self);
+}
@@ -0,0 +1,131 @@
+//
+// RecordQueue.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_RecordQueue_h
+#define MrsWatson_RecordQueue_h
+
+#include <stddef.h>
+
+#include "base/Types.h"
+
+/**
+ * Lock-free queue of fixed-size records, which any number of producer threads
+ * may write to while a single consumer thread reads from it. Records are stored
+ * in place and never allocated after the queue is created, so producers can
+ * fill them from time-critical code. Producers reserve a record, fill it, and
+ * then publish it, and the consumer peeks at published records in order and
+ * releases them when done.
+ *
+ * Unlike RingBuffer, neither side ever blocks or locks, so a consumer which
+ * wants to wait for records must poll.
+ */
+typedef struct {
+  byte* records;
+  size_t recordSize;
+  size_t recordStride;
+  unsigned long capacity;
+  unsigned long mask;
+
+  // These fields should be considered private. The enqueue index is shared by
+  // all producers, and the dequeue index is only written by the consumer.
+  volatile unsigned long _enqueueIndex;
+  volatile unsigned long _dequeueIndex;
+  volatile unsigned long _numFailedReservations;
+} RecordQueueMembers;
+typedef RecordQueueMembers* RecordQueue;
+
+/**
+ * Create a new record queue
+ * @param capacity Number of records which can be queued. Will be rounded up to
+ * the next power of two.
+ * @param recordSize Size of each record in bytes
+ * @return New record queue, or NULL if capacity or record size is zero
+ */
+RecordQueue newRecordQueue(unsigned long capacity, size_t recordSize);
+
+/**
+ * Reserve the next record for writing. May be called from any thread, and the
+ * record must be passed to recordQueuePublish() once it has been filled.
+ * @param self
+ * @return Record of recordSize bytes, or NULL if the queue is full
+ */
+void* recordQueueReserve(RecordQueue self);
+
+/**
+ * Make a reserved record visible to the consumer
+ * @param self
+ * @param record Record returned by recordQueueReserve()
+ */
+void recordQueuePublish(RecordQueue self, void* record);
+
+/**
+ * Get a queued record without removing it. Must only be called from the
+ * consumer thread.
+ * @param self
+ * @param offset Position of the record in the queue, where 0 is the oldest
+ * @return Record, or NULL if there are not that many records queued or the
+ * record has been reserved but not yet published
+ */
+void* recordQueuePeek(RecordQueue self, const unsigned long offset);
+
+/**
+ * Remove the oldest records from the queue, making room for producers. Must
+ * only be called from the consumer thread.
+ * @param self
+ * @param numRecords Number of records to remove, all of which must have been
+ * returned by recordQueuePeek()
+ */
+void recordQueueRelease(RecordQueue self, const unsigned long numRecords);
+
+/**
+ * Get the total number of records which have been reserved. Records are
+ * reserved in order, so once recordQueueGetNumReleased() reaches this value,
+ * every record reserved before the call has been consumed.
+ * @param self
+ * @return Number of reserved records since the queue was created
+ */
+unsigned long recordQueueGetNumReserved(RecordQueue self);
+
+/**
+ * @param self
+ * @return Number of released records since the queue was created
+ */
+unsigned long recordQueueGetNumReleased(RecordQueue self);
+
+/**
+ * @param self
+ * @return Number of times recordQueueReserve() failed because the queue was full
+ */
+unsigned long recordQueueGetNumFailedReservations(RecordQueue self);
+
+/**
+ * Free a record queue. No other threads may be using the queue.
+ * @param self
+ */
+void freeRecordQueue(RecordQueue self);
+
+#endif
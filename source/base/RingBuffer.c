@@ -0,0 +1,157 @@
+//
+// RingBuffer.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+
+#include "base/Atomics.h"
+#include "base/RingBuffer.h"
+#include "logging/EventLogger.h"
+
+RingBuffer newRingBuffer(unsigned long capacity) {
+  RingBuffer ringBuffer;
+  unsigned long roundedCapacity = 1;
+
+  if(capacity == 0) {
+    logError("Cannot create ring buffer with capacity %ld", capacity);
+    return NULL;
+  }
+  while(roundedCapacity < capacity) {
+    roundedCapacity <<= 1;
+  }
+
+  ringBuffer = (RingBuffer)malloc(sizeof(RingBufferMembers));
+  ringBuffer->capacity = roundedCapacity;
+  ringBuffer->mask = roundedCapacity - 1;
+  ringBuffer->items = (void**)malloc(sizeof(void*) * roundedCapacity);
+  ringBuffer->_writeIndex = 0;
+  ringBuffer->_readIndex = 0;
+  ringBuffer->_consumerWaiting = false;
+  ringBuffer->_producerWaiting = false;
+  ringBuffer->notEmpty = newThreadSignal();
+  ringBuffer->notFull = newThreadSignal();
+
+  return ringBuffer;
+}
+
+boolByte ringBufferPush(RingBuffer self, void* item) {
+  const unsigned long writeIndex = self->_writeIndex;
+
+  if(item == NULL) {
+    return false;
+  }
+  if(writeIndex - atomicLoadAcquire(self->_readIndex) >= self->capacity) {
+    return false;
+  }
+
+  self->items[writeIndex & self->mask] = item;
+  // The producer publishes an item by storing the write index with release
+  // semantics, and the consumer reads it with acquire semantics (and vice
+  // versa for the read index), so the item is always visible before its index.
+  atomicStoreRelease(self->_writeIndex, writeIndex + 1);
+  // Either a consumer which is about to sleep sees the new index, or we see
+  // its waiting flag here and wake it up.
+  atomicFullBarrier();
+  if(atomicLoadAcquire(self->_consumerWaiting)) {
+    threadSignalNotify(self->notEmpty);
+  }
+  return true;
+}
+
+void* ringBufferPop(RingBuffer self) {
+  const unsigned long readIndex = self->_readIndex;
+  void* item;
+
+  if(atomicLoadAcquire(self->_writeIndex) == readIndex) {
+    return NULL;
+  }
+
+  item = self->items[readIndex & self->mask];
+  atomicStoreRelease(self->_readIndex, readIndex + 1);
+  atomicFullBarrier();
+  if(atomicLoadAcquire(self->_producerWaiting)) {
+    threadSignalNotify(self->notFull);
+  }
+  return item;
+}
+
+void ringBufferPushBlocking(RingBuffer self, void* item) {
+  unsigned long signalCount;
+
+  if(item == NULL || ringBufferPush(self, item)) {
+    return;
+  }
+
+  // Announce that we are waiting before reading the signal count and checking
+  // the queue again, so a pop which happens after the check must notify us.
+  atomicStoreRelease(self->_producerWaiting, true);
+  atomicFullBarrier();
+  while(true) {
+    signalCount = threadSignalGetCount(self->notFull);
+    if(ringBufferPush(self, item)) {
+      break;
+    }
+    threadSignalWait(self->notFull, signalCount);
+  }
+  atomicStoreRelease(self->_producerWaiting, false);
+}
+
+void* ringBufferPopBlocking(RingBuffer self) {
+  unsigned long signalCount;
+  void* item;
+
+  item = ringBufferPop(self);
+  if(item != NULL) {
+    return item;
+  }
+
+  atomicStoreRelease(self->_consumerWaiting, true);
+  atomicFullBarrier();
+  while(true) {
+    signalCount = threadSignalGetCount(self->notEmpty);
+    item = ringBufferPop(self);
+    if(item != NULL) {
+      break;
+    }
+    threadSignalWait(self->notEmpty, signalCount);
+  }
+  atomicStoreRelease(self->_consumerWaiting, false);
+  return item;
+}
+
+unsigned long ringBufferLength(RingBuffer self) {
+  return atomicLoadAcquire(self->_writeIndex) - atomicLoadAcquire(self->_readIndex);
+}
+
+void freeRingBuffer(RingBuffer self) {
+  if(self == NULL) {
+    return;
+  }
+  freeThreadSignal(self->notEmpty);
+  freeThreadSignal(self->notFull);
+  free(self->items);
+  free(self);
+}
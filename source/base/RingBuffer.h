@@ -0,0 +1,116 @@
+//
+// RingBuffer.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_RingBuffer_h
+#define MrsWatson_RingBuffer_h
+
+#include "base/Thread.h"
+#include "base/Types.h"
+
+/**
+ * Lock-free queue of pointers with a single producer thread and a single
+ * consumer thread. Items are passed between the threads without locking, the
+ * ThreadSignal fields are only used to wake up a thread which is sleeping in
+ * one of the blocking variants because the queue was full or empty. The
+ * non-blocking calls only touch a signal when the other thread has announced
+ * that it is waiting, so the fast path never takes a lock.
+ */
+typedef struct {
+  void** items;
+  unsigned long capacity;
+  unsigned long mask;
+
+  // These fields should be considered private, as they are only updated
+  // atomically by the producer (writeIndex) and consumer (readIndex).
+  volatile unsigned long _writeIndex;
+  volatile unsigned long _readIndex;
+  // Set by the blocking variants while the consumer (or producer) is about
+  // to sleep on notEmpty (or notFull).
+  volatile boolByte _consumerWaiting;
+  volatile boolByte _producerWaiting;
+
+  ThreadSignal notEmpty;
+  ThreadSignal notFull;
+} RingBufferMembers;
+typedef RingBufferMembers* RingBuffer;
+
+/**
+ * Create a new ring buffer
+ * @param capacity Number of items which can be queued. Will be rounded up to
+ * the next power of two.
+ * @return New ring buffer, or NULL if capacity is zero
+ */
+RingBuffer newRingBuffer(unsigned long capacity);
+
+/**
+ * Add an item to the queue without blocking. Must only be called from the
+ * producer thread.
+ * @param self
+ * @param item Item to add, which may not be NULL
+ * @return True if the item was added, false if the queue is full or the item
+ * is NULL
+ */
+boolByte ringBufferPush(RingBuffer self, void* item);
+
+/**
+ * Remove the oldest item from the queue without blocking. Must only be called
+ * from the consumer thread.
+ * @param self
+ * @return Oldest item, or NULL if the queue is empty
+ */
+void* ringBufferPop(RingBuffer self);
+
+/**
+ * Add an item to the queue, waiting for the consumer if the queue is full.
+ * @param self
+ * @param item Item to add, which may not be NULL
+ */
+void ringBufferPushBlocking(RingBuffer self, void* item);
+
+/**
+ * Remove the oldest item from the queue, waiting for the producer if the
+ * queue is empty.
+ * @param self
+ * @return Oldest item
+ */
+void* ringBufferPopBlocking(RingBuffer self);
+
+/**
+ * Get the number of items currently queued. When called from a thread other
+ * than the producer or consumer, the result is only approximate.
+ * @param self
+ * @return Number of queued items
+ */
+unsigned long ringBufferLength(RingBuffer self);
+
+/**
+ * Free a ring buffer. Any items remaining in the queue are *not* freed.
+ * @param self
+ */
+void freeRingBuffer(RingBuffer self);
+
+#endif
@@ -0,0 +1,230 @@
+//
+// Thread.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "base/Thread.h"
+#include "logging/EventLogger.h"
+
+Thread newThread(ThreadFunc threadFunc, void* userData) {
+  Thread thread = (Thread)malloc(sizeof(ThreadMembers));
+
+  thread->threadFunc = threadFunc;
+  thread->userData = userData;
+  thread->isRunning = false;
+
+  return thread;
+}
+
+#if WINDOWS
+static DWORD WINAPI _windowsThreadFunc(LPVOID threadPtr) {
+  Thread thread = (Thread)threadPtr;
+  thread->threadFunc(thread->userData);
+  return 0;
+}
+#endif
+
+boolByte threadStart(Thread self) {
+  if(self->isRunning) {
+    logWarn("Thread has already been started");
+    return false;
+  }
+
+#if WINDOWS
+  self->handle = CreateThread(NULL, 0, _windowsThreadFunc, self, 0, NULL);
+  if(self->handle == NULL) {
+    logError("Could not create thread, error %d", GetLastError());
+    return false;
+  }
+#elif UNIX
+  if(pthread_create(&(self->handle), NULL, self->threadFunc, self->userData) != 0) {
+    logError("Could not create thread");
+    return false;
+  }
+#else
+  logUnsupportedFeature("Threads on this platform");
+  return false;
+#endif
+
+  self->isRunning = true;
+  return true;
+}
+
+boolByte threadJoin(Thread self) {
+  if(!self->isRunning) {
+    return false;
+  }
+
+#if WINDOWS
+  WaitForSingleObject(self->handle, INFINITE);
+  CloseHandle(self->handle);
+#elif UNIX
+  if(pthread_join(self->handle, NULL) != 0) {
+    logError("Could not join thread");
+    return false;
+  }
+#endif
+
+  self->isRunning = false;
+  return true;
+}
+
+void freeThread(Thread self) {
+  if(self == NULL) {
+    return;
+  }
+  if(self->isRunning) {
+    logInternalError("Freeing thread which is still running");
+  }
+  free(self);
+}
+
+void threadSleep(const unsigned long milliseconds) {
+#if WINDOWS
+  Sleep((DWORD)milliseconds);
+#elif UNIX
+  struct timespec sleepTime;
+  sleepTime.tv_sec = (time_t)(milliseconds / 1000);
+  sleepTime.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+  nanosleep(&sleepTime, NULL);
+#endif
+}
+
+ThreadSignal newThreadSignal(void) {
+  ThreadSignal signal = (ThreadSignal)malloc(sizeof(ThreadSignalMembers));
+
+  signal->count = 0;
+#if WINDOWS
+  InitializeCriticalSection(&(signal->mutex));
+  InitializeConditionVariable(&(signal->condition));
+#elif UNIX
+  pthread_mutex_init(&(signal->mutex), NULL);
+  pthread_cond_init(&(signal->condition), NULL);
+#endif
+
+  return signal;
+}
+
+unsigned long threadSignalGetCount(ThreadSignal self) {
+  unsigned long count;
+#if WINDOWS
+  EnterCriticalSection(&(self->mutex));
+  count = self->count;
+  LeaveCriticalSection(&(self->mutex));
+#elif UNIX
+  pthread_mutex_lock(&(self->mutex));
+  count = self->count;
+  pthread_mutex_unlock(&(self->mutex));
+#else
+  count = self->count;
+#endif
+  return count;
+}
+
+void threadSignalWait(ThreadSignal self, const unsigned long count) {
+#if WINDOWS
+  EnterCriticalSection(&(self->mutex));
+  while(self->count == count) {
+    SleepConditionVariableCS(&(self->condition), &(self->mutex), INFINITE);
+  }
+  LeaveCriticalSection(&(self->mutex));
+#elif UNIX
+  pthread_mutex_lock(&(self->mutex));
+  while(self->count == count) {
+    pthread_cond_wait(&(self->condition), &(self->mutex));
+  }
+  pthread_mutex_unlock(&(self->mutex));
+#endif
+}
+
+void threadSignalNotify(ThreadSignal self) {
+#if WINDOWS
+  EnterCriticalSection(&(self->mutex));
+  self->count++;
+  WakeAllConditionVariable(&(self->condition));
+  LeaveCriticalSection(&(self->mutex));
+#elif UNIX
+  pthread_mutex_lock(&(self->mutex));
+  self->count++;
+  pthread_cond_broadcast(&(self->condition));
+  pthread_mutex_unlock(&(self->mutex));
+#else
+  self->count++;
+#endif
+}
+
+void freeThreadSignal(ThreadSignal self) {
+  if(self == NULL) {
+    return;
+  }
+#if WINDOWS
+  DeleteCriticalSection(&(self->mutex));
+#elif UNIX
+  pthread_mutex_destroy(&(self->mutex));
+  pthread_cond_destroy(&(self->condition));
+#endif
+  free(self);
+}
+
+Mutex newMutex(void) {
+  Mutex mutex = (Mutex)malloc(sizeof(MutexMembers));
+#if WINDOWS
+  InitializeCriticalSection(&(mutex->handle));
+#elif UNIX
+  pthread_mutex_init(&(mutex->handle), NULL);
+#endif
+  return mutex;
+}
+
+void mutexLock(Mutex self) {
+#if WINDOWS
+  EnterCriticalSection(&(self->handle));
+#elif UNIX
+  pthread_mutex_lock(&(self->handle));
+#endif
+}
+
+void mutexUnlock(Mutex self) {
+#if WINDOWS
+  LeaveCriticalSection(&(self->handle));
+#elif UNIX
+  pthread_mutex_unlock(&(self->handle));
+#endif
+}
+
+void freeMutex(Mutex self) {
+  if(self == NULL) {
+    return;
+  }
+#if WINDOWS
+  DeleteCriticalSection(&(self->handle));
+#elif UNIX
+  pthread_mutex_destroy(&(self->handle));
+#endif
+  free(self);
+}
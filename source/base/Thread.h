@@ -0,0 +1,174 @@
+//
+// Thread.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_Thread_h
+#define MrsWatson_Thread_h
+
+#include "base/PlatformUtilities.h"
+#include "base/Types.h"
+
+#if UNIX
+#include <pthread.h>
+#endif
+
+typedef void* (*ThreadFunc)(void* userData);
+
+typedef struct {
+  ThreadFunc threadFunc;
+  void* userData;
+  boolByte isRunning;
+#if WINDOWS
+  HANDLE handle;
+#elif UNIX
+  pthread_t handle;
+#endif
+} ThreadMembers;
+typedef ThreadMembers* Thread;
+
+/**
+ * A signal which one thread can use to wake up another one. The signal keeps
+ * a counter which is incremented on every notification, so a waiting thread
+ * first reads the counter, then checks its own condition, and only then waits
+ * for the counter to change. That way a notification sent between checking the
+ * condition and starting to wait is never lost.
+ */
+typedef struct {
+  unsigned long count;
+#if WINDOWS
+  CRITICAL_SECTION mutex;
+  CONDITION_VARIABLE condition;
+#elif UNIX
+  pthread_mutex_t mutex;
+  pthread_cond_t condition;
+#endif
+} ThreadSignalMembers;
+typedef ThreadSignalMembers* ThreadSignal;
+
+/**
+ * A lock for data which is shared between several threads
+ */
+typedef struct {
+#if WINDOWS
+  CRITICAL_SECTION handle;
+#elif UNIX
+  pthread_mutex_t handle;
+#endif
+} MutexMembers;
+typedef MutexMembers* Mutex;
+
+/**
+ * Create a new thread. The thread is not started until threadStart() is called.
+ * @param threadFunc Function to run on the thread
+ * @param userData Argument passed to the thread function
+ * @return New thread object
+ */
+Thread newThread(ThreadFunc threadFunc, void* userData);
+
+/**
+ * Start running a thread
+ * @param self
+ * @return True if the thread was started
+ */
+boolByte threadStart(Thread self);
+
+/**
+ * Wait for a thread to finish. Does nothing if the thread was never started.
+ * @param self
+ * @return True if the thread was joined
+ */
+boolByte threadJoin(Thread self);
+
+/**
+ * Free a thread object. The thread should have been joined beforehand.
+ * @param self
+ */
+void freeThread(Thread self);
+
+/**
+ * Suspend the calling thread
+ * @param milliseconds Minimum time to sleep
+ */
+void threadSleep(const unsigned long milliseconds);
+
+/**
+ * Create a new thread signal
+ * @return New signal with a count of zero
+ */
+ThreadSignal newThreadSignal(void);
+
+/**
+ * Get the current notification count of the signal
+ * @param self
+ * @return Notification count, to be passed to threadSignalWait()
+ */
+unsigned long threadSignalGetCount(ThreadSignal self);
+
+/**
+ * Block until the signal is notified after the given count was read
+ * @param self
+ * @param count Value previously returned by threadSignalGetCount()
+ */
+void threadSignalWait(ThreadSignal self, const unsigned long count);
+
+/**
+ * Wake up all threads waiting on this signal
+ * @param self
+ */
+void threadSignalNotify(ThreadSignal self);
+
+/**
+ * Free a thread signal. No threads may be waiting on the signal.
+ * @param self
+ */
+void freeThreadSignal(ThreadSignal self);
+
+/**
+ * Create a new mutex
+ * @return New unlocked mutex
+ */
+Mutex newMutex(void);
+
+/**
+ * Lock a mutex, blocking until it is available. Mutexes are not recursive, so
+ * a thread must not lock a mutex which it is already holding.
+ * @param self
+ */
+void mutexLock(Mutex self);
+
+/**
+ * Unlock a mutex which was locked by the calling thread
+ * @param self
+ */
+void mutexUnlock(Mutex self);
+
+/**
+ * Free a mutex. The mutex must not be locked.
+ * @param self
+ */
+void freeMutex(Mutex self);
+
+#endif
@@ -0,0 +1,173 @@
+//
+// ThreadPool.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+
+#include "base/ThreadPool.h"
+#include "logging/EventLogger.h"
+
+// Take the next task of the current batch, or return -1 if none are left.
+// Must be called with the mutex held.
+static int _threadPoolTakeTask(ThreadPool self) {
+  if(self->nextTask < self->numTasks) {
+    return self->nextTask++;
+  }
+  return -1;
+}
+
+static void _threadPoolRunTask(ThreadPool self, ThreadPoolTaskFunc taskFunc, void* userData, const int taskIndex) {
+  taskFunc(userData, taskIndex);
+  mutexLock(self->mutex);
+  self->numTasksFinished++;
+  mutexUnlock(self->mutex);
+  threadSignalNotify(self->taskFinished);
+}
+
+static void* _threadPoolWorkerThread(void* userData) {
+  ThreadPool self = (ThreadPool)userData;
+  ThreadPoolTaskFunc taskFunc;
+  void* taskUserData;
+  unsigned long signalCount;
+  int taskIndex;
+
+  while(true) {
+    // Read the count before looking for work, so that a batch which is
+    // started in the meantime still wakes this thread up
+    signalCount = threadSignalGetCount(self->batchStarted);
+    mutexLock(self->mutex);
+    if(self->isStopping) {
+      mutexUnlock(self->mutex);
+      break;
+    }
+    taskIndex = _threadPoolTakeTask(self);
+    taskFunc = self->taskFunc;
+    taskUserData = self->userData;
+    mutexUnlock(self->mutex);
+
+    if(taskIndex >= 0) {
+      _threadPoolRunTask(self, taskFunc, taskUserData, taskIndex);
+    }
+    else {
+      threadSignalWait(self->batchStarted, signalCount);
+    }
+  }
+
+  return NULL;
+}
+
+ThreadPool newThreadPool(const int numThreads) {
+  ThreadPool threadPool = (ThreadPool)malloc(sizeof(ThreadPoolMembers));
+  int i;
+
+  threadPool->numThreads = 0;
+  threadPool->threads = (Thread*)malloc(sizeof(Thread) * (numThreads > 0 ? numThreads : 1));
+  threadPool->mutex = newMutex();
+  threadPool->batchStarted = newThreadSignal();
+  threadPool->taskFinished = newThreadSignal();
+  threadPool->taskFunc = NULL;
+  threadPool->userData = NULL;
+  threadPool->numTasks = 0;
+  threadPool->nextTask = 0;
+  threadPool->numTasksFinished = 0;
+  threadPool->isStopping = false;
+
+  for(i = 0; i < numThreads; i++) {
+    threadPool->threads[i] = newThread(_threadPoolWorkerThread, threadPool);
+    if(!threadStart(threadPool->threads[i])) {
+      // The pool still works with fewer threads, the calling thread runs any
+      // tasks which are left
+      logWarn("Could only start %d of %d threads for thread pool", i, numThreads);
+      freeThread(threadPool->threads[i]);
+      break;
+    }
+    threadPool->numThreads++;
+  }
+
+  return threadPool;
+}
+
+void threadPoolRun(ThreadPool self, ThreadPoolTaskFunc taskFunc, void* userData, const int numTasks) {
+  unsigned long signalCount;
+  boolByte isFinished;
+  int taskIndex;
+
+  mutexLock(self->mutex);
+  self->taskFunc = taskFunc;
+  self->userData = userData;
+  self->numTasks = numTasks;
+  self->nextTask = 0;
+  self->numTasksFinished = 0;
+  mutexUnlock(self->mutex);
+  if(self->numThreads > 0 && numTasks > 1) {
+    threadSignalNotify(self->batchStarted);
+  }
+
+  while(true) {
+    mutexLock(self->mutex);
+    taskIndex = _threadPoolTakeTask(self);
+    mutexUnlock(self->mutex);
+    if(taskIndex < 0) {
+      break;
+    }
+    _threadPoolRunTask(self, taskFunc, userData, taskIndex);
+  }
+
+  // Wait for the tasks which were taken by other threads
+  while(true) {
+    signalCount = threadSignalGetCount(self->taskFinished);
+    mutexLock(self->mutex);
+    isFinished = (boolByte)(self->numTasksFinished == self->numTasks);
+    mutexUnlock(self->mutex);
+    if(isFinished) {
+      break;
+    }
+    threadSignalWait(self->taskFinished, signalCount);
+  }
+}
+
+void freeThreadPool(ThreadPool self) {
+  int i;
+
+  if(self == NULL) {
+    return;
+  }
+
+  mutexLock(self->mutex);
+  self->isStopping = true;
+  mutexUnlock(self->mutex);
+  threadSignalNotify(self->batchStarted);
+  for(i = 0; i < self->numThreads; i++) {
+    threadJoin(self->threads[i]);
+    freeThread(self->threads[i]);
+  }
+
+  free(self->threads);
+  freeMutex(self->mutex);
+  freeThreadSignal(self->batchStarted);
+  freeThreadSignal(self->taskFinished);
+  free(self);
+}
@@ -0,0 +1,90 @@
+//
+// ThreadPool.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_ThreadPool_h
+#define MrsWatson_ThreadPool_h
+
+#include "base/Thread.h"
+#include "base/Types.h"
+
+/**
+ * Function which runs one task of a batch
+ * @param userData Data passed to threadPoolRun()
+ * @param taskIndex Index of the task, from 0 to the number of tasks in the batch
+ */
+typedef void (*ThreadPoolTaskFunc)(void* userData, const int taskIndex);
+
+/**
+ * Set of worker threads which run batches of tasks. Tasks are not assigned to
+ * threads up front; whichever thread is idle takes the next task of the batch,
+ * so a thread which finishes a short task moves on to the remaining work. The
+ * thread which runs a batch also takes tasks until the batch is done.
+ */
+typedef struct {
+  int numThreads;
+  Thread* threads;
+  Mutex mutex;
+  // Notified when a batch is started, or when the pool is shutting down
+  ThreadSignal batchStarted;
+  // Notified whenever a task of the current batch has finished
+  ThreadSignal taskFinished;
+
+  // Current batch, only accessed with the mutex held
+  ThreadPoolTaskFunc taskFunc;
+  void* userData;
+  int numTasks;
+  int nextTask;
+  int numTasksFinished;
+  boolByte isStopping;
+} ThreadPoolMembers;
+typedef ThreadPoolMembers* ThreadPool;
+
+/**
+ * Create a new thread pool and start its threads
+ * @param numThreads Number of worker threads. A pool without threads runs all
+ * tasks on the calling thread.
+ * @return New thread pool
+ */
+ThreadPool newThreadPool(const int numThreads);
+
+/**
+ * Run a batch of tasks and wait for all of them to finish. Only one batch may
+ * run at a time.
+ * @param self
+ * @param taskFunc Function called for each task
+ * @param userData Data passed to each call of the task function
+ * @param numTasks Number of tasks in the batch
+ */
+void threadPoolRun(ThreadPool self, ThreadPoolTaskFunc taskFunc, void* userData, const int numTasks);
+
+/**
+ * Stop the pool's threads and free it
+ * @param self
+ */
+void freeThreadPool(ThreadPool self);
+
+#endif
@@ -0,0 +1,293 @@
+//
+// PcmStream.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/PlatformUtilities.h"
+#include "io/PcmStream.h"
+#include "logging/EventLogger.h"
+
+#if UNIX
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#elif WINDOWS
+#include <io.h>
+#endif
+
+// Size of the chunks which the I/O thread moves between the file and the ring buffer
+#define PCM_STREAM_CHUNK_SIZE 16384
+// How often a reading thread checks whether the stream has been stopped while
+// waiting for data from the pipe
+#define PCM_STREAM_POLL_TIMEOUT_MS 50
+
+PcmStreamPolicy pcmStreamPolicyFromString(const char* string) {
+  if(string == NULL) {
+    return kNumPcmStreamPolicies;
+  }
+  else if(!strcmp(string, "wait")) {
+    return kPcmStreamPolicyWait;
+  }
+  else if(!strcmp(string, "realtime")) {
+    return kPcmStreamPolicyRealtime;
+  }
+  else {
+    return kNumPcmStreamPolicies;
+  }
+}
+
+#if UNIX
+// Returns the number of bytes read, 0 at the end of the file or when the
+// stream was stopped, or -1 on error
+static long _pcmStreamReadFile(PcmStream self, byte* data, const size_t numBytes) {
+  const int fileDescriptor = fileno(self->fileHandle);
+  struct pollfd pollDescriptor;
+  ssize_t numRead;
+  int result;
+
+  pollDescriptor.fd = fileDescriptor;
+  pollDescriptor.events = POLLIN;
+  while(!byteRingBufferIsClosed(self->ringBuffer)) {
+    // Waiting with a timeout means that the thread can notice when the stream
+    // is stopped before the pipe reaches its end
+    result = poll(&pollDescriptor, 1, PCM_STREAM_POLL_TIMEOUT_MS);
+    if(result < 0 && errno != EINTR) {
+      return -1;
+    }
+    else if(result > 0) {
+      numRead = read(fileDescriptor, data, numBytes);
+      if(numRead >= 0) {
+        return (long)numRead;
+      }
+      else if(errno != EINTR && errno != EAGAIN) {
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+#elif WINDOWS
+static long _pcmStreamReadFile(PcmStream self, byte* data, const size_t numBytes) {
+  HANDLE fileHandle = (HANDLE)_get_osfhandle(_fileno(self->fileHandle));
+  DWORD numRead = 0;
+
+  if(!ReadFile(fileHandle, data, (DWORD)numBytes, &numRead, NULL)) {
+    // A broken pipe is the normal end of the stream, and an aborted operation
+    // means that the stream was stopped
+    if(GetLastError() == ERROR_BROKEN_PIPE || GetLastError() == ERROR_OPERATION_ABORTED) {
+      return 0;
+    }
+    return -1;
+  }
+  return (long)numRead;
+}
+#endif
+
+static void* _pcmStreamReadThread(void* pcmStreamPtr) {
+  PcmStream self = (PcmStream)pcmStreamPtr;
+  long numRead;
+
+  while(true) {
+#if UNIX || WINDOWS
+    numRead = _pcmStreamReadFile(self, self->threadBuffer, PCM_STREAM_CHUNK_SIZE);
+#else
+    numRead = (long)fread(self->threadBuffer, 1, PCM_STREAM_CHUNK_SIZE, self->fileHandle);
+#endif
+    if(numRead < 0) {
+      self->hasFailed = true;
+      break;
+    }
+    else if(numRead == 0) {
+      break;
+    }
+    if(byteRingBufferWriteBlocking(self->ringBuffer, self->threadBuffer, (size_t)numRead) < (size_t)numRead) {
+      break;
+    }
+  }
+
+  byteRingBufferClose(self->ringBuffer);
+  return NULL;
+}
+
+static void* _pcmStreamWriteThread(void* pcmStreamPtr) {
+  PcmStream self = (PcmStream)pcmStreamPtr;
+  size_t numRead;
+
+  // The ring buffer is closed by pcmStreamStop(), after which any remaining
+  // data is still read here until the buffer is empty
+  while((numRead = byteRingBufferReadAvailable(self->ringBuffer, self->threadBuffer, PCM_STREAM_CHUNK_SIZE)) > 0) {
+    if(fwrite(self->threadBuffer, 1, numRead, self->fileHandle) < numRead || fflush(self->fileHandle) != 0) {
+      self->hasFailed = true;
+      byteRingBufferClose(self->ringBuffer);
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+PcmStream newPcmStream(FILE* fileHandle, const SampleSourceOpenAs openedAs,
+  const unsigned long bufferSizeInBytes, const PcmStreamPolicy policy) {
+  PcmStream pcmStream;
+
+  if(fileHandle == NULL) {
+    logInternalError("Cannot create stream without a file");
+    return NULL;
+  }
+  if(openedAs != SAMPLE_SOURCE_OPEN_READ && openedAs != SAMPLE_SOURCE_OPEN_WRITE) {
+    logInternalError("Invalid type for openedAs in PCM stream");
+    return NULL;
+  }
+  if(bufferSizeInBytes == 0 || policy >= kNumPcmStreamPolicies) {
+    logError("Invalid stream buffer size or policy");
+    return NULL;
+  }
+
+  pcmStream = (PcmStream)malloc(sizeof(PcmStreamMembers));
+  pcmStream->fileHandle = fileHandle;
+  pcmStream->openedAs = openedAs;
+  pcmStream->policy = policy;
+  pcmStream->ringBuffer = newByteRingBuffer(bufferSizeInBytes);
+  pcmStream->thread = newThread(openedAs == SAMPLE_SOURCE_OPEN_READ ? _pcmStreamReadThread : _pcmStreamWriteThread,
+    pcmStream);
+  pcmStream->threadBuffer = (byte*)malloc(PCM_STREAM_CHUNK_SIZE);
+  pcmStream->isStarted = false;
+  pcmStream->isPrimed = false;
+  pcmStream->hasFailed = false;
+  pcmStream->numUnderruns = 0;
+  pcmStream->numOverruns = 0;
+
+  return pcmStream;
+}
+
+boolByte pcmStreamStart(PcmStream self) {
+  if(self->isStarted) {
+    return true;
+  }
+  if(!threadStart(self->thread)) {
+    logError("Could not start %s thread for stream",
+      self->openedAs == SAMPLE_SOURCE_OPEN_READ ? "reader" : "writer");
+    return false;
+  }
+  logDebug("Started stream with %lu byte buffer", self->ringBuffer->capacity);
+  self->isStarted = true;
+  return true;
+}
+
+size_t pcmStreamRead(PcmStream self, byte* data, const size_t numBytes, const size_t frameSize) {
+  size_t numRead;
+  unsigned long numReadable;
+
+  if(self->policy == kPcmStreamPolicyWait) {
+    return byteRingBufferReadBlocking(self->ringBuffer, data, numBytes);
+  }
+
+  // Let the buffer fill up before starting, so that it can absorb jitter in
+  // both directions
+  if(!self->isPrimed) {
+    byteRingBufferWaitForReadable(self->ringBuffer, self->ringBuffer->capacity / 2);
+    self->isPrimed = true;
+  }
+
+  numReadable = byteRingBufferGetNumReadable(self->ringBuffer);
+  if(numReadable >= numBytes || byteRingBufferIsClosed(self->ringBuffer)) {
+    // Either enough data has arrived, or this is the end of the stream
+    return byteRingBufferReadBlocking(self->ringBuffer, data, numBytes);
+  }
+
+  // Underrun, play whatever complete frames are there and fill up the rest
+  // with silence instead of waiting
+  numRead = byteRingBufferRead(self->ringBuffer, data, (size_t)(numReadable - numReadable % frameSize));
+  memset(data + numRead, 0, numBytes - numRead);
+  self->numUnderruns++;
+  return numBytes;
+}
+
+size_t pcmStreamWrite(PcmStream self, const byte* data, const size_t numBytes) {
+  if(self->hasFailed) {
+    return 0;
+  }
+  if(self->policy == kPcmStreamPolicyWait) {
+    return byteRingBufferWriteBlocking(self->ringBuffer, data, numBytes);
+  }
+
+  // Overrun, drop the entire block rather than writing part of it, which keeps
+  // the output aligned to frames
+  if(byteRingBufferGetNumWritable(self->ringBuffer) < numBytes) {
+    self->numOverruns++;
+    return 0;
+  }
+  return byteRingBufferWrite(self->ringBuffer, data, numBytes);
+}
+
+boolByte pcmStreamStop(PcmStream self) {
+  if(!self->isStarted) {
+    return true;
+  }
+
+  byteRingBufferClose(self->ringBuffer);
+#if WINDOWS
+  if(self->openedAs == SAMPLE_SOURCE_OPEN_READ) {
+    typedef BOOL (WINAPI *CancelSynchronousIoFuncPtr)(HANDLE);
+    CancelSynchronousIoFuncPtr cancelSynchronousIoFunc = NULL;
+
+    // A reader thread may be blocked in ReadFile() until the pipe delivers more
+    // data. This function only exists on Vista and newer, so it is looked up first.
+    cancelSynchronousIoFunc = (CancelSynchronousIoFuncPtr)GetProcAddress(GetModuleHandle(TEXT("kernel32")),
+      "CancelSynchronousIo");
+    if(cancelSynchronousIoFunc != NULL) {
+      cancelSynchronousIoFunc(self->thread->handle);
+    }
+  }
+#endif
+  threadJoin(self->thread);
+  self->isStarted = false;
+
+  if(self->numUnderruns > 0) {
+    logWarn("Stream ran out of input data %lu times, missing frames were replaced by silence", self->numUnderruns);
+  }
+  if(self->numOverruns > 0) {
+    logWarn("Stream output buffer was full %lu times, blocks were dropped", self->numOverruns);
+  }
+  if(self->hasFailed) {
+    logError("Could not %s stream", self->openedAs == SAMPLE_SOURCE_OPEN_READ ? "read from" : "write to");
+    return false;
+  }
+  return true;
+}
+
+void freePcmStream(PcmStream self) {
+  if(self == NULL) {
+    return;
+  }
+  pcmStreamStop(self);
+  freeThread(self->thread);
+  freeByteRingBuffer(self->ringBuffer);
+  free(self->threadBuffer);
+  free(self);
+}
@@ -0,0 +1,144 @@
+//
+// PcmStream.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PcmStream_h
+#define MrsWatson_PcmStream_h
+
+#include <stdio.h>
+
+#include "base/ByteRingBuffer.h"
+#include "base/Thread.h"
+#include "io/SampleSource.h"
+
+/**
+ * What to do when the data in a stream does not arrive in time (an underrun),
+ * or when the data written to a stream cannot be consumed fast enough (an
+ * overrun).
+ */
+typedef enum {
+  // Wait for the other side of the stream, so that no data is ever lost. This
+  // gives exactly the same results as reading or writing the file directly.
+  kPcmStreamPolicyWait,
+  // Never wait once the stream has been started. Missing input is replaced by
+  // silence, and output which does not fit into the buffer is dropped.
+  kPcmStreamPolicyRealtime,
+  kNumPcmStreamPolicies
+} PcmStreamPolicy;
+
+/**
+ * Reads raw PCM data from a pipe or writes it to one on a separate thread. The
+ * I/O thread and the caller exchange data through a lock-free ring buffer, so
+ * that processing is not stalled by the pipe, as long as the buffer is large
+ * enough to absorb any jitter on the other end.
+ */
+typedef struct {
+  FILE* fileHandle;
+  SampleSourceOpenAs openedAs;
+  PcmStreamPolicy policy;
+  ByteRingBuffer ringBuffer;
+  Thread thread;
+  byte* threadBuffer;
+  boolByte isStarted;
+  boolByte isPrimed;
+  // Set by the I/O thread if reading or writing failed
+  volatile int hasFailed;
+  unsigned long numUnderruns;
+  unsigned long numOverruns;
+} PcmStreamMembers;
+typedef PcmStreamMembers* PcmStream;
+
+/**
+ * Parse a stream policy given by the user, either "wait" or "realtime"
+ * @param string String to parse
+ * @return Parsed policy, or kNumPcmStreamPolicies if the string is invalid
+ */
+PcmStreamPolicy pcmStreamPolicyFromString(const char* string);
+
+/**
+ * Create a new stream. The I/O thread is not started until pcmStreamStart()
+ * is called.
+ * @param fileHandle Open file to read from or write to, which is not closed by
+ * the stream
+ * @param openedAs Whether the stream is read or written
+ * @param bufferSizeInBytes Size of the ring buffer, which will be rounded up to
+ * the next power of two
+ * @param policy Underrun and overrun policy
+ * @return New stream, or NULL if the arguments are invalid
+ */
+PcmStream newPcmStream(FILE* fileHandle, const SampleSourceOpenAs openedAs,
+  const unsigned long bufferSizeInBytes, const PcmStreamPolicy policy);
+
+/**
+ * Start the I/O thread
+ * @param self
+ * @return True if the thread was started
+ */
+boolByte pcmStreamStart(PcmStream self);
+
+/**
+ * Read data from a stream opened for reading. With the wait policy, this
+ * blocks until numBytes bytes have been read. With the realtime policy, the
+ * first read waits until the ring buffer is half full, and subsequent reads
+ * fill any missing frames with zeroes.
+ * @param self
+ * @param data Buffer to read into
+ * @param numBytes Number of bytes to read
+ * @param frameSize Size of one frame in bytes, so that partial frames are not
+ * mixed with silence
+ * @return Number of bytes read, which is less than numBytes only at the end of
+ * the stream
+ */
+size_t pcmStreamRead(PcmStream self, byte* data, const size_t numBytes, const size_t frameSize);
+
+/**
+ * Write data to a stream opened for writing. With the wait policy, this blocks
+ * until all data fits into the ring buffer. With the realtime policy, data
+ * which does not fit is dropped.
+ * @param self
+ * @param data Data to write
+ * @param numBytes Number of bytes to write
+ * @return Number of bytes accepted, which is 0 if the block was dropped. Less
+ * than numBytes are otherwise only accepted if writing to the file failed, in
+ * which case hasFailed is set.
+ */
+size_t pcmStreamWrite(PcmStream self, const byte* data, const size_t numBytes);
+
+/**
+ * Stop the I/O thread. For an output stream, all buffered data is written to
+ * the file before this returns.
+ * @param self
+ * @return False if the I/O thread failed to read or write the file
+ */
+boolByte pcmStreamStop(PcmStream self);
+
+/**
+ * Free a stream, stopping it first if necessary
+ * @param self
+ */
+void freePcmStream(PcmStream self);
+
+#endif
@@ -28,6 +28,7 @@
 #ifndef MrsWatson_SampleSource_h
 #define MrsWatson_SampleSource_h
 
+#include "app/MrsWatsonContext.h"
 #include "audio/SampleBuffer.h"
 #include "base/CharString.h"
 #include "base/Types.h"
@@ -67,6 +68,12 @@ typedef struct {
   SampleSourceOpenAs openedAs;
   CharString sourceName;
   unsigned long numSamplesProcessed;
+  // Size of the audio data which has been read or written, for sources which
+  // store uncompressed samples
+  unsigned long long numBytesProcessed;
+  // Context which the source was created in, which is used when the source
+  // does its I/O from another thread
+  MrsWatsonContext context;
 
   OpenSampleSourceFunc openSampleSource;
   ReadSampleBlockFunc readSampleBlock;
@@ -99,15 +99,18 @@ static boolByte _readBlockFromAiffFile(void* sampleSourcePtr, SampleBuffer sampl
   int originalBlocksize = sampleBuffer->blocksize;
   size_t samplesRead = sampleSourcePcmRead(extraData, sampleBuffer);
   sampleSource->numSamplesProcessed += samplesRead;
+  sampleSource->numBytesProcessed += samplesRead * sampleFormatGetBytesPerSample(extraData->sampleFormat);
   return (originalBlocksize == sampleBuffer->blocksize);
 }
 
 static boolByte _writeBlockToAiffFile(void* sampleSourcePtr, const SampleBuffer sampleBuffer) {
   SampleSource sampleSource = (SampleSource)sampleSourcePtr;
   SampleSourcePcmData extraData = (SampleSourcePcmData)(sampleSource->extraData);
-  int samplesWritten = (int)sampleSourcePcmWrite(extraData, sampleBuffer);
+  size_t samplesWritten;
+  boolByte result = sampleSourcePcmWrite(extraData, sampleBuffer, &samplesWritten);
   sampleSource->numSamplesProcessed += samplesWritten;
-  return (samplesWritten == sampleBuffer->blocksize);
+  sampleSource->numBytesProcessed += samplesWritten * sampleFormatGetBytesPerSample(extraData->sampleFormat);
+  return result;
 }
 
 SampleSource newSampleSourceAiff(const CharString sampleSourceName) {
@@ -123,6 +126,8 @@ SampleSource newSampleSourceAiff(const CharString sampleSourceName) {
   sampleSource->sourceName = newCharString();
   charStringCopy(sampleSource->sourceName, sampleSourceName);
   sampleSource->numSamplesProcessed = 0;
+  sampleSource->numBytesProcessed = 0;
+  sampleSource->context = getMrsWatsonContext();
 
   sampleSource->openSampleSource = _openSampleSourceAiff;
 #if HAVE_LIBAUDIOFILE
@@ -148,10 +153,16 @@ SampleSource newSampleSourceAiff(const CharString sampleSourceName) {
   extraData->fileHandle = NULL;
   extraData->dataBufferNumItems = 0;
   extraData->interlacedPcmDataBuffer = NULL;
+  extraData->mappedFile = NULL;
+  extraData->mappedDataPosition = 0;
+  extraData->mappedDataEnd = 0;
+  extraData->stream = NULL;
+  extraData->streamBufferSizeInMs = 0;
+  extraData->streamPolicy = kPcmStreamPolicyWait;
 
   extraData->numChannels = (unsigned short)getNumChannels();
   extraData->sampleRate = (unsigned int)getSampleRate();
-  extraData->bitsPerSample = 16;
+  extraData->sampleFormat = kSampleFormatInt16;
 #endif
 
   sampleSource->extraData = extraData;
@@ -0,0 +1,295 @@
+//
+// SampleSourceAsync.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "io/SampleSourceAsync.h"
+#include "logging/EventLogger.h"
+
+static boolByte _openSampleSourceAsync(void* sampleSourcePtr, const SampleSourceOpenAs openAs) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourceAsyncData extraData = (SampleSourceAsyncData)sampleSource->extraData;
+  SampleSource source = extraData->source;
+
+  if(source->openedAs == SAMPLE_SOURCE_OPEN_NOT_OPENED) {
+    if(!source->openSampleSource(source, openAs)) {
+      return false;
+    }
+  }
+  else if(source->openedAs != openAs) {
+    logInternalError("Wrapped sample source was opened with a different mode");
+    return false;
+  }
+
+  // Some sources rename themselves when opened (ie, '-' becomes 'stdin')
+  charStringCopy(sampleSource->sourceName, source->sourceName);
+  sampleSource->openedAs = openAs;
+  return true;
+}
+
+static void* _sampleSourceAsyncReadThread(void* extraDataPtr) {
+  SampleSourceAsyncData extraData = (SampleSourceAsyncData)extraDataPtr;
+  SampleSource source = extraData->source;
+  SampleSourceAsyncBlock block;
+  unsigned long blocksize = 0;
+
+  setThreadMrsWatsonContext(source->context);
+  while(true) {
+    block = (SampleSourceAsyncBlock)ringBufferPopBlocking(extraData->emptyBlocks);
+    if(block == extraData->stopBlock) {
+      break;
+    }
+    // The source shortens the buffer for the final block, so restore it here
+    if(blocksize == 0) {
+      blocksize = block->buffer->blocksize;
+    }
+    block->buffer->blocksize = blocksize;
+    block->result = source->readSampleBlock(source, block->buffer);
+    block->numSamplesProcessed = source->numSamplesProcessed;
+    block->numBytesProcessed = source->numBytesProcessed;
+    ringBufferPushBlocking(extraData->filledBlocks, block);
+    if(!block->result) {
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+static void* _sampleSourceAsyncWriteThread(void* extraDataPtr) {
+  SampleSourceAsyncData extraData = (SampleSourceAsyncData)extraDataPtr;
+  SampleSource source = extraData->source;
+  SampleSourceAsyncBlock block;
+
+  setThreadMrsWatsonContext(source->context);
+  while(true) {
+    block = (SampleSourceAsyncBlock)ringBufferPopBlocking(extraData->filledBlocks);
+    if(block == extraData->stopBlock) {
+      break;
+    }
+    if(!source->writeSampleBlock(source, block->buffer)) {
+      extraData->hasFailed = true;
+    }
+    ringBufferPushBlocking(extraData->emptyBlocks, block);
+  }
+
+  return NULL;
+}
+
+static boolByte _startSampleSourceAsync(SampleSourceAsyncData extraData, const SampleBuffer sampleBuffer, ThreadFunc threadFunc) {
+  int i;
+
+  extraData->blocks = (SampleSourceAsyncBlock*)malloc(sizeof(SampleSourceAsyncBlock) * extraData->numBlocks);
+  for(i = 0; i < extraData->numBlocks; i++) {
+    extraData->blocks[i] = (SampleSourceAsyncBlock)malloc(sizeof(SampleSourceAsyncBlockMembers));
+    extraData->blocks[i]->buffer = newSampleBuffer(sampleBuffer->numChannels, sampleBuffer->blocksize);
+    extraData->blocks[i]->result = true;
+    extraData->blocks[i]->numSamplesProcessed = 0;
+    extraData->blocks[i]->numBytesProcessed = 0;
+    ringBufferPush(extraData->emptyBlocks, extraData->blocks[i]);
+  }
+
+  extraData->thread = newThread(threadFunc, extraData);
+  if(!threadStart(extraData->thread)) {
+    logError("Could not start I/O thread for '%s'", extraData->source->sourceName->data);
+    return false;
+  }
+
+  extraData->isStarted = true;
+  return true;
+}
+
+static boolByte _readBlockFromSampleSourceAsync(void* sampleSourcePtr, SampleBuffer sampleBuffer) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourceAsyncData extraData = (SampleSourceAsyncData)sampleSource->extraData;
+  SampleSourceAsyncBlock block;
+
+  if(!extraData->isStarted) {
+    // If the thread could not be started, then fall back to synchronous I/O
+    if(extraData->hasFailed) {
+      return extraData->source->readSampleBlock(extraData->source, sampleBuffer);
+    }
+    if(!_startSampleSourceAsync(extraData, sampleBuffer, _sampleSourceAsyncReadThread)) {
+      extraData->hasFailed = true;
+      return extraData->source->readSampleBlock(extraData->source, sampleBuffer);
+    }
+  }
+
+  // Once the final block has been read, the thread is finished
+  if(extraData->currentBlock != NULL && !extraData->currentBlock->result) {
+    sampleBufferClear(sampleBuffer);
+    return false;
+  }
+  if(extraData->currentBlock != NULL) {
+    ringBufferPushBlocking(extraData->emptyBlocks, extraData->currentBlock);
+  }
+
+  block = (SampleSourceAsyncBlock)ringBufferPopBlocking(extraData->filledBlocks);
+  sampleBuffer->blocksize = block->buffer->blocksize;
+  sampleBufferCopy(sampleBuffer, block->buffer);
+  sampleSource->numSamplesProcessed = block->numSamplesProcessed;
+  sampleSource->numBytesProcessed = block->numBytesProcessed;
+
+  // Keep the block until the next read, since returning it to the I/O thread
+  // right away would let it read past the end of the source.
+  extraData->currentBlock = block;
+  return block->result;
+}
+
+static boolByte _writeBlockToSampleSourceAsync(void* sampleSourcePtr, const SampleBuffer sampleBuffer) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourceAsyncData extraData = (SampleSourceAsyncData)sampleSource->extraData;
+  SampleSourceAsyncBlock block;
+
+  if(!extraData->isStarted) {
+    if(extraData->hasFailed) {
+      return extraData->source->writeSampleBlock(extraData->source, sampleBuffer);
+    }
+    if(!_startSampleSourceAsync(extraData, sampleBuffer, _sampleSourceAsyncWriteThread)) {
+      extraData->hasFailed = true;
+      return extraData->source->writeSampleBlock(extraData->source, sampleBuffer);
+    }
+  }
+
+  block = (SampleSourceAsyncBlock)ringBufferPopBlocking(extraData->emptyBlocks);
+  if(block->buffer->numChannels != sampleBuffer->numChannels) {
+    sampleBufferResize(block->buffer, sampleBuffer->numChannels, false);
+  }
+  block->buffer->blocksize = sampleBuffer->blocksize;
+  sampleBufferCopy(block->buffer, sampleBuffer);
+  ringBufferPushBlocking(extraData->filledBlocks, block);
+
+  // Errors are reported for the block after the one which failed
+  return (boolByte)!extraData->hasFailed;
+}
+
+static void _stopSampleSourceAsync(SampleSource sampleSource) {
+  SampleSourceAsyncData extraData = (SampleSourceAsyncData)sampleSource->extraData;
+
+  if(!extraData->isStarted) {
+    return;
+  }
+
+  // When writing, the stop marker is queued behind all remaining blocks. When
+  // reading, the thread will either pick up the marker or has already exited
+  // after reaching the end of the source.
+  if(sampleSource->openedAs == SAMPLE_SOURCE_OPEN_WRITE) {
+    ringBufferPushBlocking(extraData->filledBlocks, extraData->stopBlock);
+  }
+  else {
+    ringBufferPushBlocking(extraData->emptyBlocks, extraData->stopBlock);
+  }
+  threadJoin(extraData->thread);
+  extraData->isStarted = false;
+  sampleSource->numSamplesProcessed = extraData->source->numSamplesProcessed;
+  sampleSource->numBytesProcessed = extraData->source->numBytesProcessed;
+}
+
+static void _closeSampleSourceAsync(void* sampleSourcePtr) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourceAsyncData extraData = (SampleSourceAsyncData)sampleSource->extraData;
+
+  _stopSampleSourceAsync(sampleSource);
+  extraData->source->closeSampleSource(extraData->source);
+}
+
+static void _freeSampleSourceDataAsync(void* sampleSourceDataPtr) {
+  SampleSourceAsyncData extraData = (SampleSourceAsyncData)sampleSourceDataPtr;
+  int i;
+
+  if(extraData->isStarted) {
+    logInternalError("Async sample source was freed without being closed");
+    return;
+  }
+
+  if(extraData->blocks != NULL) {
+    for(i = 0; i < extraData->numBlocks; i++) {
+      freeSampleBuffer(extraData->blocks[i]->buffer);
+      free(extraData->blocks[i]);
+    }
+    free(extraData->blocks);
+  }
+  free(extraData->stopBlock);
+  freeThread(extraData->thread);
+  freeRingBuffer(extraData->emptyBlocks);
+  freeRingBuffer(extraData->filledBlocks);
+  freeSampleSource(extraData->source);
+  free(extraData);
+}
+
+SampleSource newSampleSourceAsync(SampleSource source, const int queueDepth) {
+  SampleSource sampleSource;
+  SampleSourceAsyncData extraData;
+
+  if(source == NULL) {
+    return NULL;
+  }
+  if(queueDepth <= 0) {
+    logError("Invalid I/O queue depth %d", queueDepth);
+    return NULL;
+  }
+
+  sampleSource = (SampleSource)malloc(sizeof(SampleSourceMembers));
+  extraData = (SampleSourceAsyncData)malloc(sizeof(SampleSourceAsyncDataMembers));
+
+  // Keep the type of the wrapped source, since callers may depend on it
+  sampleSource->sampleSourceType = source->sampleSourceType;
+  sampleSource->openedAs = source->openedAs;
+  sampleSource->sourceName = newCharString();
+  charStringCopy(sampleSource->sourceName, source->sourceName);
+  sampleSource->numSamplesProcessed = source->numSamplesProcessed;
+  sampleSource->numBytesProcessed = source->numBytesProcessed;
+  sampleSource->context = source->context;
+
+  sampleSource->openSampleSource = _openSampleSourceAsync;
+  sampleSource->readSampleBlock = _readBlockFromSampleSourceAsync;
+  sampleSource->writeSampleBlock = _writeBlockToSampleSourceAsync;
+  sampleSource->closeSampleSource = _closeSampleSourceAsync;
+  sampleSource->freeSampleSourceData = _freeSampleSourceDataAsync;
+
+  extraData->source = source;
+  extraData->queueDepth = queueDepth;
+  // One extra block is held by the caller (when reading) or the I/O thread
+  // (when writing), and the queues must also fit the stop marker.
+  extraData->numBlocks = queueDepth + 1;
+  extraData->thread = NULL;
+  extraData->isStarted = false;
+  extraData->hasFailed = false;
+  extraData->blocks = NULL;
+  extraData->emptyBlocks = newRingBuffer((unsigned long)extraData->numBlocks + 1);
+  extraData->filledBlocks = newRingBuffer((unsigned long)extraData->numBlocks + 1);
+  extraData->stopBlock = (SampleSourceAsyncBlock)malloc(sizeof(SampleSourceAsyncBlockMembers));
+  extraData->stopBlock->buffer = NULL;
+  extraData->stopBlock->result = false;
+  extraData->stopBlock->numSamplesProcessed = 0;
+  extraData->stopBlock->numBytesProcessed = 0;
+  extraData->currentBlock = NULL;
+  sampleSource->extraData = extraData;
+
+  return sampleSource;
+}
@@ -0,0 +1,77 @@
+//
+// SampleSourceAsync.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_SampleSourceAsync_h
+#define MrsWatson_SampleSourceAsync_h
+
+#include "base/RingBuffer.h"
+#include "base/Thread.h"
+#include "io/SampleSource.h"
+
+typedef struct {
+  SampleBuffer buffer;
+  boolByte result;
+  // Copied from the wrapped source, which must not be read while the I/O
+  // thread is running
+  unsigned long numSamplesProcessed;
+  unsigned long long numBytesProcessed;
+} SampleSourceAsyncBlockMembers;
+typedef SampleSourceAsyncBlockMembers* SampleSourceAsyncBlock;
+
+typedef struct {
+  SampleSource source;
+  int queueDepth;
+  int numBlocks;
+  Thread thread;
+  boolByte isStarted;
+  boolByte hasFailed;
+
+  // Blocks are allocated on the first read or write, since only then are the
+  // channel count and blocksize known. When reading, the I/O thread consumes
+  // emptyBlocks and produces filledBlocks, and when writing it is the opposite.
+  SampleSourceAsyncBlock* blocks;
+  RingBuffer emptyBlocks;
+  RingBuffer filledBlocks;
+  SampleSourceAsyncBlock stopBlock;
+  SampleSourceAsyncBlock currentBlock;
+} SampleSourceAsyncDataMembers;
+typedef SampleSourceAsyncDataMembers* SampleSourceAsyncData;
+
+/**
+ * Wrap a sample source so that reading or writing is done on a separate thread.
+ * When reading, up to queueDepth blocks are read ahead of the caller, and when
+ * writing, up to queueDepth blocks are queued before the caller must wait. The
+ * wrapped source may already be opened, otherwise it is opened along with the
+ * new source.
+ * @param source Sample source to wrap. The new source takes ownership of it,
+ * so it will be freed along with the new source.
+ * @param queueDepth Number of blocks to keep in flight
+ * @return New sample source, or NULL if queueDepth is invalid
+ */
+SampleSource newSampleSourceAsync(SampleSource source, const int queueDepth);
+
+#endif
@@ -0,0 +1,230 @@
+//
+// SampleSourceBuffered.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "io/SampleSourceBuffered.h"
+#include "logging/EventLogger.h"
+
+static boolByte _openSampleSourceBuffered(void* sampleSourcePtr, const SampleSourceOpenAs openAs) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourceBufferedData extraData = (SampleSourceBufferedData)sampleSource->extraData;
+  SampleSource source = extraData->source;
+
+  if(source->openedAs == SAMPLE_SOURCE_OPEN_NOT_OPENED) {
+    if(!source->openSampleSource(source, openAs)) {
+      return false;
+    }
+  }
+  else if(source->openedAs != openAs) {
+    logInternalError("Wrapped sample source was opened with a different mode");
+    return false;
+  }
+
+  // Some sources rename themselves when opened (ie, '-' becomes 'stdin')
+  charStringCopy(sampleSource->sourceName, source->sourceName);
+  sampleSource->openedAs = openAs;
+  return true;
+}
+
+// The wrapped source is ahead of the caller, so the number of bytes processed
+// is estimated from the samples which the caller has read or written.
+static void _updateSampleSourceBufferedCounts(SampleSource sampleSource, const unsigned long numSamples) {
+  SampleSourceBufferedData extraData = (SampleSourceBufferedData)sampleSource->extraData;
+  SampleSource source = extraData->source;
+
+  sampleSource->numSamplesProcessed += numSamples;
+  if(source->numSamplesProcessed > 0) {
+    sampleSource->numBytesProcessed = sampleSource->numSamplesProcessed *
+      (source->numBytesProcessed / source->numSamplesProcessed);
+  }
+}
+
+static boolByte _readBlockFromSampleSourceBuffered(void* sampleSourcePtr, SampleBuffer sampleBuffer) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourceBufferedData extraData = (SampleSourceBufferedData)sampleSource->extraData;
+  SampleBuffer chunk;
+  unsigned long numFramesRead = 0;
+  unsigned long numFrames;
+  unsigned int i;
+  boolByte result;
+
+  if(extraData->chunk == NULL) {
+    extraData->chunk = newSampleBuffer(sampleBuffer->numChannels, extraData->ioBlocksize);
+    if(extraData->chunk == NULL) {
+      return false;
+    }
+    extraData->chunk->blocksize = 0;
+  }
+  chunk = extraData->chunk;
+
+  while(numFramesRead < sampleBuffer->blocksize) {
+    if(extraData->chunkPosition == chunk->blocksize) {
+      if(!extraData->hasMoreChunks) {
+        break;
+      }
+      // The source shortens the chunk for the final block, so restore it here
+      chunk->blocksize = extraData->ioBlocksize;
+      extraData->hasMoreChunks = extraData->source->readSampleBlock(extraData->source, chunk);
+      extraData->chunkPosition = 0;
+      continue;
+    }
+
+    numFrames = sampleBuffer->blocksize - numFramesRead;
+    if(numFrames > chunk->blocksize - extraData->chunkPosition) {
+      numFrames = chunk->blocksize - extraData->chunkPosition;
+    }
+    // Channels are repeated if the caller has more of them, as in sampleBufferCopy()
+    for(i = 0; i < sampleBuffer->numChannels; i++) {
+      memcpy(sampleBuffer->samples[i] + numFramesRead,
+        chunk->samples[i % chunk->numChannels] + extraData->chunkPosition, sizeof(Sample) * numFrames);
+    }
+    extraData->chunkPosition += numFrames;
+    numFramesRead += numFrames;
+  }
+
+  _updateSampleSourceBufferedCounts(sampleSource, numFramesRead * sampleBuffer->numChannels);
+  // Like other sources, the buffer is shortened for the final block
+  result = (boolByte)(numFramesRead == sampleBuffer->blocksize);
+  sampleBuffer->blocksize = numFramesRead;
+  return result;
+}
+
+static boolByte _flushSampleSourceBuffered(SampleSourceBufferedData extraData) {
+  boolByte result = true;
+
+  if(extraData->chunk != NULL && extraData->chunkPosition > 0) {
+    extraData->chunk->blocksize = extraData->chunkPosition;
+    result = extraData->source->writeSampleBlock(extraData->source, extraData->chunk);
+    extraData->chunkPosition = 0;
+  }
+  return result;
+}
+
+static boolByte _writeBlockToSampleSourceBuffered(void* sampleSourcePtr, const SampleBuffer sampleBuffer) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourceBufferedData extraData = (SampleSourceBufferedData)sampleSource->extraData;
+  unsigned long numFramesWritten = 0;
+  unsigned long numFrames;
+  unsigned int i;
+  boolByte result = true;
+
+  if(extraData->chunk == NULL) {
+    extraData->chunk = newSampleBuffer(sampleBuffer->numChannels, extraData->ioBlocksize);
+    if(extraData->chunk == NULL) {
+      return false;
+    }
+  }
+  else if(extraData->chunk->numChannels != sampleBuffer->numChannels) {
+    // Blocks with different channel counts cannot share a chunk
+    result = _flushSampleSourceBuffered(extraData);
+    sampleBufferResize(extraData->chunk, sampleBuffer->numChannels, false);
+  }
+
+  while(numFramesWritten < sampleBuffer->blocksize) {
+    numFrames = sampleBuffer->blocksize - numFramesWritten;
+    if(numFrames > extraData->ioBlocksize - extraData->chunkPosition) {
+      numFrames = extraData->ioBlocksize - extraData->chunkPosition;
+    }
+    for(i = 0; i < sampleBuffer->numChannels; i++) {
+      memcpy(extraData->chunk->samples[i] + extraData->chunkPosition,
+        sampleBuffer->samples[i] + numFramesWritten, sizeof(Sample) * numFrames);
+    }
+    extraData->chunkPosition += numFrames;
+    numFramesWritten += numFrames;
+
+    // Errors are reported for the block which filled up the chunk
+    if(extraData->chunkPosition == extraData->ioBlocksize && !_flushSampleSourceBuffered(extraData)) {
+      result = false;
+    }
+  }
+
+  _updateSampleSourceBufferedCounts(sampleSource, sampleBuffer->blocksize * sampleBuffer->numChannels);
+  return result;
+}
+
+static void _closeSampleSourceBuffered(void* sampleSourcePtr) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourceBufferedData extraData = (SampleSourceBufferedData)sampleSource->extraData;
+
+  if(sampleSource->openedAs == SAMPLE_SOURCE_OPEN_WRITE && !_flushSampleSourceBuffered(extraData)) {
+    logError("Could not write final block to '%s'", sampleSource->sourceName->data);
+  }
+  sampleSource->numSamplesProcessed = extraData->source->numSamplesProcessed;
+  sampleSource->numBytesProcessed = extraData->source->numBytesProcessed;
+  extraData->source->closeSampleSource(extraData->source);
+}
+
+static void _freeSampleSourceDataBuffered(void* sampleSourceDataPtr) {
+  SampleSourceBufferedData extraData = (SampleSourceBufferedData)sampleSourceDataPtr;
+
+  freeSampleBuffer(extraData->chunk);
+  freeSampleSource(extraData->source);
+  free(extraData);
+}
+
+SampleSource newSampleSourceBuffered(SampleSource source, const unsigned long ioBlocksize) {
+  SampleSource sampleSource;
+  SampleSourceBufferedData extraData;
+
+  if(source == NULL) {
+    return NULL;
+  }
+  if(ioBlocksize == 0) {
+    logError("Invalid I/O blocksize %ld", ioBlocksize);
+    return NULL;
+  }
+
+  sampleSource = (SampleSource)malloc(sizeof(SampleSourceMembers));
+  extraData = (SampleSourceBufferedData)malloc(sizeof(SampleSourceBufferedDataMembers));
+
+  // Keep the type of the wrapped source, since callers may depend on it
+  sampleSource->sampleSourceType = source->sampleSourceType;
+  sampleSource->openedAs = source->openedAs;
+  sampleSource->sourceName = newCharString();
+  charStringCopy(sampleSource->sourceName, source->sourceName);
+  sampleSource->numSamplesProcessed = source->numSamplesProcessed;
+  sampleSource->numBytesProcessed = source->numBytesProcessed;
+  sampleSource->context = source->context;
+
+  sampleSource->openSampleSource = _openSampleSourceBuffered;
+  sampleSource->readSampleBlock = _readBlockFromSampleSourceBuffered;
+  sampleSource->writeSampleBlock = _writeBlockToSampleSourceBuffered;
+  sampleSource->closeSampleSource = _closeSampleSourceBuffered;
+  sampleSource->freeSampleSourceData = _freeSampleSourceDataBuffered;
+
+  extraData->source = source;
+  extraData->ioBlocksize = ioBlocksize;
+  extraData->chunk = NULL;
+  extraData->chunkPosition = 0;
+  extraData->hasMoreChunks = true;
+  sampleSource->extraData = extraData;
+
+  return sampleSource;
+}
@@ -0,0 +1,60 @@
+//
+// SampleSourceBuffered.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_SampleSourceBuffered_h
+#define MrsWatson_SampleSourceBuffered_h
+
+#include "io/SampleSource.h"
+
+typedef struct {
+  SampleSource source;
+  unsigned long ioBlocksize;
+  // Holds one chunk of ioBlocksize frames. It is allocated on the first read or
+  // write, since only then is the channel count known.
+  SampleBuffer chunk;
+  // Next frame of the chunk to read from or write to
+  unsigned long chunkPosition;
+  // Cleared once the wrapped source has returned its final chunk
+  boolByte hasMoreChunks;
+} SampleSourceBufferedDataMembers;
+typedef SampleSourceBufferedDataMembers* SampleSourceBufferedData;
+
+/**
+ * Wrap a sample source so that it is read or written in chunks of ioBlocksize
+ * frames, no matter which blocksize the caller uses. This lets audio files be
+ * read, written and converted in large blocks, which reduces the overhead per
+ * block, while plugins are processed with a smaller blocksize. When writing,
+ * the final chunk is written when the source is closed. The wrapped source may
+ * already be opened, otherwise it is opened along with the new source.
+ * @param source Sample source to wrap. The new source takes ownership of it,
+ * so it will be freed along with the new source.
+ * @param ioBlocksize Number of frames to read or write at once
+ * @return New sample source, or NULL if ioBlocksize is invalid
+ */
+SampleSource newSampleSourceBuffered(SampleSource source, const unsigned long ioBlocksize);
+
+#endif
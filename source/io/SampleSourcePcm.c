@@ -30,6 +30,7 @@
 #include <string.h>
 
 #include "audio/AudioSettings.h"
+#include "audio/SampleConversion.h"
 #include "base/PlatformUtilities.h"
 #include "io/SampleSourcePcm.h"
 #include "logging/EventLogger.h"
@@ -47,6 +48,9 @@ static boolByte openSampleSourcePcm(void* sampleSourcePtr, const SampleSourceOpe
     }
     else {
       extraData->fileHandle = fopen(sampleSource->sourceName->data, "rb");
+      if(extraData->fileHandle != NULL) {
+        sampleSourcePcmMapData(extraData, sampleSource->sourceName->data, 0, (size_t)-1);
+      }
     }
   }
   else if(openAs == SAMPLE_SOURCE_OPEN_WRITE) {
@@ -74,31 +78,73 @@ static boolByte openSampleSourcePcm(void* sampleSourcePtr, const SampleSourceOpe
   return true;
 }
 
-static void _convertPcmDataToSampleBuffer(const short* inPcmSamples, SampleBuffer sampleBuffer) {
-  const unsigned int numChannels = sampleBuffer->numChannels;
-  const unsigned long numInterlacedSamples = numChannels * sampleBuffer->blocksize;
-  unsigned int currentInterlacedSample = 0;
-  unsigned int currentDeinterlacedSample = 0;
-  unsigned int currentChannel;
-
-  while(currentInterlacedSample < numInterlacedSamples) {
-    for(currentChannel = 0; currentChannel < numChannels; ++currentChannel) {
-      Sample convertedSample = (Sample)inPcmSamples[currentInterlacedSample++] / 32767.0f;
-#if USE_BRICKWALL_LIMITER
-      if(convertedSample > 1.0f) {
-        convertedSample = 1.0f;
-      }
-      else if(convertedSample < -1.0f) {
-        convertedSample = -1.0f;
-      }
-#endif
-      sampleBuffer->samples[currentChannel][currentDeinterlacedSample] = convertedSample;
-    }
-    ++currentDeinterlacedSample;
+boolByte sampleSourcePcmMapData(SampleSourcePcmData pcmData, const char* filename, size_t dataOffset, size_t dataSize) {
+  if(pcmData->mappedFile == NULL) {
+    pcmData->mappedFile = newMappedFile();
+  }
+  if(!mappedFileOpen(pcmData->mappedFile, filename)) {
+    logDebug("Reading '%s' without memory mapping", filename);
+    return false;
+  }
+
+  // Samples are read directly from the mapping as shorts, which requires an aligned data offset
+  if(dataOffset >= pcmData->mappedFile->size || dataOffset % sizeof(short) != 0) {
+    mappedFileClose(pcmData->mappedFile);
+    return false;
+  }
+  if(dataSize > pcmData->mappedFile->size - dataOffset) {
+    dataSize = pcmData->mappedFile->size - dataOffset;
+  }
+
+  pcmData->mappedDataPosition = dataOffset;
+  pcmData->mappedDataEnd = dataOffset + dataSize;
+  logDebug("Mapped %lu bytes of audio data from '%s'", (unsigned long)dataSize, filename);
+  return true;
+}
+
+static size_t _sampleSourcePcmReadMapped(SampleSourcePcmData pcmData, SampleBuffer sampleBuffer) {
+  const size_t frameSize = sampleFormatGetBytesPerSample(pcmData->sampleFormat) * sampleBuffer->numChannels;
+  const size_t framesAvailable = (pcmData->mappedDataEnd - pcmData->mappedDataPosition) / frameSize;
+  const byte* pcmSamples = pcmData->mappedFile->data + pcmData->mappedDataPosition;
+
+  if(framesAvailable < sampleBuffer->blocksize) {
+    logDebug("End of PCM file reached");
+    sampleBuffer->blocksize = (unsigned long)framesAvailable;
   }
+
+  convertPcmDataToSamples(pcmSamples, pcmData->sampleFormat, sampleBuffer->samples, sampleBuffer->numChannels,
+    sampleBuffer->blocksize, pcmData->isLittleEndian != isHostLittleEndian());
+  pcmData->mappedDataPosition += sampleBuffer->blocksize * frameSize;
+  logDebug("Read %d samples from PCM file", sampleBuffer->blocksize * sampleBuffer->numChannels);
+  return sampleBuffer->blocksize * sampleBuffer->numChannels;
+}
+
+static boolByte _sampleSourcePcmStartStream(SampleSourcePcmData pcmData, const SampleSourceOpenAs openAs,
+  const SampleBuffer sampleBuffer) {
+  const size_t frameSize = sampleFormatGetBytesPerSample(pcmData->sampleFormat) * sampleBuffer->numChannels;
+  unsigned long bufferSizeInBytes = (unsigned long)((double)pcmData->streamBufferSizeInMs * pcmData->sampleRate / 1000.0) *
+    (unsigned long)frameSize;
+
+  // The buffer must hold at least two blocks, otherwise the I/O thread and the
+  // caller could never work at the same time
+  if(bufferSizeInBytes < 2 * sampleBuffer->blocksize * frameSize) {
+    bufferSizeInBytes = (unsigned long)(2 * sampleBuffer->blocksize * frameSize);
+  }
+
+  pcmData->stream = newPcmStream(pcmData->fileHandle, openAs, bufferSizeInBytes, pcmData->streamPolicy);
+  if(pcmData->stream == NULL || !pcmStreamStart(pcmData->stream)) {
+    freePcmStream(pcmData->stream);
+    pcmData->stream = NULL;
+    // Using the file directly still works, it just isn't buffered
+    logWarn("Could not start stream, falling back to unbuffered I/O");
+    pcmData->streamBufferSizeInMs = 0;
+    return false;
+  }
+  return true;
 }
 
 size_t sampleSourcePcmRead(SampleSourcePcmData pcmData, SampleBuffer sampleBuffer) {
+  const unsigned int bytesPerSample = sampleFormatGetBytesPerSample(pcmData->sampleFormat);
   size_t pcmSamplesRead = 0;
 
   if(pcmData == NULL || pcmData->fileHandle == NULL) {
@@ -106,15 +152,28 @@ size_t sampleSourcePcmRead(SampleSourcePcmData pcmData, SampleBuffer sampleBuffe
     return 0;
   }
 
+  if(pcmData->mappedFile != NULL && pcmData->mappedFile->data != NULL) {
+    return _sampleSourcePcmReadMapped(pcmData, sampleBuffer);
+  }
+
   if(pcmData->dataBufferNumItems == 0) {
     pcmData->dataBufferNumItems = (size_t)(sampleBuffer->numChannels * sampleBuffer->blocksize);
-    pcmData->interlacedPcmDataBuffer = (short*)malloc(sizeof(short) * pcmData->dataBufferNumItems);
+    pcmData->interlacedPcmDataBuffer = (byte*)malloc(bytesPerSample * pcmData->dataBufferNumItems);
   }
 
   // Clear the PCM data buffer, or else the last block will have dirty samples in the end
-  memset(pcmData->interlacedPcmDataBuffer, 0, sizeof(short) * pcmData->dataBufferNumItems);
+  memset(pcmData->interlacedPcmDataBuffer, 0, bytesPerSample * pcmData->dataBufferNumItems);
 
-  pcmSamplesRead = fread(pcmData->interlacedPcmDataBuffer, sizeof(short), pcmData->dataBufferNumItems, pcmData->fileHandle);
+  if(pcmData->isStream && pcmData->stream == NULL && pcmData->streamBufferSizeInMs > 0) {
+    _sampleSourcePcmStartStream(pcmData, SAMPLE_SOURCE_OPEN_READ, sampleBuffer);
+  }
+  if(pcmData->stream != NULL) {
+    pcmSamplesRead = pcmStreamRead(pcmData->stream, pcmData->interlacedPcmDataBuffer,
+      bytesPerSample * pcmData->dataBufferNumItems, bytesPerSample * sampleBuffer->numChannels) / bytesPerSample;
+  }
+  else {
+    pcmSamplesRead = fread(pcmData->interlacedPcmDataBuffer, bytesPerSample, pcmData->dataBufferNumItems, pcmData->fileHandle);
+  }
   if(pcmSamplesRead < pcmData->dataBufferNumItems) {
     logDebug("End of PCM file reached");
     // Set the blocksize of the sample buffer to be the number of frames read
@@ -122,7 +181,8 @@ size_t sampleSourcePcmRead(SampleSourcePcmData pcmData, SampleBuffer sampleBuffe
   }
   logDebug("Read %d samples from PCM file", pcmSamplesRead);
 
-  _convertPcmDataToSampleBuffer(pcmData->interlacedPcmDataBuffer, sampleBuffer);
+  convertPcmDataToSamples(pcmData->interlacedPcmDataBuffer, pcmData->sampleFormat, sampleBuffer->samples,
+    sampleBuffer->numChannels, sampleBuffer->blocksize, pcmData->isLittleEndian != isHostLittleEndian());
   return pcmSamplesRead;
 }
 
@@ -132,44 +192,21 @@ static boolByte readBlockFromPcmFile(void* sampleSourcePtr, SampleBuffer sampleB
   int originalBlocksize = sampleBuffer->blocksize;
   size_t samplesRead = sampleSourcePcmRead(extraData, sampleBuffer);
   sampleSource->numSamplesProcessed += samplesRead;
+  sampleSource->numBytesProcessed += samplesRead * sampleFormatGetBytesPerSample(extraData->sampleFormat);
   return (originalBlocksize == sampleBuffer->blocksize);
 }
 
 void convertSampleBufferToPcmData(const SampleBuffer sampleBuffer, short* outPcmSamples, boolByte flipEndian) {
-  const unsigned long blocksize = sampleBuffer->blocksize;
-  const unsigned int numChannels = sampleBuffer->numChannels;
-  unsigned int currentInterlacedSample = 0;
-  unsigned int currentSample = 0;
-  unsigned int currentChannel = 0;
-  short shortValue;
-  Sample sample;
-
-  for(currentSample = 0; currentSample < blocksize; ++currentSample) {
-    for(currentChannel = 0; currentChannel < numChannels; ++currentChannel) {
-      sample = sampleBuffer->samples[currentChannel][currentSample];
-#if USE_BRICKWALL_LIMITER
-      if(sample > 1.0f) {
-        sample = 1.0f;
-      }
-      else if(sample < -1.0f) {
-        sample = -1.0f;
-      }
-#endif
-      shortValue = (short)(sample * 32767.0f);
-      if(flipEndian) {
-        outPcmSamples[currentInterlacedSample++] = flipShortEndian(shortValue);
-      }
-      else {
-        outPcmSamples[currentInterlacedSample++] = shortValue;
-      }
-    }
-  }
+  convertSamplesToPcm16((const Samples*)sampleBuffer->samples, outPcmSamples, sampleBuffer->numChannels,
+    sampleBuffer->blocksize, flipEndian);
 }
 
-size_t sampleSourcePcmWrite(SampleSourcePcmData pcmData, const SampleBuffer sampleBuffer) {
+boolByte sampleSourcePcmWrite(SampleSourcePcmData pcmData, const SampleBuffer sampleBuffer, size_t* outNumSamplesWritten) {
+  const unsigned int bytesPerSample = sampleFormatGetBytesPerSample(pcmData->sampleFormat);
   size_t pcmSamplesWritten = 0;
   size_t numSamplesToWrite = (size_t)(sampleBuffer->numChannels * sampleBuffer->blocksize);
 
+  *outNumSamplesWritten = 0;
   if(pcmData == NULL || pcmData->fileHandle == NULL) {
     logCritical("Corrupt PCM data structure");
     return false;
@@ -177,34 +214,60 @@ size_t sampleSourcePcmWrite(SampleSourcePcmData pcmData, const SampleBuffer samp
 
   if(pcmData->dataBufferNumItems == 0) {
     pcmData->dataBufferNumItems = (size_t)(sampleBuffer->numChannels * sampleBuffer->blocksize);
-    pcmData->interlacedPcmDataBuffer = (short*)malloc(sizeof(short) * pcmData->dataBufferNumItems);
+    pcmData->interlacedPcmDataBuffer = (byte*)malloc(bytesPerSample * pcmData->dataBufferNumItems);
   }
 
   // Clear the PCM data buffer just to be safe
-  memset(pcmData->interlacedPcmDataBuffer, 0, sizeof(short) * pcmData->dataBufferNumItems);
+  memset(pcmData->interlacedPcmDataBuffer, 0, bytesPerSample * pcmData->dataBufferNumItems);
 
-  convertSampleBufferToPcmData(sampleBuffer, pcmData->interlacedPcmDataBuffer, pcmData->isLittleEndian != isHostLittleEndian());
-  pcmSamplesWritten = fwrite(pcmData->interlacedPcmDataBuffer, sizeof(short), numSamplesToWrite, pcmData->fileHandle);
-  if(pcmSamplesWritten < numSamplesToWrite) {
+  convertSamplesToPcmData((const Samples*)sampleBuffer->samples, pcmData->interlacedPcmDataBuffer, pcmData->sampleFormat,
+    sampleBuffer->numChannels, sampleBuffer->blocksize, pcmData->isLittleEndian != isHostLittleEndian());
+  if(pcmData->isStream && pcmData->stream == NULL && pcmData->streamBufferSizeInMs > 0) {
+    _sampleSourcePcmStartStream(pcmData, SAMPLE_SOURCE_OPEN_WRITE, sampleBuffer);
+  }
+  if(pcmData->stream != NULL) {
+    pcmSamplesWritten = pcmStreamWrite(pcmData->stream, pcmData->interlacedPcmDataBuffer,
+      bytesPerSample * numSamplesToWrite) / bytesPerSample;
+  }
+  else {
+    pcmSamplesWritten = fwrite(pcmData->interlacedPcmDataBuffer, bytesPerSample, numSamplesToWrite, pcmData->fileHandle);
+  }
+  *outNumSamplesWritten = pcmSamplesWritten;
+  if(pcmSamplesWritten == 0 && pcmData->stream != NULL && !pcmData->stream->hasFailed) {
+    // Dropped by a realtime stream, which reports the number of dropped blocks when it stops
+    return true;
+  }
+  else if(pcmSamplesWritten < numSamplesToWrite) {
     logWarn("Short write to PCM file");
-    return pcmSamplesWritten;
+    return false;
   }
 
   logDebug("Wrote %d samples to PCM file", pcmSamplesWritten);
-  return pcmSamplesWritten;
+  return true;
 }
 
 static boolByte writeBlockToPcmFile(void* sampleSourcePtr, const SampleBuffer sampleBuffer) {
   SampleSource sampleSource = (SampleSource)sampleSourcePtr;
   SampleSourcePcmData extraData = (SampleSourcePcmData)(sampleSource->extraData);
-  int samplesWritten = (int)sampleSourcePcmWrite(extraData, sampleBuffer);
+  size_t samplesWritten;
+  boolByte result = sampleSourcePcmWrite(extraData, sampleBuffer, &samplesWritten);
   sampleSource->numSamplesProcessed += samplesWritten;
-  return (samplesWritten == sampleBuffer->blocksize);
+  sampleSource->numBytesProcessed += samplesWritten * sampleFormatGetBytesPerSample(extraData->sampleFormat);
+  return result;
 }
 
 static void _closeSampleSourcePcm(void* sampleSourcePtr) {
   SampleSource sampleSource = (SampleSource)sampleSourcePtr;
   SampleSourcePcmData extraData = (SampleSourcePcmData)sampleSource->extraData;
+  if(extraData->mappedFile != NULL) {
+    mappedFileClose(extraData->mappedFile);
+  }
+  // Output streams are drained here, so this must happen before closing the file
+  if(extraData->stream != NULL) {
+    pcmStreamStop(extraData->stream);
+    freePcmStream(extraData->stream);
+    extraData->stream = NULL;
+  }
   if(extraData->fileHandle != NULL) {
     fclose(extraData->fileHandle);
   }
@@ -222,9 +285,19 @@ void sampleSourcePcmSetNumChannels(void* sampleSourcePtr, int numChannels) {
   extraData->numChannels = numChannels;
 }
 
+void sampleSourcePcmSetStreamOptions(void* sampleSourcePtr, const unsigned long bufferSizeInMs,
+  const PcmStreamPolicy policy) {
+  SampleSource sampleSource = (SampleSource)sampleSourcePtr;
+  SampleSourcePcmData extraData = (SampleSourcePcmData)sampleSource->extraData;
+  extraData->streamBufferSizeInMs = bufferSizeInMs;
+  extraData->streamPolicy = policy;
+}
+
 void freeSampleSourceDataPcm(void* sampleSourceDataPtr) {
   SampleSourcePcmData extraData = (SampleSourcePcmData)sampleSourceDataPtr;
+  freePcmStream(extraData->stream);
   free(extraData->interlacedPcmDataBuffer);
+  freeMappedFile(extraData->mappedFile);
   free(extraData);
 }
 
@@ -237,6 +310,8 @@ SampleSource newSampleSourcePcm(const CharString sampleSourceName) {
   sampleSource->sourceName = newCharString();
   charStringCopy(sampleSource->sourceName, sampleSourceName);
   sampleSource->numSamplesProcessed = 0;
+  sampleSource->numBytesProcessed = 0;
+  sampleSource->context = getMrsWatsonContext();
 
   sampleSource->openSampleSource = openSampleSourcePcm;
   sampleSource->readSampleBlock = readBlockFromPcmFile;
@@ -249,10 +324,16 @@ SampleSource newSampleSourcePcm(const CharString sampleSourceName) {
   extraData->fileHandle = NULL;
   extraData->dataBufferNumItems = 0;
   extraData->interlacedPcmDataBuffer = NULL;
+  extraData->mappedFile = NULL;
+  extraData->mappedDataPosition = 0;
+  extraData->mappedDataEnd = 0;
+  extraData->stream = NULL;
+  extraData->streamBufferSizeInMs = DEFAULT_STREAM_BUFFER_SIZE_IN_MS;
+  extraData->streamPolicy = kPcmStreamPolicyWait;
 
   extraData->numChannels = (unsigned short)getNumChannels();
   extraData->sampleRate = (unsigned int)getSampleRate();
-  extraData->bitsPerSample = 16;
+  extraData->sampleFormat = kSampleFormatInt16;
   sampleSource->extraData = extraData;
 
   return sampleSource;
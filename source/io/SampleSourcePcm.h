@@ -30,31 +30,82 @@
 
 #include <stdio.h>
 
+#include "audio/SampleConversion.h"
+#include "base/MappedFile.h"
+#include "io/PcmStream.h"
 #include "io/SampleSource.h"
 
+// Default amount of audio buffered when reading from stdin or writing to stdout
+#define DEFAULT_STREAM_BUFFER_SIZE_IN_MS 500
+
 typedef struct {
   boolByte isStream;
   boolByte isLittleEndian;
   FILE* fileHandle;
   size_t dataBufferNumItems;
-  short* interlacedPcmDataBuffer;
+  byte* interlacedPcmDataBuffer;
+
+  // When reading from a regular file, the audio data is read directly from a
+  // memory mapping instead of through fileHandle
+  MappedFile mappedFile;
+  size_t mappedDataPosition;
+  size_t mappedDataEnd;
+
+  // When reading from stdin or writing to stdout, the pipe is serviced by the
+  // stream's thread, which is started on the first read or write
+  PcmStream stream;
+  unsigned long streamBufferSizeInMs;
+  PcmStreamPolicy streamPolicy;
 
   unsigned short numChannels;
   unsigned int sampleRate;
-  unsigned short bitsPerSample;
+  SampleFormat sampleFormat;
 } SampleSourcePcmDataMembers;
 typedef SampleSourcePcmDataMembers *SampleSourcePcmData;
 
 SampleSource newSampleSourcePcm(const CharString sampleSourceName);
 
+/**
+ * Map the audio data of a file opened for reading, so that subsequent calls to
+ * sampleSourcePcmRead() convert samples directly from the mapped file. If the
+ * file cannot be mapped, reading falls back to using the file handle.
+ * @param pcmData
+ * @param filename File to map
+ * @param dataOffset Offset of the first sample in the file, in bytes
+ * @param dataSize Size of the audio data in bytes, which will be truncated if
+ * the file is shorter than expected
+ * @return True if the file was mapped
+ */
+boolByte sampleSourcePcmMapData(SampleSourcePcmData pcmData, const char* filename, size_t dataOffset, size_t dataSize);
 size_t sampleSourcePcmRead(SampleSourcePcmData pcmData, SampleBuffer sampleBuffer);
-size_t sampleSourcePcmWrite(SampleSourcePcmData pcmData, const SampleBuffer sampleBuffer);
+/**
+ * Write a block of samples to the file or stream
+ * @param pcmData
+ * @param sampleBuffer Samples to write
+ * @param outNumSamplesWritten Set to the number of samples written. This is less
+ * than the size of the block if writing failed, or if a realtime stream dropped
+ * the block.
+ * @return False if writing failed. Blocks which were dropped by a realtime
+ * stream are not a failure.
+ */
+boolByte sampleSourcePcmWrite(SampleSourcePcmData pcmData, const SampleBuffer sampleBuffer, size_t* outNumSamplesWritten);
 // TODO: Move to SampleBuffer class
 void convertSampleBufferToPcmData(const SampleBuffer sampleBuffer, short* outPcmSamples, boolByte isDataLittleEndian);
 
 void sampleSourcePcmSetSampleRate(void* sampleSourcePtr, double sampleRate);
 void sampleSourcePcmSetNumChannels(void* sampleSourcePtr, int numChannels);
 
+/**
+ * Set how stdin or stdout is buffered when the source is opened as a stream.
+ * Must be called before the first block is read or written.
+ * @param sampleSourcePtr
+ * @param bufferSizeInMs Amount of audio to buffer, or 0 to read and write the
+ * pipe directly on the calling thread
+ * @param policy What to do when the buffer runs empty or full
+ */
+void sampleSourcePcmSetStreamOptions(void* sampleSourcePtr, const unsigned long bufferSizeInMs,
+  const PcmStreamPolicy policy);
+
 void freeSampleSourceDataPcm(void* sampleSourceDataPtr);
 
 #endif
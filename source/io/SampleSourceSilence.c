@@ -60,6 +60,8 @@ SampleSource newSampleSourceSilence(void) {
   sampleSource->sourceName = newCharString();
   charStringCopyCString(sampleSource->sourceName, "(silence)");
   sampleSource->numSamplesProcessed = 0;
+  sampleSource->numBytesProcessed = 0;
+  sampleSource->context = getMrsWatsonContext();
 
   sampleSource->openSampleSource = _openSampleSourceSilence;
   sampleSource->closeSampleSource = _closeSampleSourceSilence;
@@ -42,12 +42,56 @@
 #include "io/SampleSourceAudiofile.h"
 #endif
 
+// Format codes for the fmt chunk
+#define WAVE_FORMAT_PCM 0x0001
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+#define WAVE_FORMAT_EXTENSIBLE 0xfffe
+
+// fmt chunk sizes for the different header layouts which are written
+#define WAVE_FMT_CHUNK_SIZE_PCM 16
+#define WAVE_FMT_CHUNK_SIZE_FLOAT 18
+#define WAVE_FMT_CHUNK_SIZE_EXTENSIBLE 40
+#define WAVE_MAX_HEADER_SIZE 80
+
+// The last 14 bytes of the KSDATAFORMAT_SUBTYPE_PCM and _IEEE_FLOAT GUIDs, which
+// follow the two-byte format code in a WAVE_FORMAT_EXTENSIBLE header
+static const byte kWaveSubformatGuidSuffix[14] = {
+  0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71
+};
+
+static void _writeLittleEndianShort(byte* outBytes, const unsigned short value) {
+  outBytes[0] = (byte)(value & 0xff);
+  outBytes[1] = (byte)((value >> 8) & 0xff);
+}
+
+static void _writeLittleEndianInt(byte* outBytes, const unsigned int value) {
+  outBytes[0] = (byte)(value & 0xff);
+  outBytes[1] = (byte)((value >> 8) & 0xff);
+  outBytes[2] = (byte)((value >> 16) & 0xff);
+  outBytes[3] = (byte)((value >> 24) & 0xff);
+}
+
+// Skip over any chunks before the one with the given ID. Afterwards the file is
+// positioned at the start of the chunk's data.
+static boolByte _findWaveChunk(FILE* fileHandle, RiffChunk chunk, const char* id) {
+  while(riffChunkReadNext(fileHandle, chunk, false)) {
+    if(riffChunkIsIdEqualTo(chunk, id)) {
+      return true;
+    }
+    // Chunks are padded to an even size
+    if(fseek(fileHandle, (long)(chunk->size + (chunk->size & 1)), SEEK_CUR) != 0) {
+      return false;
+    }
+  }
+  return false;
+}
+
 static boolByte _readWaveFileInfo(const char* filename, SampleSourcePcmData extraData) {
-  int chunkOffset = 0;
   RiffChunk chunk = newRiffChunk();
   char format[4];
   unsigned int itemsRead;
   unsigned int audioFormat;
+  unsigned int bitsPerSample;
   unsigned int byteRate;
   unsigned int expectedByteRate;
   unsigned int blockAlign;
@@ -76,175 +120,153 @@ static boolByte _readWaveFileInfo(const char* filename, SampleSourcePcmData extr
     return false;
   }
 
-  if(riffChunkReadNext(extraData->fileHandle, chunk, true)) {
-    if(!riffChunkIsIdEqualTo(chunk, "fmt ")) {
-      logError(filename, "Invalid format chunk header");
-      freeRiffChunk(chunk);
-      return false;
-    }
-
-    audioFormat = convertByteArrayToUnsignedShort(chunk->data + chunkOffset);
-    chunkOffset += 2;
-    if(audioFormat != 1) {
-      logUnsupportedFeature("Compressed WAVE files");
-      freeRiffChunk(chunk);
-      return false;
-    }
-
-    extraData->numChannels = convertByteArrayToUnsignedShort(chunk->data + chunkOffset);
-    chunkOffset += 2;
-    setNumChannels(extraData->numChannels);
-
-    extraData->sampleRate = convertByteArrayToUnsignedInt(chunk->data + chunkOffset);
-    chunkOffset += 4;
-    setSampleRate(extraData->sampleRate);
-
-    byteRate = convertByteArrayToUnsignedInt(chunk->data + chunkOffset);
-    chunkOffset += 4;
-
-    blockAlign = convertByteArrayToUnsignedShort(chunk->data + chunkOffset);
-    chunkOffset += 2;
-
-    extraData->bitsPerSample = convertByteArrayToUnsignedShort(chunk->data + chunkOffset);
-    if(extraData->bitsPerSample > 16) {
-      logUnsupportedFeature("Bitrates greater than 16");
-      freeRiffChunk(chunk);
-      return false;
-    }
-    else if(extraData->bitsPerSample < 16) {
-      logUnsupportedFeature("Bitrates lower than 16");
-      freeRiffChunk(chunk);
-      return false;
-    }
-
-    expectedByteRate = extraData->sampleRate * extraData->numChannels * extraData->bitsPerSample / 8;
-    if(expectedByteRate != byteRate) {
-      logWarn("Possibly invalid bitrate %d, expected %d", byteRate, expectedByteRate);
-    }
-
-    expectedBlockAlign = extraData->numChannels * extraData->bitsPerSample / 8;
-    if(expectedBlockAlign != blockAlign) {
-      logWarn("Possibly invalid block align %d, expected %d", blockAlign, expectedBlockAlign);
-    }
+  if(!_findWaveChunk(extraData->fileHandle, chunk, "fmt ")) {
+    logFileError(filename, "WAVE file has no format chunk");
+    freeRiffChunk(chunk);
+    return false;
   }
-  else {
-    logFileError(filename, "WAVE file has no chunks following format");
+  if(chunk->size < WAVE_FMT_CHUNK_SIZE_PCM) {
+    logFileError(filename, "Invalid format chunk header");
+    freeRiffChunk(chunk);
+    return false;
+  }
+  chunk->data = (byte*)malloc(chunk->size);
+  if(fread(chunk->data, 1, chunk->size, extraData->fileHandle) != chunk->size) {
+    logFileError(filename, "Could not read format chunk");
     freeRiffChunk(chunk);
     return false;
   }
+  if(chunk->size & 1) {
+    fseek(extraData->fileHandle, 1, SEEK_CUR);
+  }
 
-  // We don't need the format data anymore, so free and re-alloc the chunk to avoid a small memory leak
-  freeRiffChunk(chunk);
-  chunk = newRiffChunk();
+  audioFormat = convertByteArrayToUnsignedShort(chunk->data);
+  extraData->numChannels = convertByteArrayToUnsignedShort(chunk->data + 2);
+  extraData->sampleRate = convertByteArrayToUnsignedInt(chunk->data + 4);
+  byteRate = convertByteArrayToUnsignedInt(chunk->data + 8);
+  blockAlign = convertByteArrayToUnsignedShort(chunk->data + 12);
+  bitsPerSample = convertByteArrayToUnsignedShort(chunk->data + 14);
 
-  if(riffChunkReadNext(extraData->fileHandle, chunk, false)) {
-    if(!riffChunkIsIdEqualTo(chunk, "data")) {
-      logFileError(filename, "WAVE file has invalid data chunk header");
+  if(audioFormat == WAVE_FORMAT_EXTENSIBLE) {
+    if(chunk->size < WAVE_FMT_CHUNK_SIZE_EXTENSIBLE) {
+      logFileError(filename, "Invalid extensible format chunk");
       freeRiffChunk(chunk);
       return false;
     }
-
-    logDebug("WAVE file has %d bytes", chunk->size);
+    // The actual format is given by the first two bytes of the subformat GUID. Any valid bits
+    // setting can be ignored, since samples are stored in the high bits of each container.
+    audioFormat = convertByteArrayToUnsignedShort(chunk->data + 24);
+    if(memcmp(chunk->data + 26, kWaveSubformatGuidSuffix, sizeof(kWaveSubformatGuidSuffix)) != 0) {
+      audioFormat = 0;
+    }
   }
-
   freeRiffChunk(chunk);
-  return true;
-}
 
-static boolByte _writeWaveFileInfo(SampleSourcePcmData extraData) {
-  RiffChunk chunk = newRiffChunk();
-  unsigned short audioFormat = 1;
-  unsigned short byteRate = (unsigned short)(extraData->sampleRate * extraData->numChannels * extraData->bitsPerSample / 8);
-  unsigned short blockAlign = extraData->numChannels * extraData->bitsPerSample / 8;
-  unsigned int extraParams = 0;
-
-  memcpy(chunk->id, "RIFF", 4);
-  if(fwrite(chunk->id, sizeof(byte), 4, extraData->fileHandle) != 4) {
-    logError("Could not write RIFF header");
-    freeRiffChunk(chunk);
+  if(audioFormat != WAVE_FORMAT_PCM && audioFormat != WAVE_FORMAT_IEEE_FLOAT) {
+    logUnsupportedFeature("Compressed WAVE files");
     return false;
   }
-
-  // Write the size, but this will need to be set again when the file is finished writing
-  if(fwrite(&(chunk->size), sizeof(unsigned int), 1, extraData->fileHandle) != 1) {
-    logError("Could not write RIFF chunk size");
-    freeRiffChunk(chunk);
+  extraData->sampleFormat = sampleFormatFromBitDepth(bitsPerSample, (boolByte)(audioFormat == WAVE_FORMAT_IEEE_FLOAT));
+  if(extraData->sampleFormat == kNumSampleFormats) {
+    logError("WAVE file '%s' has unsupported %s samples with %d bits", filename,
+      audioFormat == WAVE_FORMAT_IEEE_FLOAT ? "floating point" : "integer", bitsPerSample);
     return false;
   }
+  logDebug("WAVE file has %s samples", sampleFormatGetName(extraData->sampleFormat));
 
-  memcpy(chunk->id, "WAVE", 4);
-  if(fwrite(chunk->id, sizeof(byte), 4, extraData->fileHandle) != 4) {
-    logError("Could not WAVE format");
-    freeRiffChunk(chunk);
-    return false;
+  expectedByteRate = extraData->sampleRate * extraData->numChannels * bitsPerSample / 8;
+  if(expectedByteRate != byteRate) {
+    logWarn("Possibly invalid bitrate %d, expected %d", byteRate, expectedByteRate);
   }
 
-  // Write the format header
-  memcpy(chunk->id, "fmt ", 4);
-  chunk->size = 20;
-  if(fwrite(chunk->id, sizeof(byte), 4, extraData->fileHandle) != 4) {
-    logError("Could not write format header");
-    freeRiffChunk(chunk);
-    return false;
+  expectedBlockAlign = extraData->numChannels * bitsPerSample / 8;
+  if(expectedBlockAlign != blockAlign) {
+    logWarn("Possibly invalid block align %d, expected %d", blockAlign, expectedBlockAlign);
   }
 
-  if(fwrite(&(chunk->size), sizeof(unsigned int), 1, extraData->fileHandle) != 1) {
-    logError("Could not write format chunk size");
+  // Other chunks (ie, fact or LIST) may come between the format and the data
+  chunk = newRiffChunk();
+  if(_findWaveChunk(extraData->fileHandle, chunk, "data")) {
+    logDebug("WAVE file has %d bytes", chunk->size);
+    // Files which were written to a stream may not have the data size filled in, in which
+    // case the audio data is assumed to run until the end of the file
+    sampleSourcePcmMapData(extraData, filename, (size_t)ftell(extraData->fileHandle),
+      chunk->size > 0 ? (size_t)chunk->size : (size_t)-1);
+  }
+  else {
+    logFileError(filename, "WAVE file has no data chunk");
     freeRiffChunk(chunk);
     return false;
   }
 
-  // TODO: These calls will not work on big-endian platforms
+  freeRiffChunk(chunk);
+  return true;
+}
 
-  if(fwrite(&audioFormat, sizeof(unsigned short), 1, extraData->fileHandle) != 1) {
-    logError("Could not write audio format");
-    freeRiffChunk(chunk);
-    return false;
-  }
-  if(fwrite(&(extraData->numChannels), sizeof(unsigned short), 1, extraData->fileHandle) != 1) {
-    logError("Could not write channel count");
-    freeRiffChunk(chunk);
-    return false;
-  }
-  if(fwrite(&(extraData->sampleRate), sizeof(unsigned int), 1, extraData->fileHandle) != 1) {
-    logError("Could not write sample rate");
-    freeRiffChunk(chunk);
-    return false;
-  }
-  if(fwrite(&(byteRate), sizeof(unsigned int), 1, extraData->fileHandle) != 1) {
-    logError("Could not write byte rate");
-    freeRiffChunk(chunk);
-    return false;
+static boolByte _writeWaveFileInfo(SampleSourcePcmData extraData) {
+  byte header[WAVE_MAX_HEADER_SIZE];
+  byte* fmtChunk;
+  size_t headerSize = 0;
+  const unsigned int bytesPerSample = sampleFormatGetBytesPerSample(extraData->sampleFormat);
+  const unsigned short blockAlign = (unsigned short)(extraData->numChannels * bytesPerSample);
+  const unsigned int byteRate = extraData->sampleRate * blockAlign;
+  unsigned int fmtChunkSize;
+  unsigned short audioFormat;
+
+  // 16-bit integer data uses the canonical header. Higher integer bit depths need to use the
+  // extensible header, and floating point data needs a fact chunk in addition to the format.
+  if(sampleFormatIsFloat(extraData->sampleFormat)) {
+    audioFormat = WAVE_FORMAT_IEEE_FLOAT;
+    fmtChunkSize = WAVE_FMT_CHUNK_SIZE_FLOAT;
   }
-  if(fwrite(&(blockAlign), sizeof(unsigned short), 1, extraData->fileHandle) != 1) {
-    logError("Could not write block align");
-    freeRiffChunk(chunk);
-    return false;
+  else if(extraData->sampleFormat != kSampleFormatInt16) {
+    audioFormat = WAVE_FORMAT_EXTENSIBLE;
+    fmtChunkSize = WAVE_FMT_CHUNK_SIZE_EXTENSIBLE;
   }
-  if(fwrite(&(extraData->bitsPerSample), sizeof(unsigned short), 1, extraData->fileHandle) != 1) {
-    logError("Could not write bits per sample");
-    freeRiffChunk(chunk);
-    return false;
+  else {
+    audioFormat = WAVE_FORMAT_PCM;
+    fmtChunkSize = WAVE_FMT_CHUNK_SIZE_PCM;
   }
-  if(fwrite(&(extraParams), sizeof(byte), 4, extraData->fileHandle) != 4) {
-    logError("Could not write extra PCM parameters");
-    freeRiffChunk(chunk);
-    return false;
+
+  memset(header, 0, WAVE_MAX_HEADER_SIZE);
+  // The RIFF and data chunk sizes are filled in when the file is closed
+  memcpy(header, "RIFF", 4);
+  memcpy(header + 8, "WAVE", 4);
+  memcpy(header + 12, "fmt ", 4);
+  _writeLittleEndianInt(header + 16, fmtChunkSize);
+
+  fmtChunk = header + 20;
+  _writeLittleEndianShort(fmtChunk, audioFormat);
+  _writeLittleEndianShort(fmtChunk + 2, extraData->numChannels);
+  _writeLittleEndianInt(fmtChunk + 4, extraData->sampleRate);
+  _writeLittleEndianInt(fmtChunk + 8, byteRate);
+  _writeLittleEndianShort(fmtChunk + 12, blockAlign);
+  _writeLittleEndianShort(fmtChunk + 14, (unsigned short)(bytesPerSample * 8));
+  if(audioFormat == WAVE_FORMAT_EXTENSIBLE) {
+    _writeLittleEndianShort(fmtChunk + 16, WAVE_FMT_CHUNK_SIZE_EXTENSIBLE - WAVE_FMT_CHUNK_SIZE_FLOAT);
+    _writeLittleEndianShort(fmtChunk + 18, (unsigned short)(bytesPerSample * 8));
+    // Speaker positions are only set for mono (front center) and stereo (front left and right)
+    _writeLittleEndianInt(fmtChunk + 20, extraData->numChannels == 1 ? 0x4 : (extraData->numChannels == 2 ? 0x3 : 0));
+    _writeLittleEndianShort(fmtChunk + 24, WAVE_FORMAT_PCM);
+    memcpy(fmtChunk + 26, kWaveSubformatGuidSuffix, sizeof(kWaveSubformatGuidSuffix));
   }
+  headerSize = 20 + fmtChunkSize;
 
-  memcpy(chunk->id, "data", 4);
-  if(fwrite(chunk->id, sizeof(byte), 4, extraData->fileHandle) != 4) {
-    logError("Could not write format header");
-    freeRiffChunk(chunk);
-    return false;
+  if(audioFormat == WAVE_FORMAT_IEEE_FLOAT) {
+    // Holds the number of frames in the file, which is also filled in later
+    memcpy(header + headerSize, "fact", 4);
+    _writeLittleEndianInt(header + headerSize + 4, 4);
+    headerSize += 12;
   }
-  if(fwrite(&(chunk->size), sizeof(unsigned int), 1, extraData->fileHandle) != 1) {
-    logError("Could not write data chunk size");
-    freeRiffChunk(chunk);
+
+  memcpy(header + headerSize, "data", 4);
+  headerSize += 8;
+
+  if(fwrite(header, 1, headerSize, extraData->fileHandle) != headerSize) {
+    logError("Could not write WAVE header");
     return false;
   }
 
-  freeRiffChunk(chunk);
   return true;
 }
 
@@ -291,7 +313,7 @@ static boolByte _openSampleSourceWave(void *sampleSourcePtr, const SampleSourceO
     if(extraData->fileHandle != NULL) {
       extraData->numChannels = (unsigned short)getNumChannels();
       extraData->sampleRate = (unsigned int)getSampleRate();
-      extraData->bitsPerSample = 16;
+      extraData->sampleFormat = getSampleFormat();
       if(!_writeWaveFileInfo(extraData)) {
         fclose(extraData->fileHandle);
         extraData->fileHandle = NULL;
@@ -320,23 +342,96 @@ static boolByte _readBlockFromWaveFile(void* sampleSourcePtr, SampleBuffer sampl
   int originalBlocksize = sampleBuffer->blocksize;
   size_t samplesRead = sampleSourcePcmRead(extraData, sampleBuffer);
   sampleSource->numSamplesProcessed += samplesRead;
+  sampleSource->numBytesProcessed += samplesRead * sampleFormatGetBytesPerSample(extraData->sampleFormat);
   return (originalBlocksize == sampleBuffer->blocksize);
 }
 
 static boolByte _writeBlockToWaveFile(void* sampleSourcePtr, const SampleBuffer sampleBuffer) {
   SampleSource sampleSource = (SampleSource)sampleSourcePtr;
   SampleSourcePcmData extraData = (SampleSourcePcmData)sampleSource->extraData;
-  int samplesWritten = (int)sampleSourcePcmWrite(extraData, sampleBuffer);
+  size_t samplesWritten;
+  boolByte result = sampleSourcePcmWrite(extraData, sampleBuffer, &samplesWritten);
   sampleSource->numSamplesProcessed += samplesWritten;
-  return (samplesWritten == sampleBuffer->blocksize);
+  sampleSource->numBytesProcessed += samplesWritten * sampleFormatGetBytesPerSample(extraData->sampleFormat);
+  return result;
+}
+
+// Fill in the sizes of the RIFF, fact and data chunks after all samples have been written
+static boolByte _finalizeWaveFile(SampleSource sampleSource, SampleSourcePcmData extraData) {
+  const unsigned int dataSize = (unsigned int)sampleSource->numSamplesProcessed *
+    sampleFormatGetBytesPerSample(extraData->sampleFormat);
+  const unsigned int numFrames = (unsigned int)sampleSource->numSamplesProcessed / extraData->numChannels;
+  RiffChunk chunk = newRiffChunk();
+  byte sizeBytes[4];
+  long chunkDataPosition;
+  long fileSize;
+  boolByte foundData = false;
+
+  // Chunks with odd sizes must be followed by a padding byte
+  if(dataSize & 1) {
+    if(fseek(extraData->fileHandle, 0, SEEK_END) != 0 || fputc(0, extraData->fileHandle) == EOF) {
+      logError("Could not pad data chunk during WAVE file finalization");
+      freeRiffChunk(chunk);
+      return false;
+    }
+  }
+
+  // Skip the RIFF descriptor and format type, and then visit each chunk
+  if(fseek(extraData->fileHandle, 12, SEEK_SET) != 0) {
+    logError("Could not seek to first chunk during WAVE file finalization");
+    freeRiffChunk(chunk);
+    return false;
+  }
+  while(!foundData && riffChunkReadNext(extraData->fileHandle, chunk, false)) {
+    chunkDataPosition = ftell(extraData->fileHandle);
+    if(riffChunkIsIdEqualTo(chunk, "fact")) {
+      _writeLittleEndianInt(sizeBytes, numFrames);
+      if(fseek(extraData->fileHandle, chunkDataPosition, SEEK_SET) != 0 ||
+         fwrite(sizeBytes, 1, 4, extraData->fileHandle) != 4) {
+        logError("Could not write WAVE frame count during finalization");
+        freeRiffChunk(chunk);
+        return false;
+      }
+    }
+    else if(riffChunkIsIdEqualTo(chunk, "data")) {
+      _writeLittleEndianInt(sizeBytes, dataSize);
+      if(fseek(extraData->fileHandle, chunkDataPosition - 4, SEEK_SET) != 0 ||
+         fwrite(sizeBytes, 1, 4, extraData->fileHandle) != 4) {
+        logError("Could not write WAVE file size during finalization");
+        freeRiffChunk(chunk);
+        return false;
+      }
+      foundData = true;
+    }
+    // Always seek before the next read, since the stream may have just been written to
+    if(fseek(extraData->fileHandle, chunkDataPosition + (long)(chunk->size + (chunk->size & 1)), SEEK_SET) != 0) {
+      break;
+    }
+  }
+  freeRiffChunk(chunk);
+
+  if(!foundData) {
+    logError("Could not find data chunk during WAVE file finalization");
+    return false;
+  }
+
+  if(fseek(extraData->fileHandle, 0, SEEK_END) != 0 || (fileSize = ftell(extraData->fileHandle)) < 8) {
+    logError("Could not determine file size during WAVE file finalization");
+    return false;
+  }
+  _writeLittleEndianInt(sizeBytes, (unsigned int)(fileSize - 8));
+  if(fseek(extraData->fileHandle, 4, SEEK_SET) != 0 || fwrite(sizeBytes, 1, 4, extraData->fileHandle) != 4) {
+    logError("Could not write RIFF chunk size during WAVE file finalization");
+    return false;
+  }
+
+  return true;
 }
 
 void closeSampleSourceWave(void* sampleSourceDataPtr) {
 #if ! HAVE_LIBAUDIOFILE
   SampleSource sampleSource = (SampleSource)sampleSourceDataPtr;
   SampleSourcePcmData extraData = (SampleSourcePcmData)sampleSource->extraData;
-  unsigned int numBytesWritten;
-  RiffChunk chunk;
 
   if(sampleSource->openedAs == SAMPLE_SOURCE_OPEN_WRITE) {
     // Re-open the file for editing
@@ -351,52 +446,18 @@ void closeSampleSourceWave(void* sampleSourceDataPtr) {
       return;
     }
 
-    // First go to the second chunk in the file and re-read the chunk length
-    if(fseek(extraData->fileHandle, 12, SEEK_SET) != 0) {
-      logError("Could not seek to second chunk during WAVE file finalization");
-      fclose(extraData->fileHandle);
-      return;
-    }
-    chunk = newRiffChunk();
-    if(!riffChunkReadNext(extraData->fileHandle, chunk, false)) {
-      logError("Could not read RIFF chunk during WAVE file finalization");
-      fclose(extraData->fileHandle);
-      freeRiffChunk(chunk);
-      return;
-    }
-
-    // Go to the next chunk, and then skip the type and write the new length
-    if(fseek(extraData->fileHandle, chunk->size + 4, SEEK_CUR) != 0) {
-      logError("Could not seek to next chunk during WAVE file finalization");
-      fclose(extraData->fileHandle);
-      freeRiffChunk(chunk);
-      return;
-    }
-    numBytesWritten = sampleSource->numSamplesProcessed * extraData->bitsPerSample / 8;
-    if(fwrite(&numBytesWritten, sizeof(unsigned int), 1, extraData->fileHandle) != 1) {
-      logError("Could not write WAVE file size during finalization");
-      fclose(extraData->fileHandle);
-      freeRiffChunk(chunk);
-      return;
-    }
-
-    // Add 40 bytes for fmt chunk size and write the RIFF chunk size
-    numBytesWritten += ftell(extraData->fileHandle) - 8;
-    if(fseek(extraData->fileHandle, 4, SEEK_SET) != 0) {
-      logError("Could not seek to fmt chunk during WAVE file finalization");
-      fclose(extraData->fileHandle);
-      freeRiffChunk(chunk);
-      return;
+    _finalizeWaveFile(sampleSource, extraData);
+    fflush(extraData->fileHandle);
+    fclose(extraData->fileHandle);
+  }
+  else if(sampleSource->openedAs == SAMPLE_SOURCE_OPEN_READ) {
+    if(extraData->mappedFile != NULL) {
+      mappedFileClose(extraData->mappedFile);
     }
-    if(fwrite(&numBytesWritten, sizeof(unsigned int), 1, extraData->fileHandle) != 1) {
-      logError("Could not write WAVE file size in fmt chunk during finalization");
+    if(extraData->fileHandle != NULL) {
       fclose(extraData->fileHandle);
-      freeRiffChunk(chunk);
-      return;
+      extraData->fileHandle = NULL;
     }
-    fflush(extraData->fileHandle);
-    fclose(extraData->fileHandle);
-    freeRiffChunk(chunk);
   }
 #endif
 }
@@ -414,6 +475,8 @@ SampleSource newSampleSourceWave(const CharString sampleSourceName) {
   sampleSource->sourceName = newCharString();
   charStringCopy(sampleSource->sourceName, sampleSourceName);
   sampleSource->numSamplesProcessed = 0;
+  sampleSource->numBytesProcessed = 0;
+  sampleSource->context = getMrsWatsonContext();
 
   sampleSource->openSampleSource = _openSampleSourceWave;
 #if HAVE_LIBAUDIOFILE
@@ -438,10 +501,16 @@ SampleSource newSampleSourceWave(const CharString sampleSourceName) {
   extraData->fileHandle = NULL;
   extraData->dataBufferNumItems = 0;
   extraData->interlacedPcmDataBuffer = NULL;
+  extraData->mappedFile = NULL;
+  extraData->mappedDataPosition = 0;
+  extraData->mappedDataEnd = 0;
+  extraData->stream = NULL;
+  extraData->streamBufferSizeInMs = 0;
+  extraData->streamPolicy = kPcmStreamPolicyWait;
 
   extraData->numChannels = (unsigned short)getNumChannels();
   extraData->sampleRate = (unsigned int)getSampleRate();
-  extraData->bitsPerSample = 16;
+  extraData->sampleFormat = kSampleFormatInt16;
 #endif
 
   sampleSource->extraData = extraData;
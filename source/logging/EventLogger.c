@@ -49,7 +49,32 @@
 #include <unistd.h>
 #endif
 
+// Formatted messages longer than this are truncated
+#define LOG_MESSAGE_MAX_LENGTH 256
+// Room for the message plus the level, time and color prefixes of a log line
+#define LOG_LINE_MAX_LENGTH (LOG_MESSAGE_MAX_LENGTH + 128)
+
+// Number of messages which can wait for the async log thread before new
+// messages are dropped, how often the thread checks for new messages, and
+// the most it writes at once
+#define ASYNC_LOG_QUEUE_CAPACITY 4096
+#define ASYNC_LOG_POLL_INTERVAL_MS 10
+#define ASYNC_LOG_BATCH_SIZE (64 * LOG_LINE_MAX_LENGTH)
+// How long to wait for queued messages before writing a critical error
+#define ASYNC_LOG_FLUSH_TIMEOUT_MS 1000
+
+// A record with this level tells the async log thread to exit
+#define ASYNC_LOG_STOP_LEVEL NUM_LOG_LEVELS
+
+typedef struct {
+  LogLevel logLevel;
+  long elapsedTimeInMs;
+  long numFramesProcessed;
+  char message[LOG_MESSAGE_MAX_LENGTH];
+} AsyncLogRecord;
+
 EventLogger eventLoggerInstance = NULL;
+static THREAD_LOCAL EventLogger threadEventLogger = NULL;
 
 void initEventLogger(void) {
 #if WINDOWS
@@ -64,6 +89,8 @@ void initEventLogger(void) {
   eventLoggerInstance->useColor = false;
   eventLoggerInstance->zebraStripeSize = (long)DEFAULT_SAMPLE_RATE;
   eventLoggerInstance->systemErrorMessage = NULL;
+  eventLoggerInstance->asyncQueue = NULL;
+  eventLoggerInstance->asyncThread = NULL;
 
 #if WINDOWS
   currentTime = GetTickCount();
@@ -81,7 +108,15 @@ void initEventLogger(void) {
 }
 
 static EventLogger _getEventLoggerInstance(void) {
-  return eventLoggerInstance;
+  return threadEventLogger != NULL ? threadEventLogger : eventLoggerInstance;
+}
+
+EventLogger getEventLogger(void) {
+  return _getEventLoggerInstance();
+}
+
+void setThreadEventLogger(EventLogger eventLogger) {
+  threadEventLogger = eventLogger;
 }
 
 void fillVersionString(CharString outString) {
@@ -111,6 +146,11 @@ boolByte isLogLevelAtLeast(LogLevel logLevel) {
   return (eventLogger->logLevel >= logLevel);
 }
 
+boolByte isLogLevelEnabled(const LogLevel logLevel) {
+  EventLogger eventLogger = _getEventLoggerInstance();
+  return (boolByte)(eventLogger != NULL && logLevel >= eventLogger->logLevel);
+}
+
 void setLogLevel(LogLevel logLevel) {
   EventLogger eventLogger = _getEventLoggerInstance();
   eventLogger->logLevel = logLevel;
@@ -204,72 +244,223 @@ static LogColor _logTimeZebraStripeColor(const long elapsedTime, const int zebra
 }
 
 static void _printMessage(const LogLevel logLevel, const long elapsedTimeInMs, const long numFramesProcessed, const char* message, const EventLogger eventLogger) {
-  char* logString = (char*)malloc(sizeof(char) * kCharStringLengthLong);
+  char logString[LOG_LINE_MAX_LENGTH];
   if(eventLogger->useColor) {
-    snprintf(logString, kCharStringLengthLong, "%c ", _logLevelStatusChar(logLevel));
+    snprintf(logString, LOG_LINE_MAX_LENGTH, "%c ", _logLevelStatusChar(logLevel));
     printToLog(_logLevelStatusColor(logLevel), eventLogger->logFile, logString);
-    snprintf(logString, kCharStringLengthLong, "%08ld ", numFramesProcessed);
+    snprintf(logString, LOG_LINE_MAX_LENGTH, "%08ld ", numFramesProcessed);
     printToLog(_logTimeZebraStripeColor(numFramesProcessed, eventLogger->zebraStripeSize),
       eventLogger->logFile, logString);
-    snprintf(logString, kCharStringLengthLong, "%06ld ", elapsedTimeInMs);
+    snprintf(logString, LOG_LINE_MAX_LENGTH, "%06ld ", elapsedTimeInMs);
     printToLog(_logTimeColor(), eventLogger->logFile, logString);
     printToLog(_logLevelStatusColor(logLevel), eventLogger->logFile, message);
   }
   else {
-    snprintf(logString, kCharStringLengthLong, "%c %08ld %06ld %s", _logLevelStatusChar(logLevel), numFramesProcessed, elapsedTimeInMs, message);
+    snprintf(logString, LOG_LINE_MAX_LENGTH, "%c %08ld %06ld %s", _logLevelStatusChar(logLevel), numFramesProcessed, elapsedTimeInMs, message);
     printToLog(COLOR_RESET, eventLogger->logFile, logString);
   }
   flushLog(eventLogger->logFile);
-  free(logString);
 }
 
-static void _logMessage(const LogLevel logLevel, const char* message, va_list arguments) {
-  long elapsedTimeInMs;
+static size_t _formatAsyncLogLine(char* outLine, const size_t outLineLength, const AsyncLogRecord* record, const EventLogger eventLogger) {
+  int lineLength;
+
+#if UNIX
+  // Windows colors are console attributes rather than text, so async log lines
+  // are only colored on Unix
+  if(eventLogger->useColor && eventLogger->logFile == NULL) {
+    lineLength = snprintf(outLine, outLineLength, "%s%c %s%s%08ld %s%s%06ld %s%s%s%s\n",
+      _logLevelStatusColor(record->logLevel), _logLevelStatusChar(record->logLevel), COLOR_RESET,
+      _logTimeZebraStripeColor(record->numFramesProcessed, eventLogger->zebraStripeSize), record->numFramesProcessed, COLOR_RESET,
+      _logTimeColor(), record->elapsedTimeInMs, COLOR_RESET,
+      _logLevelStatusColor(record->logLevel), record->message, COLOR_RESET);
+  }
+  else
+#endif
+  {
+    lineLength = snprintf(outLine, outLineLength, "%c %08ld %06ld %s\n", _logLevelStatusChar(record->logLevel),
+      record->numFramesProcessed, record->elapsedTimeInMs, record->message);
+  }
+
+  if(lineLength < 0) {
+    return 0;
+  }
+  // Truncated lines still fill the whole buffer, minus the terminator
+  return (size_t)lineLength < outLineLength ? (size_t)lineLength : outLineLength - 1;
+}
+
+static void* _asyncLogThreadFunc(void* eventLoggerPtr) {
+  EventLogger eventLogger = (EventLogger)eventLoggerPtr;
+  FILE* output = eventLogger->logFile != NULL ? eventLogger->logFile : stderr;
+  char* batch = (char*)malloc(ASYNC_LOG_BATCH_SIZE);
+  AsyncLogRecord* record;
+  unsigned long numRecords;
+  size_t batchLength;
+  boolByte shouldStop = false;
+
+  while(!shouldStop) {
+    numRecords = 0;
+    batchLength = 0;
+    while(ASYNC_LOG_BATCH_SIZE - batchLength >= LOG_LINE_MAX_LENGTH) {
+      record = (AsyncLogRecord*)recordQueuePeek(eventLogger->asyncQueue, numRecords);
+      if(record == NULL) {
+        break;
+      }
+      else if(record->logLevel == ASYNC_LOG_STOP_LEVEL) {
+        shouldStop = true;
+        break;
+      }
+      batchLength += _formatAsyncLogLine(batch + batchLength, ASYNC_LOG_BATCH_SIZE - batchLength, record, eventLogger);
+      numRecords++;
+    }
+
+    if(numRecords > 0) {
+      fwrite(batch, 1, batchLength, output);
+      fflush(output);
+      // Release the records only once they are written, since that is what
+      // callers waiting for the queue to be flushed want to know
+      recordQueueRelease(eventLogger->asyncQueue, numRecords);
+    }
+    else if(!shouldStop) {
+      threadSleep(ASYNC_LOG_POLL_INTERVAL_MS);
+    }
+  }
+
+  free(batch);
+  return NULL;
+}
+
+static void _waitForAsyncLog(const EventLogger eventLogger) {
+  unsigned long numQueuedRecords;
+  int i;
+
+  if(eventLogger == NULL || eventLogger->asyncQueue == NULL) {
+    return;
+  }
+  numQueuedRecords = recordQueueGetNumReserved(eventLogger->asyncQueue);
+  // The wait is bounded, since this may be called when the log thread is stuck
+  for(i = 0; i < ASYNC_LOG_FLUSH_TIMEOUT_MS; i++) {
+    if((long)(recordQueueGetNumReleased(eventLogger->asyncQueue) - numQueuedRecords) >= 0) {
+      break;
+    }
+    threadSleep(1);
+  }
+}
+
+void startAsyncLogging(void) {
   EventLogger eventLogger = _getEventLoggerInstance();
+
+  if(eventLogger == NULL || eventLogger->asyncQueue != NULL) {
+    return;
+  }
+  eventLogger->asyncQueue = newRecordQueue(ASYNC_LOG_QUEUE_CAPACITY, sizeof(AsyncLogRecord));
+  eventLogger->asyncThread = newThread(_asyncLogThreadFunc, eventLogger);
+  if(!threadStart(eventLogger->asyncThread)) {
+    freeThread(eventLogger->asyncThread);
+    freeRecordQueue(eventLogger->asyncQueue);
+    eventLogger->asyncThread = NULL;
+    eventLogger->asyncQueue = NULL;
+    logWarn("Could not start log thread, logging synchronously");
+  }
+}
+
+static void _stopAsyncLogging(EventLogger eventLogger) {
+  AsyncLogRecord* record;
+  unsigned long numDroppedMessages;
+  unsigned long numStopAttempts = 0;
+
+  if(eventLogger == NULL || eventLogger->asyncQueue == NULL) {
+    return;
+  }
+  // The thread writes everything queued before the stop record, then exits
+  while((record = (AsyncLogRecord*)recordQueueReserve(eventLogger->asyncQueue)) == NULL) {
+    numStopAttempts++;
+    threadSleep(1);
+  }
+  record->logLevel = ASYNC_LOG_STOP_LEVEL;
+  recordQueuePublish(eventLogger->asyncQueue, record);
+  threadJoin(eventLogger->asyncThread);
+
+  numDroppedMessages = recordQueueGetNumFailedReservations(eventLogger->asyncQueue) - numStopAttempts;
+  freeThread(eventLogger->asyncThread);
+  freeRecordQueue(eventLogger->asyncQueue);
+  eventLogger->asyncThread = NULL;
+  eventLogger->asyncQueue = NULL;
+
+  if(numDroppedMessages > 0) {
+    logWarn("Dropped %lu log messages because they were logged faster than they could be written", numDroppedMessages);
+  }
+}
+
+void stopAsyncLogging(void) {
+  _stopAsyncLogging(_getEventLoggerInstance());
+}
+
+static long _getElapsedTimeInMs(const EventLogger eventLogger) {
 #if WINDOWS
-  ULONGLONG currentTime;
+  ULONGLONG currentTime = GetTickCount();
+  return (long)(currentTime - eventLogger->startTimeInMs);
 #else
   struct timeval currentTime;
+  gettimeofday(&currentTime, NULL);
+  return ((currentTime.tv_sec - (eventLogger->startTimeInSec + 1)) * 1000) +
+    (currentTime.tv_usec / 1000) + (1000 - eventLogger->startTimeInMs);
 #endif
+}
 
-  if(eventLogger != NULL && logLevel >= eventLogger->logLevel) {
-    CharString formattedMessage = newCharString();
-    vsnprintf(formattedMessage->data, formattedMessage->length, message, arguments);
-#if WINDOWS
-    currentTime = GetTickCount();
-    elapsedTimeInMs = (unsigned long)(currentTime - eventLogger->startTimeInMs);
-#else
-    gettimeofday(&currentTime, NULL);
-    elapsedTimeInMs = ((currentTime.tv_sec - (eventLogger->startTimeInSec + 1)) * 1000) +
-      (currentTime.tv_usec / 1000) + (1000 - eventLogger->startTimeInMs);
-#endif
-    _printMessage(logLevel, elapsedTimeInMs, getAudioClock()->currentFrame, formattedMessage->data, eventLogger);
-    freeCharString(formattedMessage);
+static void _logMessage(const LogLevel logLevel, const char* message, va_list arguments) {
+  EventLogger eventLogger = _getEventLoggerInstance();
+  AudioClock audioClock;
+  AsyncLogRecord* record;
+  char formattedMessage[LOG_MESSAGE_MAX_LENGTH];
+  long numFramesProcessed;
+
+  if(eventLogger == NULL || logLevel < eventLogger->logLevel) {
+    return;
+  }
+  // Programs which embed MrsWatson may log without having a clock
+  audioClock = getAudioClock();
+  numFramesProcessed = audioClock != NULL ? (long)audioClock->currentFrame : 0;
+
+  if(eventLogger->asyncQueue != NULL) {
+    // Format directly into the queue, so no memory is allocated or copied
+    record = (AsyncLogRecord*)recordQueueReserve(eventLogger->asyncQueue);
+    if(record != NULL) {
+      record->logLevel = logLevel;
+      record->elapsedTimeInMs = _getElapsedTimeInMs(eventLogger);
+      record->numFramesProcessed = numFramesProcessed;
+      vsnprintf(record->message, LOG_MESSAGE_MAX_LENGTH, message, arguments);
+      recordQueuePublish(eventLogger->asyncQueue, record);
+    }
+  }
+  else {
+    vsnprintf(formattedMessage, LOG_MESSAGE_MAX_LENGTH, message, arguments);
+    _printMessage(logLevel, _getElapsedTimeInMs(eventLogger), numFramesProcessed, formattedMessage, eventLogger);
   }
 }
 
-void logDebug(const char* message, ...) {
+void logDebugMessage(const char* message, ...) {
   va_list arguments;
   va_start(arguments, message);
   _logMessage(LOG_DEBUG, message, arguments);
   va_end(arguments);
 }
 
-void logInfo(const char* message, ...) {
+void logInfoMessage(const char* message, ...) {
   va_list arguments;
   va_start(arguments, message);
   _logMessage(LOG_INFO, message, arguments);
   va_end(arguments);
 }
 
-void logWarn(const char* message, ...) {
+void logWarnMessage(const char* message, ...) {
   va_list arguments;
   va_start(arguments, message);
   _logMessage(LOG_WARN, message, arguments);
   va_end(arguments);
 }
 
-void logError(const char* message, ...) {
+void logErrorMessage(const char* message, ...) {
   va_list arguments;
   va_start(arguments, message);
   _logMessage(LOG_ERROR, message, arguments);
@@ -281,6 +472,8 @@ void logCritical(const char* message, ...) {
   CharString formattedMessage = newCharString();
   CharString wrappedMessage;
 
+  // Keep the error after any messages which were logged before it
+  _waitForAsyncLog(eventLoggerInstance);
   va_start(arguments, message);
   // Instead of going through the common logging method, we always dump critical
   // messages to stderr
@@ -300,6 +493,7 @@ void logInternalError(const char* message, ...) {
   va_list arguments;
   CharString formattedMessage = newCharString();
 
+  _waitForAsyncLog(eventLoggerInstance);
   va_start(arguments, message);
   // Instead of going through the common logging method, we always dump critical messages to stderr
   vsnprintf(formattedMessage->data, formattedMessage->length, message, arguments);
@@ -349,12 +543,14 @@ generate a diagnostic report to send to support.");
 }
 
 void flushErrorLog(void) {
+  _waitForAsyncLog(eventLoggerInstance);
   if(eventLoggerInstance != NULL && eventLoggerInstance->logFile != NULL) {
     fflush(eventLoggerInstance->logFile);
   }
 }
 
 void freeEventLogger(void) {
+  _stopAsyncLogging(eventLoggerInstance);
   if(eventLoggerInstance->logFile != NULL) {
     fclose(eventLoggerInstance->logFile);
   }
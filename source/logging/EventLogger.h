@@ -32,6 +32,8 @@
 #include <stdio.h>
 
 #include "base/CharString.h"
+#include "base/RecordQueue.h"
+#include "base/Thread.h"
 #include "base/Types.h"
 
 typedef enum {
@@ -50,17 +52,42 @@ typedef struct {
   unsigned long zebraStripeSize;
   FILE *logFile;
   CharString systemErrorMessage;
+
+  // Only used when logging asynchronously, see startAsyncLogging()
+  RecordQueue asyncQueue;
+  Thread asyncThread;
 } EventLoggerMembers;
 typedef EventLoggerMembers* EventLogger;
 extern EventLogger eventLoggerInstance;
 
 void initEventLogger(void);
 
+/**
+ * Get the logger used by the calling thread, which is the global instance
+ * unless setThreadEventLogger() was called from this thread.
+ * @return Event logger for this thread
+ */
+EventLogger getEventLogger(void);
+
+/**
+ * Use another logger than the global one for the calling thread
+ * @param eventLogger Logger to use, or NULL to use the global logger again
+ */
+void setThreadEventLogger(EventLogger eventLogger);
+
 // TODO: Move elsewhere? PlatformUtilities maybe?
 void fillVersionString(CharString outString);
 char* stringForLastError(int errorNumber);
 
 boolByte isLogLevelAtLeast(LogLevel logLevel);
+
+/**
+ * Check if messages of a given level would be written, which is much cheaper
+ * than formatting a message only to throw it away.
+ * @param logLevel Level of the message
+ * @return True if the calling thread's logger writes messages of this level
+ */
+boolByte isLogLevelEnabled(const LogLevel logLevel);
 void setLogLevel(LogLevel logLevel);
 void setLogLevelFromString(const CharString logLevelString);
 void setLogFile(const CharString logFileName);
@@ -68,10 +95,51 @@ void setLoggingColorEnabled(boolByte useColor);
 void setLoggingColorEnabledWithString(const CharString colorSchemeName);
 void setLoggingZebraSize(const unsigned long zebraStripeSize);
 
-void logDebug(const char* message, ...);
-void logInfo(const char* message, ...);
-void logWarn(const char* message, ...);
-void logError(const char* message, ...);
+/**
+ * Write log messages from a background thread rather than the thread which
+ * logs them. Messages are queued without locking or allocating memory, and
+ * the background thread writes them in batches, so even debug logging does
+ * not slow down processing much. If the queue fills up faster than it can be
+ * written, messages are dropped rather than blocking the caller, and the
+ * number of dropped messages is reported when async logging stops.
+ *
+ * Critical errors are still written immediately, after any queued messages.
+ * Must be called before any other threads start logging.
+ */
+void startAsyncLogging(void);
+
+/**
+ * Write all queued messages and go back to logging synchronously. No other
+ * threads may be logging when this is called. Does nothing if async logging
+ * was not started.
+ */
+void stopAsyncLogging(void);
+
+void logDebugMessage(const char* message, ...);
+void logInfoMessage(const char* message, ...);
+void logWarnMessage(const char* message, ...);
+void logErrorMessage(const char* message, ...);
+
+/**
+ * Messages below this level are removed at compile time, so that neither the
+ * logging call nor its arguments cost anything. The default keeps all messages.
+ */
+#ifndef MIN_COMPILED_LOG_LEVEL
+#define MIN_COMPILED_LOG_LEVEL 0
+#endif
+
+// The level is checked before the arguments are evaluated, so log calls in the
+// processing loop are cheap when their level is disabled
+#define _logIfEnabled(logLevel, logFunction, ...) do { \
+  if((logLevel) >= MIN_COMPILED_LOG_LEVEL && isLogLevelEnabled(logLevel)) { \
+    logFunction(__VA_ARGS__); \
+  } \
+} while(0)
+
+#define logDebug(...) _logIfEnabled(LOG_DEBUG, logDebugMessage, __VA_ARGS__)
+#define logInfo(...) _logIfEnabled(LOG_INFO, logInfoMessage, __VA_ARGS__)
+#define logWarn(...) _logIfEnabled(LOG_WARN, logWarnMessage, __VA_ARGS__)
+#define logError(...) _logIfEnabled(LOG_ERROR, logErrorMessage, __VA_ARGS__)
 
 void logCritical(const char* message, ...);
 void logInternalError(const char* message, ...);
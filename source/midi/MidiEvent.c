@@ -40,6 +40,7 @@ MidiEvent newMidiEvent(void) {
   midiEvent->data1 = 0;
   midiEvent->data2 = 0;
   midiEvent->extraData = NULL;
+  midiEvent->extraDataLength = 0;
 
   return midiEvent;
 }
@@ -28,6 +28,8 @@
 #ifndef MrsWatson_MidiEvent_h
 #define MrsWatson_MidiEvent_h
 
+#include <stddef.h>
+
 #include "base/Types.h"
 
 typedef enum {
@@ -46,6 +48,7 @@ typedef struct {
   byte data1;
   byte data2;
   byte* extraData;
+  size_t extraDataLength;
 } MidiEventMembers;
 
 
@@ -63,6 +66,9 @@ typedef struct {
 #define MIDI_META_TYPE_TIME_SIGNATURE 0x58
 #define MIDI_META_TYPE_TRACK_END 0x2f
 
+// Tempo events hold the beat length in microseconds as a 24-bit number
+#define MIDI_META_TEMPO_LENGTH 3
+
 typedef MidiEventMembers* MidiEvent;
 
 MidiEvent newMidiEvent(void);
@@ -114,14 +114,22 @@ static boolByte _readMidiFileHeader(FILE *midiFile, unsigned short *formatType,
   return true;
 }
 
-static boolByte _readMidiFileTrack(FILE *midiFile, const int trackNumber,
-  const int timeDivision, const MidiFileTimeDivisionType divisionType,
-  MidiSequence midiSequence) {
+static boolByte _hasMidiTrackBytes(const byte* currentByte, const byte* endByte,
+  const size_t numBytes, const int trackNumber) {
+  if((size_t)(endByte - currentByte) < numBytes) {
+    logError("MIDI file track %d ends in the middle of an event", trackNumber);
+    return false;
+  }
+  return true;
+}
+
+static boolByte _readMidiFileTrack(FILE *midiFile, const int trackNumber, MidiSequence trackSequence) {
   unsigned int numBytesBuffer;
   byte *trackData, *currentByte, *endByte;
   size_t itemsRead, numBytes;
-  unsigned long currentTimeInSampleFrames = 0;
+  unsigned long currentTimeInTicks = 0;
   unsigned long unpackedVariableLength;
+  byte runningStatus = 0;
   MidiEvent midiEvent;
   unsigned int i;
 
@@ -142,6 +150,7 @@ static boolByte _readMidiFileTrack(FILE *midiFile, const int trackNumber,
   itemsRead = fread(trackData, 1, numBytes, midiFile);
   if(itemsRead != numBytes) {
     logError("Short read of MIDI file (at track %d)", trackNumber);
+    free(trackData);
     return false;
   }
 
@@ -153,57 +162,82 @@ static boolByte _readMidiFileTrack(FILE *midiFile, const int trackNumber,
     if(unpackedVariableLength & 0x80) {
       unpackedVariableLength &= 0x7f;
       do {
-        unpackedVariableLength = (unpackedVariableLength << 7) + (*(++currentByte) & 0x7f);
+        if(!_hasMidiTrackBytes(++currentByte, endByte, 1, trackNumber)) {
+          free(trackData);
+          return false;
+        }
+        unpackedVariableLength = (unpackedVariableLength << 7) + (*currentByte & 0x7f);
       } while(*currentByte & 0x80);
     }
+    // Event times are kept in ticks here, they are converted to sample frames
+    // after all tracks have been merged and the tempo map is known.
+    currentTimeInTicks += unpackedVariableLength;
 
     currentByte++;
+    if(!_hasMidiTrackBytes(currentByte, endByte, 1, trackNumber)) {
+      free(trackData);
+      return false;
+    }
+
     midiEvent = newMidiEvent();
+    midiEvent->timestamp = currentTimeInTicks;
     switch(*currentByte) {
       case 0xff:
         midiEvent->eventType = MIDI_TYPE_META;
         currentByte++;
+        // Type and length bytes, followed by the data
+        if(!_hasMidiTrackBytes(currentByte, endByte, 2, trackNumber)) {
+          freeMidiEvent(midiEvent);
+          free(trackData);
+          return false;
+        }
         midiEvent->status = *(currentByte++);
         numBytes = *(currentByte++);
+        if(!_hasMidiTrackBytes(currentByte, endByte, numBytes, trackNumber)) {
+          freeMidiEvent(midiEvent);
+          free(trackData);
+          return false;
+        }
         midiEvent->extraData = (byte*)malloc(numBytes);
+        midiEvent->extraDataLength = numBytes;
         for(i = 0; i < numBytes; i++) {
           midiEvent->extraData[i] = *(currentByte++);
         }
         break;
-      case 0x7f:
+      case 0xf0:
+      case 0xf7:
         logUnsupportedFeature("Parsing MIDI sysex events from file");
+        free(midiEvent);
+        free(trackData);
         return false;
       default:
         midiEvent->eventType = MIDI_TYPE_REGULAR;
-        midiEvent->status = *currentByte++;
-        midiEvent->data1 = *currentByte++;
+        // Events without a status byte reuse the status of the previous event
+        // (running status), which most sequencers use when writing files.
+        if(*currentByte & 0x80) {
+          runningStatus = *currentByte++;
+        }
+        else if(runningStatus == 0) {
+          logError("MIDI file track %d has data without a status byte", trackNumber);
+          free(midiEvent);
+          free(trackData);
+          return false;
+        }
+        midiEvent->status = runningStatus;
         // All regular MIDI events have 3 bytes except for program change and channel aftertouch
-        if(!((midiEvent->status & 0xf0) == 0xc0 || (midiEvent->status & 0xf0) == 0xd0)) {
+        numBytes = ((midiEvent->status & 0xf0) == 0xc0 || (midiEvent->status & 0xf0) == 0xd0) ? 1 : 2;
+        if(!_hasMidiTrackBytes(currentByte, endByte, numBytes, trackNumber)) {
+          free(midiEvent);
+          free(trackData);
+          return false;
+        }
+        midiEvent->data1 = *currentByte++;
+        if(numBytes > 1) {
           midiEvent->data2 = *currentByte++;
         }
         break;
     }
 
-    switch(divisionType) {
-      case TIME_DIVISION_TYPE_TICKS_PER_BEAT:
-      {
-        // TODO: If the time signature is not 4/4, this calculation will be wrong
-        double ticksPerSecond = (double)timeDivision * getTempo() / 60.0;
-        double sampleFramesPerTick = getSampleRate() / ticksPerSecond;
-        currentTimeInSampleFrames += (long)(unpackedVariableLength * sampleFramesPerTick);
-      }
-        break;
-      case TIME_DIVISION_TYPE_FRAMES_PER_SECOND:
-        // Actually, this should be caught when parsing the file type
-        logUnsupportedFeature("Time division frames/sec");
-        return false;
-      case TIME_DIVISION_TYPE_INVALID:
-      default:
-        logInternalError("Invalid time division type");
-        return false;
-    }
-
-    midiEvent->timestamp = currentTimeInSampleFrames;
     if(midiEvent->eventType == MIDI_TYPE_META) {
       switch(midiEvent->status) {
         case MIDI_META_TYPE_TEXT:
@@ -215,22 +249,32 @@ static boolByte _readMidiFileTrack(FILE *midiFile, const int trackNumber,
         case MIDI_META_TYPE_CUE_POINT:
         case MIDI_META_TYPE_PROGRAM_NAME:
         case MIDI_META_TYPE_DEVICE_NAME:
-          logDebug("Ignoring MIDI meta event of type 0x%x at %ld", midiEvent->status, midiEvent->timestamp);
+          logDebug("Ignoring MIDI meta event of type 0x%x at tick %ld", midiEvent->status, midiEvent->timestamp);
+          freeMidiEvent(midiEvent);
           break;
         case MIDI_META_TYPE_TEMPO:
+          if(midiEvent->extraDataLength != MIDI_META_TEMPO_LENGTH) {
+            logError("MIDI file track %d has a tempo event with %lu bytes at tick %ld",
+              trackNumber, (unsigned long)midiEvent->extraDataLength, midiEvent->timestamp);
+            freeMidiEvent(midiEvent);
+            free(trackData);
+            return false;
+          }
+          // fall through
         case MIDI_META_TYPE_TIME_SIGNATURE:
         case MIDI_META_TYPE_TRACK_END:
-          logDebug("Parsed MIDI meta event of type 0x%02x at %ld", midiEvent->status, midiEvent->timestamp);
-          appendMidiEventToSequence(midiSequence, midiEvent);
+          logDebug("Parsed MIDI meta event of type 0x%02x at tick %ld", midiEvent->status, midiEvent->timestamp);
+          appendMidiEventToSequence(trackSequence, midiEvent);
           break;
         default:
-          logWarn("Ignoring MIDI meta event of type 0x%x at %ld", midiEvent->status, midiEvent->timestamp);
+          logWarn("Ignoring MIDI meta event of type 0x%x at tick %ld", midiEvent->status, midiEvent->timestamp);
+          freeMidiEvent(midiEvent);
           break;
       }
     }
     else {
-      logDebug("MIDI event of type 0x%02x parsed at %ld", midiEvent->status, midiEvent->timestamp);
-      appendMidiEventToSequence(midiSequence, midiEvent);
+      logDebug("MIDI event of type 0x%02x parsed at tick %ld", midiEvent->status, midiEvent->timestamp);
+      appendMidiEventToSequence(trackSequence, midiEvent);
     }
   }
 
@@ -238,17 +282,86 @@ static boolByte _readMidiFileTrack(FILE *midiFile, const int trackNumber,
   return true;
 }
 
+static double _getSampleFramesPerTick(const unsigned long beatLengthInMicroseconds, const int timeDivision) {
+  return getSampleRate() * (double)beatLengthInMicroseconds / 1000000.0 / (double)timeDivision;
+}
+
+/**
+ * Merge the events of all tracks into one sequence, ordered by tick. Events at
+ * the same tick are taken from the lower track first, so that tempo changes on
+ * the conductor track (track 0 in type 1 files) apply to all notes at that
+ * tick. Tick times are converted to sample frames while merging, following the
+ * tempo changes in the merged order.
+ */
+static void _mergeMidiFileTracks(MidiSequence* tracks, const int numTracks,
+  const int timeDivision, MidiSequence midiSequence) {
+  unsigned long* trackPositions = (unsigned long*)calloc((size_t)numTracks, sizeof(unsigned long));
+  unsigned long beatLengthInMicroseconds = (unsigned long)(60000000.0 / getTempo());
+  double sampleFramesPerTick = _getSampleFramesPerTick(beatLengthInMicroseconds, timeDivision);
+  double currentTimeInSampleFrames = 0.0;
+  unsigned long lastTick = 0;
+  int numTracksEnded = 0;
+  MidiEventMembers* trackEvent;
+  MidiEvent midiEvent;
+  int nextTrack;
+  int track;
+
+  while(true) {
+    nextTrack = -1;
+    for(track = 0; track < numTracks; track++) {
+      if(trackPositions[track] < tracks[track]->numMidiEvents &&
+         (nextTrack < 0 || tracks[track]->midiEvents[trackPositions[track]].timestamp <
+          tracks[nextTrack]->midiEvents[trackPositions[nextTrack]].timestamp)) {
+        nextTrack = track;
+      }
+    }
+    if(nextTrack < 0) {
+      break;
+    }
+
+    trackEvent = &(tracks[nextTrack]->midiEvents[trackPositions[nextTrack]++]);
+    currentTimeInSampleFrames += (double)(trackEvent->timestamp - lastTick) * sampleFramesPerTick;
+    lastTick = trackEvent->timestamp;
+
+    if(trackEvent->eventType == MIDI_TYPE_META) {
+      if(trackEvent->status == MIDI_META_TYPE_TEMPO && trackEvent->extraDataLength == MIDI_META_TEMPO_LENGTH) {
+        beatLengthInMicroseconds = (unsigned long)((trackEvent->extraData[0] << 16) |
+          (trackEvent->extraData[1] << 8) | trackEvent->extraData[2]);
+        if(beatLengthInMicroseconds > 0) {
+          sampleFramesPerTick = _getSampleFramesPerTick(beatLengthInMicroseconds, timeDivision);
+        }
+      }
+      // Every track has its own end marker, but reading stops at the first
+      // one, so only the end of the last track to finish is kept.
+      else if(trackEvent->status == MIDI_META_TYPE_TRACK_END && ++numTracksEnded < numTracks) {
+        continue;
+      }
+    }
+
+    // The merged sequence takes over the event's data
+    midiEvent = newMidiEvent();
+    *midiEvent = *trackEvent;
+    midiEvent->timestamp = (unsigned long)currentTimeInSampleFrames;
+    trackEvent->extraData = NULL;
+    appendMidiEventToSequence(midiSequence, midiEvent);
+  }
+
+  free(trackPositions);
+}
+
 static boolByte _readMidiEventsFile(void* midiSourcePtr, MidiSequence midiSequence) {
   MidiSource midiSource = (MidiSource)midiSourcePtr;
   MidiSourceFileData extraData = (MidiSourceFileData)(midiSource->extraData);
   unsigned short formatType, numTracks, timeDivision = 0;
+  MidiSequence* tracks;
+  boolByte result = true;
   int track;
 
   if(!_readMidiFileHeader(extraData->fileHandle, &formatType, &numTracks, &timeDivision)) {
     return false;
   }
-  if(formatType != 0) {
-    logUnsupportedFeature("MIDI file types other than 0");
+  if(formatType > 1) {
+    logUnsupportedFeature("MIDI file types other than 0 or 1");
     return false;
   }
   else if(formatType == 0 && numTracks != 1) {
@@ -257,7 +370,7 @@ static boolByte _readMidiEventsFile(void* midiSourcePtr, MidiSequence midiSequen
   }
 
   // Determine time division type
-  if(timeDivision & 0x7fff) {
+  if(!(timeDivision & 0x8000)) {
     extraData->divisionType = TIME_DIVISION_TYPE_TICKS_PER_BEAT;
   }
   else {
@@ -265,17 +378,37 @@ static boolByte _readMidiEventsFile(void* midiSourcePtr, MidiSequence midiSequen
     logUnsupportedFeature("MIDI file with time division in frames/second");
     return false;
   }
+  if(timeDivision == 0) {
+    logError("MIDI file '%s' has a time division of zero", midiSource->sourceName->data);
+    return false;
+  }
 
   logDebug("MIDI file is type %d, has %d tracks, and time division %d (type %d)",
     formatType, numTracks, timeDivision, extraData->divisionType);
 
+  // Each track's events are timed in ticks relative to the start of the file,
+  // but the tempo changes which are needed to convert them to sample frames
+  // may be in another track. So all tracks are read first and then merged.
+  tracks = (MidiSequence*)malloc(sizeof(MidiSequence) * numTracks);
   for(track = 0; track < numTracks; track++) {
-    if(!_readMidiFileTrack(extraData->fileHandle, track, timeDivision, extraData->divisionType, midiSequence)) {
-      return false;
+    tracks[track] = newMidiSequence();
+  }
+  for(track = 0; track < numTracks; track++) {
+    if(!_readMidiFileTrack(extraData->fileHandle, track, tracks[track])) {
+      result = false;
+      break;
     }
   }
 
-  return true;
+  if(result) {
+    _mergeMidiFileTracks(tracks, numTracks, timeDivision, midiSequence);
+  }
+
+  for(track = 0; track < numTracks; track++) {
+    freeMidiSequence(tracks[track]);
+  }
+  free(tracks);
+  return result;
 }
 
 static void _freeMidiEventsFile(void *midiSourceDataPtr) {
@@ -131,3 +131,40 @@ void freePlugin(Plugin plugin) {
   freeCharString(plugin->pluginName);
   free(plugin);
 }
+
+void pluginClearOutputs(Plugin self, SampleBuffer outputs) {
+  unsigned int i;
+
+  if(!self->overwritesOutputs) {
+    sampleBufferClear(outputs);
+    return;
+  }
+  for(i = self->numOutputs; i < outputs->numChannels; i++) {
+    memset(outputs->samples[i], 0, sizeof(Sample) * outputs->blocksize);
+  }
+}
+
+PluginSnapshot newPluginSnapshot(const void* data, const size_t dataSize) {
+  PluginSnapshot snapshot = (PluginSnapshot)malloc(sizeof(PluginSnapshotMembers));
+
+  snapshot->dataSize = dataSize;
+  snapshot->data = NULL;
+  if(dataSize > 0) {
+    snapshot->data = malloc(dataSize);
+    if(data != NULL) {
+      memcpy(snapshot->data, data, dataSize);
+    }
+    else {
+      memset(snapshot->data, 0, dataSize);
+    }
+  }
+
+  return snapshot;
+}
+
+void freePluginSnapshot(PluginSnapshot self) {
+  if(self != NULL) {
+    free(self->data);
+    free(self);
+  }
+}
@@ -55,6 +55,17 @@ typedef enum {
   NUM_PLUGIN_SETTINGS
 } PluginSetting;
 
+/**
+ * Saved state of a plugin, which is only understood by the plugin that took
+ * it. Restoring a snapshot brings the plugin back to the same parameters and
+ * programs, which is much cheaper than loading the plugin and its preset again.
+ */
+typedef struct {
+  void* data;
+  size_t dataSize;
+} PluginSnapshotMembers;
+typedef PluginSnapshotMembers* PluginSnapshot;
+
 typedef boolByte (*OpenPluginFunc)(void* pluginPtr);
 typedef void (*PluginDisplayInfoFunc)(void* pluginPtr);
 typedef void (*PluginGetAbsolutePathFunc)(void* pluginPtr, CharString outPath);
@@ -62,6 +73,8 @@ typedef int (*PluginGetSettingFunc)(void*, PluginSetting pluginSetting);
 typedef void (*PluginProcessAudioFunc)(void* pluginPtr, SampleBuffer inputs, SampleBuffer outputs);
 typedef void (*PluginProcessMidiEventsFunc)(void* pluginPtr, LinkedList midiEvents);
 typedef void (*PluginSetParameterFunc)(void* pluginPtr, int index, float value);
+typedef PluginSnapshot (*PluginTakeSnapshotFunc)(void* pluginPtr);
+typedef boolByte (*PluginRestoreSnapshotFunc)(void* pluginPtr, const PluginSnapshot snapshot);
 typedef void (*PluginPrepareForProcessingFunc)(void* pluginPtr);
 typedef void (*ClosePluginFunc)(void* pluginPtr);
 typedef void (*FreePluginDataFunc)(void* pluginDataPtr);
@@ -73,6 +86,12 @@ typedef struct {
   CharString pluginLocation;
   unsigned int numInputs;
   unsigned int numOutputs;
+  // Set if processAudio() writes every frame of its output channels, so the
+  // host does not need to clear them first
+  boolByte overwritesOutputs;
+  // Set if processAudio() may be called with the same buffer as input and
+  // output. Only used for plugins which also overwrite their outputs.
+  boolByte canProcessInPlace;
 
   OpenPluginFunc open;
   PluginDisplayInfoFunc displayInfo;
@@ -81,6 +100,10 @@ typedef struct {
   PluginProcessAudioFunc processAudio;
   PluginProcessMidiEventsFunc processMidiEvents;
   PluginSetParameterFunc setParameter;
+  // Returns NULL if the plugin's state could not be saved
+  PluginTakeSnapshotFunc takeSnapshot;
+  // Must only be called with snapshots taken by the same plugin, while it is suspended
+  PluginRestoreSnapshotFunc restoreSnapshot;
   PluginPrepareForProcessingFunc prepareForProcessing;
   ClosePluginFunc closePlugin;
   FreePluginDataFunc freePluginData;
@@ -95,4 +118,28 @@ void _logPluginLocation(const CharString location, PluginInterfaceType interface
 Plugin newPlugin(PluginInterfaceType pluginInterfaceType, const CharString pluginName, const CharString pluginLocation);
 void freePlugin(Plugin plugin);
 
+/**
+ * Clear the parts of an output buffer which processAudio() does not write to.
+ * This is the whole buffer for plugins which do not overwrite their outputs,
+ * and otherwise only the channels past the plugin's output count.
+ * @param self
+ * @param outputs Output buffer for the plugin
+ */
+void pluginClearOutputs(Plugin self, SampleBuffer outputs);
+
+/**
+ * Create a new snapshot
+ * @param data Data to copy into the snapshot, or NULL to fill it with zeroes
+ * @param dataSize Size of the data in bytes, which may be 0 for plugins which
+ * have no state
+ * @return Snapshot instance
+ */
+PluginSnapshot newPluginSnapshot(const void* data, const size_t dataSize);
+
+/**
+ * Free a snapshot and its data
+ * @param self
+ */
+void freePluginSnapshot(PluginSnapshot self);
+
 #endif
@@ -36,8 +36,19 @@ PluginChain newPluginChain(void) {
   PluginChain pluginChain = (PluginChain)malloc(sizeof(PluginChainMembers));
 
   pluginChain->numPlugins = 0;
-  pluginChain->plugins = (Plugin*)malloc(sizeof(Plugin) * MAX_PLUGINS);
-  pluginChain->presets = (PluginPreset*)malloc(sizeof(PluginPreset) * MAX_PLUGINS);
+  pluginChain->capacity = PLUGIN_CHAIN_INITIAL_CAPACITY;
+  pluginChain->plugins = (Plugin*)malloc(sizeof(Plugin) * PLUGIN_CHAIN_INITIAL_CAPACITY);
+  pluginChain->presets = (PluginPreset*)malloc(sizeof(PluginPreset) * PLUGIN_CHAIN_INITIAL_CAPACITY);
+  pluginChain->snapshots = (PluginSnapshot*)calloc(PLUGIN_CHAIN_INITIAL_CAPACITY, sizeof(PluginSnapshot));
+  pluginChain->scratchBuffer = NULL;
+  pluginChain->groups = NULL;
+  pluginChain->numGroups = 0;
+  pluginChain->threadPool = NULL;
+  pluginChain->pipeline = NULL;
+  pluginChain->sandboxMode = kPluginSandboxModeNone;
+  pluginChain->sandboxes = NULL;
+  pluginChain->numSandboxes = 0;
+  pluginChain->context = getMrsWatsonContext();
 
   return pluginChain;
 }
@@ -46,113 +57,215 @@ boolByte pluginChainAppend(PluginChain self, Plugin plugin, PluginPreset preset)
   if(plugin == NULL) {
     return false;
   }
-  else if(self->numPlugins + 1 >= MAX_PLUGINS) {
-    logError("Could not add plugin '%s', maximum number reached", plugin->pluginName->data);
-    return false;
+
+  if(self->numPlugins == self->capacity) {
+    self->capacity *= 2;
+    self->plugins = (Plugin*)realloc(self->plugins, sizeof(Plugin) * self->capacity);
+    self->presets = (PluginPreset*)realloc(self->presets, sizeof(PluginPreset) * self->capacity);
+    self->snapshots = (PluginSnapshot*)realloc(self->snapshots, sizeof(PluginSnapshot) * self->capacity);
+    memset(self->snapshots + self->numPlugins, 0, sizeof(PluginSnapshot) * (self->capacity - self->numPlugins));
   }
-  else {
-    self->plugins[self->numPlugins] = plugin;
-    self->presets[self->numPlugins] = preset;
-    self->numPlugins++;
-    return true;
+  self->plugins[self->numPlugins] = plugin;
+  self->presets[self->numPlugins] = preset;
+  self->numPlugins++;
+  return true;
+}
+
+static PluginChainGroup _newPluginChainGroup(const int firstPlugin) {
+  PluginChainGroup group = (PluginChainGroup)malloc(sizeof(PluginChainGroupMembers));
+
+  group->branchStarts = (int*)malloc(sizeof(int));
+  group->branchStarts[0] = firstPlugin;
+  group->numBranches = 0;
+  group->inputs = NULL;
+  group->outputs = NULL;
+  group->scratchBuffers = NULL;
+  group->taskTimers = NULL;
+
+  return group;
+}
+
+static void _freePluginChainGroup(PluginChainGroup group) {
+  int i;
+
+  if(group->inputs != NULL) {
+    for(i = 0; i < group->numBranches; i++) {
+      freeSampleBuffer(group->inputs[i]);
+      freeSampleBuffer(group->outputs[i]);
+      freeSampleBuffer(group->scratchBuffers[i]);
+      if(group->taskTimers[i] != NULL) {
+        freeTaskTimer(group->taskTimers[i]);
+      }
+    }
   }
+  free(group->inputs);
+  free(group->outputs);
+  free(group->scratchBuffers);
+  free(group->taskTimers);
+  free(group->branchStarts);
+  free(group);
 }
 
-boolByte pluginChainAddFromArgumentString(PluginChain pluginChain, const CharString argumentString, const CharString userSearchPath) {
-  // Expect a semicolon-separated string of plugins with comma separators for preset names
-  // Example: plugin1,preset1name;plugin2,preset2name
-  char* substringStart;
-  char* pluginSeparator;
-  char* endChar;
-  CharString pluginNameBuffer = NULL;
-  CharString presetNameBuffer = NULL;
+/**
+ * Add a single plugin from the chain string
+ * @param self
+ * @param pluginString Plugin name, optionally followed by a comma and a preset name
+ * @param length Number of characters of pluginString which belong to this plugin
+ * @param userSearchPath Additional path to search for the plugin
+ * @return False if the plugin could not be added to the chain. Plugins which
+ * could not be found are skipped.
+ */
+static boolByte _pluginChainAddPluginFromString(PluginChain self, const char* pluginString, const size_t length,
+  const CharString userSearchPath) {
+  boolByte result = true;
+  CharString pluginNameBuffer;
+  CharString presetNameBuffer;
   char* presetSeparator;
   PluginPreset preset;
   PluginPresetType presetType;
   Plugin plugin;
-  size_t substringLength;
   CharString pluginLocationBuffer;
   PluginInterfaceType pluginType;
 
+  if(length >= kCharStringLengthDefault) {
+    logError("Plugin name in chain string is too long");
+    return false;
+  }
+  pluginNameBuffer = newCharString();
+  strncpy(pluginNameBuffer->data, pluginString, length);
+
+  // Look for the separator for presets to load into these plugins
+  presetNameBuffer = newCharString();
+  presetSeparator = strchr(pluginNameBuffer->data, CHAIN_STRING_PROGRAM_SEPARATOR);
+  if(presetSeparator != NULL) {
+    // Null-terminate this string to force it to end, then extract preset name from next char
+    *presetSeparator = '\0';
+    strncpy(presetNameBuffer->data, presetSeparator + 1, strlen(presetSeparator + 1));
+  }
+
+  // Find preset for this plugin (if given)
+  preset = NULL;
+  if(strlen(presetNameBuffer->data) > 0) {
+    logInfo("Opening preset '%s' for plugin", presetNameBuffer->data);
+    presetType = pluginPresetGuessType(presetNameBuffer);
+    if(presetType != PRESET_TYPE_INVALID) {
+      preset = newPluginPreset(presetType, presetNameBuffer);
+    }
+  }
+
+  // Guess the plugin type from the file extension, search root, etc.
+  pluginLocationBuffer = newCharString();
+  pluginType = guessPluginInterfaceType(pluginNameBuffer, userSearchPath, pluginLocationBuffer);
+  if(pluginType != PLUGIN_TYPE_INVALID) {
+    plugin = newPlugin(pluginType, pluginNameBuffer, pluginLocationBuffer);
+    if(!pluginChainAppend(self, plugin, preset)) {
+      logError("Plugin '%s' could not be added to the chain", pluginNameBuffer->data);
+      result = false;
+    }
+  }
+
+  freeCharString(pluginLocationBuffer);
+  freeCharString(pluginNameBuffer);
+  freeCharString(presetNameBuffer);
+  return result;
+}
+
+boolByte pluginChainAddFromArgumentString(PluginChain self, const CharString argumentString, const CharString userSearchPath) {
+  PluginChainGroup group = NULL;
+  const char* pluginStart;
+  const char* c;
+
   if(charStringIsEmpty(argumentString)) {
     logWarn("Plugin chain string is empty");
     return false;
   }
-  substringStart = argumentString->data;
-  pluginSeparator = strchr(argumentString->data, CHAIN_STRING_PLUGIN_SEPARATOR);
-  endChar = argumentString->data + strlen(argumentString->data);
 
-  do {
-    if(pluginSeparator == NULL) {
-      substringLength = strlen(argumentString->data);
-    }
-    else {
-      substringLength = pluginSeparator - substringStart;
-    }
-    pluginNameBuffer = newCharString();
-    strncpy(pluginNameBuffer->data, substringStart, substringLength);
-
-    // Look for the separator for presets to load into these plugins
-    presetNameBuffer = newCharString();
-    presetSeparator = strchr(pluginNameBuffer->data, CHAIN_STRING_PROGRAM_SEPARATOR);
-    if(presetSeparator != NULL) {
-      // Null-terminate this string to force it to end, then extract preset name from next char
-      *presetSeparator = '\0';
-      strncpy(presetNameBuffer->data, presetSeparator + 1, strlen(presetSeparator + 1));
-    }
-
-    // Find preset for this plugin (if given)
-    preset = NULL;
-    if(strlen(presetNameBuffer->data) > 0) {
-      logInfo("Opening preset '%s' for plugin", presetNameBuffer->data);
-      presetType = pluginPresetGuessType(presetNameBuffer);
-      if(presetType != PRESET_TYPE_INVALID) {
-        preset = newPluginPreset(presetType, presetNameBuffer);
+  pluginStart = argumentString->data;
+  for(c = argumentString->data; ; c++) {
+    if(*c == CHAIN_STRING_GROUP_START) {
+      if(group != NULL) {
+        logError("Groups of plugins cannot be nested");
+        break;
       }
+      else if(c != pluginStart) {
+        logError("Expected '%c' before '%c' in plugin chain", CHAIN_STRING_PLUGIN_SEPARATOR, *c);
+        return false;
+      }
+      group = _newPluginChainGroup(self->numPlugins);
+      pluginStart = c + 1;
+      continue;
+    }
+    else if(*c != CHAIN_STRING_PLUGIN_SEPARATOR && *c != CHAIN_STRING_BRANCH_SEPARATOR &&
+      *c != CHAIN_STRING_GROUP_END && *c != '\0') {
+      continue;
+    }
+
+    if(c > pluginStart && !_pluginChainAddPluginFromString(self, pluginStart, c - pluginStart, userSearchPath)) {
+      break;
     }
+    pluginStart = c + 1;
 
-    // Guess the plugin type from the file extension, search root, etc.
-    pluginLocationBuffer = newCharString();
-    pluginType = guessPluginInterfaceType(pluginNameBuffer, userSearchPath, pluginLocationBuffer);
-    if(pluginType != PLUGIN_TYPE_INVALID) {
-      plugin = newPlugin(pluginType, pluginNameBuffer, pluginLocationBuffer);
-      if(!pluginChainAppend(pluginChain, plugin, preset)) {
-        logError("Plugin '%s' could not be added to the chain", pluginNameBuffer->data);
+    if(*c == CHAIN_STRING_BRANCH_SEPARATOR || *c == CHAIN_STRING_GROUP_END) {
+      if(group == NULL) {
+        logError("Unexpected '%c' outside of a group in plugin chain", *c);
         return false;
       }
+      group->numBranches++;
+      group->branchStarts = (int*)realloc(group->branchStarts, sizeof(int) * (group->numBranches + 1));
+      group->branchStarts[group->numBranches] = self->numPlugins;
     }
-    freeCharString(pluginLocationBuffer);
 
-    if(pluginSeparator == NULL) {
-      break;
+    if(*c == CHAIN_STRING_GROUP_END) {
+      if(group->branchStarts[group->numBranches] == group->branchStarts[0]) {
+        logError("Group of plugins must contain at least one plugin");
+        break;
+      }
+      else if(c[1] != CHAIN_STRING_PLUGIN_SEPARATOR && c[1] != '\0') {
+        logError("Expected '%c' after '%c' in plugin chain", CHAIN_STRING_PLUGIN_SEPARATOR, *c);
+        break;
+      }
+      group->inputs = (SampleBuffer*)calloc(group->numBranches, sizeof(SampleBuffer));
+      group->outputs = (SampleBuffer*)calloc(group->numBranches, sizeof(SampleBuffer));
+      group->scratchBuffers = (SampleBuffer*)calloc(group->numBranches, sizeof(SampleBuffer));
+      group->taskTimers = (TaskTimer*)calloc(group->numBranches, sizeof(TaskTimer));
+      self->groups = (PluginChainGroup*)realloc(self->groups, sizeof(PluginChainGroup) * (self->numGroups + 1));
+      self->groups[self->numGroups++] = group;
+      group = NULL;
     }
-    else {
-      substringStart = pluginSeparator + 1;
-      pluginSeparator = strchr(pluginSeparator + 1, CHAIN_STRING_PLUGIN_SEPARATOR);
+    else if(*c == '\0') {
+      if(group != NULL) {
+        logError("Group of plugins is missing '%c'", CHAIN_STRING_GROUP_END);
+        break;
+      }
+      return true;
     }
-  } while(substringStart < endChar);
+  }
 
-  freeCharString(pluginNameBuffer);
-  freeCharString(presetNameBuffer);
-  return true;
+  if(group != NULL) {
+    _freePluginChainGroup(group);
+  }
+  return false;
 }
 
-static boolByte _loadPresetForPlugin(Plugin plugin, PluginPreset preset) {
-  if(pluginPresetIsCompatibleWith(preset, plugin)) {
-    if(!preset->openPreset(preset)) {
-      logError("Could not open preset '%s'", preset->presetName->data);
-      return false;
-    }
-    if(!preset->loadPreset(preset, plugin)) {
-      logError("Could not load preset '%s' in plugin '%s'", preset->presetName->data, plugin->pluginName->data);
-      return false;
+void pluginChainSetSandboxMode(PluginChain self, const PluginSandboxMode sandboxMode) {
+  self->sandboxMode = sandboxMode;
+}
+
+/**
+ * Replace each plugin in the chain with a proxy which calls it in a sandbox
+ * process. The processes are started when the plugins are opened.
+ */
+static void _sandboxPlugins(PluginChain self) {
+  PluginSandbox sandbox = NULL;
+  int i;
+
+  self->sandboxes = (PluginSandbox*)malloc(sizeof(PluginSandbox) * self->numPlugins);
+  for(i = 0; i < self->numPlugins; i++) {
+    if(sandbox == NULL || self->sandboxMode == kPluginSandboxModePlugin) {
+      sandbox = newPluginSandbox();
+      self->sandboxes[self->numSandboxes++] = sandbox;
     }
-    logInfo("Loaded preset '%s' in plugin '%s'", preset->presetName->data, plugin->pluginName->data);
-    return true;
-  }
-  else {
-    logError("Preset '%s' is not a compatible format for plugin", preset->presetName->data);
-    return false;
+    self->plugins[i] = newPluginSandboxProxy(sandbox, self->plugins[i], self->presets[i]);
   }
 }
 
@@ -161,6 +274,20 @@ ReturnCodes pluginChainInitialize(PluginChain pluginChain) {
   PluginPreset preset;
   int i;
 
+  // The type of a plugin may already be known from the plugin cache, in which
+  // case an invalid chain can be rejected before loading any plugins
+  for(i = 1; i < pluginChain->numPlugins; i++) {
+    plugin = pluginChain->plugins[i];
+    if(plugin->pluginType == PLUGIN_TYPE_INSTRUMENT) {
+      logError("Instrument plugin '%s' must be first in the chain", plugin->pluginName->data);
+      return RETURN_CODE_INVALID_PLUGIN_CHAIN;
+    }
+  }
+
+  if(pluginChain->sandboxMode != kPluginSandboxModeNone && pluginChain->sandboxes == NULL) {
+    _sandboxPlugins(pluginChain);
+  }
+
   for(i = 0; i < pluginChain->numPlugins; i++) {
     plugin = pluginChain->plugins[i];
     if(!plugin->open(plugin)) {
@@ -181,9 +308,10 @@ ReturnCodes pluginChainInitialize(PluginChain pluginChain) {
         return RETURN_CODE_PLUGIN_ERROR;
       }
 
+      // Sandboxed plugins have already loaded their preset when they were opened
       preset = pluginChain->presets[i];
-      if(preset != NULL) {
-        if(!_loadPresetForPlugin(plugin, preset)) {
+      if(preset != NULL && pluginChain->sandboxMode == kPluginSandboxModeNone) {
+        if(!pluginPresetLoadIntoPlugin(preset, plugin)) {
           return RETURN_CODE_INVALID_ARGUMENT;
         }
       }
@@ -202,15 +330,105 @@ void pluginChainInspect(PluginChain pluginChain) {
   }
 }
 
+static void _reserveChainBuffer(SampleBuffer* buffer, const unsigned int maxNumChannels) {
+  if(*buffer == NULL) {
+    *buffer = newSampleBuffer(getNumChannels(), getBlocksize());
+  }
+  sampleBufferReserve(*buffer, maxNumChannels, getBlocksize());
+}
+
 void pluginChainPrepareForProcessing(PluginChain self) {
+  const unsigned int maxNumChannels = pluginChainGetMaxNumChannels(self, getNumChannels());
+  int maxNumBranches = 0;
+  PluginChainGroup group;
+  Plugin plugin;
+  int i, j;
+
+  for(i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+    plugin->prepareForProcessing(plugin);
+  }
+
+  _reserveChainBuffer(&self->scratchBuffer, maxNumChannels);
+  for(i = 0; i < self->numGroups; i++) {
+    group = self->groups[i];
+    for(j = 0; j < group->numBranches; j++) {
+      if(j > 0) {
+        _reserveChainBuffer(&group->inputs[j], maxNumChannels);
+        _reserveChainBuffer(&group->outputs[j], maxNumChannels);
+      }
+      _reserveChainBuffer(&group->scratchBuffers[j], maxNumChannels);
+      // Like the chain's timer, the last task is the host
+      if(group->taskTimers[j] == NULL) {
+        group->taskTimers[j] = newTaskTimer(self->numPlugins + 1);
+      }
+    }
+    if(group->numBranches > maxNumBranches) {
+      maxNumBranches = group->numBranches;
+    }
+  }
+
+  // The thread processing the chain runs one of the branches itself
+  if(maxNumBranches > 1 && self->threadPool == NULL) {
+    self->threadPool = newThreadPool(maxNumBranches - 1);
+    logInfo("Processing parallel branches with %d threads", maxNumBranches);
+  }
+}
+
+boolByte pluginChainTakeSnapshot(PluginChain self) {
+  boolByte result = true;
   Plugin plugin;
   int i;
+
   for(i = 0; i < self->numPlugins; i++) {
     plugin = self->plugins[i];
+    logDebug("Taking snapshot of plugin '%s'", plugin->pluginName->data);
+    freePluginSnapshot(self->snapshots[i]);
+    self->snapshots[i] = plugin->takeSnapshot(plugin);
+    if(self->snapshots[i] == NULL) {
+      logWarn("State of plugin '%s' could not be saved, so it will not be restored when the chain is reset",
+        plugin->pluginName->data);
+      result = false;
+    }
+  }
+  return result;
+}
+
+void pluginChainReset(PluginChain self) {
+  Plugin plugin;
+  int i;
+
+  if(self->pipeline != NULL) {
+    logInternalError("Cannot reset plugin chain while it is pipelined");
+    return;
+  }
+  for(i = 0; i < self->numSandboxes; i++) {
+    if(pluginSandboxHasCrashed(self->sandboxes[i]) && !pluginSandboxRestart(self->sandboxes[i])) {
+      logError("Could not restart crashed plugin sandbox");
+    }
+  }
+  for(i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+    logDebug("Resetting plugin '%s'", plugin->pluginName->data);
+    // Closing a plugin only suspends it, it is unloaded when the plugin is freed
+    plugin->closePlugin(plugin);
+    if(self->snapshots[i] != NULL && !plugin->restoreSnapshot(plugin, self->snapshots[i])) {
+      logWarn("Could not restore the state of plugin '%s'", plugin->pluginName->data);
+    }
     plugin->prepareForProcessing(plugin);
   }
 }
 
+boolByte pluginChainHasCrashed(PluginChain self) {
+  int i;
+  for(i = 0; i < self->numSandboxes; i++) {
+    if(pluginSandboxHasCrashed(self->sandboxes[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
 int pluginChainGetMaximumTailTimeInMs(PluginChain pluginChain) {
   Plugin plugin;
   int tailTime;
@@ -226,40 +444,319 @@ int pluginChainGetMaximumTailTimeInMs(PluginChain pluginChain) {
   return maxTailTime;
 }
 
-void pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer, SampleBuffer outBuffer, TaskTimer taskTimer) {
+unsigned int pluginChainGetMaxNumChannels(PluginChain self, const unsigned int numChannels) {
+  unsigned int maxNumChannels = numChannels;
   Plugin plugin;
   int i;
 
-  for(i = 0; i < pluginChain->numPlugins; i++) {
-    sampleBufferClear(outBuffer);
+  for(i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+    maxNumChannels = plugin->numInputs > maxNumChannels ? plugin->numInputs : maxNumChannels;
+    maxNumChannels = plugin->numOutputs > maxNumChannels ? plugin->numOutputs : maxNumChannels;
+  }
+  return maxNumChannels;
+}
+
+boolByte pluginChainStartPipeline(PluginChain self, const unsigned int numChannels, const unsigned long blocksize) {
+  if(self->pipeline != NULL) {
+    logWarn("Plugin chain is already pipelined");
+    return true;
+  }
+  else if(self->numGroups > 0) {
+    logUnsupportedFeature("Pipelining plugin chains with parallel branches");
+    return false;
+  }
+
+  self->pipeline = newPluginChainPipeline(self->plugins, self->numPlugins, numChannels, blocksize, self->context);
+  if(self->pipeline == NULL) {
+    return false;
+  }
+  if(!pluginChainPipelineStart(self->pipeline)) {
+    freePluginChainPipeline(self->pipeline);
+    self->pipeline = NULL;
+    return false;
+  }
+
+  logInfo("Processing plugin chain with %d pipelined threads", self->numPlugins);
+  return true;
+}
+
+static boolByte _pluginChainCanProcessInPlace(Plugin plugin) {
+  return (boolByte)(plugin->canProcessInPlace && plugin->overwritesOutputs);
+}
+
+static SampleBuffer _pluginChainGetScratchBuffer(SampleBuffer* scratchBuffer, const SampleBuffer buffer) {
+  if(*scratchBuffer == NULL) {
+    *scratchBuffer = newSampleBuffer(buffer->numChannels, buffer->blocksize);
+  }
+  sampleBufferReserve(*scratchBuffer, buffer->numChannels, buffer->blocksize);
+  (*scratchBuffer)->blocksize = buffer->blocksize;
+  if((*scratchBuffer)->numChannels > buffer->numChannels) {
+    sampleBufferResize(*scratchBuffer, buffer->numChannels, false);
+  }
+  return *scratchBuffer;
+}
+
+/**
+ * Find the group which starts at the given plugin
+ * @return Group, or NULL if the plugin is not the first one of a group
+ */
+static PluginChainGroup _pluginChainFindGroup(PluginChain self, const int pluginIndex) {
+  int i;
+  for(i = 0; i < self->numGroups; i++) {
+    if(self->groups[i]->branchStarts[0] == pluginIndex) {
+      return self->groups[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Get the plugin after a plugin or group in the chain
+ * @param self
+ * @param pluginIndex Index of the plugin
+ * @param includeGroups True if a group starting at pluginIndex should be skipped
+ * as a whole, which is the case for the top level of the chain
+ * @param outGroup Set to the group starting at pluginIndex, or NULL
+ * @return Index of the next plugin
+ */
+static int _pluginChainGetNextNode(PluginChain self, const int pluginIndex, const boolByte includeGroups,
+  PluginChainGroup* outGroup) {
+  *outGroup = includeGroups ? _pluginChainFindGroup(self, pluginIndex) : NULL;
+  if(*outGroup != NULL) {
+    return (*outGroup)->branchStarts[(*outGroup)->numBranches];
+  }
+  return pluginIndex + 1;
+}
+
+static void _pluginChainProcessGroup(PluginChain self, PluginChainGroup group,
+  SampleBuffer inBuffer, SampleBuffer outBuffer, TaskTimer taskTimer);
+
+/**
+ * Process audio through a range of plugins in the chain
+ * @param self
+ * @param firstPlugin Index of the first plugin in the range
+ * @param endPlugin Index after the last plugin in the range, which must be
+ * larger than firstPlugin
+ * @param includeGroups True to process groups starting in this range in parallel
+ * @param inBuffer Input block, which is overwritten during processing
+ * @param outBuffer Output block
+ * @param scratchBuffer Buffer which is used if a third buffer is needed, may
+ * point to NULL
+ * @param taskTimer Timer which records the time used by each plugin, or NULL
+ */
+static void _pluginChainProcessRange(PluginChain self, const int firstPlugin, const int endPlugin,
+  const boolByte includeGroups, SampleBuffer inBuffer, SampleBuffer outBuffer, SampleBuffer* scratchBuffer,
+  TaskTimer taskTimer) {
+  SampleBuffer currentBuffer = inBuffer;
+  SampleBuffer nextBuffer;
+  boolByte processInPlace;
+  int numHopsLeft = 0;
+  PluginChainGroup group;
+  Plugin plugin;
+  int next;
+  int i;
+
+  // Rather than copying each plugin's output back to the input buffer, every
+  // plugin reads from the buffer which holds the previous plugin's output and
+  // writes to another one. A "hop" is a plugin which writes to a different
+  // buffer than it reads from. The last plugin always hops to outBuffer, and
+  // hops alternate between inBuffer and outBuffer before that, so the first
+  // hop goes to the scratch buffer when the number of hops is even. Plugins
+  // which can process in place only hop when that fixes the parity instead.
+  // Groups always hop, since their branches are summed into another buffer.
+  for(i = firstPlugin; i < endPlugin; i = next) {
+    next = _pluginChainGetNextNode(self, i, includeGroups, &group);
+    if(next == endPlugin || group != NULL || !_pluginChainCanProcessInPlace(self->plugins[i])) {
+      numHopsLeft++;
+    }
+  }
+
+  for(i = firstPlugin; i < endPlugin; i = next) {
+    next = _pluginChainGetNextNode(self, i, includeGroups, &group);
+    plugin = self->plugins[i];
+    if(next < endPlugin && group == NULL && _pluginChainCanProcessInPlace(plugin)) {
+      // The current buffer reaches outBuffer in an even number of hops if it
+      // is outBuffer, and in an odd number otherwise
+      processInPlace = (boolByte)((currentBuffer == outBuffer) == (numHopsLeft % 2 == 0));
+    }
+    else {
+      processInPlace = false;
+      numHopsLeft--;
+    }
+
+    if(processInPlace) {
+      nextBuffer = currentBuffer;
+    }
+    else if(numHopsLeft % 2 == 0) {
+      nextBuffer = outBuffer;
+    }
+    else if(currentBuffer == inBuffer) {
+      nextBuffer = _pluginChainGetScratchBuffer(scratchBuffer, inBuffer);
+    }
+    else {
+      nextBuffer = inBuffer;
+    }
+
+    if(group != NULL) {
+      _pluginChainProcessGroup(self, group, currentBuffer, nextBuffer, taskTimer);
+      currentBuffer = nextBuffer;
+      continue;
+    }
 
-    plugin = pluginChain->plugins[i];
     logDebug("Processing audio with plugin '%s'", plugin->pluginName->data);
-    if(inBuffer->numChannels < plugin->numInputs) {
-      logDebug("Expanding input source from %d -> %d channels", inBuffer->numChannels, plugin->numInputs);
-      sampleBufferResize(inBuffer, plugin->numInputs, true);
+    if(currentBuffer->numChannels < plugin->numInputs) {
+      logDebug("Expanding input source from %d -> %d channels", currentBuffer->numChannels, plugin->numInputs);
+      sampleBufferResize(currentBuffer, plugin->numInputs, true);
+    }
+    if(nextBuffer->numChannels < plugin->numOutputs) {
+      logDebug("Expanding output source from %d -> %d channels", nextBuffer->numChannels, plugin->numOutputs);
+      sampleBufferResize(nextBuffer, plugin->numOutputs, false);
+    }
+    if(!processInPlace) {
+      pluginClearOutputs(plugin, nextBuffer);
+    }
+    if(taskTimer != NULL) {
+      startTimingTask(taskTimer, i);
     }
-    if(outBuffer->numChannels < plugin->numOutputs) {
-      logDebug("Expanding output source from %d -> %d channels", outBuffer->numChannels, plugin->numOutputs);
-      sampleBufferResize(outBuffer, plugin->numOutputs, false);
+    plugin->processAudio(plugin, currentBuffer, nextBuffer);
+    if(taskTimer != NULL) {
+      // TODO: Last task ID is the host, but this is a bit hacky
+      startTimingTask(taskTimer, taskTimer->numTasks - 1);
     }
-    startTimingTask(taskTimer, i);
-    plugin->processAudio(plugin, inBuffer, outBuffer);
-    // TODO: Last task ID is the host, but this is a bit hacky
-    startTimingTask(taskTimer, taskTimer->numTasks - 1);
+    if(processInPlace) {
+      pluginClearOutputs(plugin, nextBuffer);
+    }
+
+    currentBuffer = nextBuffer;
+  }
+}
+
+/**
+ * Block which is being processed by the branches of a group
+ */
+typedef struct {
+  PluginChain chain;
+  PluginChainGroup group;
+  SampleBuffer inBuffer;
+  SampleBuffer outBuffer;
+  // True if the branches should record their plugins' times in the group's timers
+  boolByte isTimed;
+} PluginChainGroupBlockMembers;
+typedef PluginChainGroupBlockMembers* PluginChainGroupBlock;
+
+/**
+ * Sets up a branch's buffer to hold a block with the same size as another one
+ */
+static void _prepareBranchBuffer(SampleBuffer* branchBuffer, const SampleBuffer buffer) {
+  if(*branchBuffer == NULL) {
+    *branchBuffer = newSampleBuffer(buffer->numChannels, buffer->blocksize);
+  }
+  sampleBufferReserve(*branchBuffer, buffer->numChannels, buffer->blocksize);
+  (*branchBuffer)->blocksize = buffer->blocksize;
+  sampleBufferResize(*branchBuffer, buffer->numChannels, false);
+}
+
+static void _processGroupBranch(void* userData, const int taskIndex) {
+  PluginChainGroupBlock block = (PluginChainGroupBlock)userData;
+  PluginChainGroup group = block->group;
+  const int firstPlugin = group->branchStarts[taskIndex];
+  const int endPlugin = group->branchStarts[taskIndex + 1];
+  SampleBuffer inBuffer = taskIndex == 0 ? block->inBuffer : group->inputs[taskIndex];
+  SampleBuffer outBuffer = taskIndex == 0 ? block->outBuffer : group->outputs[taskIndex];
+
+  // Plugins log through the context of the chain, no matter which thread runs them
+  setThreadMrsWatsonContext(block->chain->context);
+  if(firstPlugin == endPlugin) {
+    if(outBuffer->numChannels != inBuffer->numChannels) {
+      sampleBufferResize(outBuffer, inBuffer->numChannels, false);
+    }
+    sampleBufferCopy(outBuffer, inBuffer);
+  }
+  else {
+    _pluginChainProcessRange(block->chain, firstPlugin, endPlugin, false, inBuffer, outBuffer,
+      &group->scratchBuffers[taskIndex], block->isTimed ? group->taskTimers[taskIndex] : NULL);
+  }
+}
+
+static void _pluginChainProcessGroup(PluginChain self, PluginChainGroup group,
+  SampleBuffer inBuffer, SampleBuffer outBuffer, TaskTimer taskTimer) {
+  PluginChainGroupBlockMembers block;
+  SampleBuffer branchOutput;
+  TaskTimer branchTimer;
+  unsigned int channel;
+  unsigned long frame;
+  int i, j;
+
+  // The first branch may overwrite the input block, so the other branches
+  // process their own copy of it
+  for(i = 1; i < group->numBranches; i++) {
+    _prepareBranchBuffer(&group->inputs[i], inBuffer);
+    _prepareBranchBuffer(&group->outputs[i], inBuffer);
+    sampleBufferCopy(group->inputs[i], inBuffer);
+  }
+  block.chain = self;
+  block.group = group;
+  block.inBuffer = inBuffer;
+  block.outBuffer = outBuffer;
+  block.isTimed = (boolByte)(taskTimer != NULL);
+
+  logDebug("Processing audio with %d parallel branches", group->numBranches);
+  // The thread processing the chain is counted as the host while it waits for
+  // the other branches
+  threadPoolRun(self->threadPool, _processGroupBranch, &block, group->numBranches);
+
+  if(taskTimer != NULL) {
+    for(i = 0; i < group->numBranches; i++) {
+      branchTimer = group->taskTimers[i];
+      stopTiming(branchTimer);
+      taskTimerFinishBlock(branchTimer, 0);
+      for(j = group->branchStarts[i]; j < group->branchStarts[i + 1] && j < taskTimer->numTasks - 1; j++) {
+        taskTimerMergeTask(taskTimer, j, branchTimer, j);
+      }
+      taskTimerReset(branchTimer);
+    }
+  }
 
-    // If this is not the last plugin in the chain, then copy the output of this plugin
-    // back to the input for the next one in the chain.
-    if(i + 1 < pluginChain->numPlugins) {
-      sampleBufferCopy(inBuffer, outBuffer);
+  for(i = 1; i < group->numBranches; i++) {
+    branchOutput = group->outputs[i];
+    if(outBuffer->numChannels < branchOutput->numChannels) {
+      sampleBufferResize(outBuffer, branchOutput->numChannels, false);
+    }
+    for(channel = 0; channel < branchOutput->numChannels; channel++) {
+      for(frame = 0; frame < branchOutput->blocksize; frame++) {
+        outBuffer->samples[channel][frame] += branchOutput->samples[channel][frame];
+      }
     }
   }
 }
 
+boolByte pluginChainProcessAudio(PluginChain pluginChain, SampleBuffer inBuffer, SampleBuffer outBuffer, TaskTimer taskTimer) {
+  const unsigned int numInputChannels = inBuffer->numChannels;
+
+  if(pluginChain->pipeline != NULL) {
+    return pluginChainPipelineProcess(pluginChain->pipeline, inBuffer, outBuffer, taskTimer);
+  }
+  if(pluginChain->numPlugins > 0) {
+    _pluginChainProcessRange(pluginChain, 0, pluginChain->numPlugins, true, inBuffer, outBuffer,
+      &pluginChain->scratchBuffer, taskTimer);
+    // The input buffer may have been expanded for a plugin's inputs, or used to
+    // hold the output of a plugin with more channels. The caller reads the next
+    // block into it, which must have the channel count of the input source.
+    sampleBufferResize(inBuffer, numInputChannels, false);
+  }
+  return true;
+}
+
 void pluginChainProcessMidi(PluginChain pluginChain, LinkedList midiEvents, TaskTimer taskTimer) {
   Plugin plugin;
   if(midiEvents->item != NULL) {
     logDebug("Processing plugin chain MIDI events");
+    if(pluginChain->pipeline != NULL) {
+      // Events are delivered to the head plugin along with the next block
+      pluginChainPipelineQueueMidiEvents(pluginChain->pipeline, midiEvents);
+      return;
+    }
     // Right now, we only process MIDI in the first plugin in the chain
     // TODO: Is this really the correct behavior? How do other sequencers do it?
     plugin = pluginChain->plugins[0];
@@ -268,14 +765,36 @@ void pluginChainProcessMidi(PluginChain pluginChain, LinkedList midiEvents, Task
   }
 }
 
+boolByte pluginChainFlushAudio(PluginChain self, SampleBuffer outBuffer, TaskTimer taskTimer) {
+  if(self->pipeline == NULL) {
+    return false;
+  }
+  return pluginChainPipelineFlush(self->pipeline, outBuffer, taskTimer);
+}
+
+void pluginChainStopPipeline(PluginChain self, TaskTimer taskTimer) {
+  if(self->pipeline != NULL) {
+    pluginChainPipelineStop(self->pipeline, taskTimer);
+    freePluginChainPipeline(self->pipeline);
+    self->pipeline = NULL;
+  }
+}
+
 void pluginChainShutdown(PluginChain pluginChain) {
   Plugin plugin;
   int i;
+
+  // Plugins must not be closed while their threads are still running
+  pluginChainStopPipeline(pluginChain, NULL);
   for(i = 0; i < pluginChain->numPlugins; i++) {
     plugin = pluginChain->plugins[i];
     logInfo("Closing plugin '%s'", plugin->pluginName->data);
     plugin->closePlugin(plugin);
   }
+  // Sandboxed plugins are unloaded when their process stops
+  for(i = 0; i < pluginChain->numSandboxes; i++) {
+    pluginSandboxStop(pluginChain->sandboxes[i]);
+  }
 }
 
 void freePluginChain(PluginChain pluginChain) {
@@ -283,6 +802,7 @@ void freePluginChain(PluginChain pluginChain) {
   PluginPreset preset;
   int i;
 
+  pluginChainStopPipeline(pluginChain, NULL);
   for(i = 0; i < pluginChain->numPlugins; i++) {
     plugin = pluginChain->plugins[i];
     freePlugin(plugin);
@@ -297,5 +817,22 @@ void freePluginChain(PluginChain pluginChain) {
   }
   free(pluginChain->presets);
 
+  for(i = 0; i < pluginChain->numPlugins; i++) {
+    freePluginSnapshot(pluginChain->snapshots[i]);
+  }
+  free(pluginChain->snapshots);
+  freeSampleBuffer(pluginChain->scratchBuffer);
+
+  for(i = 0; i < pluginChain->numGroups; i++) {
+    _freePluginChainGroup(pluginChain->groups[i]);
+  }
+  free(pluginChain->groups);
+  freeThreadPool(pluginChain->threadPool);
+
+  for(i = 0; i < pluginChain->numSandboxes; i++) {
+    freePluginSandbox(pluginChain->sandboxes[i]);
+  }
+  free(pluginChain->sandboxes);
+
   free(pluginChain);
 }
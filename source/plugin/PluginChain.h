@@ -28,36 +28,201 @@
 #ifndef MrsWatson_PluginChain_h
 #define MrsWatson_PluginChain_h
 
+#include "app/MrsWatsonContext.h"
 #include "app/ReturnCodes.h"
 #include "base/LinkedList.h"
+#include "base/ThreadPool.h"
 #include "plugin/Plugin.h"
+#include "plugin/PluginChainPipeline.h"
 #include "plugin/PluginPreset.h"
+#include "plugin/PluginSandbox.h"
 #include "time/TaskTimer.h"
 
-#define MAX_PLUGINS 8
+// Number of plugins which a new chain has room for before it is enlarged
+#define PLUGIN_CHAIN_INITIAL_CAPACITY 8
 #define CHAIN_STRING_PLUGIN_SEPARATOR ';'
 #define CHAIN_STRING_PROGRAM_SEPARATOR ','
+#define CHAIN_STRING_GROUP_START '['
+#define CHAIN_STRING_GROUP_END ']'
+#define CHAIN_STRING_BRANCH_SEPARATOR '|'
+
+/**
+ * Plugins in the chain which are split into parallel branches. Each branch
+ * receives the same input, and the outputs of all branches are summed. A
+ * branch without any plugins passes its input through unchanged.
+ */
+typedef struct {
+  // Index of the first plugin of each branch in the chain, followed by the
+  // index after the last plugin of the group
+  int* branchStarts;
+  int numBranches;
+  // Buffers for each branch. The first branch reads from and writes to the
+  // buffers of the chain, so its input and output are not used.
+  SampleBuffer* inputs;
+  SampleBuffer* outputs;
+  SampleBuffer* scratchBuffers;
+  // Timer for each branch, since the branches may run on any thread. Their
+  // times are added to the chain's timer once the group has been processed.
+  TaskTimer* taskTimers;
+} PluginChainGroupMembers;
+typedef PluginChainGroupMembers* PluginChainGroup;
 
 typedef struct {
   int numPlugins;
+  // Number of plugins which the plugins, presets and snapshots arrays have room for
+  int capacity;
   Plugin* plugins;
   PluginPreset* presets;
+  PluginSnapshot* snapshots;
+  // Third buffer used when processing audio, in addition to the caller's
+  // input and output buffers
+  SampleBuffer scratchBuffer;
+  PluginChainGroup* groups;
+  int numGroups;
+  // Threads which process the branches of groups, created when the chain is
+  // prepared for processing
+  ThreadPool threadPool;
+  PluginChainPipeline pipeline;
+  PluginSandboxMode sandboxMode;
+  PluginSandbox* sandboxes;
+  int numSandboxes;
+  // Context which the chain was created in, and which its plugins run in
+  MrsWatsonContext context;
 } PluginChainMembers;
 typedef PluginChainMembers* PluginChain;
 
 PluginChain newPluginChain(void);
 
+/**
+ * Add a plugin to the end of the chain. Chains have no maximum length, their
+ * storage is enlarged as needed.
+ * @param self
+ * @param plugin Plugin to add, which is owned by the chain afterwards
+ * @param preset Preset to load into the plugin when the chain is initialized,
+ * or NULL
+ * @return False if plugin is NULL
+ */
 boolByte pluginChainAppend(PluginChain self, Plugin plugin, PluginPreset preset);
+
+/**
+ * Add plugins to the chain from a string given by the user. Plugins are
+ * separated by semicolons, and may be followed by a comma and the preset to
+ * load, ie "plugin1,preset1;plugin2". Parallel branches are written in square
+ * brackets with the branches separated by pipes, so "split;[low|mid;comp|];sum"
+ * sends the output of "split" to three branches, the last of which has no
+ * plugins, and sends their summed output to "sum". Groups may not be nested.
+ * @param self
+ * @param argumentString Chain string
+ * @param userSearchPath Additional path to search for plugins
+ * @return True if the string was valid and all plugins could be added
+ */
 boolByte pluginChainAddFromArgumentString(PluginChain self, const CharString argumentString, const CharString userSearchPath);
+
+/**
+ * Run the chain's plugins in separate processes, so that a plugin which
+ * crashes does not take down the host. Must be called before the chain is
+ * initialized.
+ * @param self
+ * @param sandboxMode Whether each plugin gets its own process, or all plugins
+ * share one process
+ */
+void pluginChainSetSandboxMode(PluginChain self, const PluginSandboxMode sandboxMode);
+
 ReturnCodes pluginChainInitialize(PluginChain self);
 
 void pluginChainInspect(PluginChain self);
 int pluginChainGetMaximumTailTimeInMs(PluginChain self);
 
+/**
+ * Get the number of channels which buffers passed to pluginChainProcessAudio()
+ * need so that no plugin in the chain has to expand them
+ * @param self
+ * @param numChannels Channel count of the audio sent to the chain
+ * @return Largest of numChannels and the input and output counts of all plugins
+ */
+unsigned int pluginChainGetMaxNumChannels(PluginChain self, const unsigned int numChannels);
+
 void pluginChainPrepareForProcessing(PluginChain self);
-void pluginChainProcessAudio(PluginChain self, SampleBuffer inBuffer, SampleBuffer outBuffer, TaskTimer taskTimer);
+
+/**
+ * Save the current state of all plugins in the chain, which is restored each
+ * time the chain is reset. This is usually called once after the chain has
+ * been initialized, so that each input source starts with the plugins' presets
+ * rather than any changes made while processing the previous one.
+ * @param self
+ * @return True if the state of every plugin was saved
+ */
+boolByte pluginChainTakeSnapshot(PluginChain self);
+
+/**
+ * Reset the internal state of all plugins in the chain (ie, delay lines and
+ * envelopes) by suspending and resuming them, so that the chain can process
+ * another input source as if it was freshly loaded. The plugins are not
+ * reloaded. If pluginChainTakeSnapshot() was called, the plugins are restored
+ * to their saved state while suspended, otherwise their parameters and
+ * programs are kept. Sandboxed plugins which have crashed are loaded again
+ * along with their presets. Must not be called while the chain is pipelined.
+ * @param self
+ */
+void pluginChainReset(PluginChain self);
+
+/**
+ * Check if a sandboxed plugin has crashed. Crashed plugins output silence
+ * until the chain is reset, which restarts their sandbox process.
+ * @param self
+ * @return True if any plugin in the chain has crashed
+ */
+boolByte pluginChainHasCrashed(PluginChain self);
+
+/**
+ * Run each plugin in the chain on its own thread, passing blocks from one
+ * plugin to the next through lock-free queues. This increases throughput for
+ * chains with several expensive plugins, at the cost of a latency of N blocks
+ * for a chain of N plugins. Note that the audio clock is advanced by the caller
+ * when sending blocks, so plugins will see a transport position which is ahead
+ * of the block they are processing. Chains with parallel branches cannot be
+ * pipelined. Must be called after pluginChainPrepareForProcessing().
+ * @param self
+ * @param numChannels Channel count of the input buffer
+ * @param blocksize Largest blocksize which will be processed
+ * @return True if the pipeline was started
+ */
+boolByte pluginChainStartPipeline(PluginChain self, const unsigned int numChannels, const unsigned long blocksize);
+
+/**
+ * Process a block of audio through the chain. The branches of each group are
+ * processed in parallel on the chain's thread pool.
+ * @param self
+ * @param inBuffer Input block, which may be overwritten during processing
+ * @param outBuffer Output block
+ * @param taskTimer Timer which records the time used by each plugin. The last
+ * task index is reserved for the host.
+ * @return True if outBuffer holds processed audio. When pipelined, this is
+ * false until the pipeline has filled up, and outBuffer then holds the block
+ * which was sent N calls earlier.
+ */
+boolByte pluginChainProcessAudio(PluginChain self, SampleBuffer inBuffer, SampleBuffer outBuffer, TaskTimer taskTimer);
 void pluginChainProcessMidi(PluginChain self, LinkedList midiEvents, TaskTimer taskTimer);
 
+/**
+ * Receive the next block which is still being processed in the pipeline. Should
+ * be called repeatedly after the last block has been sent until it returns false.
+ * @param self
+ * @param outBuffer Output block
+ * @param taskTimer Timer for the chain
+ * @return True if outBuffer holds processed audio, always false when the chain
+ * is not pipelined
+ */
+boolByte pluginChainFlushAudio(PluginChain self, SampleBuffer outBuffer, TaskTimer taskTimer);
+
+/**
+ * Stop the pipeline's worker threads, if it was started
+ * @param self
+ * @param taskTimer Timer for the chain, which receives the time used by each
+ * plugin on its thread. May be NULL.
+ */
+void pluginChainStopPipeline(PluginChain self, TaskTimer taskTimer);
+
 void pluginChainShutdown(PluginChain self);
 void freePluginChain(PluginChain self);
 
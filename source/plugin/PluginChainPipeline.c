@@ -0,0 +1,327 @@
+//
+// PluginChainPipeline.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+
+#include "audio/AudioSettings.h"
+#include "logging/EventLogger.h"
+#include "plugin/PluginChainPipeline.h"
+
+static PluginChainPipelineBlock _newPluginChainPipelineBlock(const unsigned int numChannels, const unsigned long blocksize) {
+  PluginChainPipelineBlock block = (PluginChainPipelineBlock)malloc(sizeof(PluginChainPipelineBlockMembers));
+  block->buffer = newSampleBuffer(numChannels, blocksize);
+  block->midiEvents = newLinkedList();
+  return block;
+}
+
+static void _freePluginChainPipelineBlock(PluginChainPipelineBlock self) {
+  if(self == NULL) {
+    return;
+  }
+  freeSampleBuffer(self->buffer);
+  freeLinkedList(self->midiEvents);
+  free(self);
+}
+
+static void _processPipelineBlock(PluginChainPipelineStage stage, PluginChainPipelineBlock block) {
+  Plugin plugin = stage->plugin;
+  SampleBuffer inBuffer = block->buffer;
+  SampleBuffer outBuffer = stage->outBuffer;
+
+  startTimingTask(stage->taskTimer, 0);
+  if(block->midiEvents->item != NULL) {
+    plugin->processMidiEvents(plugin, block->midiEvents);
+    linkedListClear(block->midiEvents);
+  }
+
+  logDebug("Processing audio with plugin '%s'", plugin->pluginName->data);
+  if(inBuffer->numChannels < plugin->numInputs) {
+    logDebug("Expanding input source from %d -> %d channels", inBuffer->numChannels, plugin->numInputs);
+    sampleBufferResize(inBuffer, plugin->numInputs, true);
+  }
+  // Plugins which can process in place write their output straight to the block
+  if(plugin->canProcessInPlace && plugin->overwritesOutputs) {
+    outBuffer = inBuffer;
+  }
+  if(outBuffer->numChannels < plugin->numOutputs) {
+    logDebug("Expanding output source from %d -> %d channels", outBuffer->numChannels, plugin->numOutputs);
+    sampleBufferResize(outBuffer, plugin->numOutputs, false);
+  }
+  outBuffer->blocksize = inBuffer->blocksize;
+  if(outBuffer != inBuffer) {
+    pluginClearOutputs(plugin, outBuffer);
+  }
+  plugin->processAudio(plugin, inBuffer, outBuffer);
+  if(outBuffer == inBuffer) {
+    pluginClearOutputs(plugin, outBuffer);
+  }
+  stopTiming(stage->taskTimer);
+  // Each stage has the full duration of a block to process it
+  taskTimerFinishBlock(stage->taskTimer, (double)inBuffer->blocksize * 1000.0 / getSampleRate());
+
+  // The block carries this stage's output on to the next one, with all of the
+  // output channels. Swapping the buffers avoids copying the output, and the
+  // block's old buffer becomes the output buffer for the stage's next block.
+  if(outBuffer != inBuffer) {
+    block->buffer = outBuffer;
+    stage->outBuffer = inBuffer;
+  }
+}
+
+static void* _pluginChainPipelineStageThread(void* stagePtr) {
+  PluginChainPipelineStage stage = (PluginChainPipelineStage)stagePtr;
+  PluginChainPipelineBlock block;
+
+  setThreadMrsWatsonContext(stage->context);
+  while(true) {
+    block = (PluginChainPipelineBlock)ringBufferPopBlocking(stage->input);
+    if(block != stage->stopBlock) {
+      _processPipelineBlock(stage, block);
+    }
+    ringBufferPushBlocking(stage->output, block);
+    if(block == stage->stopBlock) {
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+PluginChainPipeline newPluginChainPipeline(Plugin* plugins, const int numPlugins,
+  const unsigned int numChannels, const unsigned long maxBlocksize, MrsWatsonContext context) {
+  PluginChainPipeline pipeline;
+  PluginChainPipelineStage stage;
+  int i;
+
+  if(numPlugins <= 0) {
+    logError("Cannot create pipeline without any plugins");
+    return NULL;
+  }
+
+  pipeline = (PluginChainPipeline)malloc(sizeof(PluginChainPipelineMembers));
+  pipeline->numStages = numPlugins;
+  pipeline->maxBlocksize = maxBlocksize;
+  pipeline->isRunning = false;
+  pipeline->stopBlock = _newPluginChainPipelineBlock(1, 1);
+  pipeline->pendingMidiEvents = newLinkedList();
+
+  // Every stage can hold one block, plus the one which is being received by the
+  // caller and the one which is being sent next.
+  pipeline->numBlocks = numPlugins + 2;
+  pipeline->blocks = (PluginChainPipelineBlock*)malloc(sizeof(PluginChainPipelineBlock) * pipeline->numBlocks);
+  pipeline->freeBlocks = (PluginChainPipelineBlock*)malloc(sizeof(PluginChainPipelineBlock) * pipeline->numBlocks);
+  for(i = 0; i < pipeline->numBlocks; i++) {
+    pipeline->blocks[i] = _newPluginChainPipelineBlock(numChannels, maxBlocksize);
+    pipeline->freeBlocks[i] = pipeline->blocks[i];
+  }
+  pipeline->numFreeBlocks = pipeline->numBlocks;
+  pipeline->numBlocksInFlight = 0;
+
+  // Queues are shared between neighboring stages, and each of them must be
+  // large enough to hold all blocks plus the stop marker.
+  pipeline->stages = (PluginChainPipelineStage*)malloc(sizeof(PluginChainPipelineStage) * numPlugins);
+  for(i = 0; i < numPlugins; i++) {
+    stage = (PluginChainPipelineStage)malloc(sizeof(PluginChainPipelineStageMembers));
+    stage->plugin = plugins[i];
+    stage->outBuffer = newSampleBuffer(numChannels, maxBlocksize);
+    stage->input = (i == 0) ? newRingBuffer(pipeline->numBlocks + 2) : pipeline->stages[i - 1]->output;
+    stage->output = newRingBuffer(pipeline->numBlocks + 2);
+    stage->taskTimer = newTaskTimer(1);
+    stage->thread = newThread(_pluginChainPipelineStageThread, stage);
+    stage->stopBlock = pipeline->stopBlock;
+    stage->context = context;
+    pipeline->stages[i] = stage;
+  }
+
+  return pipeline;
+}
+
+boolByte pluginChainPipelineStart(PluginChainPipeline self) {
+  int i, j;
+
+  if(self->isRunning) {
+    return true;
+  }
+
+  for(i = 0; i < self->numStages; i++) {
+    if(!threadStart(self->stages[i]->thread)) {
+      logError("Could not start thread for plugin '%s'", self->stages[i]->plugin->pluginName->data);
+      for(j = 0; j < i; j++) {
+        ringBufferPushBlocking(self->stages[j]->input, self->stopBlock);
+        threadJoin(self->stages[j]->thread);
+      }
+      return false;
+    }
+  }
+
+  logDebug("Started processing pipeline with %d stages", self->numStages);
+  self->isRunning = true;
+  return true;
+}
+
+void pluginChainPipelineQueueMidiEvents(PluginChainPipeline self, LinkedList midiEvents) {
+  LinkedListIterator iterator = midiEvents;
+
+  while(iterator != NULL && iterator->item != NULL) {
+    linkedListAppend(self->pendingMidiEvents, iterator->item);
+    iterator = (LinkedListIterator)iterator->nextItem;
+  }
+}
+
+static boolByte _receivePipelineBlock(PluginChainPipeline self, SampleBuffer outBuffer, TaskTimer taskTimer) {
+  PluginChainPipelineBlock block;
+
+  if(self->numBlocksInFlight == 0) {
+    return false;
+  }
+
+  // Waiting on the last stage is neither plugin nor host time
+  if(taskTimer != NULL) {
+    stopTiming(taskTimer);
+  }
+  block = (PluginChainPipelineBlock)ringBufferPopBlocking(self->stages[self->numStages - 1]->output);
+  if(taskTimer != NULL) {
+    startTimingTask(taskTimer, taskTimer->numTasks - 1);
+  }
+
+  if(outBuffer->numChannels < block->buffer->numChannels) {
+    sampleBufferResize(outBuffer, block->buffer->numChannels, false);
+  }
+  outBuffer->blocksize = block->buffer->blocksize;
+  sampleBufferCopy(outBuffer, block->buffer);
+
+  self->freeBlocks[self->numFreeBlocks++] = block;
+  self->numBlocksInFlight--;
+  return true;
+}
+
+boolByte pluginChainPipelineProcess(PluginChainPipeline self, const SampleBuffer inBuffer,
+  SampleBuffer outBuffer, TaskTimer taskTimer) {
+  PluginChainPipelineBlock block;
+  LinkedList midiEvents;
+
+  if(!self->isRunning) {
+    logInternalError("Pipeline has not been started");
+    return false;
+  }
+  if(inBuffer->blocksize > self->maxBlocksize) {
+    logInternalError("Blocksize %ld is larger than pipeline maximum of %ld", inBuffer->blocksize, self->maxBlocksize);
+    return false;
+  }
+
+  block = self->freeBlocks[--self->numFreeBlocks];
+  block->buffer->blocksize = inBuffer->blocksize;
+  sampleBufferCopy(block->buffer, inBuffer);
+  // The block's own list was cleared after its last trip through the pipeline,
+  // so it takes over collecting the events for the next block
+  midiEvents = block->midiEvents;
+  block->midiEvents = self->pendingMidiEvents;
+  self->pendingMidiEvents = midiEvents;
+
+  ringBufferPushBlocking(self->stages[0]->input, block);
+  self->numBlocksInFlight++;
+
+  // Keep one block in every stage, plus one more so that the caller can read
+  // the next block while the head plugin is busy.
+  if(self->numBlocksInFlight <= self->numStages) {
+    return false;
+  }
+  return _receivePipelineBlock(self, outBuffer, taskTimer);
+}
+
+boolByte pluginChainPipelineFlush(PluginChainPipeline self, SampleBuffer outBuffer, TaskTimer taskTimer) {
+  if(!self->isRunning) {
+    return false;
+  }
+  return _receivePipelineBlock(self, outBuffer, taskTimer);
+}
+
+void pluginChainPipelineStop(PluginChainPipeline self, TaskTimer taskTimer) {
+  PluginChainPipelineBlock block;
+  int i;
+
+  if(!self->isRunning) {
+    return;
+  }
+
+  // The stop marker is passed along behind any remaining blocks, which causes
+  // each stage to exit once it has finished all work before it.
+  ringBufferPushBlocking(self->stages[0]->input, self->stopBlock);
+  for(i = 0; i < self->numStages; i++) {
+    threadJoin(self->stages[i]->thread);
+  }
+  while((block = (PluginChainPipelineBlock)ringBufferPop(self->stages[self->numStages - 1]->output)) != NULL) {
+    if(block != self->stopBlock) {
+      linkedListClear(block->midiEvents);
+      self->freeBlocks[self->numFreeBlocks++] = block;
+    }
+  }
+  self->numBlocksInFlight = 0;
+  self->isRunning = false;
+
+  // Stage timers are cleared so that the time is not added again if the
+  // pipeline is restarted for another input source.
+  for(i = 0; i < self->numStages; i++) {
+    if(taskTimer != NULL && i < taskTimer->numTasks) {
+      taskTimerMergeTask(taskTimer, i, self->stages[i]->taskTimer, 0);
+    }
+    taskTimerReset(self->stages[i]->taskTimer);
+  }
+  logDebug("Stopped processing pipeline");
+}
+
+void freePluginChainPipeline(PluginChainPipeline self) {
+  PluginChainPipelineStage stage;
+  int i;
+
+  if(self == NULL) {
+    return;
+  }
+  pluginChainPipelineStop(self, NULL);
+
+  for(i = 0; i < self->numStages; i++) {
+    stage = self->stages[i];
+    if(i == 0) {
+      freeRingBuffer(stage->input);
+    }
+    freeRingBuffer(stage->output);
+    freeSampleBuffer(stage->outBuffer);
+    freeTaskTimer(stage->taskTimer);
+    freeThread(stage->thread);
+    free(stage);
+  }
+  free(self->stages);
+
+  for(i = 0; i < self->numBlocks; i++) {
+    _freePluginChainPipelineBlock(self->blocks[i]);
+  }
+  free(self->blocks);
+  free(self->freeBlocks);
+  _freePluginChainPipelineBlock(self->stopBlock);
+  freeLinkedList(self->pendingMidiEvents);
+  free(self);
+}
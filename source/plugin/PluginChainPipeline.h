@@ -0,0 +1,150 @@
+//
+// PluginChainPipeline.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginChainPipeline_h
+#define MrsWatson_PluginChainPipeline_h
+
+#include "app/MrsWatsonContext.h"
+#include "audio/SampleBuffer.h"
+#include "base/LinkedList.h"
+#include "base/RingBuffer.h"
+#include "base/Thread.h"
+#include "plugin/Plugin.h"
+#include "time/TaskTimer.h"
+
+/**
+ * A block of audio travelling through the pipeline, along with the MIDI events
+ * which should be delivered to the head plugin before processing it.
+ */
+typedef struct {
+  SampleBuffer buffer;
+  LinkedList midiEvents;
+} PluginChainPipelineBlockMembers;
+typedef PluginChainPipelineBlockMembers* PluginChainPipelineBlock;
+
+/**
+ * Each plugin in the chain is a stage with its own worker thread. A stage pops
+ * blocks from its input queue, processes them, and pushes them to its output
+ * queue, which is the input queue of the next stage.
+ */
+typedef struct {
+  Plugin plugin;
+  SampleBuffer outBuffer;
+  RingBuffer input;
+  RingBuffer output;
+  TaskTimer taskTimer;
+  Thread thread;
+  PluginChainPipelineBlock stopBlock;
+  // Context of the plugin chain, which is bound to the stage's thread
+  MrsWatsonContext context;
+} PluginChainPipelineStageMembers;
+typedef PluginChainPipelineStageMembers* PluginChainPipelineStage;
+
+typedef struct {
+  int numStages;
+  PluginChainPipelineStage* stages;
+  unsigned long maxBlocksize;
+  boolByte isRunning;
+
+  // Blocks are owned by the pipeline and recycled, the free list and pending
+  // MIDI events are only touched from the thread which feeds the pipeline.
+  int numBlocks;
+  PluginChainPipelineBlock* blocks;
+  PluginChainPipelineBlock* freeBlocks;
+  int numFreeBlocks;
+  int numBlocksInFlight;
+  PluginChainPipelineBlock stopBlock;
+  LinkedList pendingMidiEvents;
+} PluginChainPipelineMembers;
+typedef PluginChainPipelineMembers* PluginChainPipeline;
+
+/**
+ * Create a new pipeline for a list of plugins. The plugins should already be
+ * opened and prepared for processing.
+ * @param plugins Array of plugins, in processing order
+ * @param numPlugins Number of plugins in the array
+ * @param numChannels Initial channel count for audio blocks
+ * @param maxBlocksize Largest blocksize which will be sent through the pipeline
+ * @param context Context which the stage threads should run in
+ * @return New pipeline, or NULL if it could not be created
+ */
+PluginChainPipeline newPluginChainPipeline(Plugin* plugins, const int numPlugins,
+  const unsigned int numChannels, const unsigned long maxBlocksize, MrsWatsonContext context);
+
+/**
+ * Start the worker threads of each stage
+ * @param self
+ * @return True if all threads were started
+ */
+boolByte pluginChainPipelineStart(PluginChainPipeline self);
+
+/**
+ * Queue MIDI events to be sent to the head plugin along with the next block
+ * given to pluginChainPipelineProcess(). The list itself is not retained.
+ * @param self
+ * @param midiEvents List of MidiEvent objects
+ */
+void pluginChainPipelineQueueMidiEvents(PluginChainPipeline self, LinkedList midiEvents);
+
+/**
+ * Send a block of audio into the pipeline. Once the pipeline is full, this
+ * call also waits for the oldest block to come out of the last stage.
+ * @param self
+ * @param inBuffer Block of audio to process, which is copied by the pipeline
+ * @param outBuffer Receives the oldest processed block, if one is ready
+ * @param taskTimer Host task timer, or NULL. Time spent waiting for the
+ * pipeline is not counted against the host.
+ * @return True if outBuffer was filled with a processed block
+ */
+boolByte pluginChainPipelineProcess(PluginChainPipeline self, const SampleBuffer inBuffer,
+  SampleBuffer outBuffer, TaskTimer taskTimer);
+
+/**
+ * Receive the oldest block remaining in the pipeline without sending a new one
+ * @param self
+ * @param outBuffer Receives the processed block
+ * @param taskTimer Host task timer, or NULL
+ * @return True if outBuffer was filled, false if no blocks were in flight
+ */
+boolByte pluginChainPipelineFlush(PluginChainPipeline self, SampleBuffer outBuffer, TaskTimer taskTimer);
+
+/**
+ * Stop and join all worker threads. Any blocks still in flight are discarded,
+ * so call pluginChainPipelineFlush() first to keep them.
+ * @param self
+ * @param taskTimer If not NULL, time spent in each stage is added to the task
+ * with the same index as the stage.
+ */
+void pluginChainPipelineStop(PluginChainPipeline self, TaskTimer taskTimer);
+
+/**
+ * Free a pipeline, stopping it first if necessary. The plugins are not freed.
+ * @param self
+ */
+void freePluginChainPipeline(PluginChainPipeline self);
+
+#endif
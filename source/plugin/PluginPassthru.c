@@ -58,7 +58,9 @@ static int _pluginPassthruGetSetting(void* pluginPtr, PluginSetting pluginSettin
 }
 
 static void _pluginPassthruProcessAudio(void* pluginPtr, SampleBuffer inputs, SampleBuffer outputs) {
-  sampleBufferCopy(outputs, inputs);
+  if(inputs != outputs) {
+    sampleBufferCopy(outputs, inputs);
+  }
 }
 
 static void _pluginPassthruProcessMidiEvents(void* pluginPtr, LinkedList midiEvents) {
@@ -69,6 +71,15 @@ static void _pluginPassthruSetParameter(void* pluginPtr, int i, float value) {
   // Nothing to do here
 }
 
+static PluginSnapshot _pluginPassthruTakeSnapshot(void* pluginPtr) {
+  // This plugin has no state, so there is nothing to save
+  return newPluginSnapshot(NULL, 0);
+}
+
+static boolByte _pluginPassthruRestoreSnapshot(void* pluginPtr, const PluginSnapshot snapshot) {
+  return true;
+}
+
 Plugin newPluginPassthru(const CharString pluginName) {
   Plugin plugin = (Plugin)malloc(sizeof(PluginMembers));
 
@@ -80,6 +91,8 @@ Plugin newPluginPassthru(const CharString pluginName) {
   charStringCopyCString(plugin->pluginLocation, "Internal");
   plugin->numInputs = 2;
   plugin->numOutputs = 2;
+  plugin->overwritesOutputs = true;
+  plugin->canProcessInPlace = true;
 
   plugin->open = _pluginPassthruOpen;
   plugin->displayInfo = _pluginPassthruDisplayInfo;
@@ -89,6 +102,8 @@ Plugin newPluginPassthru(const CharString pluginName) {
   plugin->processAudio = _pluginPassthruProcessAudio;
   plugin->processMidiEvents = _pluginPassthruProcessMidiEvents;
   plugin->setParameter = _pluginPassthruSetParameter;
+  plugin->takeSnapshot = _pluginPassthruTakeSnapshot;
+  plugin->restoreSnapshot = _pluginPassthruRestoreSnapshot;
   plugin->closePlugin = _pluginPassthruEmpty;
   plugin->freePluginData = _pluginPassthruEmpty;
 
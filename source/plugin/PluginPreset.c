@@ -83,6 +83,25 @@ boolByte pluginPresetIsCompatibleWith(const PluginPreset pluginPreset, const Plu
   return (pluginPreset->compatiblePluginTypes & (1 << plugin->interfaceType));
 }
 
+boolByte pluginPresetLoadIntoPlugin(PluginPreset preset, Plugin plugin) {
+  if(pluginPresetIsCompatibleWith(preset, plugin)) {
+    if(!preset->openPreset(preset)) {
+      logError("Could not open preset '%s'", preset->presetName->data);
+      return false;
+    }
+    if(!preset->loadPreset(preset, plugin)) {
+      logError("Could not load preset '%s' in plugin '%s'", preset->presetName->data, plugin->pluginName->data);
+      return false;
+    }
+    logInfo("Loaded preset '%s' in plugin '%s'", preset->presetName->data, plugin->pluginName->data);
+    return true;
+  }
+  else {
+    logError("Preset '%s' is not a compatible format for plugin", preset->presetName->data);
+    return false;
+  }
+}
+
 void freePluginPreset(PluginPreset pluginPreset) {
   pluginPreset->freePresetData(pluginPreset->extraData);
   freeCharString(pluginPreset->presetName);
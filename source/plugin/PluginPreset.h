@@ -63,6 +63,15 @@ PluginPresetType pluginPresetGuessType(const CharString presetName);
 void _pluginPresetSetCompatibleWith(PluginPreset pluginPreset, PluginInterfaceType interfaceType);
 boolByte pluginPresetIsCompatibleWith(const PluginPreset pluginPreset, const Plugin plugin);
 
+/**
+ * Open a preset and load it into a plugin, after checking that the preset is
+ * compatible with the plugin
+ * @param pluginPreset Preset to load
+ * @param plugin Plugin to load the preset into, which must already be opened
+ * @return True if the preset was loaded
+ */
+boolByte pluginPresetLoadIntoPlugin(PluginPreset pluginPreset, Plugin plugin);
+
 void freePluginPreset(PluginPreset pluginPreset);
 
 #endif
@@ -0,0 +1,1012 @@
+//
+// PluginSandbox.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "app/MrsWatsonContext.h"
+#include "app/ReturnCodes.h"
+#include "base/LinkedList.h"
+#include "base/PlatformUtilities.h"
+#include "logging/EventLogger.h"
+#include "midi/MidiEvent.h"
+#include "plugin/PluginSandbox.h"
+
+#if UNIX
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if UNIX
+// Writing to the socket of a crashed process must not kill the host with SIGPIPE
+#if defined(MSG_NOSIGNAL)
+#define SANDBOX_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SANDBOX_SEND_FLAGS 0
+#endif
+// The socket must not be inherited by the child processes of other sandboxes
+#if defined(SOCK_CLOEXEC)
+#define SANDBOX_SOCKET_TYPE (SOCK_STREAM | SOCK_CLOEXEC)
+#else
+#define SANDBOX_SOCKET_TYPE SOCK_STREAM
+#endif
+#endif
+
+// Alignment of the sample data in the shared memory block
+#define SANDBOX_SAMPLE_ALIGNMENT 64
+
+typedef enum {
+  kPluginSandboxCommandOpen,
+  kPluginSandboxCommandDisplayInfo,
+  kPluginSandboxCommandGetSetting,
+  kPluginSandboxCommandPrepareForProcessing,
+  kPluginSandboxCommandProcessAudio,
+  kPluginSandboxCommandProcessMidiEvents,
+  kPluginSandboxCommandSetParameter,
+  kPluginSandboxCommandTakeSnapshot,
+  kPluginSandboxCommandRestoreSnapshot,
+  kPluginSandboxCommandClose,
+  kPluginSandboxCommandQuit
+} PluginSandboxCommand;
+
+/**
+ * Start of the shared memory block, which is followed by the input and output
+ * samples. The host fills in a command along with its arguments, and the child
+ * process fills in the results.
+ */
+typedef struct {
+  PluginSandboxCommand command;
+  int pluginIndex;
+  // The child's context is updated before each call, so that its plugins see
+  // the same settings and transport position as they would in the host
+  AudioSettingsMembers audioSettings;
+  AudioClockMembers audioClock;
+
+  int settingOrParameterIndex;
+  float parameterValue;
+  unsigned int numInputChannels;
+  unsigned int numOutputChannels;
+  unsigned long numInputFrames;
+  unsigned long numOutputFrames;
+  unsigned int numMidiEvents;
+  MidiEventMembers midiEvents[PLUGIN_SANDBOX_MAX_MIDI_EVENTS];
+
+  int result;
+  PluginType pluginType;
+  unsigned int numInputs;
+  unsigned int numOutputs;
+} PluginSandboxMessage;
+
+typedef struct {
+  PluginSandbox sandbox;
+  int pluginIndex;
+  Plugin plugin;
+} PluginSandboxProxyDataMembers;
+typedef PluginSandboxProxyDataMembers* PluginSandboxProxyData;
+
+PluginSandboxMode pluginSandboxModeFromString(const char* string) {
+  if(string == NULL) {
+    return kNumPluginSandboxModes;
+  }
+  else if(!strcmp(string, "plugin")) {
+    return kPluginSandboxModePlugin;
+  }
+  else if(!strcmp(string, "chain")) {
+    return kPluginSandboxModeChain;
+  }
+  else {
+    return kNumPluginSandboxModes;
+  }
+}
+
+boolByte pluginSandboxIsSupported(void) {
+#if UNIX
+  return true;
+#else
+  return false;
+#endif
+}
+
+PluginSandbox newPluginSandbox(void) {
+  PluginSandbox sandbox = (PluginSandbox)malloc(sizeof(PluginSandboxMembers));
+
+  sandbox->plugins = NULL;
+  sandbox->presets = NULL;
+  sandbox->isSnapshotTaken = NULL;
+  sandbox->numPlugins = 0;
+  sandbox->maxChannels = PLUGIN_SANDBOX_MAX_CHANNELS;
+  sandbox->maxFrames = 0;
+  sandbox->sharedMemory = NULL;
+  sandbox->sharedMemorySize = 0;
+  sandbox->inputChannels = (Samples*)malloc(sizeof(Samples) * sandbox->maxChannels);
+  sandbox->outputChannels = (Samples*)malloc(sizeof(Samples) * sandbox->maxChannels);
+#if UNIX
+  sandbox->sharedMemoryHandle = -1;
+  sandbox->processId = 0;
+  sandbox->socketHandle = -1;
+#endif
+  sandbox->isRunning = false;
+  sandbox->hasCrashed = false;
+  sandbox->mutex = newMutex();
+
+  return sandbox;
+}
+
+static int _pluginSandboxAddPlugin(PluginSandbox self, Plugin plugin, PluginPreset preset) {
+  self->plugins = (Plugin*)realloc(self->plugins, sizeof(Plugin) * (self->numPlugins + 1));
+  self->presets = (PluginPreset*)realloc(self->presets, sizeof(PluginPreset) * (self->numPlugins + 1));
+  self->isSnapshotTaken = (boolByte*)realloc(self->isSnapshotTaken, sizeof(boolByte) * (self->numPlugins + 1));
+  self->plugins[self->numPlugins] = plugin;
+  self->presets[self->numPlugins] = preset;
+  self->isSnapshotTaken[self->numPlugins] = false;
+  return self->numPlugins++;
+}
+
+/**
+ * Copy the settings and transport position of a context to the shared memory
+ * block, or from it. Programs which embed MrsWatson may not have a clock.
+ */
+static void _pluginSandboxCopyContext(MrsWatsonContext context, PluginSandboxMessage* message, const boolByte toMessage) {
+  AudioSettings audioSettings = mrsWatsonContextGetAudioSettings(context);
+  AudioClock audioClock = mrsWatsonContextGetAudioClock(context);
+
+  if(audioSettings != NULL) {
+    if(toMessage) {
+      message->audioSettings = *audioSettings;
+    }
+    else {
+      *audioSettings = message->audioSettings;
+    }
+  }
+  if(audioClock != NULL) {
+    if(toMessage) {
+      message->audioClock = *audioClock;
+    }
+    else {
+      *audioClock = message->audioClock;
+    }
+  }
+}
+
+#if UNIX
+static void _pluginSandboxSetCloseOnExec(const int fileHandle, const boolByte closeOnExec) {
+  int flags = fcntl(fileHandle, F_GETFD);
+  if(flags >= 0) {
+    fcntl(fileHandle, F_SETFD, closeOnExec ? (flags | FD_CLOEXEC) : (flags & ~FD_CLOEXEC));
+  }
+}
+
+static size_t _pluginSandboxGetSamplesOffset(void) {
+  return (sizeof(PluginSandboxMessage) + SANDBOX_SAMPLE_ALIGNMENT - 1) & ~((size_t)SANDBOX_SAMPLE_ALIGNMENT - 1);
+}
+
+static void _pluginSandboxSetMaxFrames(PluginSandbox self, const unsigned long maxFrames) {
+  self->maxFrames = maxFrames;
+  self->sharedMemorySize = _pluginSandboxGetSamplesOffset() + 2 * self->maxChannels * sizeof(Sample) * maxFrames;
+}
+
+/**
+ * Map the shared memory block and find the sample data in it. The host and
+ * child process both use the same maxFrames, so that they agree on where each
+ * channel is.
+ */
+static boolByte _pluginSandboxMapSharedMemory(PluginSandbox self, const int fileHandle) {
+  const size_t samplesOffset = _pluginSandboxGetSamplesOffset();
+  const size_t channelSize = sizeof(Sample) * self->maxFrames;
+  byte* sharedMemory;
+  unsigned int i;
+
+  sharedMemory = (byte*)mmap(NULL, self->sharedMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fileHandle, 0);
+  if(sharedMemory == (byte*)MAP_FAILED) {
+    logError("Could not map shared memory for plugin sandbox: %s", stringForLastError(errno));
+    return false;
+  }
+
+  self->sharedMemory = sharedMemory;
+  for(i = 0; i < self->maxChannels; i++) {
+    self->inputChannels[i] = (Samples)(sharedMemory + samplesOffset + i * channelSize);
+    self->outputChannels[i] = (Samples)(sharedMemory + samplesOffset + (self->maxChannels + i) * channelSize);
+  }
+  return true;
+}
+
+static boolByte _pluginSandboxCreateSharedMemory(PluginSandbox self) {
+  char sharedMemoryName[64];
+  int fileHandle;
+
+  snprintf(sharedMemoryName, sizeof(sharedMemoryName), "/mrswatson-%ld-%lx",
+    (long)getpid(), (unsigned long)(size_t)self);
+  fileHandle = shm_open(sharedMemoryName, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if(fileHandle < 0) {
+    logError("Could not create shared memory for plugin sandbox: %s", stringForLastError(errno));
+    return false;
+  }
+  // Only the handle is needed, which is passed on to each child process
+  shm_unlink(sharedMemoryName);
+  // Child processes of other sandboxes must not inherit the handle
+  _pluginSandboxSetCloseOnExec(fileHandle, true);
+
+  // The block is sized for the blocksize when the sandbox is first started,
+  // larger blocks are passed to the plugins in several parts
+  _pluginSandboxSetMaxFrames(self, getBlocksize());
+  if(ftruncate(fileHandle, (off_t)self->sharedMemorySize) != 0) {
+    logError("Could not allocate shared memory for plugin sandbox: %s", stringForLastError(errno));
+    close(fileHandle);
+    return false;
+  }
+  if(!_pluginSandboxMapSharedMemory(self, fileHandle)) {
+    close(fileHandle);
+    return false;
+  }
+  self->sharedMemoryHandle = fileHandle;
+  return true;
+}
+
+static boolByte _pluginSandboxSendToken(const int socketHandle, const char token) {
+  ssize_t result;
+  do {
+    result = send(socketHandle, &token, 1, SANDBOX_SEND_FLAGS);
+  } while(result < 0 && errno == EINTR);
+  return (boolByte)(result == 1);
+}
+
+static boolByte _pluginSandboxReceiveToken(const int socketHandle, char* outToken) {
+  ssize_t result;
+  do {
+    result = recv(socketHandle, outToken, 1, 0);
+  } while(result < 0 && errno == EINTR);
+  return (boolByte)(result == 1);
+}
+
+static void _pluginSandboxProcessAudio(PluginSandbox self, Plugin plugin, PluginSandboxMessage* message) {
+  SampleBufferMembers inputs;
+  SampleBufferMembers outputs;
+  unsigned int i;
+
+  // The buffers are views of the shared memory, so they have no data of their own
+  inputs.numChannels = message->numInputChannels;
+  inputs.blocksize = message->numInputFrames;
+  inputs.samples = self->inputChannels;
+  inputs.maxNumChannels = inputs.numChannels;
+  inputs.maxBlocksize = inputs.blocksize;
+  inputs._data = NULL;
+  outputs.numChannels = message->numOutputChannels;
+  outputs.blocksize = message->numOutputFrames;
+  outputs.samples = self->outputChannels;
+  outputs.maxNumChannels = outputs.numChannels;
+  outputs.maxBlocksize = outputs.blocksize;
+  outputs._data = NULL;
+  // The host clears the output buffer before calling each plugin
+  for(i = 0; i < outputs.numChannels; i++) {
+    memset(outputs.samples[i], 0, sizeof(Sample) * outputs.blocksize);
+  }
+  plugin->processAudio(plugin, &inputs, &outputs);
+}
+
+static void _pluginSandboxProcessMidiEvents(Plugin plugin, PluginSandboxMessage* message, LinkedList midiEvents) {
+  unsigned int i;
+
+  linkedListClear(midiEvents);
+  for(i = 0; i < message->numMidiEvents; i++) {
+    linkedListAppend(midiEvents, &(message->midiEvents[i]));
+  }
+  plugin->processMidiEvents(plugin, midiEvents);
+}
+
+/**
+ * Main loop of the child process, which runs until the host quits or closes
+ * its end of the socket
+ */
+static void _pluginSandboxServe(PluginSandbox self, const int socketHandle) {
+  PluginSandboxMessage* message = (PluginSandboxMessage*)self->sharedMemory;
+  MrsWatsonContext context = getMrsWatsonContext();
+  // Snapshots are kept by the child, since they may be larger than the shared memory block
+  PluginSnapshot* snapshots = (PluginSnapshot*)calloc(self->numPlugins, sizeof(PluginSnapshot));
+  // Reused for each block, so that sending events to the plugins does not allocate memory
+  LinkedList midiEvents = newLinkedList();
+  PluginPreset preset;
+  Plugin plugin;
+  char token;
+  int i;
+
+  while(_pluginSandboxReceiveToken(socketHandle, &token)) {
+    _pluginSandboxCopyContext(context, message, false);
+    if(message->command == kPluginSandboxCommandQuit) {
+      break;
+    }
+    else if(message->pluginIndex < 0 || message->pluginIndex >= self->numPlugins) {
+      logInternalError("Invalid plugin index %d in sandbox", message->pluginIndex);
+      break;
+    }
+
+    plugin = self->plugins[message->pluginIndex];
+    switch(message->command) {
+      case kPluginSandboxCommandOpen:
+        message->result = plugin->open(plugin);
+        preset = self->presets[message->pluginIndex];
+        if(message->result && preset != NULL) {
+          message->result = pluginPresetLoadIntoPlugin(preset, plugin);
+        }
+        message->pluginType = plugin->pluginType;
+        message->numInputs = plugin->numInputs;
+        message->numOutputs = plugin->numOutputs;
+        break;
+      case kPluginSandboxCommandDisplayInfo:
+        plugin->displayInfo(plugin);
+        break;
+      case kPluginSandboxCommandGetSetting:
+        message->result = plugin->getSetting(plugin, (PluginSetting)message->settingOrParameterIndex);
+        break;
+      case kPluginSandboxCommandPrepareForProcessing:
+        plugin->prepareForProcessing(plugin);
+        break;
+      case kPluginSandboxCommandProcessAudio:
+        _pluginSandboxProcessAudio(self, plugin, message);
+        break;
+      case kPluginSandboxCommandProcessMidiEvents:
+        _pluginSandboxProcessMidiEvents(plugin, message, midiEvents);
+        break;
+      case kPluginSandboxCommandSetParameter:
+        plugin->setParameter(plugin, message->settingOrParameterIndex, message->parameterValue);
+        break;
+      case kPluginSandboxCommandTakeSnapshot:
+        freePluginSnapshot(snapshots[message->pluginIndex]);
+        snapshots[message->pluginIndex] = plugin->takeSnapshot(plugin);
+        message->result = snapshots[message->pluginIndex] != NULL;
+        break;
+      case kPluginSandboxCommandRestoreSnapshot:
+        message->result = snapshots[message->pluginIndex] != NULL &&
+          plugin->restoreSnapshot(plugin, snapshots[message->pluginIndex]);
+        break;
+      case kPluginSandboxCommandClose:
+        plugin->closePlugin(plugin);
+        break;
+      default:
+        logInternalError("Invalid sandbox command %d", message->command);
+        break;
+    }
+
+    if(!_pluginSandboxSendToken(socketHandle, token)) {
+      break;
+    }
+  }
+
+  // Unload the plugins before answering the host, so that any crash while
+  // doing so is still reported
+  for(i = 0; i < self->numPlugins; i++) {
+    freePluginSnapshot(snapshots[i]);
+    freePlugin(self->plugins[i]);
+  }
+  free(snapshots);
+  freeLinkedList(midiEvents);
+  _pluginSandboxSendToken(socketHandle, token);
+}
+
+static char* _pluginSandboxNewArgument(const char* string) {
+  char* argument = (char*)malloc(strlen(string) + 1);
+  strcpy(argument, string);
+  return argument;
+}
+
+static char* _pluginSandboxNewNumberArgument(const long number) {
+  char numberString[32];
+  snprintf(numberString, sizeof(numberString), "%ld", number);
+  return _pluginSandboxNewArgument(numberString);
+}
+
+/**
+ * Build the command line of the child process, which is parsed again by
+ * pluginSandboxChildMain(). Everything is allocated here, since the child may
+ * not allocate memory between fork() and exec().
+ * @param self
+ * @param executablePath Path to the program to start
+ * @param socketHandle Handle of the child's end of the socket
+ * @return NULL-terminated argument array
+ */
+static char** _pluginSandboxNewChildArguments(PluginSandbox self, const CharString executablePath, const int socketHandle) {
+  char** arguments = (char**)calloc(6 + 5 * self->numPlugins + 1, sizeof(char*));
+  EventLogger eventLogger = getEventLogger();
+  int argumentIndex = 0;
+  PluginPreset preset;
+  Plugin plugin;
+  int i;
+
+  arguments[argumentIndex++] = _pluginSandboxNewArgument(executablePath->data);
+  arguments[argumentIndex++] = _pluginSandboxNewArgument(PLUGIN_SANDBOX_CHILD_OPTION);
+  arguments[argumentIndex++] = _pluginSandboxNewNumberArgument(socketHandle);
+  arguments[argumentIndex++] = _pluginSandboxNewNumberArgument(self->sharedMemoryHandle);
+  arguments[argumentIndex++] = _pluginSandboxNewNumberArgument((long)self->maxFrames);
+  // Programs which embed MrsWatson may not have a logger, in which case the child does not log either
+  arguments[argumentIndex++] = _pluginSandboxNewNumberArgument(eventLogger != NULL ? eventLogger->logLevel : NUM_LOG_LEVELS);
+  for(i = 0; i < self->numPlugins; i++) {
+    plugin = self->plugins[i];
+    preset = self->presets[i];
+    arguments[argumentIndex++] = _pluginSandboxNewNumberArgument(plugin->interfaceType);
+    arguments[argumentIndex++] = _pluginSandboxNewArgument(plugin->pluginName->data);
+    arguments[argumentIndex++] = _pluginSandboxNewArgument(plugin->pluginLocation->data);
+    arguments[argumentIndex++] = _pluginSandboxNewNumberArgument(preset != NULL ? preset->presetType : PRESET_TYPE_INVALID);
+    arguments[argumentIndex++] = _pluginSandboxNewArgument(preset != NULL ? preset->presetName->data : "");
+  }
+  return arguments;
+}
+
+static void _freePluginSandboxChildArguments(char** arguments) {
+  char** argument;
+  for(argument = arguments; *argument != NULL; argument++) {
+    free(*argument);
+  }
+  free(arguments);
+}
+
+static boolByte _pluginSandboxStart(PluginSandbox self) {
+  CharString executablePath;
+  char** arguments;
+  int socketHandles[2];
+  pid_t processId;
+#if defined(SO_NOSIGPIPE)
+  int noSigPipe = 1;
+#endif
+
+  if(self->sharedMemory == NULL && !_pluginSandboxCreateSharedMemory(self)) {
+    return false;
+  }
+  executablePath = getExecutablePath();
+  if(executablePath == NULL || charStringIsEmpty(executablePath)) {
+    logError("Could not find the executable to start the plugin sandbox with");
+    freeCharString(executablePath);
+    return false;
+  }
+  if(socketpair(AF_UNIX, SANDBOX_SOCKET_TYPE, 0, socketHandles) != 0) {
+    logError("Could not create socket for plugin sandbox: %s", stringForLastError(errno));
+    freeCharString(executablePath);
+    return false;
+  }
+  // Only the child process of this sandbox may hold the other end of the
+  // socket, otherwise a crash would not close it. This is already the case
+  // on platforms which have SOCK_CLOEXEC.
+  _pluginSandboxSetCloseOnExec(socketHandles[0], true);
+  _pluginSandboxSetCloseOnExec(socketHandles[1], true);
+#if defined(SO_NOSIGPIPE)
+  setsockopt(socketHandles[0], SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+  setsockopt(socketHandles[1], SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+  arguments = _pluginSandboxNewChildArguments(self, executablePath, socketHandles[1]);
+  processId = fork();
+  if(processId == 0) {
+    // Other threads of the host may hold locks which are never released in
+    // this process, so only async-signal-safe functions are called until exec
+    _pluginSandboxSetCloseOnExec(socketHandles[1], false);
+    _pluginSandboxSetCloseOnExec(self->sharedMemoryHandle, false);
+    execv(arguments[0], arguments);
+    _exit(RETURN_CODE_NOT_RUN);
+  }
+
+  _freePluginSandboxChildArguments(arguments);
+  freeCharString(executablePath);
+  close(socketHandles[1]);
+  if(processId < 0) {
+    logError("Could not start plugin sandbox process: %s", stringForLastError(errno));
+    close(socketHandles[0]);
+    return false;
+  }
+  self->processId = processId;
+  self->socketHandle = socketHandles[0];
+  self->isRunning = true;
+  self->hasCrashed = false;
+  logDebug("Started sandbox process %ld for %d plugin(s)", (long)processId, self->numPlugins);
+  return true;
+}
+
+static void _pluginSandboxHandleCrash(PluginSandbox self, const int pluginIndex) {
+  CharString description = newCharString();
+  int status = 0;
+
+  close(self->socketHandle);
+  self->socketHandle = -1;
+  self->isRunning = false;
+  self->hasCrashed = true;
+
+  if(pluginIndex >= 0) {
+    snprintf(description->data, description->length, "Plugin '%s'", self->plugins[pluginIndex]->pluginName->data);
+  }
+  else {
+    snprintf(description->data, description->length, "Sandbox process %ld", (long)self->processId);
+  }
+  if(waitpid(self->processId, &status, 0) != self->processId) {
+    logError("%s could not be reached: %s", description->data, stringForLastError(errno));
+  }
+  else if(WIFSIGNALED(status)) {
+    logError("%s crashed with signal %d (%s)", description->data, WTERMSIG(status), strsignal(WTERMSIG(status)));
+  }
+  else {
+    logError("%s exited unexpectedly with status %d", description->data, WEXITSTATUS(status));
+  }
+  freeCharString(description);
+}
+#endif
+
+/**
+ * Send a command to the child process and wait for it to finish. Must be
+ * called with the sandbox's mutex held.
+ * @param self
+ * @param command Command to send, the arguments of which are already set
+ * @param pluginIndex Index of the plugin to call, or -1 if the command does
+ * not belong to a single plugin
+ * @return True if the command was processed, false if the child crashed
+ */
+static boolByte _pluginSandboxCall(PluginSandbox self, const PluginSandboxCommand command, const int pluginIndex) {
+#if UNIX
+  PluginSandboxMessage* message = (PluginSandboxMessage*)self->sharedMemory;
+  MrsWatsonContext context = getMrsWatsonContext();
+  char token = (char)command;
+
+  if(!self->isRunning) {
+    return false;
+  }
+
+  message->command = command;
+  message->pluginIndex = pluginIndex;
+  _pluginSandboxCopyContext(context, message, true);
+  if(!_pluginSandboxSendToken(self->socketHandle, token) ||
+    !_pluginSandboxReceiveToken(self->socketHandle, &token)) {
+    _pluginSandboxHandleCrash(self, pluginIndex);
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+static boolByte _pluginSandboxOpenPlugin(PluginSandbox self, const int pluginIndex, Plugin proxy) {
+  PluginSandboxMessage* message = (PluginSandboxMessage*)self->sharedMemory;
+
+  if(!_pluginSandboxCall(self, kPluginSandboxCommandOpen, pluginIndex) || !message->result) {
+    return false;
+  }
+  if(message->numInputs > self->maxChannels || message->numOutputs > self->maxChannels) {
+    logError("Plugin '%s' has more than %d channels, and cannot be sandboxed",
+      self->plugins[pluginIndex]->pluginName->data, self->maxChannels);
+    return false;
+  }
+  if(proxy != NULL) {
+    proxy->pluginType = message->pluginType;
+    proxy->numInputs = message->numInputs;
+    proxy->numOutputs = message->numOutputs;
+  }
+  return true;
+}
+
+boolByte pluginSandboxHasCrashed(PluginSandbox self) {
+  boolByte result;
+  mutexLock(self->mutex);
+  result = self->hasCrashed;
+  mutexUnlock(self->mutex);
+  return result;
+}
+
+boolByte pluginSandboxRestart(PluginSandbox self) {
+  boolByte result = true;
+  int i;
+
+  mutexLock(self->mutex);
+  if(!self->isRunning) {
+    logInfo("Restarting sandbox process for %d plugin(s)", self->numPlugins);
+#if UNIX
+    result = _pluginSandboxStart(self);
+#else
+    result = false;
+#endif
+    for(i = 0; result && i < self->numPlugins; i++) {
+      result = _pluginSandboxOpenPlugin(self, i, NULL);
+      // The plugin is in the same state as when the snapshot was first taken,
+      // so it must be taken again for the plugin to be restored later on
+      if(result && self->isSnapshotTaken[i]) {
+        result = _pluginSandboxCall(self, kPluginSandboxCommandTakeSnapshot, i);
+      }
+    }
+  }
+  mutexUnlock(self->mutex);
+  return result;
+}
+
+void pluginSandboxStop(PluginSandbox self) {
+  mutexLock(self->mutex);
+#if UNIX
+  if(self->isRunning && _pluginSandboxCall(self, kPluginSandboxCommandQuit, -1)) {
+    waitpid(self->processId, NULL, 0);
+    close(self->socketHandle);
+    self->socketHandle = -1;
+    self->isRunning = false;
+    logDebug("Stopped sandbox process %ld", (long)self->processId);
+  }
+#endif
+  mutexUnlock(self->mutex);
+}
+
+void freePluginSandbox(PluginSandbox self) {
+  pluginSandboxStop(self);
+#if UNIX
+  if(self->sharedMemory != NULL) {
+    munmap(self->sharedMemory, self->sharedMemorySize);
+  }
+  if(self->sharedMemoryHandle >= 0) {
+    close(self->sharedMemoryHandle);
+  }
+#endif
+  free(self->plugins);
+  free(self->presets);
+  free(self->isSnapshotTaken);
+  free(self->inputChannels);
+  free(self->outputChannels);
+  freeMutex(self->mutex);
+  free(self);
+}
+
+boolByte pluginSandboxIsChildProcess(int argc, char** argv) {
+  return (boolByte)(argc > 1 && !strcmp(argv[1], PLUGIN_SANDBOX_CHILD_OPTION));
+}
+
+int pluginSandboxChildMain(int argc, char** argv, PluginSandboxFactoryFunc pluginFactory) {
+#if UNIX
+  ReturnCodes result = RETURN_CODE_SUCCESS;
+  PluginSandbox sandbox;
+  CharString pluginName;
+  CharString pluginLocation;
+  CharString presetName;
+  PluginPresetType presetType;
+  PluginInterfaceType interfaceType;
+  Plugin plugin;
+  int socketHandle;
+  int sharedMemoryHandle;
+  int argumentIndex;
+  int i;
+
+  initEventLogger();
+  initAudioSettings();
+  initAudioClock();
+  // Pressing ^C should only stop the host, which then stops this process
+  signal(SIGINT, SIG_IGN);
+
+  // See _pluginSandboxNewChildArguments() for the order of the arguments
+  if(argc < 6 || (argc - 6) % 5 != 0) {
+    logInternalError("Invalid arguments for sandbox process");
+    return RETURN_CODE_INVALID_ARGUMENT;
+  }
+  socketHandle = (int)strtol(argv[2], NULL, 10);
+  sharedMemoryHandle = (int)strtol(argv[3], NULL, 10);
+  setLogLevel((LogLevel)strtol(argv[5], NULL, 10));
+
+  sandbox = newPluginSandbox();
+  _pluginSandboxSetMaxFrames(sandbox, strtoul(argv[4], NULL, 10));
+  if(!_pluginSandboxMapSharedMemory(sandbox, sharedMemoryHandle)) {
+    close(socketHandle);
+    freePluginSandbox(sandbox);
+    return RETURN_CODE_IO_ERROR;
+  }
+  sandbox->sharedMemoryHandle = sharedMemoryHandle;
+
+  pluginName = newCharString();
+  pluginLocation = newCharString();
+  presetName = newCharString();
+  for(argumentIndex = 6; argumentIndex < argc; argumentIndex += 5) {
+    interfaceType = (PluginInterfaceType)strtol(argv[argumentIndex], NULL, 10);
+    charStringCopyCString(pluginName, argv[argumentIndex + 1]);
+    charStringCopyCString(pluginLocation, argv[argumentIndex + 2]);
+    presetType = (PluginPresetType)strtol(argv[argumentIndex + 3], NULL, 10);
+    charStringCopyCString(presetName, argv[argumentIndex + 4]);
+
+    plugin = pluginFactory(interfaceType, pluginName, pluginLocation);
+    if(plugin == NULL) {
+      logError("Plugin '%s' could not be loaded in the sandbox process", pluginName->data);
+      result = RETURN_CODE_PLUGIN_ERROR;
+      break;
+    }
+    _pluginSandboxAddPlugin(sandbox, plugin,
+      presetType != PRESET_TYPE_INVALID ? newPluginPreset(presetType, presetName) : NULL);
+  }
+
+  // The plugins are freed by the main loop, while the presets belong to this function
+  if(result == RETURN_CODE_SUCCESS) {
+    _pluginSandboxServe(sandbox, socketHandle);
+  }
+  else {
+    for(i = 0; i < sandbox->numPlugins; i++) {
+      freePlugin(sandbox->plugins[i]);
+    }
+  }
+  for(i = 0; i < sandbox->numPlugins; i++) {
+    if(sandbox->presets[i] != NULL) {
+      freePluginPreset(sandbox->presets[i]);
+    }
+  }
+
+  close(socketHandle);
+  freeCharString(pluginName);
+  freeCharString(pluginLocation);
+  freeCharString(presetName);
+  freePluginSandbox(sandbox);
+  freeAudioSettings();
+  freeEventLogger();
+  return result;
+#else
+  logUnsupportedFeature("Plugin sandboxing");
+  return RETURN_CODE_UNSUPPORTED_FEATURE;
+#endif
+}
+
+static boolByte _pluginSandboxProxyOpen(void* pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+  PluginSandbox sandbox = data->sandbox;
+  boolByte result = false;
+
+  mutexLock(sandbox->mutex);
+  // The child process is started when its first plugin is opened, after all
+  // plugins have been added to the sandbox
+#if UNIX
+  if(!sandbox->isRunning && !sandbox->hasCrashed) {
+    _pluginSandboxStart(sandbox);
+  }
+#else
+  logUnsupportedFeature("Plugin sandboxing");
+#endif
+  if(sandbox->isRunning) {
+    result = _pluginSandboxOpenPlugin(sandbox, data->pluginIndex, self);
+  }
+  mutexUnlock(sandbox->mutex);
+  return result;
+}
+
+static void _pluginSandboxProxyDisplayInfo(void* pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+
+  mutexLock(data->sandbox->mutex);
+  _pluginSandboxCall(data->sandbox, kPluginSandboxCommandDisplayInfo, data->pluginIndex);
+  mutexUnlock(data->sandbox->mutex);
+}
+
+static void _pluginSandboxProxyGetAbsolutePath(void* pluginPtr, CharString outPath) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+  // Finding the path does not require the plugin to be opened
+  data->plugin->getAbsolutePath(data->plugin, outPath);
+}
+
+static int _pluginSandboxProxyGetSetting(void* pluginPtr, PluginSetting pluginSetting) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+  PluginSandboxMessage* message = (PluginSandboxMessage*)data->sandbox->sharedMemory;
+  int result = 0;
+
+  mutexLock(data->sandbox->mutex);
+  if(message != NULL) {
+    message->settingOrParameterIndex = pluginSetting;
+    if(_pluginSandboxCall(data->sandbox, kPluginSandboxCommandGetSetting, data->pluginIndex)) {
+      result = message->result;
+    }
+  }
+  mutexUnlock(data->sandbox->mutex);
+  return result;
+}
+
+static void _pluginSandboxProxyProcessAudio(void* pluginPtr, SampleBuffer inputs, SampleBuffer outputs) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+  PluginSandbox sandbox = data->sandbox;
+  PluginSandboxMessage* message = (PluginSandboxMessage*)sandbox->sharedMemory;
+  unsigned long totalFrames = inputs->blocksize > outputs->blocksize ? inputs->blocksize : outputs->blocksize;
+  unsigned long frameOffset;
+  unsigned int i;
+  boolByte result = true;
+
+  if(message == NULL) {
+    sampleBufferClear(outputs);
+    return;
+  }
+
+  mutexLock(sandbox->mutex);
+  message->numInputChannels = inputs->numChannels < sandbox->maxChannels ? inputs->numChannels : sandbox->maxChannels;
+  message->numOutputChannels = outputs->numChannels < sandbox->maxChannels ? outputs->numChannels : sandbox->maxChannels;
+  // Blocks which are larger than the shared memory are processed in parts
+  for(frameOffset = 0; result && frameOffset < totalFrames; frameOffset += sandbox->maxFrames) {
+    message->numInputFrames = inputs->blocksize > frameOffset ? inputs->blocksize - frameOffset : 0;
+    if(message->numInputFrames > sandbox->maxFrames) {
+      message->numInputFrames = sandbox->maxFrames;
+    }
+    message->numOutputFrames = outputs->blocksize > frameOffset ? outputs->blocksize - frameOffset : 0;
+    if(message->numOutputFrames > sandbox->maxFrames) {
+      message->numOutputFrames = sandbox->maxFrames;
+    }
+
+    for(i = 0; i < message->numInputChannels; i++) {
+      memcpy(sandbox->inputChannels[i], inputs->samples[i] + frameOffset, sizeof(Sample) * message->numInputFrames);
+    }
+    result = _pluginSandboxCall(sandbox, kPluginSandboxCommandProcessAudio, data->pluginIndex);
+    if(result) {
+      for(i = 0; i < message->numOutputChannels; i++) {
+        memcpy(outputs->samples[i] + frameOffset, sandbox->outputChannels[i], sizeof(Sample) * message->numOutputFrames);
+      }
+    }
+  }
+  mutexUnlock(sandbox->mutex);
+
+  // A plugin which has crashed only outputs silence
+  if(!result) {
+    sampleBufferClear(outputs);
+  }
+}
+
+static void _pluginSandboxProxyProcessMidiEvents(void* pluginPtr, LinkedList midiEvents) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+  PluginSandboxMessage* message = (PluginSandboxMessage*)data->sandbox->sharedMemory;
+  LinkedListIterator iterator = midiEvents;
+  MidiEvent midiEvent;
+  unsigned int numDroppedEvents = 0;
+
+  if(message == NULL) {
+    return;
+  }
+
+  mutexLock(data->sandbox->mutex);
+  message->numMidiEvents = 0;
+  while(iterator != NULL && iterator->item != NULL) {
+    midiEvent = (MidiEvent)iterator->item;
+    if(message->numMidiEvents < PLUGIN_SANDBOX_MAX_MIDI_EVENTS) {
+      message->midiEvents[message->numMidiEvents] = *midiEvent;
+      // Extra data for sysex and meta events is not passed to the sandbox
+      message->midiEvents[message->numMidiEvents].extraData = NULL;
+      message->numMidiEvents++;
+    }
+    else {
+      numDroppedEvents++;
+    }
+    iterator = iterator->nextItem;
+  }
+  _pluginSandboxCall(data->sandbox, kPluginSandboxCommandProcessMidiEvents, data->pluginIndex);
+  mutexUnlock(data->sandbox->mutex);
+
+  if(numDroppedEvents > 0) {
+    logWarn("Dropped %d MIDI events for sandboxed plugin '%s'", numDroppedEvents, self->pluginName->data);
+  }
+}
+
+static void _pluginSandboxProxySetParameter(void* pluginPtr, int index, float value) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+  PluginSandboxMessage* message = (PluginSandboxMessage*)data->sandbox->sharedMemory;
+
+  if(message == NULL) {
+    return;
+  }
+  mutexLock(data->sandbox->mutex);
+  message->settingOrParameterIndex = index;
+  message->parameterValue = value;
+  _pluginSandboxCall(data->sandbox, kPluginSandboxCommandSetParameter, data->pluginIndex);
+  mutexUnlock(data->sandbox->mutex);
+}
+
+static PluginSnapshot _pluginSandboxProxyTakeSnapshot(void* pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+  PluginSandbox sandbox = data->sandbox;
+  PluginSandboxMessage* message = (PluginSandboxMessage*)sandbox->sharedMemory;
+  PluginSnapshot snapshot = NULL;
+
+  mutexLock(sandbox->mutex);
+  if(_pluginSandboxCall(sandbox, kPluginSandboxCommandTakeSnapshot, data->pluginIndex) && message->result) {
+    sandbox->isSnapshotTaken[data->pluginIndex] = true;
+    // The snapshot's data stays in the child process, so the host only gets an empty one
+    snapshot = newPluginSnapshot(NULL, 0);
+  }
+  mutexUnlock(sandbox->mutex);
+  return snapshot;
+}
+
+static boolByte _pluginSandboxProxyRestoreSnapshot(void* pluginPtr, const PluginSnapshot snapshot) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+  PluginSandboxMessage* message = (PluginSandboxMessage*)data->sandbox->sharedMemory;
+  boolByte result;
+
+  mutexLock(data->sandbox->mutex);
+  result = _pluginSandboxCall(data->sandbox, kPluginSandboxCommandRestoreSnapshot, data->pluginIndex) && message->result;
+  mutexUnlock(data->sandbox->mutex);
+  return result;
+}
+
+static void _pluginSandboxProxyPrepareForProcessing(void* pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+
+  mutexLock(data->sandbox->mutex);
+  _pluginSandboxCall(data->sandbox, kPluginSandboxCommandPrepareForProcessing, data->pluginIndex);
+  mutexUnlock(data->sandbox->mutex);
+}
+
+static void _pluginSandboxProxyClose(void* pluginPtr) {
+  Plugin self = (Plugin)pluginPtr;
+  PluginSandboxProxyData data = (PluginSandboxProxyData)self->extraData;
+
+  mutexLock(data->sandbox->mutex);
+  _pluginSandboxCall(data->sandbox, kPluginSandboxCommandClose, data->pluginIndex);
+  mutexUnlock(data->sandbox->mutex);
+}
+
+static void _pluginSandboxProxyFreeData(void* pluginDataPtr) {
+  PluginSandboxProxyData data = (PluginSandboxProxyData)pluginDataPtr;
+  freePlugin(data->plugin);
+  free(data);
+}
+
+Plugin newPluginSandboxProxy(PluginSandbox sandbox, Plugin plugin, PluginPreset preset) {
+  Plugin proxy = (Plugin)malloc(sizeof(PluginMembers));
+  PluginSandboxProxyData data = (PluginSandboxProxyData)malloc(sizeof(PluginSandboxProxyDataMembers));
+
+  proxy->interfaceType = plugin->interfaceType;
+  proxy->pluginType = plugin->pluginType;
+  proxy->pluginName = newCharString();
+  charStringCopy(proxy->pluginName, plugin->pluginName);
+  proxy->pluginLocation = newCharString();
+  charStringCopy(proxy->pluginLocation, plugin->pluginLocation);
+  proxy->numInputs = plugin->numInputs;
+  proxy->numOutputs = plugin->numOutputs;
+  // Inputs are copied to shared memory before the outputs are copied back, and
+  // the sandboxed plugin's outputs are cleared in the child process
+  proxy->overwritesOutputs = true;
+  proxy->canProcessInPlace = true;
+
+  proxy->open = _pluginSandboxProxyOpen;
+  proxy->displayInfo = _pluginSandboxProxyDisplayInfo;
+  proxy->getAbsolutePath = _pluginSandboxProxyGetAbsolutePath;
+  proxy->getSetting = _pluginSandboxProxyGetSetting;
+  proxy->processAudio = _pluginSandboxProxyProcessAudio;
+  proxy->processMidiEvents = _pluginSandboxProxyProcessMidiEvents;
+  proxy->setParameter = _pluginSandboxProxySetParameter;
+  proxy->takeSnapshot = _pluginSandboxProxyTakeSnapshot;
+  proxy->restoreSnapshot = _pluginSandboxProxyRestoreSnapshot;
+  proxy->prepareForProcessing = _pluginSandboxProxyPrepareForProcessing;
+  proxy->closePlugin = _pluginSandboxProxyClose;
+  proxy->freePluginData = _pluginSandboxProxyFreeData;
+
+  data->sandbox = sandbox;
+  data->plugin = plugin;
+  data->pluginIndex = _pluginSandboxAddPlugin(sandbox, plugin, preset);
+  proxy->extraData = data;
+
+  return proxy;
+}
@@ -0,0 +1,193 @@
+//
+// PluginSandbox.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginSandbox_h
+#define MrsWatson_PluginSandbox_h
+
+#include "base/PlatformUtilities.h"
+#include "base/Thread.h"
+#include "base/Types.h"
+#include "plugin/Plugin.h"
+#include "plugin/PluginPreset.h"
+
+#if UNIX
+#include <sys/types.h>
+#endif
+
+// Largest number of channels which can be passed to a sandboxed plugin
+#define PLUGIN_SANDBOX_MAX_CHANNELS 32
+// Largest number of MIDI events which can be sent to a sandboxed plugin in one block
+#define PLUGIN_SANDBOX_MAX_MIDI_EVENTS 1024
+// First argument of the program when it is started as a sandbox process
+#define PLUGIN_SANDBOX_CHILD_OPTION "--sandbox-child"
+
+/**
+ * How plugins in a chain are isolated from the host process
+ */
+typedef enum {
+  // Plugins are loaded into the host process
+  kPluginSandboxModeNone,
+  // Each plugin runs in its own process
+  kPluginSandboxModePlugin,
+  // All plugins in the chain share a single process
+  kPluginSandboxModeChain,
+  kNumPluginSandboxModes
+} PluginSandboxMode;
+
+/**
+ * Function which creates the plugins in a sandbox process. Its arguments are
+ * the same as those of newPlugin(), which is used by MrsWatson itself.
+ */
+typedef Plugin (*PluginSandboxFactoryFunc)(PluginInterfaceType interfaceType,
+  const CharString pluginName, const CharString pluginLocation);
+
+/**
+ * A child process which hosts one or more plugins, so that a plugin which
+ * crashes only takes down its own process. The host talks to the child through
+ * a block of shared memory which holds the arguments of each call along with
+ * the audio and MIDI data. Each call wakes up the child by sending a single
+ * byte through a socket, and the child answers the same way once it is done.
+ * If the child dies, the socket is closed, so a crash is noticed on the next
+ * call without any polling.
+ *
+ * The child process is the host's own executable, which is started again with
+ * PLUGIN_SANDBOX_CHILD_OPTION and loads the plugins by their name and location.
+ * The host may be running other threads, so it cannot simply fork itself, as
+ * the child could then deadlock on a lock held by one of these threads.
+ */
+typedef struct {
+  // Plugins hosted by the child process. The host never opens its copies, but
+  // passes their name and location to the child, which loads them itself.
+  Plugin* plugins;
+  PluginPreset* presets;
+  // Plugins whose snapshot must be taken again when the child is restarted
+  boolByte* isSnapshotTaken;
+  int numPlugins;
+
+  unsigned int maxChannels;
+  unsigned long maxFrames;
+  void* sharedMemory;
+  size_t sharedMemorySize;
+  Samples* inputChannels;
+  Samples* outputChannels;
+
+#if UNIX
+  int sharedMemoryHandle;
+  pid_t processId;
+  int socketHandle;
+#endif
+  boolByte isRunning;
+  boolByte hasCrashed;
+  // Held for each call, since the same sandbox may be used by several threads
+  Mutex mutex;
+} PluginSandboxMembers;
+typedef PluginSandboxMembers* PluginSandbox;
+
+/**
+ * Parse a sandbox mode given by the user, either "plugin" or "chain"
+ * @param string String to parse
+ * @return Parsed mode, or kNumPluginSandboxModes if the string is invalid
+ */
+PluginSandboxMode pluginSandboxModeFromString(const char* string);
+
+/**
+ * @return True if plugins can be sandboxed on this platform
+ */
+boolByte pluginSandboxIsSupported(void);
+
+/**
+ * Check if the program was started as a sandbox process, in which case
+ * pluginSandboxChildMain() must be called instead of the program's usual main
+ * function. Programs which sandbox plugins must do this at the very start of
+ * main(), before any threads are started.
+ * @param argc Number of arguments passed to main()
+ * @param argv Arguments passed to main()
+ * @return True if this is a sandbox process
+ */
+boolByte pluginSandboxIsChildProcess(int argc, char** argv);
+
+/**
+ * Host the plugins of a sandbox until the parent process stops it
+ * @param argc Number of arguments passed to main()
+ * @param argv Arguments passed to main()
+ * @param pluginFactory Function which creates the plugins, usually newPlugin()
+ * @return Exit code for the process
+ */
+int pluginSandboxChildMain(int argc, char** argv, PluginSandboxFactoryFunc pluginFactory);
+
+/**
+ * Create a new sandbox. The child process is started by the first call to one
+ * of its plugins, so all plugins should be added before then.
+ * @return Sandbox instance
+ */
+PluginSandbox newPluginSandbox(void);
+
+/**
+ * Create a plugin which forwards all calls to a plugin hosted in a sandbox.
+ * The returned plugin has the same name, location and interface type as the
+ * hosted one, and takes ownership of it. Presets are loaded by the sandbox
+ * when the plugin is opened, so they should not be loaded into the returned
+ * plugin.
+ * @param sandbox Sandbox which hosts the plugin
+ * @param plugin Plugin to host, which must not have been opened
+ * @param preset Preset to load after opening the plugin, or NULL. This is not
+ * owned by the sandbox, and must outlive it.
+ * @return Plugin which calls the hosted plugin
+ */
+Plugin newPluginSandboxProxy(PluginSandbox sandbox, Plugin plugin, PluginPreset preset);
+
+/**
+ * @param self
+ * @return True if the child process crashed, or exited without being stopped
+ */
+boolByte pluginSandboxHasCrashed(PluginSandbox self);
+
+/**
+ * Start a new child process after a crash, and open all plugins in it again.
+ * Parameters which were set on the plugins are lost, but their presets are
+ * loaded again. Plugins which had a snapshot get a new one of their freshly
+ * loaded state.
+ * @param self
+ * @return True if the plugins were opened in the new process
+ */
+boolByte pluginSandboxRestart(PluginSandbox self);
+
+/**
+ * Stop the child process, which frees the plugins hosted by it. Afterwards
+ * the sandbox's plugins do nothing but output silence.
+ * @param self
+ */
+void pluginSandboxStop(PluginSandbox self);
+
+/**
+ * Stop the child process and free all memory used by a sandbox. Plugins
+ * created by newPluginSandboxProxy() must be freed separately.
+ * @param self
+ */
+void freePluginSandbox(PluginSandbox self);
+
+#endif
@@ -0,0 +1,542 @@
+//
+// PluginScanCache.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/FileUtilities.h"
+#include "base/PlatformUtilities.h"
+#include "logging/EventLogger.h"
+#include "plugin/PluginScanCache.h"
+
+#if UNIX
+#include <unistd.h>
+#elif WINDOWS
+#include <process.h>
+#endif
+
+#define PLUGIN_SCAN_CACHE_HEADER "# MrsWatson plugin cache, version"
+#define PLUGIN_SCAN_CACHE_FIELD_SEPARATOR '\t'
+#define PLUGIN_SCAN_CACHE_LIST_SEPARATOR ','
+#define PLUGIN_SCAN_CACHE_ENTRY_TAG "plugin"
+#define PLUGIN_SCAN_CACHE_LOOKUP_TAG "lookup"
+#define PLUGIN_SCAN_CACHE_NUM_ENTRY_FIELDS 11
+#define PLUGIN_SCAN_CACHE_NUM_LOOKUP_FIELDS 6
+// Shell plugins may have hundreds of sub-plugins, which are all on one line
+#define PLUGIN_SCAN_CACHE_MAX_LINE_LENGTH 65536
+
+static PluginScanCache _pluginScanCache = NULL;
+
+static const char* kPluginScanCacheTypeNames[NUM_PLUGIN_TYPES] = {
+  "unknown",
+  "unsupported",
+  "effect",
+  "instrument"
+};
+
+PluginScanInfo newPluginScanInfo(void) {
+  PluginScanInfo info = (PluginScanInfo)malloc(sizeof(PluginScanInfoMembers));
+  info->uniqueId = 0;
+  info->pluginType = PLUGIN_TYPE_UNKNOWN;
+  info->numInputs = 0;
+  info->numOutputs = 0;
+  info->tailSizeInFrames = 0;
+  info->shellPluginIds = NULL;
+  info->numShellPlugins = 0;
+  return info;
+}
+
+void pluginScanInfoAddShellPlugin(PluginScanInfo self, const unsigned long uniqueId) {
+  self->shellPluginIds = (unsigned long*)realloc(self->shellPluginIds,
+    sizeof(unsigned long) * (self->numShellPlugins + 1));
+  self->shellPluginIds[self->numShellPlugins] = uniqueId;
+  self->numShellPlugins++;
+}
+
+void pluginScanInfoCopy(PluginScanInfo self, const PluginScanInfo other) {
+  int i;
+  self->uniqueId = other->uniqueId;
+  self->pluginType = other->pluginType;
+  self->numInputs = other->numInputs;
+  self->numOutputs = other->numOutputs;
+  self->tailSizeInFrames = other->tailSizeInFrames;
+  free(self->shellPluginIds);
+  self->shellPluginIds = NULL;
+  self->numShellPlugins = 0;
+  for(i = 0; i < other->numShellPlugins; i++) {
+    pluginScanInfoAddShellPlugin(self, other->shellPluginIds[i]);
+  }
+}
+
+void freePluginScanInfo(PluginScanInfo self) {
+  if(self == NULL) {
+    return;
+  }
+  free(self->shellPluginIds);
+  free(self);
+}
+
+PluginScanCache newPluginScanCache(void) {
+  PluginScanCache cache = (PluginScanCache)malloc(sizeof(PluginScanCacheMembers));
+  cache->entries = NULL;
+  cache->numEntries = 0;
+  cache->lookups = NULL;
+  cache->numLookups = 0;
+  cache->isModified = false;
+  cache->mutex = newMutex();
+  return cache;
+}
+
+static PluginScanCacheEntry _findEntry(PluginScanCache self, const char* absolutePath) {
+  int i;
+  for(i = 0; i < self->numEntries; i++) {
+    if(!strcmp(self->entries[i]->absolutePath->data, absolutePath)) {
+      return self->entries[i];
+    }
+  }
+  return NULL;
+}
+
+static PluginScanCacheEntry _addEntry(PluginScanCache self, const char* absolutePath) {
+  PluginScanCacheEntry entry = (PluginScanCacheEntry)malloc(sizeof(PluginScanCacheEntryMembers));
+  entry->absolutePath = newCharStringWithCString(absolutePath);
+  entry->fileSize = 0;
+  entry->modificationTime = 0;
+  entry->info = NULL;
+
+  self->entries = (PluginScanCacheEntry*)realloc(self->entries,
+    sizeof(PluginScanCacheEntry) * (self->numEntries + 1));
+  self->entries[self->numEntries] = entry;
+  self->numEntries++;
+  return entry;
+}
+
+// Compare the file against what was stored in the cache. If the file has
+// changed, then the entry is updated and its information is discarded. Returns
+// false if the file no longer exists or has changed.
+static boolByte _refreshEntry(PluginScanCache self, PluginScanCacheEntry entry) {
+  unsigned long long fileSize;
+  long long modificationTime;
+
+  if(!getFileInfo(entry->absolutePath->data, &fileSize, &modificationTime)) {
+    return false;
+  }
+  if(fileSize == entry->fileSize && modificationTime == entry->modificationTime) {
+    return true;
+  }
+
+  logDebug("Plugin '%s' has changed since it was cached", entry->absolutePath->data);
+  entry->fileSize = fileSize;
+  entry->modificationTime = modificationTime;
+  freePluginScanInfo(entry->info);
+  entry->info = NULL;
+  self->isModified = true;
+  return false;
+}
+
+static PluginScanCacheLookup _findLookup(PluginScanCache self, const char* pluginName, const char* pluginRoot,
+  const char* currentDirectory) {
+  PluginScanCacheLookup lookup;
+  int i;
+  for(i = 0; i < self->numLookups; i++) {
+    lookup = self->lookups[i];
+    if(!strcmp(lookup->pluginName->data, pluginName) && !strcmp(lookup->pluginRoot->data, pluginRoot) &&
+      !strcmp(lookup->currentDirectory->data, currentDirectory)) {
+      return lookup;
+    }
+  }
+  return NULL;
+}
+
+static PluginScanCacheLookup _addLookup(PluginScanCache self, const char* pluginName, const char* pluginRoot,
+  const char* currentDirectory) {
+  PluginScanCacheLookup lookup = (PluginScanCacheLookup)malloc(sizeof(PluginScanCacheLookupMembers));
+  lookup->pluginName = newCharStringWithCString(pluginName);
+  // The plugin root is empty unless one was given on the command line, which
+  // newCharStringWithCString() does not allow
+  lookup->pluginRoot = newCharStringWithCapacity(kCharStringLengthLong);
+  charStringCopyCString(lookup->pluginRoot, pluginRoot);
+  lookup->currentDirectory = newCharStringWithCString(currentDirectory);
+  lookup->location = newCharString();
+  lookup->absolutePath = newCharString();
+
+  self->lookups = (PluginScanCacheLookup*)realloc(self->lookups,
+    sizeof(PluginScanCacheLookup) * (self->numLookups + 1));
+  self->lookups[self->numLookups] = lookup;
+  self->numLookups++;
+  return lookup;
+}
+
+static PluginType _pluginTypeFromName(const char* name) {
+  int i;
+  for(i = 0; i < NUM_PLUGIN_TYPES; i++) {
+    if(!strcmp(name, kPluginScanCacheTypeNames[i])) {
+      return (PluginType)i;
+    }
+  }
+  return PLUGIN_TYPE_UNKNOWN;
+}
+
+// Split a line into tab-separated fields in place. Empty fields are allowed.
+static int _splitCacheLine(char* line, char** outFields, const int maxFields) {
+  int numFields = 0;
+  char* separator;
+
+  line[strcspn(line, "\r\n")] = '\0';
+  while(numFields < maxFields) {
+    outFields[numFields++] = line;
+    separator = strchr(line, PLUGIN_SCAN_CACHE_FIELD_SEPARATOR);
+    if(separator == NULL) {
+      return numFields;
+    }
+    *separator = '\0';
+    line = separator + 1;
+  }
+  // Too many fields
+  return maxFields + 1;
+}
+
+static boolByte _parseEntry(PluginScanCache self, char** fields) {
+  PluginScanCacheEntry entry;
+  PluginScanInfo info;
+  char* shellPluginId;
+
+  if(_findEntry(self, fields[1]) != NULL) {
+    return false;
+  }
+  entry = _addEntry(self, fields[1]);
+  entry->fileSize = strtoull(fields[2], NULL, 10);
+  entry->modificationTime = strtoll(fields[3], NULL, 10);
+  if(strtol(fields[4], NULL, 10) == 0) {
+    return true;
+  }
+
+  info = newPluginScanInfo();
+  info->uniqueId = strtoul(fields[5], NULL, 10);
+  info->pluginType = _pluginTypeFromName(fields[6]);
+  info->numInputs = (unsigned int)strtoul(fields[7], NULL, 10);
+  info->numOutputs = (unsigned int)strtoul(fields[8], NULL, 10);
+  info->tailSizeInFrames = (int)strtol(fields[9], NULL, 10);
+  shellPluginId = fields[10];
+  while(*shellPluginId != '\0') {
+    pluginScanInfoAddShellPlugin(info, strtoul(shellPluginId, &shellPluginId, 10));
+    if(*shellPluginId == PLUGIN_SCAN_CACHE_LIST_SEPARATOR) {
+      shellPluginId++;
+    }
+    else if(*shellPluginId != '\0') {
+      break;
+    }
+  }
+  entry->info = info;
+  return true;
+}
+
+static boolByte _parseLookup(PluginScanCache self, char** fields) {
+  PluginScanCacheLookup lookup;
+
+  if(_findLookup(self, fields[1], fields[2], fields[3]) != NULL) {
+    return false;
+  }
+  lookup = _addLookup(self, fields[1], fields[2], fields[3]);
+  charStringCopyCString(lookup->location, fields[4]);
+  charStringCopyCString(lookup->absolutePath, fields[5]);
+  return true;
+}
+
+boolByte pluginScanCacheLoad(PluginScanCache self, const CharString filename) {
+  FILE* cacheFile;
+  char* line;
+  char* fields[PLUGIN_SCAN_CACHE_NUM_ENTRY_FIELDS];
+  int numFields;
+  int lineNumber = 0;
+  boolByte isValid;
+
+  if(filename == NULL || charStringIsEmpty(filename)) {
+    logError("Cannot read plugin cache from empty filename");
+    return false;
+  }
+  else if(!fileExists(filename->data)) {
+    logDebug("Plugin cache '%s' does not exist yet", filename->data);
+    return true;
+  }
+
+  cacheFile = fopen(filename->data, "r");
+  if(cacheFile == NULL) {
+    logError("Could not open plugin cache '%s' for reading", filename->data);
+    return false;
+  }
+
+  line = (char*)malloc(PLUGIN_SCAN_CACHE_MAX_LINE_LENGTH);
+  if(fgets(line, PLUGIN_SCAN_CACHE_MAX_LINE_LENGTH, cacheFile) == NULL ||
+    strncmp(line, PLUGIN_SCAN_CACHE_HEADER, strlen(PLUGIN_SCAN_CACHE_HEADER)) ||
+    strtol(line + strlen(PLUGIN_SCAN_CACHE_HEADER), NULL, 10) != PLUGIN_SCAN_CACHE_VERSION) {
+    logInfo("Plugin cache '%s' has an unknown format, it will be rebuilt", filename->data);
+    free(line);
+    fclose(cacheFile);
+    self->isModified = true;
+    return true;
+  }
+
+  mutexLock(self->mutex);
+  while(fgets(line, PLUGIN_SCAN_CACHE_MAX_LINE_LENGTH, cacheFile) != NULL) {
+    lineNumber++;
+    numFields = _splitCacheLine(line, fields, PLUGIN_SCAN_CACHE_NUM_ENTRY_FIELDS);
+    if(!strcmp(fields[0], PLUGIN_SCAN_CACHE_ENTRY_TAG) && numFields == PLUGIN_SCAN_CACHE_NUM_ENTRY_FIELDS) {
+      isValid = _parseEntry(self, fields);
+    }
+    else if(!strcmp(fields[0], PLUGIN_SCAN_CACHE_LOOKUP_TAG) && numFields == PLUGIN_SCAN_CACHE_NUM_LOOKUP_FIELDS) {
+      isValid = _parseLookup(self, fields);
+    }
+    else {
+      isValid = false;
+    }
+    // Bad lines are dropped, and will be gone once the cache is saved again
+    if(!isValid) {
+      logWarn("Ignoring invalid record on line %d of plugin cache '%s'", lineNumber + 1, filename->data);
+      self->isModified = true;
+    }
+  }
+  mutexUnlock(self->mutex);
+
+  logDebug("Read %d plugins from plugin cache '%s'", self->numEntries, filename->data);
+  free(line);
+  fclose(cacheFile);
+  return true;
+}
+
+// Replace the cache file with the temporary file in one step, so that another
+// process never reads a partially written cache
+static boolByte _pluginScanCacheReplaceFile(const CharString tempFilename, const CharString filename) {
+#if WINDOWS
+  return (boolByte)(MoveFileExA(tempFilename->data, filename->data, MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+  return (boolByte)(rename(tempFilename->data, filename->data) == 0);
+#endif
+}
+
+boolByte pluginScanCacheSave(PluginScanCache self, const CharString filename) {
+  boolByte result = true;
+  PluginScanCacheEntry entry;
+  PluginScanCacheLookup lookup;
+  CharString tempFilename;
+  FILE* cacheFile;
+  int i;
+  int j;
+
+  mutexLock(self->mutex);
+  if(!self->isModified) {
+    mutexUnlock(self->mutex);
+    return true;
+  }
+
+  // Each process writes to its own temporary file next to the cache
+  tempFilename = newCharStringWithCapacity(strlen(filename->data) + 32);
+#if WINDOWS
+  snprintf(tempFilename->data, tempFilename->length, "%s.tmp.%d", filename->data, _getpid());
+#else
+  snprintf(tempFilename->data, tempFilename->length, "%s.tmp.%ld", filename->data, (long)getpid());
+#endif
+  cacheFile = fopen(tempFilename->data, "w");
+  if(cacheFile == NULL) {
+    logError("Could not open plugin cache '%s' for writing", tempFilename->data);
+    freeCharString(tempFilename);
+    mutexUnlock(self->mutex);
+    return false;
+  }
+
+  fprintf(cacheFile, "%s %d\n", PLUGIN_SCAN_CACHE_HEADER, PLUGIN_SCAN_CACHE_VERSION);
+  for(i = 0; i < self->numEntries; i++) {
+    entry = self->entries[i];
+    fprintf(cacheFile, "%s\t%s\t%llu\t%lld\t", PLUGIN_SCAN_CACHE_ENTRY_TAG, entry->absolutePath->data,
+      entry->fileSize, entry->modificationTime);
+    if(entry->info == NULL) {
+      fprintf(cacheFile, "0\t0\t%s\t0\t0\t0\t\n", kPluginScanCacheTypeNames[PLUGIN_TYPE_UNKNOWN]);
+      continue;
+    }
+    fprintf(cacheFile, "1\t%lu\t%s\t%u\t%u\t%d\t", entry->info->uniqueId,
+      kPluginScanCacheTypeNames[entry->info->pluginType], entry->info->numInputs, entry->info->numOutputs,
+      entry->info->tailSizeInFrames);
+    for(j = 0; j < entry->info->numShellPlugins; j++) {
+      fprintf(cacheFile, j > 0 ? ",%lu" : "%lu", entry->info->shellPluginIds[j]);
+    }
+    fprintf(cacheFile, "\n");
+  }
+  for(i = 0; i < self->numLookups; i++) {
+    lookup = self->lookups[i];
+    fprintf(cacheFile, "%s\t%s\t%s\t%s\t%s\t%s\n", PLUGIN_SCAN_CACHE_LOOKUP_TAG, lookup->pluginName->data,
+      lookup->pluginRoot->data, lookup->currentDirectory->data, lookup->location->data, lookup->absolutePath->data);
+  }
+
+  if(fclose(cacheFile) != 0) {
+    logError("Could not write plugin cache '%s'", tempFilename->data);
+    remove(tempFilename->data);
+    result = false;
+  }
+  else if(!_pluginScanCacheReplaceFile(tempFilename, filename)) {
+    logError("Could not replace plugin cache '%s'", filename->data);
+    remove(tempFilename->data);
+    result = false;
+  }
+  else {
+    logDebug("Wrote %d plugins to plugin cache '%s'", self->numEntries, filename->data);
+    self->isModified = false;
+  }
+  freeCharString(tempFilename);
+  mutexUnlock(self->mutex);
+  return result;
+}
+
+boolByte pluginScanCacheFindPlugin(PluginScanCache self, const CharString pluginName, const CharString pluginRoot,
+  CharString outLocation, CharString outAbsolutePath) {
+  boolByte result = false;
+  CharString currentDirectory = getCurrentDirectory();
+  PluginScanCacheLookup lookup;
+  PluginScanCacheEntry entry;
+
+  mutexLock(self->mutex);
+  lookup = _findLookup(self, pluginName->data, pluginRoot != NULL ? pluginRoot->data : EMPTY_STRING,
+    currentDirectory->data);
+  if(lookup != NULL) {
+    entry = _findEntry(self, lookup->absolutePath->data);
+    if(entry != NULL && _refreshEntry(self, entry)) {
+      charStringCopy(outLocation, lookup->location);
+      if(outAbsolutePath != NULL) {
+        charStringCopy(outAbsolutePath, lookup->absolutePath);
+      }
+      result = true;
+    }
+  }
+  mutexUnlock(self->mutex);
+
+  freeCharString(currentDirectory);
+  return result;
+}
+
+void pluginScanCacheAddPlugin(PluginScanCache self, const CharString pluginName, const CharString pluginRoot,
+  const CharString location, const CharString absolutePath) {
+  CharString currentDirectory = getCurrentDirectory();
+  const char* pluginRootString = pluginRoot != NULL ? pluginRoot->data : EMPTY_STRING;
+  PluginScanCacheLookup lookup;
+  PluginScanCacheEntry entry;
+
+  mutexLock(self->mutex);
+  lookup = _findLookup(self, pluginName->data, pluginRootString, currentDirectory->data);
+  if(lookup == NULL) {
+    lookup = _addLookup(self, pluginName->data, pluginRootString, currentDirectory->data);
+  }
+  charStringCopy(lookup->location, location);
+  charStringCopy(lookup->absolutePath, absolutePath);
+
+  entry = _findEntry(self, absolutePath->data);
+  if(entry == NULL) {
+    entry = _addEntry(self, absolutePath->data);
+  }
+  _refreshEntry(self, entry);
+  self->isModified = true;
+  mutexUnlock(self->mutex);
+
+  freeCharString(currentDirectory);
+}
+
+boolByte pluginScanCacheGetInfo(PluginScanCache self, const CharString absolutePath, PluginScanInfo outInfo) {
+  boolByte result = false;
+  PluginScanCacheEntry entry;
+
+  mutexLock(self->mutex);
+  entry = _findEntry(self, absolutePath->data);
+  if(entry != NULL && _refreshEntry(self, entry) && entry->info != NULL) {
+    pluginScanInfoCopy(outInfo, entry->info);
+    result = true;
+  }
+  mutexUnlock(self->mutex);
+  return result;
+}
+
+static boolByte _isInfoEqual(const PluginScanInfo info, const PluginScanInfo other) {
+  if(info->uniqueId != other->uniqueId || info->pluginType != other->pluginType ||
+    info->numInputs != other->numInputs || info->numOutputs != other->numOutputs ||
+    info->tailSizeInFrames != other->tailSizeInFrames || info->numShellPlugins != other->numShellPlugins) {
+    return false;
+  }
+  return (boolByte)(info->numShellPlugins == 0 ||
+    !memcmp(info->shellPluginIds, other->shellPluginIds, sizeof(unsigned long) * info->numShellPlugins));
+}
+
+void pluginScanCacheSetInfo(PluginScanCache self, const CharString absolutePath, const PluginScanInfo info) {
+  PluginScanCacheEntry entry;
+
+  mutexLock(self->mutex);
+  entry = _findEntry(self, absolutePath->data);
+  if(entry == NULL) {
+    entry = _addEntry(self, absolutePath->data);
+  }
+  // Plugins are loaded on every run, so only write the cache if anything changed
+  if(_refreshEntry(self, entry) && entry->info != NULL && _isInfoEqual(entry->info, info)) {
+    mutexUnlock(self->mutex);
+    return;
+  }
+  if(entry->info == NULL) {
+    entry->info = newPluginScanInfo();
+  }
+  pluginScanInfoCopy(entry->info, info);
+  self->isModified = true;
+  mutexUnlock(self->mutex);
+}
+
+void freePluginScanCache(PluginScanCache self) {
+  int i;
+
+  if(self == NULL) {
+    return;
+  }
+  for(i = 0; i < self->numEntries; i++) {
+    freeCharString(self->entries[i]->absolutePath);
+    freePluginScanInfo(self->entries[i]->info);
+    free(self->entries[i]);
+  }
+  for(i = 0; i < self->numLookups; i++) {
+    freeCharString(self->lookups[i]->pluginName);
+    freeCharString(self->lookups[i]->pluginRoot);
+    freeCharString(self->lookups[i]->currentDirectory);
+    freeCharString(self->lookups[i]->location);
+    freeCharString(self->lookups[i]->absolutePath);
+    free(self->lookups[i]);
+  }
+  free(self->entries);
+  free(self->lookups);
+  freeMutex(self->mutex);
+  free(self);
+}
+
+void setPluginScanCache(PluginScanCache cache) {
+  _pluginScanCache = cache;
+}
+
+PluginScanCache getPluginScanCache(void) {
+  return _pluginScanCache;
+}
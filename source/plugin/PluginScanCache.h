@@ -0,0 +1,212 @@
+//
+// PluginScanCache.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_PluginScanCache_h
+#define MrsWatson_PluginScanCache_h
+
+#include "base/CharString.h"
+#include "base/Thread.h"
+#include "base/Types.h"
+#include "plugin/Plugin.h"
+
+#define PLUGIN_SCAN_CACHE_VERSION 1
+
+/**
+ * Information about a plugin which is learned by loading it. Since loading a
+ * plugin can be slow, this is stored in the plugin cache so that it is known
+ * before the plugin is loaded on subsequent runs.
+ */
+typedef struct {
+  unsigned long uniqueId;
+  PluginType pluginType;
+  unsigned int numInputs;
+  unsigned int numOutputs;
+  // As reported by the plugin, which does not depend on the sample rate
+  int tailSizeInFrames;
+  // Unique IDs of the sub-plugins of a shell plugin
+  unsigned long* shellPluginIds;
+  int numShellPlugins;
+} PluginScanInfoMembers;
+typedef PluginScanInfoMembers* PluginScanInfo;
+
+/**
+ * A plugin file which has been seen before, along with its size and
+ * modification time when it was seen. The cached information is only used as
+ * long as the file has not changed.
+ */
+typedef struct {
+  CharString absolutePath;
+  unsigned long long fileSize;
+  long long modificationTime;
+  // NULL until the plugin has been loaded
+  PluginScanInfo info;
+} PluginScanCacheEntryMembers;
+typedef PluginScanCacheEntryMembers* PluginScanCacheEntry;
+
+/**
+ * The result of searching for a plugin by name, which depends on the plugin
+ * root and the current directory, since relative names are also searched there.
+ */
+typedef struct {
+  CharString pluginName;
+  CharString pluginRoot;
+  CharString currentDirectory;
+  CharString location;
+  CharString absolutePath;
+} PluginScanCacheLookupMembers;
+typedef PluginScanCacheLookupMembers* PluginScanCacheLookup;
+
+/**
+ * Index of plugin files which is kept on disk between runs, so that plugins
+ * can be found without searching every plugin location, and so that their
+ * type and I/O configuration are known without loading them. Entries are
+ * refreshed individually whenever a plugin's file has changed.
+ *
+ * The cache file is a text file with one tab-separated record per line. All
+ * functions may be called from several threads at once.
+ */
+typedef struct {
+  PluginScanCacheEntry* entries;
+  int numEntries;
+  PluginScanCacheLookup* lookups;
+  int numLookups;
+  boolByte isModified;
+  Mutex mutex;
+} PluginScanCacheMembers;
+typedef PluginScanCacheMembers* PluginScanCache;
+
+/**
+ * @return New plugin info with no shell plugins
+ */
+PluginScanInfo newPluginScanInfo(void);
+
+/**
+ * Add the ID of a shell plugin's sub-plugin
+ * @param self
+ * @param uniqueId Sub-plugin ID
+ */
+void pluginScanInfoAddShellPlugin(PluginScanInfo self, const unsigned long uniqueId);
+
+/**
+ * Copy all fields, including the list of shell plugins
+ * @param self Info to copy to
+ * @param other Info to copy from
+ */
+void pluginScanInfoCopy(PluginScanInfo self, const PluginScanInfo other);
+
+/**
+ * Free a plugin info object
+ * @param self
+ */
+void freePluginScanInfo(PluginScanInfo self);
+
+/**
+ * @return New empty plugin cache
+ */
+PluginScanCache newPluginScanCache(void);
+
+/**
+ * Read a plugin cache file. A missing file, or a file written by another
+ * version of the program, leaves the cache empty but is not an error.
+ * @param self
+ * @param filename File to read
+ * @return False if the file exists but could not be read
+ */
+boolByte pluginScanCacheLoad(PluginScanCache self, const CharString filename);
+
+/**
+ * Write the cache to a file, if anything has changed since it was loaded
+ * @param self
+ * @param filename File to write
+ * @return True if the file was written or did not need to be written
+ */
+boolByte pluginScanCacheSave(PluginScanCache self, const CharString filename);
+
+/**
+ * Find a plugin which was already found on a previous run. This only checks
+ * that the plugin's file has not changed, so a plugin which was installed in a
+ * location which is searched before the cached location will not be found
+ * until the cache is removed.
+ * @param self
+ * @param pluginName Plugin name as given by the user
+ * @param pluginRoot Plugin root given by the user, or an empty string
+ * @param outLocation Set to the location where the plugin was found
+ * @param outAbsolutePath Set to the absolute path of the plugin, may be NULL
+ * @return True if the plugin was found
+ */
+boolByte pluginScanCacheFindPlugin(PluginScanCache self, const CharString pluginName, const CharString pluginRoot,
+  CharString outLocation, CharString outAbsolutePath);
+
+/**
+ * Remember where a plugin was found. If the plugin's file has changed since it
+ * was last seen, its cached information is discarded.
+ * @param self
+ * @param pluginName Plugin name as given by the user
+ * @param pluginRoot Plugin root given by the user, or an empty string
+ * @param location Location where the plugin was found
+ * @param absolutePath Absolute path of the plugin's file
+ */
+void pluginScanCacheAddPlugin(PluginScanCache self, const CharString pluginName, const CharString pluginRoot,
+  const CharString location, const CharString absolutePath);
+
+/**
+ * Get the information for a plugin which was loaded on a previous run
+ * @param self
+ * @param absolutePath Absolute path of the plugin's file
+ * @param outInfo Filled with the cached information
+ * @return True if the plugin is in the cache and its file has not changed
+ */
+boolByte pluginScanCacheGetInfo(PluginScanCache self, const CharString absolutePath, PluginScanInfo outInfo);
+
+/**
+ * Store the information for a plugin after it has been loaded
+ * @param self
+ * @param absolutePath Absolute path of the plugin's file
+ * @param info Information to store, which is copied
+ */
+void pluginScanCacheSetInfo(PluginScanCache self, const CharString absolutePath, const PluginScanInfo info);
+
+/**
+ * Free a plugin cache. If this cache is the global one, it should be unset
+ * first with setPluginScanCache().
+ * @param self
+ */
+void freePluginScanCache(PluginScanCache self);
+
+/**
+ * Set the cache used when searching for and loading plugins
+ * @param cache Cache to use, or NULL to disable caching
+ */
+void setPluginScanCache(PluginScanCache cache);
+
+/**
+ * @return Cache used when searching for and loading plugins, or NULL if there
+ * is none
+ */
+PluginScanCache getPluginScanCache(void);
+
+#endif
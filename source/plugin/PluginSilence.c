@@ -69,6 +69,15 @@ static void _pluginSilenceSetParameter(void* pluginPtr, int i, float value) {
   // Nothing to do here
 }
 
+static PluginSnapshot _pluginSilenceTakeSnapshot(void* pluginPtr) {
+  // This plugin has no state, so there is nothing to save
+  return newPluginSnapshot(NULL, 0);
+}
+
+static boolByte _pluginSilenceRestoreSnapshot(void* pluginPtr, const PluginSnapshot snapshot) {
+  return true;
+}
+
 Plugin newPluginSilence(const CharString pluginName) {
   Plugin plugin = (Plugin)malloc(sizeof(PluginMembers));
 
@@ -80,6 +89,8 @@ Plugin newPluginSilence(const CharString pluginName) {
   charStringCopyCString(plugin->pluginLocation, "Internal");
   plugin->numInputs = 0;
   plugin->numOutputs = 2;
+  plugin->overwritesOutputs = true;
+  plugin->canProcessInPlace = true;
 
   plugin->open = _pluginSilenceOpen;
   plugin->displayInfo = _pluginSilenceDisplayInfo;
@@ -89,6 +100,8 @@ Plugin newPluginSilence(const CharString pluginName) {
   plugin->processAudio = _pluginSilenceProcessAudio;
   plugin->processMidiEvents = _pluginSilenceProcessMidiEvents;
   plugin->setParameter = _pluginSilenceSetParameter;
+  plugin->takeSnapshot = _pluginSilenceTakeSnapshot;
+  plugin->restoreSnapshot = _pluginSilenceRestoreSnapshot;
   plugin->closePlugin = _pluginSilenceEmpty;
   plugin->freePluginData = _pluginSilenceEmpty;
 
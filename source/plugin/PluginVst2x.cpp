@@ -42,6 +42,7 @@ extern "C" {
 #include "base/StringUtilities.h"
 #include "logging/EventLogger.h"
 #include "midi/MidiEvent.h"
+#include "plugin/PluginScanCache.h"
 #include "plugin/PluginVst2x.h"
 
 extern LinkedList getVst2xPluginLocations(CharString currentDirectory);
@@ -50,6 +51,9 @@ extern AEffect* loadVst2xPlugin(LibraryHandle libraryHandle);
 extern void closeLibraryHandle(LibraryHandle libraryHandle);
 }
 
+// Number of MIDI events which a plugin's event pool has room for at first
+#define VST2X_MIDI_EVENT_POOL_SIZE 256
+
 // Opaque struct must be declared here rather than in the header, otherwise many
 // other files in this project must be compiled as C++ code. =/
 typedef struct {
@@ -58,9 +62,18 @@ typedef struct {
   LibraryHandle libraryHandle;
   boolByte isPluginShell;
   unsigned long shellPluginId;
+  // Path of the plugin's file, which is known once the plugin has been opened
+  CharString pluginAbsolutePath;
   // Must be retained until processReplacing() is called, so best to keep a
-  // reference in the plugin's data storage.
+  // reference in the plugin's data storage. The events are stored in a pool
+  // which is allocated with the plugin, and only reallocated when a block has
+  // more events than any before it.
   struct VstEvents *vstEvents;
+  VstMidiEvent *vstMidiEventPool;
+  // Events which are sent after all note off events
+  VstEvent **deferredVstEvents;
+  int vstEventsCapacity;
+  PluginVst2xHostContext hostContext;
 } PluginVst2xDataMembers;
 typedef PluginVst2xDataMembers* PluginVst2xData;
 
@@ -96,29 +109,61 @@ static const char* _getVst2xPlatformExtension(void) {
   }
 }
 
+typedef struct {
+  CharString location;
+  boolByte pluginsFound;
+} PluginVst2xListContext;
+
+static const char* _getVst2xPluginTypeName(const PluginType pluginType) {
+  switch(pluginType) {
+    case PLUGIN_TYPE_EFFECT:
+      return "effect";
+    case PLUGIN_TYPE_INSTRUMENT:
+      return "instrument";
+    default:
+      return "other";
+  }
+}
+
 static void _logPluginVst2xInLocation(void* item, void* userData) {
   CharString itemName = (CharString)item;
-  boolByte* pluginsFound = (boolByte*)userData;
+  PluginVst2xListContext* listContext = (PluginVst2xListContext*)userData;
+  PluginScanCache pluginScanCache = getPluginScanCache();
   char* dot;
 
   dot = strrchr(itemName->data, '.');
   if(dot != NULL) {
     if(!strncmp(dot + 1, _getVst2xPlatformExtension(), 3)) {
+      // Plugins which have been loaded before are listed with their cached
+      // information, which does not require loading them again
+      CharString pluginFilePath = newCharString();
+      PluginScanInfo info = newPluginScanInfo();
+      buildAbsolutePath(listContext->location, itemName, NULL, pluginFilePath);
       *dot = '\0';
-      logInfo("  %s", itemName->data);
-      *pluginsFound = true;
+      if(pluginScanCache != NULL && pluginScanCacheGetInfo(pluginScanCache, pluginFilePath, info)) {
+        CharString uniqueIdString = convertIntIdToString(info->uniqueId);
+        logInfo("  %s (ID '%s', %s, I/O %d/%d)", itemName->data, uniqueIdString->data,
+          _getVst2xPluginTypeName(info->pluginType), info->numInputs, info->numOutputs);
+        freeCharString(uniqueIdString);
+      }
+      else {
+        logInfo("  %s", itemName->data);
+      }
+      freePluginScanInfo(info);
+      freeCharString(pluginFilePath);
+      listContext->pluginsFound = true;
     }
   }
 }
 
 static void _listPluginsVst2xInLocation(void* item, void* userData) {
-  CharString location;
+  PluginVst2xListContext listContext;
   LinkedList locationItems;
-  boolByte pluginsFound = false;
 
-  location = (CharString)item;
-  _logPluginLocation(location, PLUGIN_TYPE_VST_2X);
-  locationItems = listDirectory(location);
+  listContext.location = (CharString)item;
+  listContext.pluginsFound = false;
+  _logPluginLocation(listContext.location, PLUGIN_TYPE_VST_2X);
+  locationItems = listDirectory(listContext.location);
   if(linkedListLength(locationItems) == 0) {
     // Empty or does not exist, return
     logInfo("  (Empty or non-existent directory)");
@@ -126,8 +171,8 @@ static void _listPluginsVst2xInLocation(void* item, void* userData) {
     return;
   }
 
-  linkedListForeach(locationItems, _logPluginVst2xInLocation, &pluginsFound);
-  if(!pluginsFound) {
+  linkedListForeach(locationItems, _logPluginVst2xInLocation, &listContext);
+  if(!listContext.pluginsFound) {
     logInfo("  (No plugins found)");
   }
 
@@ -218,8 +263,46 @@ static boolByte _fillVst2xPluginAbsolutePath(const CharString pluginName, const
   return result;
 }
 
+// Build the path of the plugin's file, without any sub-plugin ID which may be
+// appended to the plugin name
+static void _getVst2xPluginFilePath(const CharString pluginName, const CharString pluginLocation, CharString outPath) {
+  CharString pluginFileName = newCharString();
+  char* subpluginSeparator;
+
+  charStringCopy(pluginFileName, pluginName);
+  subpluginSeparator = strrchr((char*)getFileBasename(pluginFileName->data), kPluginVst2xSubpluginSeparator);
+  if(subpluginSeparator != NULL) {
+    *subpluginSeparator = '\0';
+  }
+
+  if(isAbsolutePath(pluginFileName)) {
+    charStringCopy(outPath, pluginFileName);
+  }
+  else {
+    buildAbsolutePath(pluginLocation, pluginFileName, _getVst2xPlatformExtension(), outPath);
+  }
+  freeCharString(pluginFileName);
+}
+
 boolByte vst2xPluginExists(const CharString pluginName, const CharString pluginRoot, CharString outLocation) {
-  return _fillVst2xPluginAbsolutePath(pluginName, pluginRoot, outLocation);
+  PluginScanCache pluginScanCache = getPluginScanCache();
+  CharString pluginFilePath;
+
+  if(pluginScanCache != NULL && pluginScanCacheFindPlugin(pluginScanCache, pluginName, pluginRoot, outLocation, NULL)) {
+    logDebug("Found plugin '%s' in plugin cache", pluginName->data);
+    return true;
+  }
+  if(!_fillVst2xPluginAbsolutePath(pluginName, pluginRoot, outLocation)) {
+    return false;
+  }
+
+  if(pluginScanCache != NULL) {
+    pluginFilePath = newCharString();
+    _getVst2xPluginFilePath(pluginName, outLocation, pluginFilePath);
+    pluginScanCacheAddPlugin(pluginScanCache, pluginName, pluginRoot, outLocation, pluginFilePath);
+    freeCharString(pluginFilePath);
+  }
+  return true;
 }
 
 static short _canPluginDo(Plugin plugin, const char* canDoString) {
@@ -228,11 +311,32 @@ static short _canPluginDo(Plugin plugin, const char* canDoString) {
   return result;
 }
 
+static void _logCachedVst2xShellPlugins(Plugin plugin) {
+  PluginVst2xData data = (PluginVst2xData)plugin->extraData;
+  PluginScanCache pluginScanCache = getPluginScanCache();
+  PluginScanInfo info;
+
+  if(pluginScanCache == NULL) {
+    return;
+  }
+  info = newPluginScanInfo();
+  if(pluginScanCacheGetInfo(pluginScanCache, data->pluginAbsolutePath, info) && info->numShellPlugins > 0) {
+    logInfo("Sub-plugin IDs of '%s' from the plugin cache:", plugin->pluginName->data);
+    for(int i = 0; i < info->numShellPlugins; i++) {
+      CharString shellPluginIdString = convertIntIdToString(info->shellPluginIds[i]);
+      logInfo("  '%s'", shellPluginIdString->data);
+      freeCharString(shellPluginIdString);
+    }
+  }
+  freePluginScanInfo(info);
+}
+
 static void _resumePlugin(Plugin plugin) {
   logDebug("Resuming plugin '%s'", plugin->pluginName->data);
   PluginVst2xData data = (PluginVst2xData)plugin->extraData;
   if(data->isPluginShell && data->shellPluginId == 0) {
     logError("'%s' is a shell plugin, but no sub-plugin ID was given, run with --help plugin", plugin->pluginName->data);
+    _logCachedVst2xShellPlugins(plugin);
   }
   data->dispatcher(data->pluginHandle, effMainsChanged, 0, 1, NULL, 0.0f);
   data->dispatcher(data->pluginHandle, effStartProcess, 0, 0, NULL, 0.0f);
@@ -299,6 +403,28 @@ unsigned long getVst2xPluginUniqueId(const Plugin plugin) {
   return 0;
 }
 
+static void _cacheVst2xPluginInfo(Plugin plugin, const CharString pluginAbsolutePath) {
+  PluginVst2xData data = (PluginVst2xData)plugin->extraData;
+  PluginScanCache pluginScanCache = getPluginScanCache();
+  PluginScanInfo info;
+
+  if(pluginScanCache == NULL) {
+    return;
+  }
+
+  // Sub-plugins of a shell are only listed by --display-info, so keep the ones
+  // which were cached before
+  info = newPluginScanInfo();
+  pluginScanCacheGetInfo(pluginScanCache, pluginAbsolutePath, info);
+  info->uniqueId = (unsigned long)data->pluginHandle->uniqueID;
+  info->pluginType = plugin->pluginType;
+  info->numInputs = plugin->numInputs;
+  info->numOutputs = plugin->numOutputs;
+  info->tailSizeInFrames = (int)data->dispatcher(data->pluginHandle, effGetTailSize, 0, 0, NULL, 0.0f);
+  pluginScanCacheSetInfo(pluginScanCache, pluginAbsolutePath, info);
+  freePluginScanInfo(info);
+}
+
 static boolByte _openVst2xPlugin(void* pluginPtr) {
   boolByte result = false;
   AEffect* pluginHandle;
@@ -357,7 +483,14 @@ static boolByte _openVst2xPlugin(void* pluginPtr) {
   else {
     data->dispatcher = (Vst2xPluginDispatcherFunc)(pluginHandle->dispatcher);
     data->pluginHandle = pluginHandle;
+    // The plugin runs in the context of the thread which opened it
+    data->hostContext->context = getMrsWatsonContext();
+    pluginHandle->resvd1 = (VstIntPtr)data->hostContext;
     result = _initVst2xPlugin(plugin);
+    if(result) {
+      charStringCopy(data->pluginAbsolutePath, pluginAbsolutePath);
+      _cacheVst2xPluginInfo(plugin, pluginAbsolutePath);
+    }
   }
 
   freeCharString(pluginAbsolutePath);
@@ -431,6 +564,14 @@ static void _displayVst2xPluginInfo(void* pluginPtr) {
   logInfo("I/O: %d/%d", data->pluginHandle->numInputs, data->pluginHandle->numOutputs);
 
   if(data->isPluginShell && data->shellPluginId == 0) {
+    // Remember the sub-plugins, so that they can be suggested when the shell
+    // is used without a sub-plugin ID
+    PluginScanCache pluginScanCache = getPluginScanCache();
+    PluginScanInfo info = newPluginScanInfo();
+    boolByte isCached = (boolByte)(pluginScanCache != NULL &&
+      pluginScanCacheGetInfo(pluginScanCache, data->pluginAbsolutePath, info));
+    info->numShellPlugins = 0;
+
     logInfo("Sub-plugins:");
     nameBuffer = newCharStringWithCapacity(kCharStringLengthShort);
     while(true) {
@@ -443,9 +584,15 @@ static void _displayVst2xPluginInfo(void* pluginPtr) {
         CharString shellPluginIdString = convertIntIdToString(shellPluginId);
         logInfo("  '%s' (%s)", shellPluginIdString->data, nameBuffer->data);
         freeCharString(shellPluginIdString);
+        pluginScanInfoAddShellPlugin(info, (unsigned long)shellPluginId);
       }
     }
     freeCharString(nameBuffer);
+
+    if(isCached) {
+      pluginScanCacheSetInfo(pluginScanCache, data->pluginAbsolutePath, info);
+    }
+    freePluginScanInfo(info);
   }
   else {
     nameBuffer = newCharStringWithCapacity(kCharStringLengthShort);
@@ -512,7 +659,7 @@ static void _processAudioVst2xPlugin(void* pluginPtr, SampleBuffer inputs, Sampl
   data->pluginHandle->processReplacing(data->pluginHandle, inputs->samples, outputs->samples, outputs->blocksize);
 }
 
-static void _fillVstMidiEvent(const MidiEvent midiEvent, VstMidiEvent* vstMidiEvent) {
+static boolByte _fillVstMidiEvent(const MidiEvent midiEvent, VstMidiEvent* vstMidiEvent) {
   switch(midiEvent->eventType) {
     case MIDI_TYPE_REGULAR:
       vstMidiEvent->type = kVstMidiType;
@@ -524,61 +671,75 @@ static void _fillVstMidiEvent(const MidiEvent midiEvent, VstMidiEvent* vstMidiEv
       vstMidiEvent->flags = 0;
       vstMidiEvent->reserved1 = 0;
       vstMidiEvent->reserved2 = 0;
-      break;
+      return true;
     case MIDI_TYPE_SYSEX:
       logUnsupportedFeature("VST2.x plugin sysex messages");
-      break;
+      return false;
     case MIDI_TYPE_META:
       // Ignore, don't care
-      break;
+      return false;
     default:
       logInternalError("Cannot convert MIDI event type '%d' to VstMidiEvent", midiEvent->eventType);
-      break;
+      return false;
+  }
+}
+
+static void _freeVst2xMidiEventPool(PluginVst2xData data) {
+  free(data->vstEvents);
+  free(data->vstMidiEventPool);
+  free(data->deferredVstEvents);
+  data->vstEvents = NULL;
+  data->vstMidiEventPool = NULL;
+  data->deferredVstEvents = NULL;
+  data->vstEventsCapacity = 0;
+}
+
+static void _reserveVst2xMidiEvents(PluginVst2xData data, const int numEvents) {
+  if(numEvents <= data->vstEventsCapacity) {
+    return;
   }
+
+  int capacity = data->vstEventsCapacity > 0 ? data->vstEventsCapacity : VST2X_MIDI_EVENT_POOL_SIZE;
+  while(capacity < numEvents) {
+    capacity *= 2;
+  }
+  logDebug("Allocating space for %d MIDI events", capacity);
+  // The events from the previous block are no longer used once the plugin has processed it
+  _freeVst2xMidiEventPool(data);
+  data->vstEvents = (struct VstEvents*)malloc(sizeof(struct VstEvents) + (capacity * sizeof(VstEvent*)));
+  data->vstMidiEventPool = (VstMidiEvent*)malloc(capacity * sizeof(VstMidiEvent));
+  data->deferredVstEvents = (VstEvent**)malloc(capacity * sizeof(VstEvent*));
+  data->vstEventsCapacity = capacity;
 }
 
 static void _processMidiEventsVst2xPlugin(void *pluginPtr, LinkedList midiEvents) {
   Plugin plugin = (Plugin)pluginPtr;
   PluginVst2xData data = (PluginVst2xData)(plugin->extraData);
-  int numEvents = linkedListLength(midiEvents);
+  int numNoteOffEvents = 0;
+  int numDeferredEvents = 0;
 
-  // Free events from the previous call
-  if(data->vstEvents != NULL) {
-    for(int i = 0; i < data->vstEvents->numEvents; i++) {
-      free(data->vstEvents->events[i]);
-    }
-    free(data->vstEvents);
-  }
-
-  data->vstEvents = (struct VstEvents*)malloc(sizeof(struct VstEvent) + (numEvents * sizeof(struct VstEvent*)));
-  data->vstEvents->numEvents = numEvents;
+  _reserveVst2xMidiEvents(data, linkedListLength(midiEvents));
 
   // Some monophonic instruments have problems dealing with the order of MIDI events,
-  // so send them all note off events *first* followed by any other event types.
+  // so send them all note off events *first* followed by any other event types. Both
+  // groups keep their original order.
   LinkedListIterator iterator = midiEvents;
-  int outIndex = 0;
-  while(iterator != NULL && outIndex < numEvents) {
+  while(iterator != NULL && iterator->item != NULL) {
     MidiEvent midiEvent = (MidiEvent)(iterator->item);
-    if(midiEvent != NULL && (midiEvent->status >> 4) == 0x08) {
-      VstMidiEvent* vstMidiEvent = (VstMidiEvent*)malloc(sizeof(VstMidiEvent));
-      _fillVstMidiEvent(midiEvent, vstMidiEvent);
-      data->vstEvents->events[outIndex] = (VstEvent*)vstMidiEvent;
-      outIndex++;
-    }
-    iterator = (LinkedListIterator)(iterator->nextItem);
-  }
-
-  iterator = midiEvents;
-  while(iterator != NULL && outIndex < numEvents) {
-    MidiEvent midiEvent = (MidiEvent)(iterator->item);
-    if(midiEvent != NULL && (midiEvent->status >> 4) != 0x08) {
-      VstMidiEvent* vstMidiEvent = (VstMidiEvent*)malloc(sizeof(VstMidiEvent));
-      _fillVstMidiEvent(midiEvent, vstMidiEvent);
-      data->vstEvents->events[outIndex] = (VstEvent*)vstMidiEvent;
-      outIndex++;
+    VstMidiEvent* vstMidiEvent = &(data->vstMidiEventPool[numNoteOffEvents + numDeferredEvents]);
+    if(_fillVstMidiEvent(midiEvent, vstMidiEvent)) {
+      if((midiEvent->status >> 4) == 0x08) {
+        data->vstEvents->events[numNoteOffEvents++] = (VstEvent*)vstMidiEvent;
+      }
+      else {
+        data->deferredVstEvents[numDeferredEvents++] = (VstEvent*)vstMidiEvent;
+      }
     }
     iterator = (LinkedListIterator)(iterator->nextItem);
   }
+  memcpy(data->vstEvents->events + numNoteOffEvents, data->deferredVstEvents, numDeferredEvents * sizeof(VstEvent*));
+  data->vstEvents->numEvents = numNoteOffEvents + numDeferredEvents;
+  data->vstEvents->reserved = 0;
 
   data->dispatcher(data->pluginHandle, effProcessEvents, 0, 0, data->vstEvents, 0.0f);
 }
@@ -618,6 +779,59 @@ static void _setParameterVst2xPlugin(void *pluginPtr, int index, float value) {
   data->pluginHandle->setParameter(data->pluginHandle, index, value);
 }
 
+// Plugins which don't support chunks are saved as their current program
+// followed by the values of all parameters
+static PluginSnapshot _takeVst2xPluginSnapshot(void* pluginPtr) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginVst2xData data = (PluginVst2xData)(plugin->extraData);
+  AEffect* pluginHandle = data->pluginHandle;
+
+  if(pluginHandle->flags & effFlagsProgramChunks) {
+    void* chunk = NULL;
+    // The chunk belongs to the plugin and is only valid until the next call
+    VstIntPtr chunkSize = data->dispatcher(pluginHandle, effGetChunk, 0, 0, &chunk, 0.0f);
+    if(chunk == NULL || chunkSize <= 0) {
+      logWarn("Plugin '%s' did not return its state chunk", plugin->pluginName->data);
+      return NULL;
+    }
+    return newPluginSnapshot(chunk, (size_t)chunkSize);
+  }
+
+  PluginSnapshot snapshot = newPluginSnapshot(NULL, sizeof(VstInt32) + sizeof(float) * pluginHandle->numParams);
+  VstInt32* program = (VstInt32*)snapshot->data;
+  float* parameters = (float*)(program + 1);
+  *program = (VstInt32)data->dispatcher(pluginHandle, effGetProgram, 0, 0, NULL, 0.0f);
+  for(int i = 0; i < pluginHandle->numParams; i++) {
+    parameters[i] = pluginHandle->getParameter(pluginHandle, i);
+  }
+  return snapshot;
+}
+
+static boolByte _restoreVst2xPluginSnapshot(void* pluginPtr, const PluginSnapshot snapshot) {
+  Plugin plugin = (Plugin)pluginPtr;
+  PluginVst2xData data = (PluginVst2xData)(plugin->extraData);
+  AEffect* pluginHandle = data->pluginHandle;
+
+  if(pluginHandle->flags & effFlagsProgramChunks) {
+    data->dispatcher(pluginHandle, effSetChunk, 0, (VstIntPtr)snapshot->dataSize, snapshot->data, 0.0f);
+    return true;
+  }
+
+  if(snapshot->dataSize != sizeof(VstInt32) + sizeof(float) * pluginHandle->numParams) {
+    logInternalError("Snapshot does not match the parameters of plugin '%s'", plugin->pluginName->data);
+    return false;
+  }
+  VstInt32* program = (VstInt32*)snapshot->data;
+  float* parameters = (float*)(program + 1);
+  if(pluginHandle->numPrograms > 0) {
+    data->dispatcher(pluginHandle, effSetProgram, 0, *program, NULL, 0.0f);
+  }
+  for(int i = 0; i < pluginHandle->numParams; i++) {
+    pluginHandle->setParameter(pluginHandle, i, parameters[i]);
+  }
+  return true;
+}
+
 static void _prepareForProcessingVst2xPlugin(void* pluginPtr) {
   Plugin plugin = (Plugin)pluginPtr;
   _resumePlugin(plugin);
@@ -631,17 +845,19 @@ static void _closeVst2xPlugin(void *pluginPtr) {
 static void _freeVst2xPluginData(void* pluginDataPtr) {
   PluginVst2xData data = (PluginVst2xData)(pluginDataPtr);
 
-  data->dispatcher(data->pluginHandle, effClose, 0, 0, NULL, 0.0f);
-  data->dispatcher = NULL;
-  data->pluginHandle = NULL;
-  closeLibraryHandle(data->libraryHandle);
-  if(data->vstEvents != NULL) {
-    for(int i = 0; i < data->vstEvents->numEvents; i++) {
-      free(data->vstEvents->events[i]);
-    }
-    free(data->vstEvents);
+  // Plugins which are hosted in a sandbox process are never opened by the host
+  if(data->dispatcher != NULL) {
+    data->dispatcher(data->pluginHandle, effClose, 0, 0, NULL, 0.0f);
+    data->dispatcher = NULL;
+    data->pluginHandle = NULL;
+  }
+  if(data->libraryHandle != NULL) {
+    closeLibraryHandle(data->libraryHandle);
   }
+  _freeVst2xMidiEventPool(data);
 
+  free(data->hostContext);
+  freeCharString(data->pluginAbsolutePath);
   free(data);
 }
 
@@ -656,6 +872,10 @@ Plugin newPluginVst2x(const CharString pluginName, const CharString pluginLocati
   charStringCopy(plugin->pluginLocation, pluginLocation);
   plugin->numInputs = 0;
   plugin->numOutputs = 0;
+  // processReplacing() must overwrite the outputs, but not every plugin
+  // handles its inputs and outputs sharing memory
+  plugin->overwritesOutputs = true;
+  plugin->canProcessInPlace = false;
 
   plugin->open = _openVst2xPlugin;
   plugin->displayInfo = _displayVst2xPluginInfo;
@@ -664,6 +884,8 @@ Plugin newPluginVst2x(const CharString pluginName, const CharString pluginLocati
   plugin->processAudio = _processAudioVst2xPlugin;
   plugin->processMidiEvents = _processMidiEventsVst2xPlugin;
   plugin->setParameter = _setParameterVst2xPlugin;
+  plugin->takeSnapshot = _takeVst2xPluginSnapshot;
+  plugin->restoreSnapshot = _restoreVst2xPluginSnapshot;
   plugin->prepareForProcessing = _prepareForProcessingVst2xPlugin;
   plugin->closePlugin = _closeVst2xPlugin;
   plugin->freePluginData = _freeVst2xPluginData;
@@ -674,9 +896,32 @@ Plugin newPluginVst2x(const CharString pluginName, const CharString pluginLocati
   extraData->libraryHandle = NULL;
   extraData->isPluginShell = false;
   extraData->shellPluginId = 0;
+  extraData->pluginAbsolutePath = newCharString();
   extraData->vstEvents = NULL;
+  extraData->vstMidiEventPool = NULL;
+  extraData->deferredVstEvents = NULL;
+  extraData->vstEventsCapacity = 0;
+  _reserveVst2xMidiEvents(extraData, VST2X_MIDI_EVENT_POOL_SIZE);
+  extraData->hostContext = (PluginVst2xHostContext)malloc(sizeof(PluginVst2xHostContextMembers));
+  memset(extraData->hostContext, 0, sizeof(PluginVst2xHostContextMembers));
   plugin->extraData = extraData;
 
+  // If the plugin was loaded on a previous run, its type and I/O configuration
+  // are already known, so the plugin chain can be checked before loading it
+  PluginScanCache pluginScanCache = getPluginScanCache();
+  if(pluginScanCache != NULL && (isAbsolutePath(pluginName) || !charStringIsEmpty(pluginLocation))) {
+    CharString pluginFilePath = newCharString();
+    PluginScanInfo info = newPluginScanInfo();
+    _getVst2xPluginFilePath(pluginName, pluginLocation, pluginFilePath);
+    if(pluginScanCacheGetInfo(pluginScanCache, pluginFilePath, info)) {
+      plugin->pluginType = info->pluginType;
+      plugin->numInputs = info->numInputs;
+      plugin->numOutputs = info->numOutputs;
+    }
+    freePluginScanInfo(info);
+    freeCharString(pluginFilePath);
+  }
+
   return plugin;
 }
 }
@@ -39,22 +39,32 @@ extern "C" {
 #include "app/BuildInfo.h"
 #include "audio/AudioSettings.h"
 #include "base/CharString.h"
+#include "base/PlatformUtilities.h"
 #include "base/StringUtilities.h"
 #include "logging/EventLogger.h"
 #include "plugin/PluginVst2x.h"
 #include "sequencer/AudioClock.h"
 }
 
-// Global variables (sigh, yes)
-// TODO: This doesn't necessarily have to be global, actually
-static VstTimeInfo vstTimeInfo;
-
 extern "C" {
 // Current plugin ID, which is mostly used by shell plugins during initialization.
 // Instance declared in PluginVst2x.cpp, see explanation for the global-ness and
 // need of this variable there.
 extern VstInt32 currentPluginUniqueId;
 
+// Time info for plugins which ask for it while they are being opened, before
+// they have a host context. Each thread opens one plugin at a time.
+static THREAD_LOCAL VstTimeInfo openingPluginVstTimeInfo;
+
+static PluginVst2xHostContext _getHostContext(AEffect *effect) {
+  // The context is set after the plugin has been loaded, so calls made during
+  // initialization will not have one.
+  if(effect == NULL) {
+    return NULL;
+  }
+  return (PluginVst2xHostContext)effect->resvd1;
+}
+
 static int _canHostDo(const char* pluginName, const char* canDoString) {
   boolByte supported = false;
 
@@ -124,6 +134,7 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
     uniqueIdString = newCharStringWithCString("????");
   }
   const char* uniqueId = uniqueIdString->data;
+  PluginVst2xHostContext hostContext = _getHostContext(effect);
   VstIntPtr result = 0;
 
   logDebug("Plugin '%s' called host dispatcher with %d, %d, %d", uniqueId, opcode, index, value);
@@ -154,16 +165,24 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
       result = 1;
       break;
     case audioMasterGetTime: {
-      AudioClock audioClock = getAudioClock();
+      // Plugins which are still being opened use the context of the thread
+      // which opens them
+      MrsWatsonContext context = hostContext != NULL ? hostContext->context : getMrsWatsonContext();
+      AudioSettings audioSettings = mrsWatsonContextGetAudioSettings(context);
+      AudioClock audioClock = mrsWatsonContextGetAudioClock(context);
+      VstTimeInfo &vstTimeInfo = hostContext != NULL ? hostContext->vstTimeInfo : openingPluginVstTimeInfo;
 
-      // These values are always valid
-      vstTimeInfo.samplePos = audioClock->currentFrame;
-      vstTimeInfo.sampleRate = getSampleRate();
+      // These values are always valid. Programs which embed MrsWatson may not
+      // have a clock, in which case the transport is stopped at the start.
+      vstTimeInfo.samplePos = audioClock != NULL ? audioClock->currentFrame : 0;
+      vstTimeInfo.sampleRate = audioSettings->sampleRate;
 
       // Set flags for transport state
       vstTimeInfo.flags = 0;
-      vstTimeInfo.flags |= audioClock->transportChanged ? kVstTransportChanged : 0;
-      vstTimeInfo.flags |= audioClock->isPlaying ? kVstTransportPlaying : 0;
+      if(audioClock != NULL) {
+        vstTimeInfo.flags |= audioClock->transportChanged ? kVstTransportChanged : 0;
+        vstTimeInfo.flags |= audioClock->isPlaying ? kVstTransportPlaying : 0;
+      }
 
       // Fill values based on other flags which may have been requested
       if(value & kVstNanosValid) {
@@ -175,14 +194,14 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
       }
       if(value & kVstPpqPosValid) {
         // TODO: Move calculations to AudioClock
-        double samplesPerBeat = (60.0 / getTempo()) * getSampleRate();
+        double samplesPerBeat = (60.0 / audioSettings->tempo) * audioSettings->sampleRate;
         // Musical time starts with 1, not 0
         vstTimeInfo.ppqPos = (vstTimeInfo.samplePos / samplesPerBeat) + 1.0;
         logDebug("Current PPQ position is %g", vstTimeInfo.ppqPos);
         vstTimeInfo.flags |= kVstPpqPosValid;
       }
       if(value & kVstTempoValid) {
-        vstTimeInfo.tempo = getTempo();
+        vstTimeInfo.tempo = audioSettings->tempo;
         vstTimeInfo.flags |= kVstTempoValid;
       }
       if(value & kVstBarsValid) {
@@ -190,8 +209,8 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
           logError("Plugin requested position in bars, but not PPQ");
         }
         // TODO: Move calculations to AudioClock
-        double currentBarPos = floor(vstTimeInfo.ppqPos / (double)getTimeSignatureBeatsPerMeasure());
-        vstTimeInfo.barStartPos = currentBarPos * (double)getTimeSignatureBeatsPerMeasure() + 1.0;
+        double currentBarPos = floor(vstTimeInfo.ppqPos / (double)audioSettings->timeSignatureBeatsPerMeasure);
+        vstTimeInfo.barStartPos = currentBarPos * (double)audioSettings->timeSignatureBeatsPerMeasure + 1.0;
         logDebug("Current bar is %g", vstTimeInfo.barStartPos);
         vstTimeInfo.flags |= kVstBarsValid;
       }
@@ -199,8 +218,8 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
         // We don't support cycling, so this is always 0
       }
       if(value & kVstTimeSigValid) {
-        vstTimeInfo.timeSigNumerator = getTimeSignatureBeatsPerMeasure();
-        vstTimeInfo.timeSigDenominator = getTimeSignatureNoteValue();
+        vstTimeInfo.timeSigNumerator = audioSettings->timeSignatureBeatsPerMeasure;
+        vstTimeInfo.timeSigDenominator = audioSettings->timeSignatureNoteValue;
         vstTimeInfo.flags |= kVstTimeSigValid;
       }
       if(value & kVstSmpteValid) {
@@ -238,10 +257,10 @@ VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode,
       logWarn("Plugin '%s' asked us to resize window (unsupported)", uniqueId);
       break;
     case audioMasterGetSampleRate:
-      result = (int)getSampleRate();
+      result = (int)(hostContext != NULL ? mrsWatsonContextGetAudioSettings(hostContext->context)->sampleRate : getSampleRate());
       break;
     case audioMasterGetBlockSize:
-      result = getBlocksize();
+      result = hostContext != NULL ? mrsWatsonContextGetAudioSettings(hostContext->context)->blocksize : getBlocksize();
       break;
     case audioMasterGetInputLatency:
       // Input latency is not used, and is always 0
@@ -31,12 +31,28 @@
 #define VST_FORCE_DEPRECATED 0
 #include "aeffectx.h"
 
+extern "C" {
+#include "app/MrsWatsonContext.h"
+}
+
 typedef AEffect* (*Vst2xPluginEntryFunc)(audioMasterCallback host);
 typedef VstIntPtr (*Vst2xPluginDispatcherFunc)(AEffect *effect, VstInt32 opCode, VstInt32 index, VstIntPtr value, void *ptr, float opt);
 typedef float (*Vst2xPluginGetParameterFunc)(AEffect *effect, VstInt32 index);
 typedef void (*Vst2xPluginSetParameterFunc)(AEffect *effect, VstInt32 index, float value);
 typedef void (*Vst2xPluginProcessFunc)(AEffect* effect, float** inputs, float** outputs, VstInt32 sampleFrames);
 
+/**
+ * Host state for a single plugin instance. A pointer to this struct is stored
+ * in the AEffect's resvd1 field, which is reserved for the host, so that the
+ * host callback can map the calling plugin back to the context of the plugin
+ * chain which it belongs to.
+ */
+typedef struct {
+  MrsWatsonContext context;
+  VstTimeInfo vstTimeInfo;
+} PluginVst2xHostContextMembers;
+typedef PluginVst2xHostContextMembers* PluginVst2xHostContext;
+
 extern "C" {
 VstIntPtr VSTCALLBACK pluginVst2xHostCallback(AEffect *effect, VstInt32 opcode, VstInt32 index, VstIntPtr value, void *dataPtr, float opt);
 }
@@ -28,19 +28,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "base/PlatformUtilities.h"
 #include "sequencer/AudioClock.h"
 
 AudioClock audioClockInstance = NULL;
+static THREAD_LOCAL AudioClock threadAudioClock = NULL;
 
 void initAudioClock(void) {
-  audioClockInstance = (AudioClock)malloc(sizeof(AudioClockMembers));
-  audioClockInstance->currentFrame = 0;
-  audioClockInstance->transportChanged = false;
-  audioClockInstance->isPlaying = false;
+  audioClockInstance = newAudioClock();
+}
+
+AudioClock newAudioClock(void) {
+  AudioClock audioClock = (AudioClock)malloc(sizeof(AudioClockMembers));
+  audioClock->currentFrame = 0;
+  audioClock->transportChanged = false;
+  audioClock->isPlaying = false;
+  return audioClock;
 }
 
 AudioClock getAudioClock(void) {
-  return audioClockInstance;
+  return threadAudioClock != NULL ? threadAudioClock : audioClockInstance;
+}
+
+void setThreadAudioClock(AudioClock audioClock) {
+  threadAudioClock = audioClock;
 }
 
 void advanceAudioClock(AudioClock self, const unsigned long blocksize) {
@@ -59,7 +70,15 @@ void audioClockStop(AudioClock self) {
   self->transportChanged = true;
 }
 
+void audioClockRewind(AudioClock self) {
+  audioClockStop(self);
+  self->currentFrame = 0;
+}
+
 void freeAudioClock(AudioClock self) {
+  if(threadAudioClock == self) {
+    threadAudioClock = NULL;
+  }
   free(self);
   self = NULL;
 }
@@ -34,7 +34,9 @@
  * The AudioClock class keeps track of the sequence time and delivers the
  * position in a variety of formats. Unlike most other classes, this one
  * maintains a singleton instance because it must be accessed from C++
- * callbacks where it is difficult to pass a void* pointer.
+ * callbacks where it is difficult to pass a void* pointer. Threads which
+ * process their own plugin chain use the clock of their MrsWatsonContext
+ * instead, see setThreadMrsWatsonContext().
  */
 
 typedef struct {
@@ -52,10 +54,33 @@ extern AudioClock audioClockInstance;
  */
 void initAudioClock(void);
 
+/**
+ * @return New audio clock, which is stopped at the first frame
+ */
+AudioClock newAudioClock(void);
+
+/**
+ * Get the clock used by the calling thread, which is the global instance
+ * unless setThreadAudioClock() was called from this thread.
+ * @return Audio clock for this thread
+ */
 AudioClock getAudioClock(void);
+
+/**
+ * Use another clock than the global one for the calling thread
+ * @param audioClock Clock to use, or NULL to use the global clock again
+ */
+void setThreadAudioClock(AudioClock audioClock);
 void advanceAudioClock(AudioClock self, const unsigned long blocksize);
 void audioClockStop(AudioClock self);
 
+/**
+ * Stop the clock and move it back to the first frame, so that a new input
+ * source can be processed from the start of the timeline.
+ * @param self
+ */
+void audioClockRewind(AudioClock self);
+
 void freeAudioClock(AudioClock self);
 
 #endif
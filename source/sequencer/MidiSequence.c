@@ -27,6 +27,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sequencer/MidiSequence.h"
 #include "logging/EventLogger.h"
@@ -34,62 +35,97 @@
 MidiSequence newMidiSequence(void) {
   MidiSequence midiSequence = malloc(sizeof(MidiSequenceMembers));
 
-  midiSequence->midiEvents = newLinkedList();
-  midiSequence->_lastEvent = midiSequence->midiEvents;
-  midiSequence->_lastTimestamp = 0;
+  midiSequence->midiEvents = (MidiEventMembers*)malloc(sizeof(MidiEventMembers) * MIDI_SEQUENCE_INITIAL_CAPACITY);
+  midiSequence->numMidiEvents = 0;
+  midiSequence->capacity = MIDI_SEQUENCE_INITIAL_CAPACITY;
+  midiSequence->_nextEvent = 0;
   midiSequence->numMidiEventsProcessed = 0;
 
   return midiSequence;
 }
 
 void appendMidiEventToSequence(MidiSequence midiSequence, MidiEvent midiEvent) {
-  if(midiSequence != NULL && midiEvent != NULL) {
-    linkedListAppend(midiSequence->midiEvents, midiEvent);
+  unsigned long index;
+
+  if(midiSequence == NULL || midiEvent == NULL) {
+    return;
+  }
+
+  if(midiSequence->numMidiEvents == midiSequence->capacity) {
+    midiSequence->capacity *= 2;
+    midiSequence->midiEvents = (MidiEventMembers*)realloc(midiSequence->midiEvents,
+      sizeof(MidiEventMembers) * midiSequence->capacity);
+  }
+
+  // Events from a file are already in order, so this rarely moves any others
+  index = midiSequence->numMidiEvents;
+  while(index > 0 && midiSequence->midiEvents[index - 1].timestamp > midiEvent->timestamp) {
+    index--;
+  }
+  if(index < midiSequence->numMidiEvents) {
+    memmove(midiSequence->midiEvents + index + 1, midiSequence->midiEvents + index,
+      sizeof(MidiEventMembers) * (midiSequence->numMidiEvents - index));
+  }
+  midiSequence->midiEvents[index] = *midiEvent;
+  midiSequence->numMidiEvents++;
+  // The copy in the sequence now owns the event's extra data
+  free(midiEvent);
+}
+
+void midiSequenceSeek(MidiSequence self, const unsigned long timestamp) {
+  unsigned long low = 0;
+  unsigned long high = self->numMidiEvents;
+  unsigned long middle;
+
+  while(low < high) {
+    middle = low + (high - low) / 2;
+    if(self->midiEvents[middle].timestamp < timestamp) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
   }
+  self->_nextEvent = low;
 }
 
 boolByte fillMidiEventsFromRange(MidiSequence midiSequence, const unsigned long startTimestamp,
   const unsigned long blocksize, LinkedList outMidiEvents) {
   MidiEvent midiEvent;
-  LinkedListIterator iterator = midiSequence->_lastEvent;
   const unsigned long stopTimestamp = startTimestamp + blocksize;
 
-  while(true) {
-    if((iterator == NULL) || (iterator->item == NULL)) {
-      return false;
-    }
-
-    midiEvent = iterator->item;
-    if(stopTimestamp < midiEvent->timestamp) {
+  while(midiSequence->_nextEvent < midiSequence->numMidiEvents) {
+    midiEvent = &(midiSequence->midiEvents[midiSequence->_nextEvent]);
+    if(stopTimestamp <= midiEvent->timestamp) {
       // We have not yet reached this event, stop iterating
       break;
     }
-    else if(startTimestamp <= midiEvent->timestamp && stopTimestamp > midiEvent->timestamp) {
+    else if(startTimestamp > midiEvent->timestamp) {
+      logInternalError("Inconsistent MIDI sequence ordering");
+    }
+    else {
       midiEvent->deltaFrames = midiEvent->timestamp - startTimestamp;
       logDebug("Scheduling MIDI event 0x%x (%x, %x) in %ld frames",
         midiEvent->status, midiEvent->data1, midiEvent->data2, midiEvent->deltaFrames);
       linkedListAppend(outMidiEvents, midiEvent);
-      midiSequence->_lastEvent = iterator->nextItem;
       midiSequence->numMidiEventsProcessed++;
     }
-    else if(startTimestamp > midiEvent->timestamp) {
-      logInternalError("Inconsistent MIDI sequence ordering");
-    }
-
-    // Last item in the list
-    if(iterator->nextItem == NULL) {
-      if(startTimestamp <= midiEvent->timestamp && stopTimestamp > midiEvent->timestamp) {
-        return false;
-      }
-      break;
-    }
-    iterator = iterator->nextItem;
+    midiSequence->_nextEvent++;
   }
 
-  return true;
+  return (boolByte)(midiSequence->_nextEvent < midiSequence->numMidiEvents);
 }
 
 void freeMidiSequence(MidiSequence midiSequence) {
-  freeLinkedListAndItems(midiSequence->midiEvents, (LinkedListFreeItemFunc)freeMidiEvent);
+  MidiEvent midiEvent;
+  unsigned long i;
+
+  for(i = 0; i < midiSequence->numMidiEvents; i++) {
+    midiEvent = &(midiSequence->midiEvents[i]);
+    if(midiEvent->eventType == MIDI_TYPE_SYSEX || midiEvent->eventType == MIDI_TYPE_META) {
+      free(midiEvent->extraData);
+    }
+  }
+  free(midiSequence->midiEvents);
   free(midiSequence);
 }
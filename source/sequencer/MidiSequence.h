@@ -31,10 +31,20 @@
 #include "base/LinkedList.h"
 #include "midi/MidiEvent.h"
 
+// Number of events which a new sequence has room for before it is enlarged
+#define MIDI_SEQUENCE_INITIAL_CAPACITY 256
+
+/**
+ * A list of MIDI events which are sorted by timestamp, and stored in a single
+ * array so that events for a given time can be found with a binary search.
+ */
 typedef struct {
-  LinkedList midiEvents;
-  LinkedListIterator _lastEvent;
-  int _lastTimestamp;
+  // Events with the same timestamp are kept in the order they were appended
+  MidiEventMembers* midiEvents;
+  unsigned long numMidiEvents;
+  unsigned long capacity;
+  // Index of the first event which has not yet been played
+  unsigned long _nextEvent;
   int numMidiEventsProcessed;
 } MidiSequenceMembers;
 
@@ -42,7 +52,35 @@ typedef MidiSequenceMembers* MidiSequence;
 
 MidiSequence newMidiSequence(void);
 
+/**
+ * Add an event to the sequence. Events are usually appended in order of their
+ * timestamp, which takes constant time, but events which are out of order are
+ * inserted at the correct position.
+ * @param midiSequence
+ * @param midiEvent Event to add. The sequence keeps a copy of the event and
+ * takes ownership of its data, and the event itself is freed.
+ */
 void appendMidiEventToSequence(MidiSequence midiSequence, MidiEvent midiEvent);
+
+/**
+ * Move the sequence to a new position, so that the next call to
+ * fillMidiEventsFromRange() starts with the first event at or after the given
+ * time. Events before the new position, including any tempo changes, are not
+ * played.
+ * @param self
+ * @param timestamp Position in sample frames
+ */
+void midiSequenceSeek(MidiSequence self, const unsigned long timestamp);
+
+/**
+ * Get the events of the next block, starting at the sequence's current position
+ * @param midiSequence
+ * @param startTimestamp Start time of the block in sample frames
+ * @param blocksize Length of the block in sample frames
+ * @param outMidiEvents List to append the events to. The events belong to the
+ * sequence, and have their delta frames set relative to the block's start.
+ * @return False if there are no more events after this block
+ */
 boolByte fillMidiEventsFromRange(MidiSequence midiSequence, const unsigned long startTimestamp,
   const unsigned long blocksize, LinkedList outMidiEvents);
 
@@ -27,32 +27,64 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "base/PlatformUtilities.h"
+#include "logging/EventLogger.h"
 #include "time/TaskTimer.h"
 
-#if UNIX
-#include <sys/time.h>
+#if MACOSX
+#include <mach/mach_time.h>
+#elif UNIX
+#include <time.h>
 #endif
 
+#define NS_PER_MS 1000000.0
+
+static unsigned long long _getCurrentTimeInNs(TaskTimer taskTimer) {
+#if WINDOWS
+  LARGE_INTEGER currentTime;
+  QueryPerformanceCounter(&currentTime);
+  return (unsigned long long)((double)currentTime.QuadPart * taskTimer->nanosecondsPerClock);
+#elif MACOSX
+  return (unsigned long long)((double)mach_absolute_time() * taskTimer->timebaseRatio);
+#elif UNIX
+  struct timespec currentTime;
+  clock_gettime(CLOCK_MONOTONIC, &currentTime);
+  return (unsigned long long)currentTime.tv_sec * 1000000000ull + (unsigned long long)currentTime.tv_nsec;
+#else
+  return 0;
+#endif
+}
+
 TaskTimer newTaskTimer(const int numTasks) {
   TaskTimer taskTimer = (TaskTimer)malloc(sizeof(TaskTimerMembers));
   int i;
 #if WINDOWS
   LARGE_INTEGER queryFrequency;
+#elif MACOSX
+  mach_timebase_info_data_t timebaseInfo;
 #endif
 
   taskTimer->numTasks = numTasks;
   taskTimer->currentTask = -1;
   taskTimer->totalTaskTimes = (double*)malloc(sizeof(double) * numTasks);
+  taskTimer->blockTaskTimes = (unsigned long long*)malloc(sizeof(unsigned long long) * numTasks);
+  taskTimer->isTaskUsedInBlock = (boolByte*)malloc(sizeof(boolByte) * numTasks);
+  taskTimer->taskHistograms = (TimingHistogram*)malloc(sizeof(TimingHistogram) * numTasks);
+  taskTimer->numMissedTaskDeadlines = (unsigned long*)malloc(sizeof(unsigned long) * numTasks);
   for(i = 0; i < numTasks; i++) {
-    taskTimer->totalTaskTimes[i] = 0.0;
+    taskTimer->taskHistograms[i] = newTimingHistogram();
   }
+  taskTimer->blockHistogram = newTimingHistogram();
+  taskTimerReset(taskTimer);
+  taskTimer->startTime = 0;
 #if WINDOWS
   QueryPerformanceFrequency(&queryFrequency);
-  taskTimer->counterFrequency = (double)(queryFrequency.QuadPart) / 1000.0;
-#elif UNIX
-  taskTimer->startTime = (struct timeval*)malloc(sizeof(struct timeval));
+  taskTimer->nanosecondsPerClock = 1000000000.0 / (double)(queryFrequency.QuadPart);
+#elif MACOSX
+  mach_timebase_info(&timebaseInfo);
+  taskTimer->timebaseRatio = (double)timebaseInfo.numer / (double)timebaseInfo.denom;
 #endif
 
   return taskTimer;
@@ -63,50 +95,166 @@ void startTimingTask(TaskTimer taskTimer, const int taskId) {
     return;
   }
   stopTiming(taskTimer);
-#if WINDOWS
-  QueryPerformanceCounter(&(taskTimer->startTime));
-#elif UNIX
-  gettimeofday(taskTimer->startTime, NULL);
-#endif
+  taskTimer->startTime = _getCurrentTimeInNs(taskTimer);
   taskTimer->currentTask = taskId;
+  taskTimer->isTaskUsedInBlock[taskId] = true;
+}
+
+// Add the time since the current task was started to its totals, and return the
+// time at which this was done.
+static unsigned long long _addElapsedTime(TaskTimer taskTimer) {
+  unsigned long long currentTime = _getCurrentTimeInNs(taskTimer);
+  unsigned long long elapsedTime;
+
+  if(taskTimer->currentTask >= 0) {
+    elapsedTime = currentTime > taskTimer->startTime ? currentTime - taskTimer->startTime : 0;
+    taskTimer->blockTaskTimes[taskTimer->currentTask] += elapsedTime;
+    taskTimer->totalTaskTimes[taskTimer->currentTask] += (double)elapsedTime / NS_PER_MS;
+  }
+  return currentTime;
 }
 
 void stopTiming(TaskTimer taskTimer) {
-#if WINDOWS
-  LONGLONG elapsedTimeInClocks;
   if(taskTimer->currentTask >= 0) {
-    LARGE_INTEGER stopTime;
-    QueryPerformanceCounter(&stopTime);
-    elapsedTimeInClocks = stopTime.QuadPart - taskTimer->startTime.QuadPart;
-    taskTimer->totalTaskTimes[taskTimer->currentTask] += (double)(elapsedTimeInClocks) / taskTimer->counterFrequency;
+    _addElapsedTime(taskTimer);
   }
-#elif UNIX
-  double elapsedTimeInMs;
-  double elapsedFullSeconds;
-  double elapsedMicroseconds;
-  struct timeval currentTime;
+  taskTimer->currentTask = -1;
+}
+
+void taskTimerFinishBlock(TaskTimer taskTimer, const double deadlineInMs) {
+  const unsigned long long deadlineInNs = (unsigned long long)(deadlineInMs * NS_PER_MS);
+  unsigned long long blockTime = 0;
+  boolByte isBlockUsed = false;
+  int i;
 
   if(taskTimer->currentTask >= 0) {
-    if(gettimeofday(&currentTime, NULL) == 0) {
-      if(currentTime.tv_sec == taskTimer->startTime->tv_sec) {
-        elapsedTimeInMs = (double)(currentTime.tv_usec - taskTimer->startTime->tv_usec) / 1000.0;
-      }
-      else {
-        elapsedFullSeconds = (double)(currentTime.tv_sec - taskTimer->startTime->tv_sec - 1);
-        elapsedMicroseconds = (double)(currentTime.tv_usec + (1000000l - taskTimer->startTime->tv_usec));
-        elapsedTimeInMs = (elapsedFullSeconds * 1000.0) + (elapsedMicroseconds / 1000.0);
+    taskTimer->startTime = _addElapsedTime(taskTimer);
+  }
+
+  for(i = 0; i < taskTimer->numTasks; i++) {
+    if(taskTimer->isTaskUsedInBlock[i]) {
+      timingHistogramAdd(taskTimer->taskHistograms[i], taskTimer->blockTaskTimes[i]);
+      if(deadlineInNs > 0 && taskTimer->blockTaskTimes[i] > deadlineInNs) {
+        taskTimer->numMissedTaskDeadlines[i]++;
       }
-      taskTimer->totalTaskTimes[taskTimer->currentTask] += elapsedTimeInMs;
+      blockTime += taskTimer->blockTaskTimes[i];
+      isBlockUsed = true;
     }
+    taskTimer->blockTaskTimes[i] = 0;
+    taskTimer->isTaskUsedInBlock[i] = false;
+  }
+
+  if(isBlockUsed) {
+    timingHistogramAdd(taskTimer->blockHistogram, blockTime);
+    if(deadlineInNs > 0 && blockTime > deadlineInNs) {
+      taskTimer->numMissedBlockDeadlines++;
+    }
+  }
+  // The running task carries on into the next block
+  if(taskTimer->currentTask >= 0) {
+    taskTimer->isTaskUsedInBlock[taskTimer->currentTask] = true;
   }
-#endif
-  taskTimer->currentTask = -1;
+}
+
+void taskTimerMergeTask(TaskTimer taskTimer, const int taskId, const TaskTimer other, const int otherTaskId) {
+  taskTimer->totalTaskTimes[taskId] += other->totalTaskTimes[otherTaskId];
+  timingHistogramMerge(taskTimer->taskHistograms[taskId], other->taskHistograms[otherTaskId]);
+  taskTimer->numMissedTaskDeadlines[taskId] += other->numMissedTaskDeadlines[otherTaskId];
+}
+
+void taskTimerMerge(TaskTimer taskTimer, const TaskTimer other) {
+  int i;
+  for(i = 0; i < taskTimer->numTasks && i < other->numTasks; i++) {
+    taskTimerMergeTask(taskTimer, i, other, i);
+  }
+  timingHistogramMerge(taskTimer->blockHistogram, other->blockHistogram);
+  taskTimer->numMissedBlockDeadlines += other->numMissedBlockDeadlines;
+}
+
+void taskTimerReset(TaskTimer taskTimer) {
+  int i;
+  for(i = 0; i < taskTimer->numTasks; i++) {
+    taskTimer->totalTaskTimes[i] = 0.0;
+    taskTimer->blockTaskTimes[i] = 0;
+    taskTimer->isTaskUsedInBlock[i] = false;
+    timingHistogramClear(taskTimer->taskHistograms[i]);
+    taskTimer->numMissedTaskDeadlines[i] = 0;
+  }
+  timingHistogramClear(taskTimer->blockHistogram);
+  taskTimer->numMissedBlockDeadlines = 0;
+  if(taskTimer->currentTask >= 0) {
+    taskTimer->isTaskUsedInBlock[taskTimer->currentTask] = true;
+  }
+}
+
+static void _writeJsonString(FILE* file, const char* string) {
+  const char* c;
+  fputc('"', file);
+  for(c = string; *c != '\0'; c++) {
+    if(*c == '"' || *c == '\\') {
+      fprintf(file, "\\%c", *c);
+    }
+    else if((unsigned char)*c < 0x20) {
+      fprintf(file, "\\u%04x", (unsigned char)*c);
+    }
+    else {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+static void _writeHistogramReport(FILE* file, const TimingHistogram histogram, const unsigned long numMissedDeadlines) {
+  fprintf(file, "\"blocks\": %lu, ", histogram->count);
+  fprintf(file, "\"totalMs\": %.6f, ", (double)histogram->total / NS_PER_MS);
+  fprintf(file, "\"meanMs\": %.6f, ", histogram->count > 0 ?
+    (double)histogram->total / NS_PER_MS / (double)histogram->count : 0.0);
+  fprintf(file, "\"p50Ms\": %.6f, ", (double)timingHistogramGetPercentile(histogram, 50.0) / NS_PER_MS);
+  fprintf(file, "\"p99Ms\": %.6f, ", (double)timingHistogramGetPercentile(histogram, 99.0) / NS_PER_MS);
+  fprintf(file, "\"p999Ms\": %.6f, ", (double)timingHistogramGetPercentile(histogram, 99.9) / NS_PER_MS);
+  fprintf(file, "\"maxMs\": %.6f, ", (double)histogram->max / NS_PER_MS);
+  fprintf(file, "\"missedDeadlines\": %lu", numMissedDeadlines);
+}
+
+boolByte taskTimerWriteReport(const TaskTimer taskTimer, const CharString filename,
+  const char* const* taskNames, const double deadlineInMs) {
+  FILE* file = fopen(filename->data, "w");
+  int i;
+
+  if(file == NULL) {
+    logError("Could not open timing report '%s' for writing", filename->data);
+    return false;
+  }
+
+  fprintf(file, "{\n  \"deadlineMs\": %.6f,\n  \"total\": {", deadlineInMs);
+  _writeHistogramReport(file, taskTimer->blockHistogram, taskTimer->numMissedBlockDeadlines);
+  fprintf(file, "},\n  \"tasks\": [\n");
+  for(i = 0; i < taskTimer->numTasks; i++) {
+    fprintf(file, "    {\"name\": ");
+    _writeJsonString(file, taskNames[i]);
+    fprintf(file, ", ");
+    _writeHistogramReport(file, taskTimer->taskHistograms[i], taskTimer->numMissedTaskDeadlines[i]);
+    fprintf(file, "}%s\n", i + 1 < taskTimer->numTasks ? "," : "");
+  }
+  fprintf(file, "  ]\n}\n");
+
+  if(fclose(file) != 0) {
+    logError("Could not write timing report '%s'", filename->data);
+    return false;
+  }
+  return true;
 }
 
 void freeTaskTimer(TaskTimer self) {
+  int i;
+  for(i = 0; i < self->numTasks; i++) {
+    freeTimingHistogram(self->taskHistograms[i]);
+  }
+  freeTimingHistogram(self->blockHistogram);
   free(self->totalTaskTimes);
-#if UNIX
-  free(self->startTime);
-#endif
+  free(self->blockTaskTimes);
+  free(self->isTaskUsedInBlock);
+  free(self->taskHistograms);
+  free(self->numMissedTaskDeadlines);
   free(self);
 }
@@ -30,16 +30,38 @@
 
 #include "base/CharString.h"
 #include "base/PlatformUtilities.h"
+#include "time/TimingHistogram.h"
 
+/**
+ * Measures the time used by a number of tasks, of which only one runs at any
+ * time. Besides the total time of each task, the timer keeps a histogram of the
+ * time used by each task per processing block, and counts the blocks which took
+ * longer than they would have in realtime. Time is read from a monotonic clock
+ * with nanosecond resolution where the platform supports it.
+ */
 typedef struct {
   int numTasks;
   int currentTask;
+  // Total time used by each task, in milliseconds
   double* totalTaskTimes;
+
+  // Time used by each task in the current block, in nanoseconds
+  unsigned long long* blockTaskTimes;
+  boolByte* isTaskUsedInBlock;
+  // Histograms of the time used by each task per block, and of the total time
+  // used by all tasks per block
+  TimingHistogram* taskHistograms;
+  TimingHistogram blockHistogram;
+  // Number of blocks in which a single task, or all tasks together, used more
+  // time than the block's deadline
+  unsigned long* numMissedTaskDeadlines;
+  unsigned long numMissedBlockDeadlines;
+
+  unsigned long long startTime;
 #if WINDOWS
-  LARGE_INTEGER startTime;
-  double counterFrequency;
-#elif UNIX
-  struct timeval* startTime;
+  double nanosecondsPerClock;
+#elif MACOSX
+  double timebaseRatio;
 #endif
 } TaskTimerMembers;
 typedef TaskTimerMembers* TaskTimer;
@@ -49,6 +71,52 @@ TaskTimer newTaskTimer(const int maxTasks);
 void startTimingTask(TaskTimer taskTimer, const int taskId);
 void stopTiming(TaskTimer taskTimer);
 
+/**
+ * Finish timing the current processing block, adding the time used by each task
+ * in it to the histograms. A task which is running continues to be timed, but
+ * its time from now on counts towards the next block. Tasks which were not run
+ * during the block are not counted.
+ * @param taskTimer
+ * @param deadlineInMs Time which the block may use when processed in realtime, or
+ * 0 to not count missed deadlines
+ */
+void taskTimerFinishBlock(TaskTimer taskTimer, const double deadlineInMs);
+
+/**
+ * Add the time recorded for a task in another timer to one of this timer's tasks.
+ * This is used to collect the times of tasks which were run on other threads.
+ * @param taskTimer
+ * @param taskId Task to add the time to
+ * @param other Other timer, which should be stopped
+ * @param otherTaskId Task in the other timer
+ */
+void taskTimerMergeTask(TaskTimer taskTimer, const int taskId, const TaskTimer other, const int otherTaskId);
+
+/**
+ * Add all times recorded by another timer with the same tasks to this one,
+ * including its block histogram.
+ * @param taskTimer
+ * @param other Other timer, which should be stopped
+ */
+void taskTimerMerge(TaskTimer taskTimer, const TaskTimer other);
+
+/**
+ * Clear all recorded times
+ * @param taskTimer
+ */
+void taskTimerReset(TaskTimer taskTimer);
+
+/**
+ * Write a JSON report with the block time histogram of each task
+ * @param taskTimer
+ * @param filename File to write
+ * @param taskNames Name of each task
+ * @param deadlineInMs Deadline of a full block, which is included in the report
+ * @return True if the report was written
+ */
+boolByte taskTimerWriteReport(const TaskTimer taskTimer, const CharString filename,
+  const char* const* taskNames, const double deadlineInMs);
+
 void freeTaskTimer(TaskTimer taskTimer);
 
 #endif
@@ -0,0 +1,143 @@
+//
+// TimingHistogram.c - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "time/TimingHistogram.h"
+
+// Each power of two is split into this many linear sub-buckets, which gives a
+// relative error of at most 1 / SUB_BUCKET_COUNT.
+#define SUB_BUCKET_BITS 5
+#define SUB_BUCKET_COUNT (1 << SUB_BUCKET_BITS)
+// Durations up to 2^(MAX_EXPONENT + 1)ns, about 36 minutes, have their own buckets
+#define MAX_EXPONENT 40
+#define NUM_BUCKETS ((MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT)
+
+// Values below 2 * SUB_BUCKET_COUNT map directly to their bucket. Above that,
+// the bucket group is given by the position of the highest set bit, and the
+// sub-bucket by the next SUB_BUCKET_BITS bits.
+static unsigned long _getBucketIndex(const unsigned long long value) {
+  unsigned long long shifted = value;
+  unsigned int shift = 0;
+
+  if(value < 2 * SUB_BUCKET_COUNT) {
+    return (unsigned long)value;
+  }
+  while(shifted >= 2 * SUB_BUCKET_COUNT) {
+    shifted >>= 1;
+    shift++;
+  }
+  if(shift > MAX_EXPONENT - SUB_BUCKET_BITS) {
+    return NUM_BUCKETS - 1;
+  }
+  return (unsigned long)(shift * SUB_BUCKET_COUNT + shifted);
+}
+
+static unsigned long long _getBucketUpperBound(const unsigned long index) {
+  unsigned long shift;
+  if(index < 2 * SUB_BUCKET_COUNT) {
+    return index;
+  }
+  shift = index / SUB_BUCKET_COUNT - 1;
+  return (((unsigned long long)(index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT + 1)) << shift) - 1;
+}
+
+TimingHistogram newTimingHistogram(void) {
+  TimingHistogram histogram = (TimingHistogram)malloc(sizeof(TimingHistogramMembers));
+  histogram->numBuckets = NUM_BUCKETS;
+  histogram->buckets = (unsigned long*)malloc(sizeof(unsigned long) * NUM_BUCKETS);
+  timingHistogramClear(histogram);
+  return histogram;
+}
+
+void timingHistogramAdd(TimingHistogram self, const unsigned long long durationInNs) {
+  self->buckets[_getBucketIndex(durationInNs)]++;
+  self->count++;
+  self->total += durationInNs;
+  if(durationInNs > self->max) {
+    self->max = durationInNs;
+  }
+}
+
+unsigned long long timingHistogramGetPercentile(const TimingHistogram self, const double percentile) {
+  unsigned long long rank;
+  unsigned long long upperBound;
+  unsigned long cumulativeCount = 0;
+  unsigned long i;
+
+  if(self->count == 0) {
+    return 0;
+  }
+  if(percentile >= 100.0) {
+    return self->max;
+  }
+
+  // Rank of the value in the sorted list of all values, starting from 1
+  rank = (unsigned long long)(percentile / 100.0 * self->count);
+  if((double)rank < percentile / 100.0 * self->count) {
+    rank++;
+  }
+  if(rank < 1) {
+    rank = 1;
+  }
+
+  for(i = 0; i < self->numBuckets; i++) {
+    cumulativeCount += self->buckets[i];
+    if(cumulativeCount >= rank) {
+      upperBound = _getBucketUpperBound(i);
+      return upperBound < self->max ? upperBound : self->max;
+    }
+  }
+  return self->max;
+}
+
+void timingHistogramMerge(TimingHistogram self, const TimingHistogram other) {
+  unsigned long i;
+  for(i = 0; i < self->numBuckets; i++) {
+    self->buckets[i] += other->buckets[i];
+  }
+  self->count += other->count;
+  self->total += other->total;
+  if(other->max > self->max) {
+    self->max = other->max;
+  }
+}
+
+void timingHistogramClear(TimingHistogram self) {
+  memset(self->buckets, 0, sizeof(unsigned long) * self->numBuckets);
+  self->count = 0;
+  self->total = 0;
+  self->max = 0;
+}
+
+void freeTimingHistogram(TimingHistogram self) {
+  if(self != NULL) {
+    free(self->buckets);
+    free(self);
+  }
+}
@@ -0,0 +1,91 @@
+//
+// TimingHistogram.h - MrsWatson
+// Created by Nik Reiman on 19 May 13.
+// Copyright (c) 2013 Teragon Audio. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef MrsWatson_TimingHistogram_h
+#define MrsWatson_TimingHistogram_h
+
+#include "base/Types.h"
+
+/**
+ * Histogram of durations in nanoseconds, used to find latency percentiles
+ * without storing every measurement. Durations shorter than 64ns are counted
+ * exactly, and longer ones go into buckets which are about 3% wide, so that
+ * the histogram has a fixed size no matter how many values are added to it.
+ * Durations longer than about 36 minutes are counted in the last bucket.
+ */
+typedef struct {
+  unsigned long* buckets;
+  unsigned long numBuckets;
+  unsigned long count;
+  unsigned long long total;
+  unsigned long long max;
+} TimingHistogramMembers;
+typedef TimingHistogramMembers* TimingHistogram;
+
+/**
+ * Create a new, empty histogram
+ * @return New histogram
+ */
+TimingHistogram newTimingHistogram(void);
+
+/**
+ * Count a single duration
+ * @param self
+ * @param durationInNs Duration in nanoseconds
+ */
+void timingHistogramAdd(TimingHistogram self, const unsigned long long durationInNs);
+
+/**
+ * Get the duration which the given percentage of all values do not exceed. The
+ * result is the upper bound of the bucket holding that value, but is never
+ * larger than the longest duration which was added.
+ * @param self
+ * @param percentile Percentile between 0 and 100, ie 99.9
+ * @return Duration in nanoseconds, or 0 if the histogram is empty
+ */
+unsigned long long timingHistogramGetPercentile(const TimingHistogram self, const double percentile);
+
+/**
+ * Add all values counted by another histogram to this one
+ * @param self
+ * @param other Histogram to merge, which is not changed
+ */
+void timingHistogramMerge(TimingHistogram self, const TimingHistogram other);
+
+/**
+ * Remove all values from the histogram
+ * @param self
+ */
+void timingHistogramClear(TimingHistogram self);
+
+/**
+ * Free a histogram and its buckets
+ * @param self
+ */
+void freeTimingHistogram(TimingHistogram self);
+
+#endif
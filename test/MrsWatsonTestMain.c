@@ -15,6 +15,7 @@
 #include "base/FileUtilities.h"
 #include "base/PlatformUtilities.h"
 #include "base/StringUtilities.h"
+#include "plugin/PluginSandbox.h"
 #include "unit/ApplicationRunner.h"
 #include "unit/TestRunner.h"
 
@@ -26,6 +27,7 @@ extern TestCase findTestCase(TestSuite testSuite, char* testName);
 extern void printInternalTests(void);
 extern void runInternalTestSuite(boolByte onlyPrintFailing);
 extern int runApplicationTestSuite(TestEnvironment testEnvironment);
+extern Plugin newPluginSandboxTestPlugin(PluginInterfaceType interfaceType, const CharString pluginName, const CharString pluginLocation);
 
 static const char* DEFAULT_TEST_SUITE_NAME = "all";
 
@@ -97,6 +99,11 @@ int main(int argc, char* argv[]) {
   char* testCaseName;
   char* testSuiteName;
 
+  // The sandbox tests start this program again to host their plugins
+  if(pluginSandboxIsChildProcess(argc, argv)) {
+    return pluginSandboxChildMain(argc, argv, newPluginSandboxTestPlugin);
+  }
+
   programOptions = _newTestProgramOptions();
   if(!programOptionsParseArgs(programOptions, argc, argv)) {
     printf("Or run %s --help (option) to see help for a single option\n", getFileBasename(argv[0]));
@@ -0,0 +1,114 @@
+#include "unit/TestRunner.h"
+#include "app/BatchManifest.h"
+
+#if UNIX
+#define TEST_MANIFEST_FILE "/tmp/mrswatsontest-manifest.txt"
+#elif WINDOWS
+#define TEST_MANIFEST_FILE "C:\\Temp\\mrswatsontest-manifest.txt"
+#else
+#define TEST_MANIFEST_FILE "mrswatsontest-manifest.txt"
+#endif
+
+static int _testNewBatchManifest(void) {
+  BatchManifest b = newBatchManifest();
+  assertIntEquals(b->numJobs, 0);
+  freeBatchManifest(b);
+  return 0;
+}
+
+static int _testParseLine(void) {
+  BatchManifest b = newBatchManifest();
+  assert(batchManifestParseLine(b, "in.wav\tout.wav\n"));
+  assertIntEquals(b->numJobs, 1);
+  assertCharStringEquals(b->jobs[0]->inputSource, "in.wav");
+  assertCharStringEquals(b->jobs[0]->outputSource, "out.wav");
+  freeBatchManifest(b);
+  return 0;
+}
+
+static int _testParseLineWithQuotes(void) {
+  BatchManifest b = newBatchManifest();
+  assert(batchManifestParseLine(b, "  \"my input.wav\"   \"my output.wav\"  "));
+  assertIntEquals(b->numJobs, 1);
+  assertCharStringEquals(b->jobs[0]->inputSource, "my input.wav");
+  assertCharStringEquals(b->jobs[0]->outputSource, "my output.wav");
+  freeBatchManifest(b);
+  return 0;
+}
+
+static int _testParseEmptyLineAndComment(void) {
+  BatchManifest b = newBatchManifest();
+  assert(batchManifestParseLine(b, ""));
+  assert(batchManifestParseLine(b, "   \r\n"));
+  assert(batchManifestParseLine(b, "# in.wav out.wav"));
+  assertIntEquals(b->numJobs, 0);
+  freeBatchManifest(b);
+  return 0;
+}
+
+static int _testParseInvalidLines(void) {
+  BatchManifest b = newBatchManifest();
+  assertFalse(batchManifestParseLine(b, "in.wav"));
+  assertFalse(batchManifestParseLine(b, "in.wav out.wav extra.wav"));
+  assertFalse(batchManifestParseLine(b, "\"in.wav out.wav"));
+  assertFalse(batchManifestParseLine(b, "\"\" out.wav"));
+  assertIntEquals(b->numJobs, 0);
+  freeBatchManifest(b);
+  return 0;
+}
+
+static int _testParseFile(void) {
+  BatchManifest b = newBatchManifest();
+  CharString filename = newCharStringWithCString(TEST_MANIFEST_FILE);
+  FILE* fp = fopen(TEST_MANIFEST_FILE, "w");
+  fprintf(fp, "# Test manifest\na.wav a-out.wav\n\nb.pcm b-out.pcm\n");
+  fclose(fp);
+
+  assert(batchManifestParseFile(b, filename));
+  assertIntEquals(b->numJobs, 2);
+  assertCharStringEquals(b->jobs[0]->inputSource, "a.wav");
+  assertCharStringEquals(b->jobs[1]->outputSource, "b-out.pcm");
+
+  unlink(TEST_MANIFEST_FILE);
+  freeCharString(filename);
+  freeBatchManifest(b);
+  return 0;
+}
+
+static int _testParseFileWithoutJobs(void) {
+  BatchManifest b = newBatchManifest();
+  CharString filename = newCharStringWithCString(TEST_MANIFEST_FILE);
+  FILE* fp = fopen(TEST_MANIFEST_FILE, "w");
+  fprintf(fp, "# Nothing to do\n");
+  fclose(fp);
+
+  assertFalse(batchManifestParseFile(b, filename));
+
+  unlink(TEST_MANIFEST_FILE);
+  freeCharString(filename);
+  freeBatchManifest(b);
+  return 0;
+}
+
+static int _testParseInvalidFile(void) {
+  BatchManifest b = newBatchManifest();
+  CharString filename = newCharStringWithCString("invalid");
+  assertFalse(batchManifestParseFile(b, filename));
+  freeCharString(filename);
+  freeBatchManifest(b);
+  return 0;
+}
+
+TestSuite addBatchManifestTests(void);
+TestSuite addBatchManifestTests(void) {
+  TestSuite testSuite = newTestSuite("BatchManifest", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewBatchManifest);
+  addTest(testSuite, "ParseLine", _testParseLine);
+  addTest(testSuite, "ParseLineWithQuotes", _testParseLineWithQuotes);
+  addTest(testSuite, "ParseEmptyLineAndComment", _testParseEmptyLineAndComment);
+  addTest(testSuite, "ParseInvalidLines", _testParseInvalidLines);
+  addTest(testSuite, "ParseFile", _testParseFile);
+  addTest(testSuite, "ParseFileWithoutJobs", _testParseFileWithoutJobs);
+  addTest(testSuite, "ParseInvalidFile", _testParseInvalidFile);
+  return testSuite;
+}
@@ -0,0 +1,70 @@
+#include "unit/TestRunner.h"
+#include "app/MrsWatsonContext.h"
+
+static void _mrsWatsonContextSetup(void) {
+  initAudioSettings();
+  initAudioClock();
+}
+
+static void _mrsWatsonContextTeardown(void) {
+  setThreadMrsWatsonContext(NULL);
+  freeAudioSettings();
+  freeAudioClock(audioClockInstance);
+  audioClockInstance = NULL;
+}
+
+static int _testNewMrsWatsonContext(void) {
+  MrsWatsonContext c;
+  setSampleRate(48000.0);
+  c = newMrsWatsonContext();
+  assertNotNull(c);
+  assertDoubleEquals(c->audioSettings->sampleRate, 48000.0, TEST_FLOAT_TOLERANCE);
+  assert(c->audioSettings != audioSettingsInstance);
+  assertUnsignedLongEquals(c->audioClock->currentFrame, 0ul);
+  assert(c->audioClock != audioClockInstance);
+  freeMrsWatsonContext(c);
+  return 0;
+}
+
+static int _testSetThreadMrsWatsonContext(void) {
+  MrsWatsonContext c = newMrsWatsonContext();
+  assertIsNull(getMrsWatsonContext());
+  setThreadMrsWatsonContext(c);
+  assert(getMrsWatsonContext() == c);
+  assert(getAudioSettings() == c->audioSettings);
+  assert(getAudioClock() == c->audioClock);
+  setBlocksize(128);
+  assertUnsignedLongEquals(c->audioSettings->blocksize, 128ul);
+  assertUnsignedLongEquals(audioSettingsInstance->blocksize, DEFAULT_BLOCKSIZE);
+  setThreadMrsWatsonContext(NULL);
+  assertIsNull(getMrsWatsonContext());
+  assert(getAudioSettings() == audioSettingsInstance);
+  assert(getAudioClock() == audioClockInstance);
+  freeMrsWatsonContext(c);
+  return 0;
+}
+
+static int _testGetMembersOfGlobalContext(void) {
+  assert(mrsWatsonContextGetAudioSettings(NULL) == audioSettingsInstance);
+  assert(mrsWatsonContextGetAudioClock(NULL) == audioClockInstance);
+  return 0;
+}
+
+static int _testFreeBoundMrsWatsonContext(void) {
+  MrsWatsonContext c = newMrsWatsonContext();
+  setThreadMrsWatsonContext(c);
+  freeMrsWatsonContext(c);
+  assertIsNull(getMrsWatsonContext());
+  assert(getAudioSettings() == audioSettingsInstance);
+  return 0;
+}
+
+TestSuite addMrsWatsonContextTests(void);
+TestSuite addMrsWatsonContextTests(void) {
+  TestSuite testSuite = newTestSuite("MrsWatsonContext", _mrsWatsonContextSetup, _mrsWatsonContextTeardown);
+  addTest(testSuite, "NewObject", _testNewMrsWatsonContext);
+  addTest(testSuite, "SetThreadContext", _testSetThreadMrsWatsonContext);
+  addTest(testSuite, "GetMembersOfGlobalContext", _testGetMembersOfGlobalContext);
+  addTest(testSuite, "FreeBoundContext", _testFreeBoundMrsWatsonContext);
+  return testSuite;
+}
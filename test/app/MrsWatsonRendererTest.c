@@ -0,0 +1,177 @@
+#include <stdlib.h>
+
+#include "unit/TestRunner.h"
+#include "MrsWatsonRenderer.h"
+
+static MrsWatsonRenderer _newPassthruRenderer(void) {
+  MrsWatsonRenderer r = newMrsWatsonRenderer();
+  mrsWatsonRendererSetBlocksize(r, 64);
+  mrsWatsonRendererAddPlugins(r, "mrs_passthru", NULL);
+  return r;
+}
+
+static int _testNewMrsWatsonRenderer(void) {
+  MrsWatsonRenderer r = newMrsWatsonRenderer();
+  assertNotNull(r);
+  assertNotNull(r->context);
+  assertIntEquals(r->pluginChain->numPlugins, 0);
+  assertFalse(r->isPrepared);
+  assertDoubleEquals(r->context->audioSettings->sampleRate, DEFAULT_SAMPLE_RATE, TEST_FLOAT_TOLERANCE);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testSetSettings(void) {
+  MrsWatsonRenderer r = newMrsWatsonRenderer();
+  assertIntEquals(mrsWatsonRendererSetSampleRate(r, 48000.0), RETURN_CODE_SUCCESS);
+  assertIntEquals(mrsWatsonRendererSetNumChannels(r, 1), RETURN_CODE_SUCCESS);
+  assertIntEquals(mrsWatsonRendererSetBlocksize(r, 128), RETURN_CODE_SUCCESS);
+  assertIntEquals(mrsWatsonRendererSetTempo(r, 90.0), RETURN_CODE_SUCCESS);
+  assertDoubleEquals(r->context->audioSettings->sampleRate, 48000.0, TEST_FLOAT_TOLERANCE);
+  assertIntEquals(r->context->audioSettings->numChannels, 1);
+  assertUnsignedLongEquals(r->context->audioSettings->blocksize, 128ul);
+  assertDoubleEquals(r->context->audioSettings->tempo, 90.0, TEST_FLOAT_TOLERANCE);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testSetInvalidSettings(void) {
+  MrsWatsonRenderer r = newMrsWatsonRenderer();
+  assertIntEquals(mrsWatsonRendererSetSampleRate(r, 0.0), RETURN_CODE_INVALID_ARGUMENT);
+  assertIntEquals(mrsWatsonRendererSetNumChannels(r, 0), RETURN_CODE_INVALID_ARGUMENT);
+  assertIntEquals(mrsWatsonRendererSetBlocksize(r, 0), RETURN_CODE_INVALID_ARGUMENT);
+  assertDoubleEquals(r->context->audioSettings->sampleRate, DEFAULT_SAMPLE_RATE, TEST_FLOAT_TOLERANCE);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testSetSettingsAfterPrepare(void) {
+  MrsWatsonRenderer r = _newPassthruRenderer();
+  assertIntEquals(mrsWatsonRendererPrepare(r), RETURN_CODE_SUCCESS);
+  assertIntEquals(mrsWatsonRendererSetSampleRate(r, 48000.0), RETURN_CODE_INVALID_ARGUMENT);
+  assertIntEquals(mrsWatsonRendererAddPlugins(r, "mrs_passthru", NULL), RETURN_CODE_INVALID_ARGUMENT);
+  assertIntEquals(mrsWatsonRendererSetTempo(r, 100.0), RETURN_CODE_SUCCESS);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testAddInvalidPlugin(void) {
+  MrsWatsonRenderer r = newMrsWatsonRenderer();
+  assertIntEquals(mrsWatsonRendererAddPlugins(r, "mrs_invalid", NULL), RETURN_CODE_INVALID_PLUGIN_CHAIN);
+  assertIntEquals(mrsWatsonRendererAddPlugins(r, NULL, NULL), RETURN_CODE_INVALID_PLUGIN_CHAIN);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testPrepareWithoutPlugins(void) {
+  MrsWatsonRenderer r = newMrsWatsonRenderer();
+  assertIntEquals(mrsWatsonRendererPrepare(r), RETURN_CODE_INVALID_PLUGIN_CHAIN);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testProcessBeforePrepare(void) {
+  MrsWatsonRenderer r = _newPassthruRenderer();
+  float samples[4] = {0.1f, 0.2f, 0.3f, 0.4f};
+  assertIntEquals(mrsWatsonRendererProcessInterleaved(r, samples, samples, 2), RETURN_CODE_NOT_RUN);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testProcessInterleaved(void) {
+  MrsWatsonRenderer r = _newPassthruRenderer();
+  // Not a multiple of the blocksize, so the last block is shorter
+  const unsigned long numFrames = 150;
+  float* inSamples = (float*)malloc(sizeof(float) * numFrames * 2);
+  float* outSamples = (float*)malloc(sizeof(float) * numFrames * 2);
+  unsigned long i;
+
+  for(i = 0; i < numFrames * 2; i++) {
+    inSamples[i] = (float)i / (float)(numFrames * 2);
+  }
+  assertIntEquals(mrsWatsonRendererPrepare(r), RETURN_CODE_SUCCESS);
+  assertIntEquals(mrsWatsonRendererProcessInterleaved(r, inSamples, outSamples, numFrames), RETURN_CODE_SUCCESS);
+  for(i = 0; i < numFrames * 2; i++) {
+    assertDoubleEquals(outSamples[i], inSamples[i], TEST_FLOAT_TOLERANCE);
+  }
+  assertUnsignedLongEquals(r->context->audioClock->currentFrame, numFrames);
+
+  free(inSamples);
+  free(outSamples);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testProcessSampleBuffer(void) {
+  MrsWatsonRenderer r = _newPassthruRenderer();
+  SampleBuffer inBuffer = newSampleBuffer(2, 200);
+  SampleBuffer outBuffer = newSampleBuffer(2, 200);
+  unsigned long i;
+
+  for(i = 0; i < 200; i++) {
+    inBuffer->samples[0][i] = 0.5f;
+    inBuffer->samples[1][i] = -0.5f;
+  }
+  assertIntEquals(mrsWatsonRendererPrepare(r), RETURN_CODE_SUCCESS);
+  assertIntEquals(mrsWatsonRendererProcess(r, inBuffer, outBuffer), RETURN_CODE_SUCCESS);
+  for(i = 0; i < 200; i++) {
+    assertDoubleEquals(outBuffer->samples[0][i], 0.5f, TEST_FLOAT_TOLERANCE);
+    assertDoubleEquals(outBuffer->samples[1][i], -0.5f, TEST_FLOAT_TOLERANCE);
+  }
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testProcessSampleBufferWithWrongChannels(void) {
+  MrsWatsonRenderer r = _newPassthruRenderer();
+  SampleBuffer inBuffer = newSampleBuffer(1, 64);
+  SampleBuffer outBuffer = newSampleBuffer(1, 64);
+  assertIntEquals(mrsWatsonRendererPrepare(r), RETURN_CODE_SUCCESS);
+  assertIntEquals(mrsWatsonRendererProcess(r, inBuffer, outBuffer), RETURN_CODE_INVALID_ARGUMENT);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testResetRenderer(void) {
+  MrsWatsonRenderer r = _newPassthruRenderer();
+  float samples[8] = {0};
+  assertIntEquals(mrsWatsonRendererPrepare(r), RETURN_CODE_SUCCESS);
+  assertIntEquals(mrsWatsonRendererProcessInterleaved(r, samples, samples, 4), RETURN_CODE_SUCCESS);
+  assertUnsignedLongEquals(r->context->audioClock->currentFrame, 4ul);
+  mrsWatsonRendererReset(r);
+  assertUnsignedLongEquals(r->context->audioClock->currentFrame, 0ul);
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+static int _testRendererRestoresCallerContext(void) {
+  MrsWatsonRenderer r = newMrsWatsonRenderer();
+  assertIsNull(getMrsWatsonContext());
+  mrsWatsonRendererSetSampleRate(r, 48000.0);
+  assertIsNull(getMrsWatsonContext());
+  freeMrsWatsonRenderer(r);
+  return 0;
+}
+
+TestSuite addMrsWatsonRendererTests(void);
+TestSuite addMrsWatsonRendererTests(void) {
+  TestSuite testSuite = newTestSuite("MrsWatsonRenderer", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewMrsWatsonRenderer);
+  addTest(testSuite, "SetSettings", _testSetSettings);
+  addTest(testSuite, "SetInvalidSettings", _testSetInvalidSettings);
+  addTest(testSuite, "SetSettingsAfterPrepare", _testSetSettingsAfterPrepare);
+  addTest(testSuite, "AddInvalidPlugin", _testAddInvalidPlugin);
+  addTest(testSuite, "PrepareWithoutPlugins", _testPrepareWithoutPlugins);
+  addTest(testSuite, "ProcessBeforePrepare", _testProcessBeforePrepare);
+  addTest(testSuite, "ProcessInterleaved", _testProcessInterleaved);
+  addTest(testSuite, "ProcessSampleBuffer", _testProcessSampleBuffer);
+  addTest(testSuite, "ProcessSampleBufferWithWrongChannels", _testProcessSampleBufferWithWrongChannels);
+  addTest(testSuite, "ResetRenderer", _testResetRenderer);
+  addTest(testSuite, "RestoresCallerContext", _testRendererRestoresCallerContext);
+  return testSuite;
+}
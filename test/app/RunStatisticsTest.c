@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "unit/TestRunner.h"
+#include "app/RunStatistics.h"
+
+#if UNIX
+#define TEST_STATISTICS_FILE "/tmp/mrswatsontest-stats.json"
+#elif WINDOWS
+#define TEST_STATISTICS_FILE "C:\\Temp\\mrswatsontest-stats.json"
+#else
+#define TEST_STATISTICS_FILE "mrswatsontest-stats.json"
+#endif
+
+static int _testNewRunStatistics(void) {
+  RunStatistics r = newRunStatistics();
+  assertNotNull(r);
+  assertUnsignedLongEquals(r->numJobs, 0l);
+  assertUnsignedLongEquals((unsigned long)r->numFramesWritten, 0l);
+  assertIntEquals(r->phaseTimer->numTasks, kNumRunPhases);
+  freeRunStatistics(r);
+  return 0;
+}
+
+static int _testAddJob(void) {
+  RunStatistics r = newRunStatistics();
+  SampleSource input = newSampleSource(SAMPLE_SOURCE_TYPE_SILENCE, NULL);
+  SampleSource output = newSampleSource(SAMPLE_SOURCE_TYPE_SILENCE, NULL);
+
+  input->numSamplesProcessed = 200;
+  input->numBytesProcessed = 400;
+  output->numSamplesProcessed = 100;
+  output->numBytesProcessed = 300;
+  runStatisticsAddJob(r, input, output, 2);
+  runStatisticsAddJob(r, input, output, 2);
+  assertUnsignedLongEquals(r->numJobs, 2l);
+  assertUnsignedLongEquals((unsigned long)r->numFramesRead, 200l);
+  assertUnsignedLongEquals((unsigned long)r->numFramesWritten, 100l);
+  assertUnsignedLongEquals((unsigned long)r->numBytesRead, 800l);
+  assertUnsignedLongEquals((unsigned long)r->numBytesWritten, 600l);
+
+  freeSampleSource(input);
+  freeSampleSource(output);
+  freeRunStatistics(r);
+  return 0;
+}
+
+static int _testWriteReport(void) {
+  RunStatistics r = newRunStatistics();
+  CharString filename = newCharStringWithCString(TEST_STATISTICS_FILE);
+  char contents[2048];
+  size_t contentsLength;
+  FILE* fp;
+
+  r->sampleRate = 44100.0;
+  r->numJobs = 3;
+  r->numFramesWritten = 88200;
+  runStatisticsStartPhase(r, kRunPhaseProcessing);
+  assert(runStatisticsWriteReport(r, filename));
+
+  fp = fopen(TEST_STATISTICS_FILE, "r");
+  assertNotNull(fp);
+  contentsLength = fread(contents, 1, sizeof(contents) - 1, fp);
+  contents[contentsLength] = '\0';
+  fclose(fp);
+  assertNotNull(strstr(contents, "\"jobs\": 3,"));
+  assertNotNull(strstr(contents, "\"audioSeconds\": 2.000000,"));
+  assertNotNull(strstr(contents, "\"realtimeFactor\""));
+  assertNotNull(strstr(contents, "\"peakMemoryBytes\""));
+  assertIntEquals(r->phaseTimer->currentTask, -1);
+
+  unlink(TEST_STATISTICS_FILE);
+  freeCharString(filename);
+  freeRunStatistics(r);
+  return 0;
+}
+
+static int _testWriteReportInvalidFile(void) {
+  RunStatistics r = newRunStatistics();
+  CharString filename = newCharStringWithCString("/invalid/path/stats.json");
+  assertFalse(runStatisticsWriteReport(r, filename));
+  freeCharString(filename);
+  freeRunStatistics(r);
+  return 0;
+}
+
+TestSuite addRunStatisticsTests(void);
+TestSuite addRunStatisticsTests(void) {
+  TestSuite testSuite = newTestSuite("RunStatistics", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewRunStatistics);
+  addTest(testSuite, "AddJob", _testAddJob);
+  addTest(testSuite, "WriteReport", _testWriteReport);
+  addTest(testSuite, "WriteReportInvalidFile", _testWriteReportInvalidFile);
+  return testSuite;
+}
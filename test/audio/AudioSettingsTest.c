@@ -16,6 +16,7 @@ static int _testInitAudioSettings(void) {
   assertDoubleEquals(getTempo(), DEFAULT_TEMPO, TEST_FLOAT_TOLERANCE);
   assertIntEquals(getTimeSignatureBeatsPerMeasure(), DEFAULT_TIMESIG_BEATS_PER_MEASURE);
   assertIntEquals(getTimeSignatureNoteValue(), DEFAULT_TIMESIG_NOTE_VALUE);
+  assertIntEquals(getSampleFormat(), DEFAULT_SAMPLE_FORMAT);
   return 0;
 }
 
@@ -129,6 +130,35 @@ static int _testSetTimeSignatureWithMidiBytesNull(void) {
   return 0;
 }
 
+static int _testSetSampleFormat(void) {
+  setSampleFormat(kSampleFormatFloat32);
+  assertIntEquals(getSampleFormat(), kSampleFormatFloat32);
+  return 0;
+}
+
+static int _testSetInvalidSampleFormat(void) {
+  setSampleFormat(kSampleFormatInt24);
+  assertIntEquals(getSampleFormat(), kSampleFormatInt24);
+  setSampleFormat(kNumSampleFormats);
+  assertIntEquals(getSampleFormat(), kSampleFormatInt24);
+  return 0;
+}
+
+static int _testSetThreadAudioSettings(void) {
+  AudioSettings threadSettings;
+  setSampleRate(22050.0);
+  threadSettings = newAudioSettingsCopy();
+  setThreadAudioSettings(threadSettings);
+  assert(getAudioSettings() == threadSettings);
+  assertDoubleEquals(getSampleRate(), 22050.0, TEST_FLOAT_TOLERANCE);
+  setSampleRate(48000.0);
+  setThreadAudioSettings(NULL);
+  assertDoubleEquals(threadSettings->sampleRate, 48000.0, TEST_FLOAT_TOLERANCE);
+  assertDoubleEquals(getSampleRate(), 22050.0, TEST_FLOAT_TOLERANCE);
+  freeAudioSettingsCopy(threadSettings);
+  return 0;
+}
+
 TestSuite addAudioSettingsTests(void);
 TestSuite addAudioSettingsTests(void) {
   TestSuite testSuite = newTestSuite("AudioSettings", _audioSettingsSetup, _audioSettingsTeardown);
@@ -147,5 +177,8 @@ TestSuite addAudioSettingsTests(void) {
   addTest(testSuite, "SetTimeSignatureNoteValue", _testSetTimeSigNoteValue);
   addTest(testSuite, "SetTimeSignatureWithMidiBytes", _testSetTimeSignatureWithMidiBytes);
   addTest(testSuite, "SetTimeSignatureWithMidiBytesNull", _testSetTimeSignatureWithMidiBytesNull);
+  addTest(testSuite, "SetSampleFormat", _testSetSampleFormat);
+  addTest(testSuite, "SetInvalidSampleFormat", _testSetInvalidSampleFormat);
+  addTest(testSuite, "SetThreadAudioSettings", _testSetThreadAudioSettings);
   return testSuite;
 }
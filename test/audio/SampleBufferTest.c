@@ -161,6 +161,98 @@ static int _testResizeSampleBufferSameSize(void) {
   return 0;  
 }
 
+static int _testResizeSampleBufferExpandShortBlock(void) {
+  SampleBuffer s = newSampleBuffer(1, 4);
+  s->samples[0][3] = 1.0;
+  s->blocksize = 2;
+  assert(sampleBufferResize(s, 2, true));
+  s->blocksize = 4;
+  assertDoubleEquals(s->samples[1][3], 1.0, TEST_FLOAT_TOLERANCE);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testResizeSampleBufferWithinCapacity(void) {
+  SampleBuffer s = newSampleBuffer(2, 4);
+  Samples channel = s->samples[1];
+  s->samples[1][0] = 1.0;
+  assert(sampleBufferResize(s, 1, false));
+  assert(sampleBufferResize(s, 2, false));
+  assertUnsignedLongEquals(s->maxNumChannels, 2ul);
+  assert(s->samples[1] == channel);
+  assertDoubleEquals(s->samples[1][0], 0.0, TEST_FLOAT_TOLERANCE);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testSampleBufferChannelsAreAligned(void) {
+  SampleBuffer s = newSampleBuffer(3, 100);
+  unsigned int i;
+  for(i = 0; i < s->numChannels; i++) {
+    assertUnsignedLongEquals((unsigned long)((size_t)s->samples[i] % SAMPLE_BUFFER_ALIGNMENT), 0ul);
+  }
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testReserveSampleBuffer(void) {
+  SampleBuffer s = newSampleBuffer(1, 4);
+  s->samples[0][3] = 1.0;
+  assert(sampleBufferReserve(s, 4, 8));
+  assertIntEquals(s->numChannels, 1);
+  assertUnsignedLongEquals(s->blocksize, 4ul);
+  assertUnsignedLongEquals(s->maxNumChannels, 4ul);
+  assertUnsignedLongEquals(s->maxBlocksize, 8ul);
+  assertDoubleEquals(s->samples[0][3], 1.0, TEST_FLOAT_TOLERANCE);
+  assertUnsignedLongEquals((unsigned long)((size_t)s->samples[3] % SAMPLE_BUFFER_ALIGNMENT), 0ul);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testSampleBufferView(void) {
+  SampleBuffer s = newSampleBuffer(2, 8);
+  SampleBuffer v;
+  unsigned long i;
+  for(i = 0; i < s->blocksize; i++) {
+    s->samples[0][i] = (Sample)i;
+    s->samples[1][i] = (Sample)i;
+  }
+
+  v = newSampleBufferView(s);
+  assertIntEquals(v->numChannels, 2);
+  assertUnsignedLongEquals(v->blocksize, 8ul);
+  assert(sampleBufferSetViewRange(v, s, 4, 4));
+  assertUnsignedLongEquals(v->blocksize, 4ul);
+  assertDoubleEquals(v->samples[1][0], 4.0, TEST_FLOAT_TOLERANCE);
+  v->samples[0][0] = 9.0;
+  assertDoubleEquals(s->samples[0][4], 9.0, TEST_FLOAT_TOLERANCE);
+
+  freeSampleBuffer(v);
+  assertDoubleEquals(s->samples[0][7], 7.0, TEST_FLOAT_TOLERANCE);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testSampleBufferViewInvalidRange(void) {
+  SampleBuffer s = newSampleBuffer(2, 8);
+  SampleBuffer v = newSampleBufferView(s);
+  assertFalse(sampleBufferSetViewRange(v, s, 4, 5));
+  assertFalse(sampleBufferSetViewRange(s, s, 0, 4));
+  freeSampleBuffer(v);
+  freeSampleBuffer(s);
+  return 0;
+}
+
+static int _testSampleBufferViewCannotExpand(void) {
+  SampleBuffer s = newSampleBuffer(1, 8);
+  SampleBuffer v = newSampleBufferView(s);
+  assertFalse(sampleBufferResize(v, 2, false));
+  assertFalse(sampleBufferReserve(v, 1, 16));
+  freeSampleBuffer(v);
+  freeSampleBuffer(s);
+  return 0;
+}
+
 static int _testFreeNullSampleBuffer(void) {
   freeSampleBuffer(NULL);
   return 0;
@@ -183,6 +275,13 @@ TestSuite addSampleBufferTests(void) {
   addTest(testSuite, "ResizeSampleBufferShrink", _testResizeSampleBufferShrink);
   addTest(testSuite, "ResizeSampleBufferInvalidSize", _testResizeSampleBufferInvalidSize);
   addTest(testSuite, "ResizeSampleBufferSameSize", _testResizeSampleBufferSameSize);
+  addTest(testSuite, "ResizeSampleBufferExpandShortBlock", _testResizeSampleBufferExpandShortBlock);
+  addTest(testSuite, "ResizeSampleBufferWithinCapacity", _testResizeSampleBufferWithinCapacity);
+  addTest(testSuite, "SampleBufferChannelsAreAligned", _testSampleBufferChannelsAreAligned);
+  addTest(testSuite, "ReserveSampleBuffer", _testReserveSampleBuffer);
+  addTest(testSuite, "SampleBufferView", _testSampleBufferView);
+  addTest(testSuite, "SampleBufferViewInvalidRange", _testSampleBufferViewInvalidRange);
+  addTest(testSuite, "SampleBufferViewCannotExpand", _testSampleBufferViewCannotExpand);
   addTest(testSuite, "FreeNullSampleBuffer", _testFreeNullSampleBuffer);
   return testSuite;
 }
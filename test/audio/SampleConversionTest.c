@@ -0,0 +1,315 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/SampleConversion.h"
+#include "unit/TestRunner.h"
+
+// Odd lengths make sure that the scalar code handles the frames after the last full vector
+static const unsigned long kTestNumFrames = 77;
+static const unsigned int kTestMaxChannels = 3;
+
+static unsigned int _testRandomSeed = 1;
+
+static int _nextTestRandom(void) {
+  // Deterministic LCG, so that failures can be reproduced
+  _testRandomSeed = _testRandomSeed * 1103515245 + 12345;
+  return (int)((_testRandomSeed >> 8) & 0xffff);
+}
+
+static short* _newTestPcmData(const unsigned int numChannels) {
+  short* pcmData = (short*)malloc(sizeof(short) * numChannels * kTestNumFrames);
+  unsigned long i;
+  for(i = 0; i < numChannels * kTestNumFrames; i++) {
+    pcmData[i] = (short)(_nextTestRandom() - 32768);
+  }
+  // Always include the extreme values
+  pcmData[0] = -32768;
+  pcmData[1] = 32767;
+  return pcmData;
+}
+
+static Samples* _newTestSamples(const unsigned int numChannels, boolByte randomize) {
+  Samples* samples = (Samples*)malloc(sizeof(Samples) * numChannels);
+  unsigned int i;
+  unsigned long j;
+
+  for(i = 0; i < numChannels; i++) {
+    samples[i] = (Samples)malloc(sizeof(Sample) * kTestNumFrames);
+    for(j = 0; j < kTestNumFrames; j++) {
+      // Roughly -1.5 to 1.5, so that clipping is exercised as well
+      samples[i][j] = randomize ? ((Sample)_nextTestRandom() - 32768.0f) / 21845.0f : 0.0f;
+    }
+  }
+  if(randomize) {
+    samples[0][0] = 1.0f;
+    samples[0][1] = -1.0f;
+    samples[numChannels - 1][2] = 100.0f;
+    samples[numChannels - 1][3] = -100.0f;
+  }
+
+  return samples;
+}
+
+static void _freeTestSamples(Samples* samples, const unsigned int numChannels) {
+  unsigned int i;
+  for(i = 0; i < numChannels; i++) {
+    free(samples[i]);
+  }
+  free(samples);
+}
+
+static SampleConversionKernel _originalKernel;
+
+static void _sampleConversionSetup(void) {
+  _originalKernel = sampleConversionGetKernel();
+}
+
+static void _sampleConversionTeardown(void) {
+  sampleConversionSetKernel(_originalKernel);
+}
+
+static int _testScalarKernelIsSupported(void) {
+  assert(sampleConversionIsKernelSupported(kSampleConversionKernelScalar));
+  assertFalse(sampleConversionIsKernelSupported(kNumSampleConversionKernels));
+  return 0;
+}
+
+static int _testSetUnsupportedKernel(void) {
+  SampleConversionKernel kernel = sampleConversionGetKernel();
+  assertFalse(sampleConversionSetKernel(kNumSampleConversionKernels));
+  assertIntEquals((int)sampleConversionGetKernel(), (int)kernel);
+  return 0;
+}
+
+static int _testConvertPcm16ToSamples(void) {
+  short pcmData[] = {32767, -32767, 0, 16384};
+  Samples* samples = _newTestSamples(2, false);
+
+  assert(sampleConversionSetKernel(kSampleConversionKernelScalar));
+  convertPcm16ToSamples(pcmData, samples, 2, 2, false);
+  assertDoubleEquals(samples[0][0], 1.0, TEST_FLOAT_TOLERANCE);
+  assertDoubleEquals(samples[1][0], -1.0, TEST_FLOAT_TOLERANCE);
+  assertDoubleEquals(samples[0][1], 0.0, TEST_FLOAT_TOLERANCE);
+  assertDoubleEquals(samples[1][1], 0.5, TEST_FLOAT_TOLERANCE);
+
+  _freeTestSamples(samples, 2);
+  return 0;
+}
+
+static int _testConvertSamplesToPcm16Clips(void) {
+  short pcmData[4];
+  Samples* samples = _newTestSamples(1, false);
+  samples[0][0] = 2.0f;
+  samples[0][1] = -2.0f;
+  samples[0][2] = 1.0f;
+  samples[0][3] = -1.0f;
+
+  assert(sampleConversionSetKernel(kSampleConversionKernelScalar));
+  convertSamplesToPcm16((const Samples*)samples, pcmData, 1, 4, false);
+  assertIntEquals(pcmData[0], 32767);
+  assertIntEquals(pcmData[1], -32768);
+  assertIntEquals(pcmData[2], 32767);
+  assertIntEquals(pcmData[3], -32767);
+
+  _freeTestSamples(samples, 1);
+  return 0;
+}
+
+static int _testConvertPcm16ToSamplesFlipEndian(void) {
+  short pcmData[] = {0x0080, 0x0180};
+  Samples* samples = _newTestSamples(1, false);
+
+  assert(sampleConversionSetKernel(kSampleConversionKernelScalar));
+  convertPcm16ToSamples(pcmData, samples, 1, 2, true);
+  assertDoubleEquals(samples[0][0], (double)(short)0x8000 / 32767.0, 0.00001);
+  assertDoubleEquals(samples[0][1], (double)(short)0x8001 / 32767.0, 0.00001);
+
+  _freeTestSamples(samples, 1);
+  return 0;
+}
+
+static int _testKernelsMatchScalarPcm16ToSamples(void) {
+  SampleConversionKernel kernel;
+  unsigned int numChannels;
+  unsigned int i;
+  int flipEndian;
+  short* pcmData;
+  Samples* expectedValues;
+  Samples* actualValues;
+
+  for(numChannels = 1; numChannels <= kTestMaxChannels; numChannels++) {
+    pcmData = _newTestPcmData(numChannels);
+    expectedValues = _newTestSamples(numChannels, false);
+    actualValues = _newTestSamples(numChannels, false);
+
+    for(flipEndian = 0; flipEndian <= 1; flipEndian++) {
+      assert(sampleConversionSetKernel(kSampleConversionKernelScalar));
+      convertPcm16ToSamples(pcmData, expectedValues, numChannels, kTestNumFrames, (boolByte)flipEndian);
+
+      for(kernel = kSampleConversionKernelScalar; kernel < kNumSampleConversionKernels; kernel++) {
+        if(!sampleConversionIsKernelSupported(kernel)) {
+          continue;
+        }
+        assert(sampleConversionSetKernel(kernel));
+        convertPcm16ToSamples(pcmData, actualValues, numChannels, kTestNumFrames, (boolByte)flipEndian);
+        for(i = 0; i < numChannels; i++) {
+          assertIntEquals(memcmp(expectedValues[i], actualValues[i], sizeof(Sample) * kTestNumFrames), 0);
+        }
+      }
+    }
+
+    free(pcmData);
+    _freeTestSamples(expectedValues, numChannels);
+    _freeTestSamples(actualValues, numChannels);
+  }
+
+  return 0;
+}
+
+static int _testKernelsMatchScalarSamplesToPcm16(void) {
+  SampleConversionKernel kernel;
+  unsigned int numChannels;
+  int flipEndian;
+  Samples* samples;
+  short* expectedValues;
+  short* actualValues;
+
+  for(numChannels = 1; numChannels <= kTestMaxChannels; numChannels++) {
+    samples = _newTestSamples(numChannels, true);
+    expectedValues = (short*)malloc(sizeof(short) * numChannels * kTestNumFrames);
+    actualValues = (short*)malloc(sizeof(short) * numChannels * kTestNumFrames);
+
+    for(flipEndian = 0; flipEndian <= 1; flipEndian++) {
+      assert(sampleConversionSetKernel(kSampleConversionKernelScalar));
+      convertSamplesToPcm16((const Samples*)samples, expectedValues, numChannels, kTestNumFrames, (boolByte)flipEndian);
+
+      for(kernel = kSampleConversionKernelScalar; kernel < kNumSampleConversionKernels; kernel++) {
+        if(!sampleConversionIsKernelSupported(kernel)) {
+          continue;
+        }
+        assert(sampleConversionSetKernel(kernel));
+        memset(actualValues, 0, sizeof(short) * numChannels * kTestNumFrames);
+        convertSamplesToPcm16((const Samples*)samples, actualValues, numChannels, kTestNumFrames, (boolByte)flipEndian);
+        assertIntEquals(memcmp(expectedValues, actualValues, sizeof(short) * numChannels * kTestNumFrames), 0);
+      }
+    }
+
+    _freeTestSamples(samples, numChannels);
+    free(expectedValues);
+    free(actualValues);
+  }
+
+  return 0;
+}
+
+static int _testSampleFormatFromString(void) {
+  assertIntEquals(sampleFormatFromString("16"), kSampleFormatInt16);
+  assertIntEquals(sampleFormatFromString("24"), kSampleFormatInt24);
+  assertIntEquals(sampleFormatFromString("32"), kSampleFormatInt32);
+  assertIntEquals(sampleFormatFromString("32f"), kSampleFormatFloat32);
+  assertIntEquals(sampleFormatFromString("64F"), kSampleFormatFloat64);
+  return 0;
+}
+
+static int _testSampleFormatFromInvalidString(void) {
+  assertIntEquals(sampleFormatFromString(NULL), kNumSampleFormats);
+  assertIntEquals(sampleFormatFromString(""), kNumSampleFormats);
+  assertIntEquals(sampleFormatFromString("8"), kNumSampleFormats);
+  assertIntEquals(sampleFormatFromString("16f"), kNumSampleFormats);
+  assertIntEquals(sampleFormatFromString("64"), kNumSampleFormats);
+  assertIntEquals(sampleFormatFromString("32fx"), kNumSampleFormats);
+  assertIntEquals(sampleFormatFromString("float"), kNumSampleFormats);
+  return 0;
+}
+
+static int _testConvertSamplesRoundTripAllFormats(void) {
+  SampleFormat format;
+  Samples* samples = _newTestSamples(2, false);
+  Samples* actualSamples = _newTestSamples(2, false);
+  byte pcmData[4 * 2 * 8];
+  int flipEndian;
+
+  samples[0][0] = 0.5f;
+  samples[1][0] = -0.25f;
+  samples[0][1] = 1.0f;
+  samples[1][1] = -1.0f;
+  samples[0][2] = 0.0f;
+  samples[1][2] = 0.123456f;
+  samples[0][3] = -0.75f;
+  samples[1][3] = 0.999f;
+
+  for(format = kSampleFormatInt16; format < kNumSampleFormats; format++) {
+    for(flipEndian = 0; flipEndian <= 1; flipEndian++) {
+      convertSamplesToPcmData((const Samples*)samples, pcmData, format, 2, 4, (boolByte)flipEndian);
+      convertPcmDataToSamples(pcmData, format, actualSamples, 2, 4, (boolByte)flipEndian);
+      if(sampleFormatIsFloat(format)) {
+        assertIntEquals(memcmp(samples[0], actualSamples[0], sizeof(Sample) * 4), 0);
+        assertIntEquals(memcmp(samples[1], actualSamples[1], sizeof(Sample) * 4), 0);
+      }
+      else {
+        assertDoubleEquals(actualSamples[0][0], 0.5, 0.0001);
+        assertDoubleEquals(actualSamples[1][0], -0.25, 0.0001);
+        assertDoubleEquals(actualSamples[0][1], 1.0, 0.0001);
+        assertDoubleEquals(actualSamples[1][1], -1.0, 0.0001);
+        assertDoubleEquals(actualSamples[1][2], 0.123456, 0.0001);
+        assertDoubleEquals(actualSamples[0][3], -0.75, 0.0001);
+        assertDoubleEquals(actualSamples[1][3], 0.999, 0.0001);
+      }
+    }
+  }
+
+  _freeTestSamples(samples, 2);
+  _freeTestSamples(actualSamples, 2);
+  return 0;
+}
+
+static int _testConvertSamplesToPcm24(void) {
+  byte pcmData[6];
+  Samples* samples = _newTestSamples(1, false);
+  samples[0][0] = 1.0f;
+  samples[0][1] = -2.0f;
+
+  convertSamplesToPcmData((const Samples*)samples, pcmData, kSampleFormatInt24, 1, 2, false);
+  // Always little-endian, independent of the host
+  assertIntEquals(pcmData[0], 0xff);
+  assertIntEquals(pcmData[1], 0xff);
+  assertIntEquals(pcmData[2], 0x7f);
+  assertIntEquals(pcmData[3], 0x00);
+  assertIntEquals(pcmData[4], 0x00);
+  assertIntEquals(pcmData[5], 0x80);
+
+  _freeTestSamples(samples, 1);
+  return 0;
+}
+
+static int _testConvertSamplesToFloatIsNotClipped(void) {
+  float pcmData[2];
+  Samples* samples = _newTestSamples(2, false);
+  samples[0][0] = 4.0f;
+  samples[1][0] = -3.0f;
+
+  convertSamplesToPcmData((const Samples*)samples, pcmData, kSampleFormatFloat32, 2, 1, false);
+  assertDoubleEquals(pcmData[0], 4.0, 0.0);
+  assertDoubleEquals(pcmData[1], -3.0, 0.0);
+
+  _freeTestSamples(samples, 2);
+  return 0;
+}
+
+TestSuite addSampleConversionTests(void);
+TestSuite addSampleConversionTests(void) {
+  TestSuite testSuite = newTestSuite("SampleConversion", _sampleConversionSetup, _sampleConversionTeardown);
+  addTest(testSuite, "ScalarKernelIsSupported", _testScalarKernelIsSupported);
+  addTest(testSuite, "SetUnsupportedKernel", _testSetUnsupportedKernel);
+  addTest(testSuite, "ConvertPcm16ToSamples", _testConvertPcm16ToSamples);
+  addTest(testSuite, "ConvertSamplesToPcm16Clips", _testConvertSamplesToPcm16Clips);
+  addTest(testSuite, "ConvertPcm16ToSamplesFlipEndian", _testConvertPcm16ToSamplesFlipEndian);
+  addTest(testSuite, "KernelsMatchScalarPcm16ToSamples", _testKernelsMatchScalarPcm16ToSamples);
+  addTest(testSuite, "KernelsMatchScalarSamplesToPcm16", _testKernelsMatchScalarSamplesToPcm16);
+  addTest(testSuite, "SampleFormatFromString", _testSampleFormatFromString);
+  addTest(testSuite, "SampleFormatFromInvalidString", _testSampleFormatFromInvalidString);
+  addTest(testSuite, "ConvertSamplesRoundTripAllFormats", _testConvertSamplesRoundTripAllFormats);
+  addTest(testSuite, "ConvertSamplesToPcm24", _testConvertSamplesToPcm24);
+  addTest(testSuite, "ConvertSamplesToFloatIsNotClipped", _testConvertSamplesToFloatIsNotClipped);
+  return testSuite;
+}
@@ -0,0 +1,160 @@
+#include <string.h>
+
+#include "base/ByteRingBuffer.h"
+#include "base/Thread.h"
+#include "unit/TestRunner.h"
+
+#define NUM_THREADED_BYTES 100000
+
+static int _testNewByteRingBuffer(void) {
+  ByteRingBuffer r = newByteRingBuffer(16);
+  assertNotNull(r);
+  assertUnsignedLongEquals(r->capacity, 16l);
+  assertUnsignedLongEquals(byteRingBufferGetNumReadable(r), 0l);
+  assertUnsignedLongEquals(byteRingBufferGetNumWritable(r), 16l);
+  assertFalse(byteRingBufferIsClosed(r));
+  freeByteRingBuffer(r);
+  return 0;
+}
+
+static int _testNewByteRingBufferInvalidCapacity(void) {
+  ByteRingBuffer r = newByteRingBuffer(0);
+  assertIsNull(r);
+  freeByteRingBuffer(r);
+  return 0;
+}
+
+static int _testNewByteRingBufferRoundsCapacity(void) {
+  ByteRingBuffer r = newByteRingBuffer(9);
+  assertUnsignedLongEquals(r->capacity, 16l);
+  freeByteRingBuffer(r);
+  return 0;
+}
+
+static int _testReadEmptyByteRingBuffer(void) {
+  ByteRingBuffer r = newByteRingBuffer(4);
+  byte data[4];
+  assertUnsignedLongEquals((unsigned long)byteRingBufferRead(r, data, 4), 0l);
+  freeByteRingBuffer(r);
+  return 0;
+}
+
+static int _testWriteAndReadInOrder(void) {
+  ByteRingBuffer r = newByteRingBuffer(8);
+  const byte input[6] = {1, 2, 3, 4, 5, 6};
+  byte output[6];
+
+  assertUnsignedLongEquals((unsigned long)byteRingBufferWrite(r, input, 6), 6l);
+  assertUnsignedLongEquals(byteRingBufferGetNumReadable(r), 6l);
+  assertUnsignedLongEquals((unsigned long)byteRingBufferRead(r, output, 4), 4l);
+  assertUnsignedLongEquals((unsigned long)byteRingBufferRead(r, output + 4, 4), 2l);
+  assertIntEquals(memcmp(input, output, 6), 0);
+
+  freeByteRingBuffer(r);
+  return 0;
+}
+
+static int _testWriteFullByteRingBuffer(void) {
+  ByteRingBuffer r = newByteRingBuffer(4);
+  const byte input[6] = {1, 2, 3, 4, 5, 6};
+  byte output[4];
+
+  assertUnsignedLongEquals((unsigned long)byteRingBufferWrite(r, input, 6), 4l);
+  assertUnsignedLongEquals(byteRingBufferGetNumWritable(r), 0l);
+  assertUnsignedLongEquals((unsigned long)byteRingBufferWrite(r, input + 4, 2), 0l);
+  assertUnsignedLongEquals((unsigned long)byteRingBufferRead(r, output, 4), 4l);
+  assertIntEquals(memcmp(input, output, 4), 0);
+
+  freeByteRingBuffer(r);
+  return 0;
+}
+
+static int _testWriteAndReadWrapsAround(void) {
+  ByteRingBuffer r = newByteRingBuffer(4);
+  const byte input[5] = {1, 2, 3, 4, 5};
+  byte output[4];
+
+  assertUnsignedLongEquals((unsigned long)byteRingBufferWrite(r, input, 3), 3l);
+  assertUnsignedLongEquals((unsigned long)byteRingBufferRead(r, output, 2), 2l);
+  // This write starts at the end of the buffer and continues at the beginning
+  assertUnsignedLongEquals((unsigned long)byteRingBufferWrite(r, input + 3, 2), 2l);
+  assertUnsignedLongEquals((unsigned long)byteRingBufferRead(r, output, 4), 3l);
+  assertIntEquals(output[0], 3);
+  assertIntEquals(output[1], 4);
+  assertIntEquals(output[2], 5);
+
+  freeByteRingBuffer(r);
+  return 0;
+}
+
+static int _testCloseByteRingBuffer(void) {
+  ByteRingBuffer r = newByteRingBuffer(8);
+  const byte input[3] = {1, 2, 3};
+  byte output[8];
+
+  assertUnsignedLongEquals((unsigned long)byteRingBufferWrite(r, input, 3), 3l);
+  byteRingBufferClose(r);
+  assert(byteRingBufferIsClosed(r));
+  assertUnsignedLongEquals((unsigned long)byteRingBufferWrite(r, input, 3), 0l);
+  // Data written before closing can still be read, and reading does not block
+  assertUnsignedLongEquals((unsigned long)byteRingBufferReadBlocking(r, output, 8), 3l);
+  assertUnsignedLongEquals((unsigned long)byteRingBufferReadAvailable(r, output, 8), 0l);
+  assertUnsignedLongEquals(byteRingBufferWaitForReadable(r, 8), 0l);
+
+  freeByteRingBuffer(r);
+  return 0;
+}
+
+static void* _producerThread(void* ringBufferPtr) {
+  ByteRingBuffer r = (ByteRingBuffer)ringBufferPtr;
+  byte chunk[7];
+  unsigned long i;
+  unsigned long j;
+
+  for(i = 0; i < NUM_THREADED_BYTES; i += 7) {
+    for(j = 0; j < 7; j++) {
+      chunk[j] = (byte)(i + j);
+    }
+    byteRingBufferWriteBlocking(r, chunk, NUM_THREADED_BYTES - i < 7 ? NUM_THREADED_BYTES - i : 7);
+  }
+  byteRingBufferClose(r);
+  return NULL;
+}
+
+static int _testBlockingWriteAndReadWithThreads(void) {
+  ByteRingBuffer r = newByteRingBuffer(16);
+  Thread t = newThread(_producerThread, r);
+  byte chunk[5];
+  unsigned long numRead = 0;
+  size_t numReadInChunk;
+  size_t i;
+
+  assert(threadStart(t));
+  while((numReadInChunk = byteRingBufferReadBlocking(r, chunk, 5)) > 0) {
+    for(i = 0; i < numReadInChunk; i++) {
+      assertIntEquals(chunk[i], (byte)(numRead + i));
+    }
+    numRead += (unsigned long)numReadInChunk;
+  }
+  assert(threadJoin(t));
+  assertUnsignedLongEquals(numRead, (unsigned long)NUM_THREADED_BYTES);
+
+  freeThread(t);
+  freeByteRingBuffer(r);
+  return 0;
+}
+
+TestSuite addByteRingBufferTests(void);
+TestSuite addByteRingBufferTests(void) {
+  TestSuite testSuite = newTestSuite("ByteRingBuffer", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewByteRingBuffer);
+  addTest(testSuite, "NewObjectInvalidCapacity", _testNewByteRingBufferInvalidCapacity);
+  addTest(testSuite, "NewObjectRoundsCapacity", _testNewByteRingBufferRoundsCapacity);
+  addTest(testSuite, "ReadEmptyByteRingBuffer", _testReadEmptyByteRingBuffer);
+  addTest(testSuite, "WriteAndReadInOrder", _testWriteAndReadInOrder);
+  addTest(testSuite, "WriteFullByteRingBuffer", _testWriteFullByteRingBuffer);
+  addTest(testSuite, "WriteAndReadWrapsAround", _testWriteAndReadWrapsAround);
+  addTest(testSuite, "CloseByteRingBuffer", _testCloseByteRingBuffer);
+  addTest(testSuite, "BlockingWriteAndReadWithThreads", _testBlockingWriteAndReadWithThreads);
+  return testSuite;
+}
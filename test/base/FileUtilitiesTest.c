@@ -37,6 +37,28 @@ static int _testInvalidFileExists(void) {
   return 0;
 }
 
+static int _testGetFileInfo(void) {
+  unsigned long long fileSize = 0;
+  long long modificationTime = 0;
+  FILE *fp = fopen(TEST_FILENAME, "w");
+  assert(fp != NULL);
+  fputs("1234", fp);
+  fclose(fp);
+  assert(getFileInfo(TEST_FILENAME, &fileSize, &modificationTime));
+  assertUnsignedLongEquals((unsigned long)fileSize, 4l);
+  assert(modificationTime > 0);
+  unlink(TEST_FILENAME);
+  return 0;
+}
+
+static int _testGetInvalidFileInfo(void) {
+  unsigned long long fileSize = 0;
+  long long modificationTime = 0;
+  assertFalse(getFileInfo("invalid", &fileSize, &modificationTime));
+  assertFalse(getFileInfo(NULL, &fileSize, &modificationTime));
+  return 0;
+}
+
 static CharString _fileUtilitiesMakeTempDir(void) {
   CharString tempDirName = newCharString();
 #if UNIX
@@ -343,6 +365,8 @@ TestSuite addFileUtilitiesTests(void) {
   addTest(testSuite, "FileExists", _testFileExists);
   addTest(testSuite, "NullFileExists", _testNullFileExists);
   addTest(testSuite, "InvalidFileExists", _testInvalidFileExists);
+  addTest(testSuite, "GetFileInfo", _testGetFileInfo);
+  addTest(testSuite, "GetInvalidFileInfo", _testGetInvalidFileInfo);
   addTest(testSuite, "CopyFileToDirectory", _testCopyFileToDirectory);
   addTest(testSuite, "CopyInvalidFileToDirectory", _testCopyInvalidFileToDirectory);
   addTest(testSuite, "CopyFileToInvalidDirectory", _testCopyFileToInvalidDirectory);
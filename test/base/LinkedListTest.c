@@ -95,54 +95,79 @@ static int _testNumItemsInNullList(void) {
   return 0;
 }
 
-static int _testLinkedListToArray(void) {
+static int _testClearList(void) {
   LinkedList l = newLinkedList();
-  CharString* arr;
-  CharString c;
+  CharString c = newCharStringWithCString(TEST_ITEM_STRING);
 
-  linkedListAppend(l, newCharStringWithCString("one"));
-  linkedListAppend(l, newCharStringWithCString("two"));
-
-  arr = (CharString*)linkedListToArray(l);
-  assertNotNull(arr);
-  c = (CharString)arr[0];
-  assertCharStringEquals(c, "one");
-  c = (CharString)arr[1];
-  assertCharStringEquals(c, "two");
-  assertIsNull(arr[2]);
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  linkedListClear(l);
+  assertIntEquals(linkedListLength(l), 0);
+  assertIsNull(l->item);
+  assertIsNull(linkedListToArray(l));
 
-  free(arr);
-  freeLinkedListAndItems(l, (LinkedListFreeItemFunc)freeCharString);
+  freeLinkedList(l);
+  freeCharString(c);
   return 0;
 }
 
-static int _testLinkedListToArrayWithNull(void) {
-  CharString** arr;
-  arr = (CharString**)linkedListToArray(NULL);
-  assertIsNull(arr);
+static int _testAppendItemAfterClear(void) {
+  LinkedListIterator i;
+  LinkedList l = newLinkedList();
+  CharString c = newCharStringWithCString(TEST_ITEM_STRING);
+  CharString c2 = newCharStringWithCString(OTHER_TEST_ITEM_STRING);
+
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  i = l->nextItem;
+  linkedListClear(l);
+  linkedListAppend(l, c2);
+  linkedListAppend(l, c2);
+  assertIntEquals(linkedListLength(l), 2);
+  // Nodes are reused rather than allocated again
+  assert(l->nextItem == i);
+  assertCharStringEquals(((CharString)i->item), OTHER_TEST_ITEM_STRING);
+  assertIsNull(((LinkedListIterator)i->nextItem)->item);
+
+  freeLinkedList(l);
+  freeCharString(c);
+  freeCharString(c2);
   return 0;
 }
 
-static int _testLinkedListWithEmptyList(void) {
-  CharString** arr;
+static int _testFreeClearedListAndItems(void) {
   LinkedList l = newLinkedList();
-  arr = (CharString**)linkedListToArray(l);
-  assertIsNull(arr);
+  CharString c = newCharStringWithCString(TEST_ITEM_STRING);
+
+  linkedListAppend(l, c);
+  linkedListAppend(l, c);
+  linkedListClear(l);
+  linkedListAppend(l, newCharStringWithCString(OTHER_TEST_ITEM_STRING));
+  // Only the item which is still in the list should be freed
+  freeLinkedListAndItems(l, (LinkedListFreeItemFunc)freeCharString);
+  freeCharString(c);
   return 0;
 }
 
 static int _testLinkedListToArray(void) {
   LinkedList l = newLinkedList();
   CharString* arr;
+  CharString c;
+
+  linkedListAppend(l, newCharStringWithCString("one"));
+  linkedListAppend(l, newCharStringWithCString("two"));
 
-  appendItemToList(l, newCharStringWithCString("one"));
-  appendItemToList(l, newCharStringWithCString("two"));
   arr = (CharString*)linkedListToArray(l);
   assertNotNull(arr);
-  assertCharStringEquals((CharString)arr[0], "one");
-  assertCharStringEquals((CharString)arr[1], "two");
+  c = (CharString)arr[0];
+  assertCharStringEquals(c, "one");
+  c = (CharString)arr[1];
+  assertCharStringEquals(c, "two");
   assertIsNull(arr[2]);
 
+  free(arr);
+  freeLinkedListAndItems(l, (LinkedListFreeItemFunc)freeCharString);
   return 0;
 }
 
@@ -158,6 +183,7 @@ static int _testLinkedListWithEmptyList(void) {
   LinkedList l = newLinkedList();
   arr = (CharString**)linkedListToArray(l);
   assertIsNull(arr);
+  freeLinkedList(l);
   return 0;
 }
 
@@ -224,11 +250,6 @@ static int _testFreeNullLinkedList(void) {
   return 0;
 }
 
-static int _testFreeNullLinkedList(void) {
-  freeLinkedList(NULL);
-  return 0;
-}
-
 TestSuite addLinkedListTests(void);
 TestSuite addLinkedListTests(void) {
   TestSuite testSuite = newTestSuite("LinkedList", _linkedListTestSetup, NULL);
@@ -242,6 +263,10 @@ TestSuite addLinkedListTests(void) {
   addTest(testSuite, "NumItemsInList", _testNumItemsInList);
   addTest(testSuite, "NumItemsInNullList", _testNumItemsInNullList);
 
+  addTest(testSuite, "ClearList", _testClearList);
+  addTest(testSuite, "AppendItemAfterClear", _testAppendItemAfterClear);
+  addTest(testSuite, "FreeClearedListAndItems", _testFreeClearedListAndItems);
+
   addTest(testSuite, "LinkedListToArray", _testLinkedListToArray);
   addTest(testSuite, "LinkedListToArrayWithNull", _testLinkedListToArrayWithNull);
   addTest(testSuite, "LinkedListWithEmptyList", _testLinkedListWithEmptyList);
@@ -59,6 +59,9 @@ static int _testIsHostLittleEndian(void) {
 }
 
 static int _testFlipShortEndian(void) {
+  assertIntEquals(flipShortEndian(0x0102), 0x0201);
+  assertIntEquals(flipShortEndian((short)0x8001), 0x0180);
+  assertIntEquals(flipShortEndian(0x0180), (short)0x8001);
   return 0;
 }
 
@@ -95,7 +98,7 @@ TestSuite addPlatformUtilitiesTests(void) {
 
   addTest(testSuite, "IsHostLittleEndian", NULL); // _testIsHostLittleEndian);
 
-  addTest(testSuite, "FlipShortEndian", NULL); // _testFlipShortEndian);
+  addTest(testSuite, "FlipShortEndian", _testFlipShortEndian);
   addTest(testSuite, "ConvertBigEndianShortToPlatform", NULL); // _testConvertBigEndianShortToPlatform);
   addTest(testSuite, "ConvertBigEndianIntToPlatform", NULL); // _testConvertBigEndianIntToPlatform);
   addTest(testSuite, "ConvertLittleEndianIntToPlatform", NULL); // _testConvertLittleEndianIntToPlatform);
@@ -0,0 +1,167 @@
+#include "base/RecordQueue.h"
+#include "base/Thread.h"
+#include "unit/TestRunner.h"
+
+#define NUM_PRODUCER_THREADS 4
+#define NUM_ITEMS_PER_PRODUCER 10000
+
+typedef struct {
+  unsigned long producer;
+  unsigned long value;
+} TestRecord;
+
+static boolByte _pushTestRecord(RecordQueue q, const unsigned long producer, const unsigned long value) {
+  TestRecord* record = (TestRecord*)recordQueueReserve(q);
+  if(record == NULL) {
+    return false;
+  }
+  record->producer = producer;
+  record->value = value;
+  recordQueuePublish(q, record);
+  return true;
+}
+
+static int _testNewRecordQueue(void) {
+  RecordQueue q = newRecordQueue(4, sizeof(TestRecord));
+  assertNotNull(q);
+  assertUnsignedLongEquals(q->capacity, 4l);
+  assertUnsignedLongEquals(recordQueueGetNumReserved(q), 0l);
+  assertUnsignedLongEquals(recordQueueGetNumReleased(q), 0l);
+  freeRecordQueue(q);
+  return 0;
+}
+
+static int _testNewRecordQueueInvalidSize(void) {
+  assertIsNull(newRecordQueue(0, sizeof(TestRecord)));
+  assertIsNull(newRecordQueue(4, 0));
+  return 0;
+}
+
+static int _testNewRecordQueueRoundsCapacity(void) {
+  RecordQueue q = newRecordQueue(5, sizeof(TestRecord));
+  assertUnsignedLongEquals(q->capacity, 8l);
+  freeRecordQueue(q);
+  return 0;
+}
+
+static int _testPeekEmptyRecordQueue(void) {
+  RecordQueue q = newRecordQueue(4, sizeof(TestRecord));
+  assertIsNull(recordQueuePeek(q, 0));
+  freeRecordQueue(q);
+  return 0;
+}
+
+static int _testPeekUnpublishedRecord(void) {
+  RecordQueue q = newRecordQueue(4, sizeof(TestRecord));
+  TestRecord* record = (TestRecord*)recordQueueReserve(q);
+
+  assertNotNull(record);
+  assertIsNull(recordQueuePeek(q, 0));
+  recordQueuePublish(q, record);
+  assert(recordQueuePeek(q, 0) == record);
+
+  freeRecordQueue(q);
+  return 0;
+}
+
+static int _testPeekAndReleaseInOrder(void) {
+  RecordQueue q = newRecordQueue(4, sizeof(TestRecord));
+
+  assert(_pushTestRecord(q, 0, 1));
+  assert(_pushTestRecord(q, 0, 2));
+  assert(_pushTestRecord(q, 0, 3));
+  assertUnsignedLongEquals(((TestRecord*)recordQueuePeek(q, 0))->value, 1l);
+  assertUnsignedLongEquals(((TestRecord*)recordQueuePeek(q, 2))->value, 3l);
+  assertIsNull(recordQueuePeek(q, 3));
+  recordQueueRelease(q, 2);
+  assertUnsignedLongEquals(recordQueueGetNumReleased(q), 2l);
+  assertUnsignedLongEquals(((TestRecord*)recordQueuePeek(q, 0))->value, 3l);
+  recordQueueRelease(q, 1);
+  assertIsNull(recordQueuePeek(q, 0));
+
+  freeRecordQueue(q);
+  return 0;
+}
+
+static int _testReserveFullRecordQueue(void) {
+  RecordQueue q = newRecordQueue(2, sizeof(TestRecord));
+
+  assert(_pushTestRecord(q, 0, 1));
+  assert(_pushTestRecord(q, 0, 2));
+  assertFalse(_pushTestRecord(q, 0, 3));
+  assertUnsignedLongEquals(recordQueueGetNumFailedReservations(q), 1l);
+  recordQueueRelease(q, 1);
+  assert(_pushTestRecord(q, 0, 3));
+  assertUnsignedLongEquals(((TestRecord*)recordQueuePeek(q, 0))->value, 2l);
+  assertUnsignedLongEquals(((TestRecord*)recordQueuePeek(q, 1))->value, 3l);
+
+  freeRecordQueue(q);
+  return 0;
+}
+
+typedef struct {
+  RecordQueue q;
+  unsigned long producer;
+} ProducerArguments;
+
+static void* _producerThread(void* argumentsPtr) {
+  ProducerArguments* arguments = (ProducerArguments*)argumentsPtr;
+  unsigned long i;
+  for(i = 0; i < NUM_ITEMS_PER_PRODUCER; i++) {
+    while(!_pushTestRecord(arguments->q, arguments->producer, i)) {
+      threadSleep(0);
+    }
+  }
+  return NULL;
+}
+
+static int _testReserveFromManyThreads(void) {
+  RecordQueue q = newRecordQueue(16, sizeof(TestRecord));
+  ProducerArguments arguments[NUM_PRODUCER_THREADS];
+  Thread threads[NUM_PRODUCER_THREADS];
+  unsigned long nextValues[NUM_PRODUCER_THREADS];
+  unsigned long numReceived = 0;
+  TestRecord* record;
+  int i;
+
+  for(i = 0; i < NUM_PRODUCER_THREADS; i++) {
+    arguments[i].q = q;
+    arguments[i].producer = (unsigned long)i;
+    nextValues[i] = 0;
+    threads[i] = newThread(_producerThread, &arguments[i]);
+    assert(threadStart(threads[i]));
+  }
+
+  // Each producer's records must arrive in the order they were written
+  while(numReceived < NUM_PRODUCER_THREADS * NUM_ITEMS_PER_PRODUCER) {
+    record = (TestRecord*)recordQueuePeek(q, 0);
+    if(record != NULL) {
+      assertUnsignedLongEquals(record->value, nextValues[record->producer]);
+      nextValues[record->producer]++;
+      recordQueueRelease(q, 1);
+      numReceived++;
+    }
+  }
+
+  for(i = 0; i < NUM_PRODUCER_THREADS; i++) {
+    assert(threadJoin(threads[i]));
+    freeThread(threads[i]);
+  }
+  assertIsNull(recordQueuePeek(q, 0));
+  freeRecordQueue(q);
+  return 0;
+}
+
+TestSuite addRecordQueueTests(void);
+TestSuite addRecordQueueTests(void) {
+  TestSuite testSuite = newTestSuite("RecordQueue", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewRecordQueue);
+  addTest(testSuite, "NewObjectInvalidSize", _testNewRecordQueueInvalidSize);
+  addTest(testSuite, "NewObjectRoundsCapacity", _testNewRecordQueueRoundsCapacity);
+  addTest(testSuite, "PeekEmptyRecordQueue", _testPeekEmptyRecordQueue);
+  addTest(testSuite, "PeekUnpublishedRecord", _testPeekUnpublishedRecord);
+  addTest(testSuite, "PeekAndReleaseInOrder", _testPeekAndReleaseInOrder);
+  addTest(testSuite, "ReserveFullRecordQueue", _testReserveFullRecordQueue);
+  addTest(testSuite, "ReserveFromManyThreads", _testReserveFromManyThreads);
+  return testSuite;
+}
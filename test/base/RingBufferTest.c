@@ -0,0 +1,117 @@
+#include "base/RingBuffer.h"
+#include "base/Thread.h"
+#include "unit/TestRunner.h"
+
+#define NUM_THREADED_ITEMS 10000
+
+static int _testNewRingBuffer(void) {
+  RingBuffer r = newRingBuffer(4);
+  assertNotNull(r);
+  assertUnsignedLongEquals(r->capacity, 4l);
+  assertUnsignedLongEquals(ringBufferLength(r), 0l);
+  freeRingBuffer(r);
+  return 0;
+}
+
+static int _testNewRingBufferInvalidCapacity(void) {
+  RingBuffer r = newRingBuffer(0);
+  assertIsNull(r);
+  freeRingBuffer(r);
+  return 0;
+}
+
+static int _testNewRingBufferRoundsCapacity(void) {
+  RingBuffer r = newRingBuffer(5);
+  assertUnsignedLongEquals(r->capacity, 8l);
+  freeRingBuffer(r);
+  return 0;
+}
+
+static int _testPopEmptyRingBuffer(void) {
+  RingBuffer r = newRingBuffer(4);
+  assertIsNull(ringBufferPop(r));
+  freeRingBuffer(r);
+  return 0;
+}
+
+static int _testPushNullItem(void) {
+  RingBuffer r = newRingBuffer(4);
+  assertFalse(ringBufferPush(r, NULL));
+  assertUnsignedLongEquals(ringBufferLength(r), 0l);
+  freeRingBuffer(r);
+  return 0;
+}
+
+static int _testPushAndPopInOrder(void) {
+  RingBuffer r = newRingBuffer(4);
+  int items[3] = {1, 2, 3};
+
+  assert(ringBufferPush(r, &items[0]));
+  assert(ringBufferPush(r, &items[1]));
+  assert(ringBufferPush(r, &items[2]));
+  assertUnsignedLongEquals(ringBufferLength(r), 3l);
+  assert(ringBufferPop(r) == &items[0]);
+  assert(ringBufferPop(r) == &items[1]);
+  assert(ringBufferPop(r) == &items[2]);
+  assertIsNull(ringBufferPop(r));
+
+  freeRingBuffer(r);
+  return 0;
+}
+
+static int _testPushFullRingBuffer(void) {
+  RingBuffer r = newRingBuffer(2);
+  int items[3] = {1, 2, 3};
+
+  assert(ringBufferPush(r, &items[0]));
+  assert(ringBufferPush(r, &items[1]));
+  assertFalse(ringBufferPush(r, &items[2]));
+  assert(ringBufferPop(r) == &items[0]);
+  assert(ringBufferPush(r, &items[2]));
+  assert(ringBufferPop(r) == &items[1]);
+  assert(ringBufferPop(r) == &items[2]);
+
+  freeRingBuffer(r);
+  return 0;
+}
+
+static void* _producerThread(void* ringBufferPtr) {
+  RingBuffer r = (RingBuffer)ringBufferPtr;
+  unsigned long i;
+  // Items are offset by one, since NULL can't be pushed
+  for(i = 1; i <= NUM_THREADED_ITEMS; i++) {
+    ringBufferPushBlocking(r, (void*)i);
+  }
+  return NULL;
+}
+
+static int _testBlockingPushAndPopWithThreads(void) {
+  RingBuffer r = newRingBuffer(4);
+  Thread t = newThread(_producerThread, r);
+  unsigned long i;
+
+  assert(threadStart(t));
+  for(i = 1; i <= NUM_THREADED_ITEMS; i++) {
+    assertUnsignedLongEquals((unsigned long)ringBufferPopBlocking(r), i);
+  }
+  assert(threadJoin(t));
+  assertIsNull(ringBufferPop(r));
+
+  freeThread(t);
+  freeRingBuffer(r);
+  return 0;
+}
+
+TestSuite addRingBufferTests(void);
+TestSuite addRingBufferTests(void) {
+  TestSuite testSuite = newTestSuite("RingBuffer", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewRingBuffer);
+  addTest(testSuite, "NewObjectInvalidCapacity", _testNewRingBufferInvalidCapacity);
+  addTest(testSuite, "NewObjectRoundsCapacity", _testNewRingBufferRoundsCapacity);
+  addTest(testSuite, "PopEmptyRingBuffer", _testPopEmptyRingBuffer);
+  addTest(testSuite, "PushNullItem", _testPushNullItem);
+  addTest(testSuite, "PushAndPopInOrder", _testPushAndPopInOrder);
+  addTest(testSuite, "PushFullRingBuffer", _testPushFullRingBuffer);
+  addTest(testSuite, "BlockingPushAndPopWithThreads", _testBlockingPushAndPopWithThreads);
+  return testSuite;
+}
@@ -0,0 +1,73 @@
+#include "base/ThreadPool.h"
+#include "unit/TestRunner.h"
+
+#define TEST_NUM_TASKS 64
+
+static void _markTask(void* userData, const int taskIndex) {
+  int* results = (int*)userData;
+  results[taskIndex]++;
+}
+
+static int _runAndCheckTasks(ThreadPool t, const int numTasks) {
+  int results[TEST_NUM_TASKS];
+  int expected;
+  int i;
+
+  memset(results, 0, sizeof(results));
+  threadPoolRun(t, _markTask, results, numTasks);
+  // Every task must run exactly once, and all of them must be finished
+  for(i = 0; i < TEST_NUM_TASKS; i++) {
+    expected = i < numTasks ? 1 : 0;
+    assertIntEquals(results[i], expected);
+  }
+  return 0;
+}
+
+static int _testNewThreadPool(void) {
+  ThreadPool t = newThreadPool(2);
+  assertNotNull(t);
+  assertIntEquals(t->numThreads, 2);
+  freeThreadPool(t);
+  return 0;
+}
+
+static int _testRunTasks(void) {
+  ThreadPool t = newThreadPool(3);
+  assertIntEquals(_runAndCheckTasks(t, TEST_NUM_TASKS), 0);
+  freeThreadPool(t);
+  return 0;
+}
+
+static int _testRunManyBatches(void) {
+  ThreadPool t = newThreadPool(3);
+  int i;
+  for(i = 0; i < 1000; i++) {
+    assertIntEquals(_runAndCheckTasks(t, i % 5), 0);
+  }
+  freeThreadPool(t);
+  return 0;
+}
+
+static int _testRunTasksWithoutThreads(void) {
+  ThreadPool t = newThreadPool(0);
+  assertIntEquals(t->numThreads, 0);
+  assertIntEquals(_runAndCheckTasks(t, 8), 0);
+  freeThreadPool(t);
+  return 0;
+}
+
+static int _testFreeNullThreadPool(void) {
+  freeThreadPool(NULL);
+  return 0;
+}
+
+TestSuite addThreadPoolTests(void);
+TestSuite addThreadPoolTests(void) {
+  TestSuite testSuite = newTestSuite("ThreadPool", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewThreadPool);
+  addTest(testSuite, "RunTasks", _testRunTasks);
+  addTest(testSuite, "RunManyBatches", _testRunManyBatches);
+  addTest(testSuite, "RunTasksWithoutThreads", _testRunTasksWithoutThreads);
+  addTest(testSuite, "FreeNullThreadPool", _testFreeNullThreadPool);
+  return testSuite;
+}
@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "io/PcmStream.h"
+#include "unit/TestRunner.h"
+
+#define TEST_STREAM_DATA_SIZE 100000
+
+static void _fillTestData(byte* data, const size_t numBytes) {
+  size_t i;
+  for(i = 0; i < numBytes; i++) {
+    data[i] = (byte)(i % 251);
+  }
+}
+
+static int _testPcmStreamPolicyFromString(void) {
+  assertIntEquals(pcmStreamPolicyFromString("wait"), kPcmStreamPolicyWait);
+  assertIntEquals(pcmStreamPolicyFromString("realtime"), kPcmStreamPolicyRealtime);
+  assertIntEquals(pcmStreamPolicyFromString("invalid"), kNumPcmStreamPolicies);
+  assertIntEquals(pcmStreamPolicyFromString(NULL), kNumPcmStreamPolicies);
+  return 0;
+}
+
+static int _testNewPcmStreamInvalid(void) {
+  assertIsNull(newPcmStream(NULL, SAMPLE_SOURCE_OPEN_READ, 1024, kPcmStreamPolicyWait));
+  assertIsNull(newPcmStream(stdin, SAMPLE_SOURCE_OPEN_NOT_OPENED, 1024, kPcmStreamPolicyWait));
+  assertIsNull(newPcmStream(stdin, SAMPLE_SOURCE_OPEN_READ, 0, kPcmStreamPolicyWait));
+  return 0;
+}
+
+static int _testReadPcmStream(void) {
+  static byte input[TEST_STREAM_DATA_SIZE];
+  static byte output[TEST_STREAM_DATA_SIZE];
+  FILE* file = tmpfile();
+  PcmStream s;
+  size_t numRead = 0;
+  size_t numReadInBlock;
+
+  assertNotNull(file);
+  _fillTestData(input, TEST_STREAM_DATA_SIZE);
+  assertUnsignedLongEquals((unsigned long)fwrite(input, 1, TEST_STREAM_DATA_SIZE, file),
+    (unsigned long)TEST_STREAM_DATA_SIZE);
+  rewind(file);
+
+  s = newPcmStream(file, SAMPLE_SOURCE_OPEN_READ, 4096, kPcmStreamPolicyWait);
+  assertNotNull(s);
+  assert(pcmStreamStart(s));
+  // Read in blocks which do not divide the data size, so the last one is short
+  while((numReadInBlock = pcmStreamRead(s, output + numRead, 4000, 4)) == 4000) {
+    numRead += numReadInBlock;
+  }
+  numRead += numReadInBlock;
+  assertUnsignedLongEquals((unsigned long)numRead, (unsigned long)TEST_STREAM_DATA_SIZE);
+  assertIntEquals(memcmp(input, output, TEST_STREAM_DATA_SIZE), 0);
+  assert(pcmStreamStop(s));
+  assertUnsignedLongEquals(s->numUnderruns, 0l);
+
+  freePcmStream(s);
+  fclose(file);
+  return 0;
+}
+
+static int _testWritePcmStream(void) {
+  static byte input[TEST_STREAM_DATA_SIZE];
+  static byte output[TEST_STREAM_DATA_SIZE];
+  FILE* file = tmpfile();
+  PcmStream s;
+  size_t numWritten;
+  size_t i;
+
+  assertNotNull(file);
+  _fillTestData(input, TEST_STREAM_DATA_SIZE);
+  s = newPcmStream(file, SAMPLE_SOURCE_OPEN_WRITE, 4096, kPcmStreamPolicyWait);
+  assertNotNull(s);
+  assert(pcmStreamStart(s));
+  for(i = 0; i < TEST_STREAM_DATA_SIZE; i += 1000) {
+    numWritten = pcmStreamWrite(s, input + i, 1000);
+    assertUnsignedLongEquals((unsigned long)numWritten, 1000l);
+  }
+  // Stopping must write all data which is still buffered
+  assert(pcmStreamStop(s));
+  assertUnsignedLongEquals(s->numOverruns, 0l);
+
+  rewind(file);
+  assertUnsignedLongEquals((unsigned long)fread(output, 1, TEST_STREAM_DATA_SIZE, file),
+    (unsigned long)TEST_STREAM_DATA_SIZE);
+  assertIntEquals(memcmp(input, output, TEST_STREAM_DATA_SIZE), 0);
+
+  freePcmStream(s);
+  fclose(file);
+  return 0;
+}
+
+static int _testReadPcmStreamRealtimeUnderrun(void) {
+  PcmStream s = newPcmStream(stdin, SAMPLE_SOURCE_OPEN_READ, 64, kPcmStreamPolicyRealtime);
+  const byte input[6] = {1, 2, 3, 4, 5, 6};
+  byte output[8];
+
+  // Without starting the reader thread, only data written here is available
+  s->isPrimed = true;
+  assertUnsignedLongEquals((unsigned long)byteRingBufferWrite(s->ringBuffer, input, 6), 6l);
+  memset(output, 0xff, 8);
+  assertUnsignedLongEquals((unsigned long)pcmStreamRead(s, output, 8, 4), 8l);
+  // Only whole frames are used, the rest is filled with silence
+  assertIntEquals(memcmp(input, output, 4), 0);
+  assertIntEquals(output[4], 0);
+  assertIntEquals(output[7], 0);
+  assertUnsignedLongEquals(s->numUnderruns, 1l);
+  assertUnsignedLongEquals(byteRingBufferGetNumReadable(s->ringBuffer), 2l);
+
+  freePcmStream(s);
+  return 0;
+}
+
+static int _testWritePcmStreamRealtimeOverrun(void) {
+  PcmStream s = newPcmStream(stdout, SAMPLE_SOURCE_OPEN_WRITE, 16, kPcmStreamPolicyRealtime);
+  byte input[12];
+  size_t numWritten;
+
+  _fillTestData(input, 12);
+  // Without starting the writer thread, nothing drains the buffer
+  numWritten = pcmStreamWrite(s, input, 12);
+  assertUnsignedLongEquals((unsigned long)numWritten, 12l);
+  // The second block does not fit, so it is dropped and not counted as written
+  numWritten = pcmStreamWrite(s, input, 12);
+  assertUnsignedLongEquals((unsigned long)numWritten, 0l);
+  assertUnsignedLongEquals(s->numOverruns, 1l);
+  assertUnsignedLongEquals(byteRingBufferGetNumReadable(s->ringBuffer), 12l);
+
+  freePcmStream(s);
+  return 0;
+}
+
+TestSuite addPcmStreamTests(void);
+TestSuite addPcmStreamTests(void) {
+  TestSuite testSuite = newTestSuite("PcmStream", NULL, NULL);
+  addTest(testSuite, "PolicyFromString", _testPcmStreamPolicyFromString);
+  addTest(testSuite, "NewObjectInvalid", _testNewPcmStreamInvalid);
+  addTest(testSuite, "Read", _testReadPcmStream);
+  addTest(testSuite, "Write", _testWritePcmStream);
+  addTest(testSuite, "ReadRealtimeUnderrun", _testReadPcmStreamRealtimeUnderrun);
+  addTest(testSuite, "WriteRealtimeOverrun", _testWritePcmStreamRealtimeOverrun);
+  return testSuite;
+}
@@ -1,7 +1,20 @@
 #include "unit/TestRunner.h"
+#include "audio/AudioSettings.h"
 #include "io/SampleSource.h"
+#include "io/SampleSourceAsync.h"
+#include "io/SampleSourceBuffered.h"
+#include "io/SampleSourcePcm.h"
 
 const char* TEST_SAMPLESOURCE_FILENAME = "test.pcm";
+const char* TEST_SAMPLESOURCE_WAVE_FILENAME = "test.wav";
+
+static void _sampleSourceSetup(void) {
+  initAudioSettings();
+}
+
+static void _sampleSourceTeardown(void) {
+  freeAudioSettings();
+}
 
 static int _testGuessSampleSourceTypePcm(void) {
   CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FILENAME);
@@ -31,12 +44,224 @@ static int _testGuessSampleSourceTypeWrongCase(void) {
   return 0;
 }
 
+static int _testNewSampleSourceAsyncInvalidQueueDepth(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FILENAME);
+  SampleSource s = newSampleSource(SAMPLE_SOURCE_TYPE_PCM, c);
+  assertIsNull(newSampleSourceAsync(s, 0));
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testSampleSourceAsyncWriteAndRead(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FILENAME);
+  SampleSource s = newSampleSourceAsync(newSampleSource(SAMPLE_SOURCE_TYPE_PCM, c), 2);
+  SampleBuffer b = newSampleBuffer(2, 32);
+  const int numBlocks = 10;
+  int i;
+
+  assertIntEquals(s->sampleSourceType, SAMPLE_SOURCE_TYPE_PCM);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  for(i = 0; i < numBlocks; i++) {
+    b->samples[0][0] = (Sample)i / 100.0f;
+    b->samples[1][31] = (Sample)-i / 100.0f;
+    assert(s->writeSampleBlock(s, b));
+  }
+  s->closeSampleSource(s);
+  assertUnsignedLongEquals(s->numSamplesProcessed, (unsigned long)(numBlocks * 2 * 32));
+  assertUnsignedLongEquals((unsigned long)s->numBytesProcessed, (unsigned long)(numBlocks * 2 * 32 * 2));
+  freeSampleSource(s);
+
+  // Blocks must be read back in the same order
+  s = newSampleSourceAsync(newSampleSource(SAMPLE_SOURCE_TYPE_PCM, c), 2);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  for(i = 0; i < numBlocks; i++) {
+    assert(s->readSampleBlock(s, b));
+    assertDoubleEquals(b->samples[0][0], (double)i / 100.0, TEST_FLOAT_TOLERANCE);
+    assertDoubleEquals(b->samples[1][31], (double)-i / 100.0, TEST_FLOAT_TOLERANCE);
+  }
+  assertFalse(s->readSampleBlock(s, b));
+  assertUnsignedLongEquals(b->blocksize, 0l);
+  assertFalse(s->readSampleBlock(s, b));
+  s->closeSampleSource(s);
+  assertUnsignedLongEquals(s->numSamplesProcessed, (unsigned long)(numBlocks * 2 * 32));
+  assertUnsignedLongEquals((unsigned long)s->numBytesProcessed, (unsigned long)(numBlocks * 2 * 32 * 2));
+
+  freeSampleSource(s);
+  freeSampleBuffer(b);
+  unlink(TEST_SAMPLESOURCE_FILENAME);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testNewSampleSourceBufferedInvalidBlocksize(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FILENAME);
+  SampleSource s = newSampleSource(SAMPLE_SOURCE_TYPE_PCM, c);
+  assertIsNull(newSampleSourceBuffered(s, 0));
+  freeSampleSource(s);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testSampleSourceBufferedWriteAndRead(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_FILENAME);
+  SampleSource s = newSampleSourceBuffered(newSampleSource(SAMPLE_SOURCE_TYPE_PCM, c), 100);
+  SampleBuffer b = newSampleBuffer(2, 32);
+  const int numBlocks = 10;
+  const int numFrames = numBlocks * 32;
+  unsigned long frame = 0;
+  unsigned long i;
+
+  assertIntEquals(s->sampleSourceType, SAMPLE_SOURCE_TYPE_PCM);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  while(frame < (unsigned long)numFrames) {
+    for(i = 0; i < b->blocksize; i++) {
+      b->samples[0][i] = (Sample)(frame + i) / 1000.0f;
+      b->samples[1][i] = (Sample)(frame + i) / -1000.0f;
+    }
+    assert(s->writeSampleBlock(s, b));
+    frame += b->blocksize;
+  }
+  // The last chunk is only partly filled, and is written when closing
+  s->closeSampleSource(s);
+  assertUnsignedLongEquals(s->numSamplesProcessed, (unsigned long)(numFrames * 2));
+  assertUnsignedLongEquals((unsigned long)s->numBytesProcessed, (unsigned long)(numFrames * 2 * 2));
+  freeSampleSource(s);
+
+  // Read with a blocksize which does not divide the chunk size or the file size
+  s = newSampleSourceBuffered(newSampleSource(SAMPLE_SOURCE_TYPE_PCM, c), 100);
+  freeSampleBuffer(b);
+  b = newSampleBuffer(2, 48);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  for(frame = 0; frame + 48 <= (unsigned long)numFrames; frame += 48) {
+    assert(s->readSampleBlock(s, b));
+    assertUnsignedLongEquals(b->blocksize, 48l);
+    for(i = 0; i < b->blocksize; i++) {
+      assertDoubleEquals(b->samples[0][i], (double)(frame + i) / 1000.0, 0.0001);
+      assertDoubleEquals(b->samples[1][i], (double)(frame + i) / -1000.0, 0.0001);
+    }
+  }
+  assertFalse(s->readSampleBlock(s, b));
+  assertUnsignedLongEquals(b->blocksize, (unsigned long)numFrames - frame);
+  assertDoubleEquals(b->samples[0][b->blocksize - 1], (double)(numFrames - 1) / 1000.0, 0.0001);
+  b->blocksize = 48;
+  assertFalse(s->readSampleBlock(s, b));
+  assertUnsignedLongEquals(b->blocksize, 0l);
+  s->closeSampleSource(s);
+  assertUnsignedLongEquals(s->numSamplesProcessed, (unsigned long)(numFrames * 2));
+
+  freeSampleSource(s);
+  freeSampleBuffer(b);
+  unlink(TEST_SAMPLESOURCE_FILENAME);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testReadWaveFileMapped(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_WAVE_FILENAME);
+  SampleSource s = newSampleSource(SAMPLE_SOURCE_TYPE_WAVE, c);
+  SampleBuffer b = newSampleBuffer(2, 32);
+  SampleSourcePcmData pcmData;
+  int i;
+
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+  for(i = 0; i < 3; i++) {
+    b->samples[0][0] = (Sample)i / 100.0f;
+    b->samples[1][31] = (Sample)-i / 100.0f;
+    assert(s->writeSampleBlock(s, b));
+  }
+  b->blocksize = 10;
+  b->samples[1][9] = 0.5f;
+  assert(s->writeSampleBlock(s, b));
+  s->closeSampleSource(s);
+  freeSampleSource(s);
+
+  s = newSampleSource(SAMPLE_SOURCE_TYPE_WAVE, c);
+  assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+  pcmData = (SampleSourcePcmData)s->extraData;
+  assertNotNull(pcmData->mappedFile);
+  assertNotNull(pcmData->mappedFile->data);
+
+  b->blocksize = 32;
+  for(i = 0; i < 3; i++) {
+    assert(s->readSampleBlock(s, b));
+    assertDoubleEquals(b->samples[0][0], (double)i / 100.0, TEST_FLOAT_TOLERANCE);
+    assertDoubleEquals(b->samples[1][31], (double)-i / 100.0, TEST_FLOAT_TOLERANCE);
+  }
+  // The last block is short, and nothing past the data chunk may be read as audio
+  assertFalse(s->readSampleBlock(s, b));
+  assertUnsignedLongEquals(b->blocksize, 10l);
+  assertDoubleEquals(b->samples[1][9], 0.5, TEST_FLOAT_TOLERANCE);
+  assertUnsignedLongEquals(s->numSamplesProcessed, (unsigned long)((3 * 32 + 10) * 2));
+  s->closeSampleSource(s);
+
+  freeSampleSource(s);
+  freeSampleBuffer(b);
+  unlink(TEST_SAMPLESOURCE_WAVE_FILENAME);
+  freeCharString(c);
+  return 0;
+}
+
+static int _testWriteAndReadWaveFileAllFormats(void) {
+  CharString c = newCharStringWithCString(TEST_SAMPLESOURCE_WAVE_FILENAME);
+  SampleSource s;
+  SampleBuffer b = newSampleBuffer(2, 32);
+  SampleFormat format;
+  int i;
+
+  for(format = kSampleFormatInt16; format < kNumSampleFormats; format++) {
+    setSampleFormat(format);
+    s = newSampleSource(SAMPLE_SOURCE_TYPE_WAVE, c);
+    assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_WRITE));
+    b->blocksize = 32;
+    for(i = 0; i < 3; i++) {
+      b->samples[0][0] = (Sample)i / 100.0f;
+      b->samples[1][31] = (Sample)-i / 100.0f;
+      assert(s->writeSampleBlock(s, b));
+    }
+    // An odd number of frames, so that 24-bit data needs a padding byte
+    b->blocksize = 7;
+    assert(s->writeSampleBlock(s, b));
+    s->closeSampleSource(s);
+    freeSampleSource(s);
+
+    // Reading must not depend on the output format setting
+    setSampleFormat(kSampleFormatInt16);
+    s = newSampleSource(SAMPLE_SOURCE_TYPE_WAVE, c);
+    assert(s->openSampleSource(s, SAMPLE_SOURCE_OPEN_READ));
+    assertIntEquals((int)((SampleSourcePcmData)s->extraData)->sampleFormat, (int)format);
+    b->blocksize = 32;
+    for(i = 0; i < 3; i++) {
+      assert(s->readSampleBlock(s, b));
+      assertDoubleEquals(b->samples[0][0], (double)i / 100.0, 0.0001);
+      assertDoubleEquals(b->samples[1][31], (double)-i / 100.0, 0.0001);
+    }
+    assertFalse(s->readSampleBlock(s, b));
+    assertUnsignedLongEquals(b->blocksize, 7l);
+    assertUnsignedLongEquals((unsigned long)s->numBytesProcessed,
+      (unsigned long)((3 * 32 + 7) * 2 * sampleFormatGetBytesPerSample(format)));
+    s->closeSampleSource(s);
+    freeSampleSource(s);
+  }
+
+  freeSampleBuffer(b);
+  unlink(TEST_SAMPLESOURCE_WAVE_FILENAME);
+  freeCharString(c);
+  return 0;
+}
+
 TestSuite addSampleSourceTests(void);
 TestSuite addSampleSourceTests(void) {
-  TestSuite testSuite = newTestSuite("SampleSource", NULL, NULL);
+  TestSuite testSuite = newTestSuite("SampleSource", _sampleSourceSetup, _sampleSourceTeardown);
   addTest(testSuite, "GuessSampleSourceTypePcm", _testGuessSampleSourceTypePcm);
   addTest(testSuite, "GuessSampleSourceTypeEmpty", _testGuessSampleSourceTypeEmpty);
   addTest(testSuite, "GuessSampleSourceTypeInvalid", _testGuessSampleSourceTypeInvalid);
   addTest(testSuite, "GuessSampleSourceTypeWrongCase", _testGuessSampleSourceTypeWrongCase);
+  addTest(testSuite, "NewSampleSourceAsyncInvalidQueueDepth", _testNewSampleSourceAsyncInvalidQueueDepth);
+  addTest(testSuite, "SampleSourceAsyncWriteAndRead", _testSampleSourceAsyncWriteAndRead);
+  addTest(testSuite, "NewSampleSourceBufferedInvalidBlocksize", _testNewSampleSourceBufferedInvalidBlocksize);
+  addTest(testSuite, "SampleSourceBufferedWriteAndRead", _testSampleSourceBufferedWriteAndRead);
+  addTest(testSuite, "ReadWaveFileMapped", _testReadWaveFileMapped);
+  addTest(testSuite, "WriteAndReadWaveFileAllFormats", _testWriteAndReadWaveFileAllFormats);
   return testSuite;
 }
@@ -1,8 +1,56 @@
 #include "unit/TestRunner.h"
+#include "audio/AudioSettings.h"
 #include "midi/MidiSource.h"
 
 const char* TEST_MIDI_FILENAME = "test.mid";
 
+static void _midiSourceSetup(void) {
+  initAudioSettings();
+  setSampleRate(44100.0);
+  setTempo(120.0);
+}
+
+static void _midiSourceTeardown(void) {
+  freeAudioSettings();
+}
+
+// Header, conductor track and one note track of a type 1 file with 96 ticks
+// per beat. The conductor starts at 120 BPM and doubles the tempo after one
+// beat, and the note track uses running status for its second event.
+static const byte _testType1MidiFile[] = {
+  'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, 0, 2, 0, 96,
+  'M', 'T', 'r', 'k', 0, 0, 0, 18,
+  0x00, 0xff, 0x51, 0x03, 0x07, 0xa1, 0x20,
+  0x60, 0xff, 0x51, 0x03, 0x03, 0xd0, 0x90,
+  0x00, 0xff, 0x2f, 0x00,
+  'M', 'T', 'r', 'k', 0, 0, 0, 15,
+  0x00, 0x90, 0x3c, 0x64,
+  0x60, 0x3c, 0x00,
+  0x60, 0x90, 0x3e, 0x64,
+  0x00, 0xff, 0x2f, 0x00,
+};
+
+static MidiSequence _readTestMidiFile(const byte* data, size_t dataSize) {
+  CharString c = newCharStringWithCString(TEST_MIDI_FILENAME);
+  MidiSource m = newMidiSource(MIDI_SOURCE_TYPE_FILE, c);
+  MidiSequence s = newMidiSequence();
+  FILE* fp = fopen(TEST_MIDI_FILENAME, "wb");
+  boolByte result;
+
+  fwrite(data, 1, dataSize, fp);
+  fclose(fp);
+  result = (boolByte)(m->openMidiSource(m) && m->readMidiEvents(m, s));
+
+  unlink(TEST_MIDI_FILENAME);
+  freeMidiSource(m);
+  freeCharString(c);
+  if(!result) {
+    freeMidiSequence(s);
+    return NULL;
+  }
+  return s;
+}
+
 static int _testGuessMidiSourceType(void) {
   CharString c = newCharStringWithCString(TEST_MIDI_FILENAME);
   assertIntEquals(guessMidiSourceType(c), MIDI_SOURCE_TYPE_FILE);
@@ -27,11 +75,75 @@ static int _testNewMidiSource(void) {
   return 0;
 }
 
+static int _testReadType1File(void) {
+  MidiSequence s = _readTestMidiFile(_testType1MidiFile, sizeof(_testType1MidiFile));
+  assertNotNull(s);
+  assertUnsignedLongEquals(s->numMidiEvents, 6ul);
+  // The tempo change applies to the note event on the same tick
+  assertIntEquals(s->midiEvents[0].status, MIDI_META_TYPE_TEMPO);
+  assertIntEquals(s->midiEvents[1].status, 0x90);
+  assertUnsignedLongEquals(s->midiEvents[1].timestamp, 0ul);
+  assertIntEquals(s->midiEvents[2].status, MIDI_META_TYPE_TEMPO);
+  assertUnsignedLongEquals(s->midiEvents[2].timestamp, 22050ul);
+  assertIntEquals(s->midiEvents[3].status, 0x90);
+  assertIntEquals(s->midiEvents[3].data1, 0x3c);
+  assertIntEquals(s->midiEvents[3].data2, 0);
+  assertUnsignedLongEquals(s->midiEvents[3].timestamp, 22050ul);
+  // One beat at 240 BPM
+  assertIntEquals(s->midiEvents[4].data1, 0x3e);
+  assertUnsignedLongEquals(s->midiEvents[4].timestamp, 33075ul);
+  freeMidiSequence(s);
+  return 0;
+}
+
+static int _testReadType1FileKeepsLastTrackEnd(void) {
+  MidiSequence s = _readTestMidiFile(_testType1MidiFile, sizeof(_testType1MidiFile));
+  assertNotNull(s);
+  assertIntEquals(s->midiEvents[5].eventType, MIDI_TYPE_META);
+  assertIntEquals(s->midiEvents[5].status, MIDI_META_TYPE_TRACK_END);
+  assertUnsignedLongEquals(s->midiEvents[5].timestamp, 33075ul);
+  freeMidiSequence(s);
+  return 0;
+}
+
+static int _testReadType2FileFails(void) {
+  byte data[sizeof(_testType1MidiFile)];
+  memcpy(data, _testType1MidiFile, sizeof(_testType1MidiFile));
+  data[9] = 2;
+  assertIsNull(_readTestMidiFile(data, sizeof(data)));
+  return 0;
+}
+
+static int _testReadTruncatedTrackFails(void) {
+  byte data[sizeof(_testType1MidiFile)];
+  memcpy(data, _testType1MidiFile, sizeof(_testType1MidiFile));
+  // Cut off the length byte of the note track's end event
+  data[47] = 14;
+  assertIsNull(_readTestMidiFile(data, sizeof(data) - 1));
+  // Cut off the velocity of the last note
+  data[47] = 10;
+  assertIsNull(_readTestMidiFile(data, sizeof(data) - 5));
+  return 0;
+}
+
+static int _testReadTempoEventWithInvalidLengthFails(void) {
+  byte data[sizeof(_testType1MidiFile)];
+  memcpy(data, _testType1MidiFile, sizeof(_testType1MidiFile));
+  data[25] = 2;
+  assertIsNull(_readTestMidiFile(data, sizeof(data)));
+  return 0;
+}
+
 TestSuite addMidiSourceTests(void);
 TestSuite addMidiSourceTests(void) {
-  TestSuite testSuite = newTestSuite("MidiSource", NULL, NULL);
+  TestSuite testSuite = newTestSuite("MidiSource", _midiSourceSetup, _midiSourceTeardown);
   addTest(testSuite, "GuessMidiSourceType", _testGuessMidiSourceType);
   addTest(testSuite, "GuessMidiSourceTypeInvalid", _testGuessMidiSourceTypeInvalid);
   addTest(testSuite, "NewObject", _testNewMidiSource);
+  addTest(testSuite, "ReadType1File", _testReadType1File);
+  addTest(testSuite, "ReadType1FileKeepsLastTrackEnd", _testReadType1FileKeepsLastTrackEnd);
+  addTest(testSuite, "ReadType2FileFails", _testReadType2FileFails);
+  addTest(testSuite, "ReadTruncatedTrackFails", _testReadTruncatedTrackFails);
+  addTest(testSuite, "ReadTempoEventWithInvalidLengthFails", _testReadTempoEventWithInvalidLengthFails);
   return testSuite;
 }
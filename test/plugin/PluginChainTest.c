@@ -1,7 +1,17 @@
 #include "unit/TestRunner.h"
+#include "audio/AudioSettings.h"
 #include "plugin/PluginChain.h"
 #include "plugin/PluginPassthru.h"
 
+// Pipeline stages use the sample rate to find each block's deadline
+static void _pluginChainSetup(void) {
+  initAudioSettings();
+}
+
+static void _pluginChainTeardown(void) {
+  freeAudioSettings();
+}
+
 static int _testNewPluginChain(void) {
   PluginChain p = newPluginChain();
   assertIntEquals(p->numPlugins, 0);
@@ -129,6 +139,89 @@ static int _testAddPluginFromArgumentStringWithPresetSpaces(void) {
   return 0;
 }
 
+static int _testAddManyPluginsFromArgumentString(void) {
+  const int numPlugins = PLUGIN_CHAIN_INITIAL_CAPACITY * 4 + 1;
+  PluginChain p = newPluginChain();
+  CharString testArgs = newCharStringWithCapacity(kCharStringLengthLong);
+  int i;
+
+  for(i = 0; i < numPlugins; i++) {
+    charStringAppendCString(testArgs, i > 0 ? ";mrs_passthru" : "mrs_passthru");
+  }
+  assert(pluginChainAddFromArgumentString(p, testArgs, NULL));
+  assertIntEquals(p->numPlugins, numPlugins);
+  for(i = 0; i < p->numPlugins; i++) {
+    assertCharStringEquals(p->plugins[i]->pluginName, kInternalPluginPassthruName);
+    assertIsNull(p->presets[i]);
+    assertIsNull(p->snapshots[i]);
+  }
+
+  freePluginChain(p);
+  freeCharString(testArgs);
+  return 0;
+}
+
+static int _testAddPluginGroupFromArgumentString(void) {
+  PluginChain p = newPluginChain();
+  CharString testArgs = newCharStringWithCString("mrs_passthru;[mrs_passthru|mrs_passthru;mrs_passthru];mrs_passthru");
+
+  assert(pluginChainAddFromArgumentString(p, testArgs, NULL));
+  assertIntEquals(p->numPlugins, 5);
+  assertIntEquals(p->numGroups, 1);
+  assertIntEquals(p->groups[0]->numBranches, 2);
+  assertIntEquals(p->groups[0]->branchStarts[0], 1);
+  assertIntEquals(p->groups[0]->branchStarts[1], 2);
+  assertIntEquals(p->groups[0]->branchStarts[2], 4);
+
+  freePluginChain(p);
+  freeCharString(testArgs);
+  return 0;
+}
+
+static int _testAddPluginGroupWithEmptyBranchFromArgumentString(void) {
+  PluginChain p = newPluginChain();
+  CharString testArgs = newCharStringWithCString("[|mrs_passthru,testPreset.fxp|]");
+
+  assert(pluginChainAddFromArgumentString(p, testArgs, NULL));
+  assertIntEquals(p->numPlugins, 1);
+  assertNotNull(p->presets[0]);
+  assertIntEquals(p->numGroups, 1);
+  assertIntEquals(p->groups[0]->numBranches, 3);
+  assertIntEquals(p->groups[0]->branchStarts[0], 0);
+  assertIntEquals(p->groups[0]->branchStarts[1], 0);
+  assertIntEquals(p->groups[0]->branchStarts[2], 1);
+  assertIntEquals(p->groups[0]->branchStarts[3], 1);
+
+  freePluginChain(p);
+  freeCharString(testArgs);
+  return 0;
+}
+
+static int _testAddInvalidPluginGroupFromArgumentString(void) {
+  const char* chains[] = {
+    "[mrs_passthru|mrs_passthru",
+    "mrs_passthru]",
+    "mrs_passthru|mrs_passthru",
+    "[[mrs_passthru]]",
+    "mrs_passthru[mrs_passthru]",
+    "[mrs_passthru]mrs_passthru",
+    "[|]"
+  };
+  PluginChain p;
+  CharString testArgs;
+  size_t i;
+
+  for(i = 0; i < sizeof(chains) / sizeof(const char*); i++) {
+    p = newPluginChain();
+    testArgs = newCharStringWithCString(chains[i]);
+    assertFalse(pluginChainAddFromArgumentString(p, testArgs, NULL));
+    assertIntEquals(p->numGroups, 0);
+    freePluginChain(p);
+    freeCharString(testArgs);
+  }
+  return 0;
+}
+
 static int _testGetMaximumTailTime(void) {
   return 0;
 }
@@ -145,9 +238,402 @@ static int _testClosePluginChain(void) {
   return 0;
 }
 
+static PluginChain _newPipelinedPassthruChain(const int numPlugins) {
+  PluginChain p = newPluginChain();
+  CharString testArgs = newCharStringWithCString(kInternalPluginPassthruName);
+  int i;
+
+  for(i = 0; i < numPlugins; i++) {
+    pluginChainAddFromArgumentString(p, testArgs, NULL);
+  }
+  pluginChainInitialize(p);
+  pluginChainPrepareForProcessing(p);
+  freeCharString(testArgs);
+  return p;
+}
+
+static int _testProcessPipelinedPluginChainAudio(void) {
+  PluginChain p = _newPipelinedPassthruChain(3);
+  SampleBuffer inBuffer = newSampleBuffer(2, 64);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+  TaskTimer t = newTaskTimer(p->numPlugins + 1);
+  const int numBlocks = 20;
+  int numBlocksReceived = 0;
+  int i;
+
+  assert(pluginChainStartPipeline(p, 2, 64));
+  for(i = 0; i < numBlocks; i++) {
+    inBuffer->samples[0][0] = (Sample)i;
+    inBuffer->samples[1][63] = (Sample)-i;
+    if(pluginChainProcessAudio(p, inBuffer, outBuffer, t)) {
+      // Blocks must come out in the same order that they were sent
+      assertDoubleEquals(outBuffer->samples[0][0], (double)numBlocksReceived, TEST_FLOAT_TOLERANCE);
+      assertDoubleEquals(outBuffer->samples[1][63], (double)-numBlocksReceived, TEST_FLOAT_TOLERANCE);
+      numBlocksReceived++;
+    }
+  }
+  // Latency should be one block per plugin
+  assertIntEquals(numBlocksReceived, numBlocks - p->numPlugins);
+  while(pluginChainFlushAudio(p, outBuffer, t)) {
+    assertDoubleEquals(outBuffer->samples[0][0], (double)numBlocksReceived, TEST_FLOAT_TOLERANCE);
+    numBlocksReceived++;
+  }
+  assertIntEquals(numBlocksReceived, numBlocks);
+  pluginChainStopPipeline(p, t);
+  assertIsNull(p->pipeline);
+
+  freeTaskTimer(t);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+static int _testProcessPipelinedPluginChainShortBlock(void) {
+  PluginChain p = _newPipelinedPassthruChain(2);
+  SampleBuffer inBuffer = newSampleBuffer(2, 64);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+
+  assert(pluginChainStartPipeline(p, 2, 64));
+  inBuffer->blocksize = 10;
+  assertFalse(pluginChainProcessAudio(p, inBuffer, outBuffer, NULL));
+  assert(pluginChainFlushAudio(p, outBuffer, NULL));
+  assertUnsignedLongEquals(outBuffer->blocksize, 10l);
+  assertFalse(pluginChainFlushAudio(p, outBuffer, NULL));
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+static int _testFlushPluginChainNotPipelined(void) {
+  PluginChain p = _newPipelinedPassthruChain(1);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+
+  assertFalse(pluginChainFlushAudio(p, outBuffer, NULL));
+
+  freeSampleBuffer(outBuffer);
+  freePluginChain(p);
+  return 0;
+}
+
+static int _testResetPluginChainAfterPipeline(void) {
+  PluginChain p = _newPipelinedPassthruChain(2);
+  SampleBuffer inBuffer = newSampleBuffer(2, 64);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+  int i;
+
+  // The chain should be usable again after being reset between input sources
+  for(i = 0; i < 2; i++) {
+    assert(pluginChainStartPipeline(p, 2, 64));
+    inBuffer->samples[0][0] = (Sample)(i + 1);
+    assertFalse(pluginChainProcessAudio(p, inBuffer, outBuffer, NULL));
+    while(pluginChainFlushAudio(p, outBuffer, NULL)) {}
+    assertDoubleEquals(outBuffer->samples[0][0], (double)(i + 1), TEST_FLOAT_TOLERANCE);
+    pluginChainStopPipeline(p, NULL);
+    pluginChainReset(p);
+    assertIntEquals(p->numPlugins, 2);
+  }
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+static int _testTakePluginChainSnapshot(void) {
+  PluginChain p = _newPipelinedPassthruChain(2);
+
+  assert(pluginChainTakeSnapshot(p));
+  assertNotNull(p->snapshots[0]);
+  assertNotNull(p->snapshots[1]);
+  // Taking another snapshot replaces the old ones
+  assert(pluginChainTakeSnapshot(p));
+  assertUnsignedLongEquals(p->snapshots[0]->dataSize, 0l);
+
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+// Gain of the mock plugin below, which is the only state that it has
+static float _mockGain;
+
+static void _mockGainProcessAudio(void* pluginPtr, SampleBuffer inputs, SampleBuffer outputs) {
+  unsigned int i;
+  unsigned long j;
+  for(i = 0; i < outputs->numChannels; i++) {
+    for(j = 0; j < outputs->blocksize; j++) {
+      outputs->samples[i][j] = inputs->samples[i][j] * _mockGain;
+    }
+  }
+}
+
+static void _mockGainSetParameter(void* pluginPtr, int index, float value) {
+  _mockGain = value;
+}
+
+static PluginSnapshot _mockGainTakeSnapshot(void* pluginPtr) {
+  return newPluginSnapshot(&_mockGain, sizeof(_mockGain));
+}
+
+static boolByte _mockGainRestoreSnapshot(void* pluginPtr, const PluginSnapshot snapshot) {
+  memcpy(&_mockGain, snapshot->data, sizeof(_mockGain));
+  return true;
+}
+
+static int _testResetPluginChainRestoresSnapshot(void) {
+  PluginChain p = newPluginChain();
+  CharString pluginName = newCharStringWithCString(kInternalPluginPassthruName);
+  Plugin plugin = newPluginPassthru(pluginName);
+  SampleBuffer inBuffer = newSampleBuffer(2, 64);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+  TaskTimer t = newTaskTimer(2);
+
+  plugin->processAudio = _mockGainProcessAudio;
+  plugin->setParameter = _mockGainSetParameter;
+  plugin->takeSnapshot = _mockGainTakeSnapshot;
+  plugin->restoreSnapshot = _mockGainRestoreSnapshot;
+  assert(pluginChainAppend(p, plugin, NULL));
+  assertIntEquals(pluginChainInitialize(p), RETURN_CODE_SUCCESS);
+  _mockGain = 1.0f;
+  assert(pluginChainTakeSnapshot(p));
+  pluginChainPrepareForProcessing(p);
+
+  plugin->setParameter(plugin, 0, 0.5f);
+  inBuffer->samples[0][0] = 0.8f;
+  assert(pluginChainProcessAudio(p, inBuffer, outBuffer, t));
+  assertDoubleEquals(outBuffer->samples[0][0], 0.4, TEST_FLOAT_TOLERANCE);
+
+  // Changes made while processing the previous input are undone by a reset
+  pluginChainReset(p);
+  inBuffer->samples[0][0] = 0.8f;
+  assert(pluginChainProcessAudio(p, inBuffer, outBuffer, t));
+  assertDoubleEquals(outBuffer->samples[0][0], 0.8, TEST_FLOAT_TOLERANCE);
+
+  freeTaskTimer(t);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freeCharString(pluginName);
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+// Chain of mock gain plugins, where every plugin which isInPlace is true for
+// can process in place
+static PluginChain _newMockGainChain(const char* isInPlace) {
+  PluginChain p = newPluginChain();
+  CharString pluginName = newCharStringWithCString(kInternalPluginPassthruName);
+  Plugin plugin;
+  size_t i;
+
+  for(i = 0; i < strlen(isInPlace); i++) {
+    plugin = newPluginPassthru(pluginName);
+    plugin->processAudio = _mockGainProcessAudio;
+    plugin->canProcessInPlace = (boolByte)(isInPlace[i] == 'y');
+    pluginChainAppend(p, plugin, NULL);
+  }
+  pluginChainInitialize(p);
+  pluginChainPrepareForProcessing(p);
+  freeCharString(pluginName);
+  return p;
+}
+
+static int _testProcessPluginChainAudioWithoutCopies(void) {
+  const char* chains[] = {"n", "nn", "nnn", "nnnn", "yn", "ny", "yyn", "nyy", "yny", "ynyn"};
+  SampleBuffer inBuffer = newSampleBuffer(2, 64);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+  TaskTimer t = newTaskTimer(5);
+  PluginChain p;
+  size_t i;
+
+  _mockGain = 0.5f;
+  for(i = 0; i < sizeof(chains) / sizeof(const char*); i++) {
+    p = _newMockGainChain(chains[i]);
+    inBuffer->samples[1][63] = 1.0f;
+    outBuffer->samples[1][63] = 0.0f;
+    assert(pluginChainProcessAudio(p, inBuffer, outBuffer, t));
+    // Every plugin halves the signal, whichever buffers it was routed through
+    assertDoubleEquals(outBuffer->samples[1][63], pow(0.5, (double)strlen(chains[i])), TEST_FLOAT_TOLERANCE);
+    pluginChainShutdown(p);
+    freePluginChain(p);
+  }
+
+  freeTaskTimer(t);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  return 0;
+}
+
+// Adds the input to the output, so it relies on the host clearing the output
+static void _mockMixProcessAudio(void* pluginPtr, SampleBuffer inputs, SampleBuffer outputs) {
+  unsigned long i;
+  for(i = 0; i < outputs->blocksize; i++) {
+    outputs->samples[0][i] += inputs->samples[0][i];
+  }
+}
+
+static int _testProcessPluginChainAudioClearsOutputs(void) {
+  PluginChain p = _newMockGainChain("nn");
+  SampleBuffer inBuffer = newSampleBuffer(2, 64);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+  TaskTimer t = newTaskTimer(3);
+
+  p->plugins[0]->processAudio = _mockMixProcessAudio;
+  p->plugins[0]->overwritesOutputs = false;
+  p->plugins[1]->processAudio = _mockMixProcessAudio;
+  p->plugins[1]->overwritesOutputs = false;
+  inBuffer->samples[0][0] = 0.25f;
+  outBuffer->samples[0][0] = 1.0f;
+  assert(pluginChainProcessAudio(p, inBuffer, outBuffer, t));
+  assertDoubleEquals(outBuffer->samples[0][0], 0.25, TEST_FLOAT_TOLERANCE);
+
+  freeTaskTimer(t);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+// Copies the first input channel to every output
+static void _mockMonoToStereoProcessAudio(void* pluginPtr, SampleBuffer inputs, SampleBuffer outputs) {
+  unsigned int i;
+  for(i = 0; i < outputs->numChannels; i++) {
+    memcpy(outputs->samples[i], inputs->samples[0], sizeof(Sample) * outputs->blocksize);
+  }
+}
+
+static int _testProcessMonoInputWithStereoPlugins(void) {
+  // With three plugins, the output of the second one is routed into inBuffer
+  PluginChain p = _newMockGainChain("nnn");
+  SampleBuffer inBuffer = newSampleBuffer(1, 64);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+  TaskTimer t = newTaskTimer(4);
+  int i;
+
+  for(i = 0; i < p->numPlugins; i++) {
+    p->plugins[i]->processAudio = _mockMonoToStereoProcessAudio;
+    p->plugins[i]->numInputs = 1;
+    p->plugins[i]->numOutputs = 2;
+  }
+  for(i = 0; i < 2; i++) {
+    inBuffer->samples[0][0] = 0.5f;
+    assert(pluginChainProcessAudio(p, inBuffer, outBuffer, t));
+    // The next block is read into inBuffer with the input source's channel count
+    assertUnsignedLongEquals((unsigned long)inBuffer->numChannels, 1ul);
+    assertUnsignedLongEquals((unsigned long)outBuffer->numChannels, 2ul);
+    assertDoubleEquals(outBuffer->samples[1][0], 0.5, TEST_FLOAT_TOLERANCE);
+  }
+
+  freeTaskTimer(t);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+static PluginChain _newMockGainGroupChain(void) {
+  PluginChain p = newPluginChain();
+  CharString testArgs = newCharStringWithCString("mrs_passthru;[mrs_passthru;mrs_passthru|mrs_passthru|];mrs_passthru");
+  int i;
+
+  pluginChainAddFromArgumentString(p, testArgs, NULL);
+  for(i = 1; i <= 3; i++) {
+    p->plugins[i]->processAudio = _mockGainProcessAudio;
+    p->plugins[i]->canProcessInPlace = false;
+  }
+  pluginChainInitialize(p);
+  pluginChainPrepareForProcessing(p);
+  freeCharString(testArgs);
+  return p;
+}
+
+static int _testProcessPluginChainAudioWithGroup(void) {
+  PluginChain p = _newMockGainGroupChain();
+  SampleBuffer inBuffer = newSampleBuffer(2, 64);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+  TaskTimer t = newTaskTimer(6);
+  int i;
+
+  _mockGain = 0.5f;
+  assertNotNull(p->threadPool);
+  for(i = 0; i < 4; i++) {
+    inBuffer->samples[1][63] = 1.0f;
+    outBuffer->samples[1][63] = 0.0f;
+    assert(pluginChainProcessAudio(p, inBuffer, outBuffer, t));
+    // Branches halve the signal twice, once and not at all, and are then summed
+    assertDoubleEquals(outBuffer->samples[1][63], 1.75, TEST_FLOAT_TOLERANCE);
+  }
+  // Each plugin in the branches is timed once per block under its own task
+  for(i = 1; i <= 3; i++) {
+    assertUnsignedLongEquals(t->taskHistograms[i]->count, 4ul);
+  }
+
+  freeTaskTimer(t);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+static int _testStartPipelineWithGroupFails(void) {
+  PluginChain p = _newMockGainGroupChain();
+
+  assertFalse(pluginChainStartPipeline(p, 2, 64));
+  assertIsNull(p->pipeline);
+
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+static int _testProcessLongPluginChainAudio(void) {
+  const int numPlugins = PLUGIN_CHAIN_INITIAL_CAPACITY * 2 + 1;
+  PluginChain p = newPluginChain();
+  CharString pluginName = newCharStringWithCString(kInternalPluginPassthruName);
+  SampleBuffer inBuffer = newSampleBuffer(2, 64);
+  SampleBuffer outBuffer = newSampleBuffer(2, 64);
+  TaskTimer t;
+  Plugin plugin;
+  int i;
+
+  for(i = 0; i < numPlugins; i++) {
+    plugin = newPluginPassthru(pluginName);
+    plugin->processAudio = _mockGainProcessAudio;
+    assert(pluginChainAppend(p, plugin, NULL));
+  }
+  assertIntEquals(pluginChainInitialize(p), RETURN_CODE_SUCCESS);
+  pluginChainPrepareForProcessing(p);
+  t = newTaskTimer(p->numPlugins + 1);
+
+  _mockGain = 0.5f;
+  inBuffer->samples[0][0] = 1.0f;
+  assert(pluginChainProcessAudio(p, inBuffer, outBuffer, t));
+  assertDoubleEquals(outBuffer->samples[0][0], pow(0.5, numPlugins), TEST_FLOAT_TOLERANCE);
+  for(i = 0; i < numPlugins; i++) {
+    assert(t->isTaskUsedInBlock[i]);
+  }
+
+  freeTaskTimer(t);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freeCharString(pluginName);
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
 TestSuite addPluginChainTests(void);
 TestSuite addPluginChainTests(void) {
-  TestSuite testSuite = newTestSuite("PluginChain", NULL, NULL);
+  TestSuite testSuite = newTestSuite("PluginChain", _pluginChainSetup, _pluginChainTeardown);
   addTest(testSuite, "NewObject", _testNewPluginChain);
   addTest(testSuite, "AddPluginFromArgumentStringNull", _testAddPluginFromArgumentStringNull);
   addTest(testSuite, "AddPluginFromArgumentStringEmpty", _testAddPluginFromArgumentStringEmpty);
@@ -157,9 +643,25 @@ TestSuite addPluginChainTests(void) {
   addTest(testSuite, "AddPluginsFromArgumentString", _testAddPluginsFromArgumentString);
   addTest(testSuite, "AddPluginWithPresetFromArgumentString", _testAddPluginWithPresetFromArgumentString);
   addTest(testSuite, "AddPluginFromArgumentStringWithPresetSpaces", _testAddPluginFromArgumentStringWithPresetSpaces);
+  addTest(testSuite, "AddManyPluginsFromArgumentString", _testAddManyPluginsFromArgumentString);
+  addTest(testSuite, "AddPluginGroupFromArgumentString", _testAddPluginGroupFromArgumentString);
+  addTest(testSuite, "AddPluginGroupWithEmptyBranchFromArgumentString", _testAddPluginGroupWithEmptyBranchFromArgumentString);
+  addTest(testSuite, "AddInvalidPluginGroupFromArgumentString", _testAddInvalidPluginGroupFromArgumentString);
   addTest(testSuite, "GetMaximumTailTime", NULL); // _testGetMaximumTailTime);
   addTest(testSuite, "ProcessPluginChainAudio", NULL); // _testProcessPluginChainAudio);
   addTest(testSuite, "ProcessPluginChainMidiEvents", NULL); // _testProcessPluginChainMidiEvents);
   addTest(testSuite, "ClosePluginChain", NULL); // _testClosePluginChain);
+  addTest(testSuite, "ProcessPipelinedPluginChainAudio", _testProcessPipelinedPluginChainAudio);
+  addTest(testSuite, "ProcessPipelinedPluginChainShortBlock", _testProcessPipelinedPluginChainShortBlock);
+  addTest(testSuite, "FlushPluginChainNotPipelined", _testFlushPluginChainNotPipelined);
+  addTest(testSuite, "ResetPluginChainAfterPipeline", _testResetPluginChainAfterPipeline);
+  addTest(testSuite, "TakePluginChainSnapshot", _testTakePluginChainSnapshot);
+  addTest(testSuite, "ResetPluginChainRestoresSnapshot", _testResetPluginChainRestoresSnapshot);
+  addTest(testSuite, "ProcessPluginChainAudioWithoutCopies", _testProcessPluginChainAudioWithoutCopies);
+  addTest(testSuite, "ProcessPluginChainAudioClearsOutputs", _testProcessPluginChainAudioClearsOutputs);
+  addTest(testSuite, "ProcessMonoInputWithStereoPlugins", _testProcessMonoInputWithStereoPlugins);
+  addTest(testSuite, "ProcessPluginChainAudioWithGroup", _testProcessPluginChainAudioWithGroup);
+  addTest(testSuite, "StartPipelineWithGroupFails", _testStartPipelineWithGroupFails);
+  addTest(testSuite, "ProcessLongPluginChainAudio", _testProcessLongPluginChainAudio);
   return testSuite;
 }
@@ -0,0 +1,306 @@
+#include <stdlib.h>
+
+#include "unit/TestRunner.h"
+#include "audio/AudioSettings.h"
+#include "plugin/PluginChain.h"
+#include "plugin/PluginPassthru.h"
+#include "plugin/PluginSandbox.h"
+
+static void _pluginSandboxSetup(void) {
+  initAudioSettings();
+}
+
+static void _pluginSandboxTeardown(void) {
+  freeAudioSettings();
+}
+
+static Plugin _newPassthruPlugin(void) {
+  CharString pluginName = newCharStringWithCString(kInternalPluginPassthruName);
+  Plugin plugin = newPluginPassthru(pluginName);
+  freeCharString(pluginName);
+  return plugin;
+}
+
+static void _pluginSandboxCrashingProcessAudio(void* pluginPtr, SampleBuffer inputs, SampleBuffer outputs) {
+  abort();
+}
+
+// Set in the sandbox process by the mock plugin below
+static boolByte _isMockMuted = false;
+
+static void _mockMuteProcessAudio(void* pluginPtr, SampleBuffer inputs, SampleBuffer outputs) {
+  if(!_isMockMuted) {
+    sampleBufferCopy(outputs, inputs);
+  }
+}
+
+static void _mockMuteSetParameter(void* pluginPtr, int index, float value) {
+  _isMockMuted = (boolByte)(value > 0.5f);
+}
+
+static PluginSnapshot _mockMuteTakeSnapshot(void* pluginPtr) {
+  return newPluginSnapshot(&_isMockMuted, sizeof(_isMockMuted));
+}
+
+static boolByte _mockMuteRestoreSnapshot(void* pluginPtr, const PluginSnapshot snapshot) {
+  _isMockMuted = *(boolByte*)snapshot->data;
+  return true;
+}
+
+// Names of the mock plugins, which are only known to the test program
+static const char* kMockCrashName = "mock_crash";
+static const char* kMockMuteName = "mock_mute";
+
+/**
+ * Creates the plugins when the test program is started as a sandbox process,
+ * and is also used by the tests so that they get the same mock plugins
+ */
+Plugin newPluginSandboxTestPlugin(PluginInterfaceType interfaceType, const CharString pluginName, const CharString pluginLocation);
+Plugin newPluginSandboxTestPlugin(PluginInterfaceType interfaceType, const CharString pluginName, const CharString pluginLocation) {
+  Plugin plugin;
+
+  if(charStringIsEqualToCString(pluginName, kMockCrashName, false)) {
+    plugin = newPluginPassthru(pluginName);
+    plugin->processAudio = _pluginSandboxCrashingProcessAudio;
+  }
+  else if(charStringIsEqualToCString(pluginName, kMockMuteName, false)) {
+    plugin = newPluginPassthru(pluginName);
+    plugin->processAudio = _mockMuteProcessAudio;
+    plugin->setParameter = _mockMuteSetParameter;
+    plugin->takeSnapshot = _mockMuteTakeSnapshot;
+    plugin->restoreSnapshot = _mockMuteRestoreSnapshot;
+  }
+  else {
+    plugin = newPlugin(interfaceType, pluginName, pluginLocation);
+  }
+  return plugin;
+}
+
+static Plugin _newMockPlugin(const char* name) {
+  CharString pluginName = newCharStringWithCString(name);
+  CharString pluginLocation = newCharString();
+  Plugin plugin = newPluginSandboxTestPlugin(PLUGIN_TYPE_INTERNAL, pluginName, pluginLocation);
+  freeCharString(pluginName);
+  freeCharString(pluginLocation);
+  return plugin;
+}
+
+static SampleBuffer _newRampSampleBuffer(const unsigned long blocksize) {
+  SampleBuffer sampleBuffer = newSampleBuffer(2, blocksize);
+  unsigned long i;
+  for(i = 0; i < blocksize; i++) {
+    sampleBuffer->samples[0][i] = (Sample)i / (Sample)blocksize;
+    sampleBuffer->samples[1][i] = -(Sample)i / (Sample)blocksize;
+  }
+  return sampleBuffer;
+}
+
+static int _testPluginSandboxModeFromString(void) {
+  assertIntEquals(pluginSandboxModeFromString("plugin"), kPluginSandboxModePlugin);
+  assertIntEquals(pluginSandboxModeFromString("chain"), kPluginSandboxModeChain);
+  return 0;
+}
+
+static int _testPluginSandboxModeFromInvalidString(void) {
+  assertIntEquals(pluginSandboxModeFromString("invalid"), kNumPluginSandboxModes);
+  assertIntEquals(pluginSandboxModeFromString(""), kNumPluginSandboxModes);
+  assertIntEquals(pluginSandboxModeFromString(NULL), kNumPluginSandboxModes);
+  return 0;
+}
+
+static int _testNewPluginSandboxProxy(void) {
+  PluginSandbox sandbox = newPluginSandbox();
+  Plugin proxy = newPluginSandboxProxy(sandbox, _newPassthruPlugin(), NULL);
+
+  assertCharStringEquals(proxy->pluginName, kInternalPluginPassthruName);
+  assertIntEquals(proxy->interfaceType, PLUGIN_TYPE_INTERNAL);
+  assertIntEquals(proxy->pluginType, PLUGIN_TYPE_EFFECT);
+  assertIntEquals(sandbox->numPlugins, 1);
+  assertFalse(sandbox->isRunning);
+  assertFalse(pluginSandboxHasCrashed(sandbox));
+
+  freePlugin(proxy);
+  freePluginSandbox(sandbox);
+  return 0;
+}
+
+static int _testProcessAudioInSandbox(void) {
+  PluginSandbox sandbox = newPluginSandbox();
+  Plugin proxy = newPluginSandboxProxy(sandbox, _newPassthruPlugin(), NULL);
+  SampleBuffer inBuffer = _newRampSampleBuffer(getBlocksize());
+  SampleBuffer outBuffer = newSampleBuffer(2, getBlocksize());
+
+  if(!pluginSandboxIsSupported()) {
+    return 0;
+  }
+  assert(proxy->open(proxy));
+  assert(sandbox->isRunning);
+  assertIntEquals(proxy->numInputs, 2);
+  assertIntEquals(proxy->numOutputs, 2);
+  proxy->prepareForProcessing(proxy);
+  proxy->processAudio(proxy, inBuffer, outBuffer);
+  assertDoubleEquals(outBuffer->samples[0][10], inBuffer->samples[0][10], TEST_FLOAT_TOLERANCE);
+  assertDoubleEquals(outBuffer->samples[1][getBlocksize() - 1], inBuffer->samples[1][getBlocksize() - 1], TEST_FLOAT_TOLERANCE);
+  assertIntEquals(proxy->getSetting(proxy, PLUGIN_SETTING_TAIL_TIME_IN_MS), 0);
+  proxy->closePlugin(proxy);
+  assertFalse(pluginSandboxHasCrashed(sandbox));
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freePlugin(proxy);
+  freePluginSandbox(sandbox);
+  return 0;
+}
+
+static int _testProcessAudioLargerThanSharedMemory(void) {
+  PluginSandbox sandbox = newPluginSandbox();
+  Plugin proxy = newPluginSandboxProxy(sandbox, _newPassthruPlugin(), NULL);
+  const unsigned long blocksize = getBlocksize() * 3 + 7;
+  SampleBuffer inBuffer = _newRampSampleBuffer(blocksize);
+  SampleBuffer outBuffer = newSampleBuffer(2, blocksize);
+
+  if(!pluginSandboxIsSupported()) {
+    return 0;
+  }
+  assert(proxy->open(proxy));
+  proxy->processAudio(proxy, inBuffer, outBuffer);
+  assertDoubleEquals(outBuffer->samples[0][getBlocksize() + 1], inBuffer->samples[0][getBlocksize() + 1], TEST_FLOAT_TOLERANCE);
+  assertDoubleEquals(outBuffer->samples[1][blocksize - 1], inBuffer->samples[1][blocksize - 1], TEST_FLOAT_TOLERANCE);
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freePlugin(proxy);
+  freePluginSandbox(sandbox);
+  return 0;
+}
+
+static int _testCrashInSandbox(void) {
+  PluginSandbox sandbox = newPluginSandbox();
+  Plugin proxy = newPluginSandboxProxy(sandbox, _newMockPlugin(kMockCrashName), NULL);
+  SampleBuffer inBuffer = _newRampSampleBuffer(getBlocksize());
+  SampleBuffer outBuffer = _newRampSampleBuffer(getBlocksize());
+
+  if(!pluginSandboxIsSupported()) {
+    return 0;
+  }
+  assert(proxy->open(proxy));
+  proxy->processAudio(proxy, inBuffer, outBuffer);
+  assert(pluginSandboxHasCrashed(sandbox));
+  assertFalse(sandbox->isRunning);
+  // Crashed plugins output silence
+  assertDoubleEquals(outBuffer->samples[0][10], 0.0, TEST_FLOAT_TOLERANCE);
+  assertIntEquals(proxy->getSetting(proxy, PLUGIN_SETTING_TAIL_TIME_IN_MS), 0);
+
+  assert(pluginSandboxRestart(sandbox));
+  assert(sandbox->isRunning);
+  assertFalse(pluginSandboxHasCrashed(sandbox));
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freePlugin(proxy);
+  freePluginSandbox(sandbox);
+  return 0;
+}
+
+static int _testSnapshotInSandbox(void) {
+  PluginSandbox sandbox = newPluginSandbox();
+  Plugin proxy = newPluginSandboxProxy(sandbox, _newMockPlugin(kMockMuteName), NULL);
+  SampleBuffer inBuffer = _newRampSampleBuffer(getBlocksize());
+  SampleBuffer outBuffer = newSampleBuffer(2, getBlocksize());
+  PluginSnapshot snapshot;
+
+  if(!pluginSandboxIsSupported()) {
+    return 0;
+  }
+  assert(proxy->open(proxy));
+  snapshot = proxy->takeSnapshot(proxy);
+  assertNotNull(snapshot);
+  assert(sandbox->isSnapshotTaken[0]);
+
+  proxy->setParameter(proxy, 0, 1.0f);
+  proxy->processAudio(proxy, inBuffer, outBuffer);
+  assertDoubleEquals(outBuffer->samples[0][10], 0.0, TEST_FLOAT_TOLERANCE);
+  assert(proxy->restoreSnapshot(proxy, snapshot));
+  proxy->processAudio(proxy, inBuffer, outBuffer);
+  assertDoubleEquals(outBuffer->samples[0][10], inBuffer->samples[0][10], TEST_FLOAT_TOLERANCE);
+
+  // Snapshots must survive restarting the sandbox
+  pluginSandboxStop(sandbox);
+  assertFalse(proxy->restoreSnapshot(proxy, snapshot));
+  assert(pluginSandboxRestart(sandbox));
+  assert(proxy->restoreSnapshot(proxy, snapshot));
+
+  freePluginSnapshot(snapshot);
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freePlugin(proxy);
+  freePluginSandbox(sandbox);
+  return 0;
+}
+
+static int _testSandboxPluginChain(void) {
+  PluginChain p = newPluginChain();
+  CharString testArgs = newCharStringWithCString("mrs_passthru;mrs_passthru");
+  SampleBuffer inBuffer = _newRampSampleBuffer(getBlocksize());
+  SampleBuffer outBuffer = newSampleBuffer(2, getBlocksize());
+  TaskTimer taskTimer = newTaskTimer(3);
+  Sample expected = inBuffer->samples[0][20];
+
+  if(!pluginSandboxIsSupported()) {
+    return 0;
+  }
+  assert(pluginChainAddFromArgumentString(p, testArgs, NULL));
+  pluginChainSetSandboxMode(p, kPluginSandboxModeChain);
+  assertIntEquals(pluginChainInitialize(p), RETURN_CODE_SUCCESS);
+  assertIntEquals(p->numSandboxes, 1);
+  assertIntEquals(p->sandboxes[0]->numPlugins, 2);
+  pluginChainPrepareForProcessing(p);
+  assert(pluginChainProcessAudio(p, inBuffer, outBuffer, taskTimer));
+  assertDoubleEquals(outBuffer->samples[0][20], expected, TEST_FLOAT_TOLERANCE);
+  assertFalse(pluginChainHasCrashed(p));
+
+  freeSampleBuffer(inBuffer);
+  freeSampleBuffer(outBuffer);
+  freeTaskTimer(taskTimer);
+  freeCharString(testArgs);
+  pluginChainShutdown(p);
+  freePluginChain(p);
+  return 0;
+}
+
+static int _testSandboxEachPluginInChain(void) {
+  PluginChain p = newPluginChain();
+  CharString testArgs = newCharStringWithCString("mrs_passthru;mrs_passthru");
+
+  if(!pluginSandboxIsSupported()) {
+    return 0;
+  }
+  assert(pluginChainAddFromArgumentString(p, testArgs, NULL));
+  pluginChainSetSandboxMode(p, kPluginSandboxModePlugin);
+  assertIntEquals(pluginChainInitialize(p), RETURN_CODE_SUCCESS);
+  assertIntEquals(p->numSandboxes, 2);
+  assert(p->sandboxes[0]->isRunning);
+  assert(p->sandboxes[1]->isRunning);
+
+  freeCharString(testArgs);
+  pluginChainShutdown(p);
+  assertFalse(p->sandboxes[0]->isRunning);
+  assertFalse(pluginChainHasCrashed(p));
+  freePluginChain(p);
+  return 0;
+}
+
+TestSuite addPluginSandboxTests(void);
+TestSuite addPluginSandboxTests(void) {
+  TestSuite testSuite = newTestSuite("PluginSandbox", _pluginSandboxSetup, _pluginSandboxTeardown);
+  addTest(testSuite, "ModeFromString", _testPluginSandboxModeFromString);
+  addTest(testSuite, "ModeFromInvalidString", _testPluginSandboxModeFromInvalidString);
+  addTest(testSuite, "NewProxy", _testNewPluginSandboxProxy);
+  addTest(testSuite, "ProcessAudio", _testProcessAudioInSandbox);
+  addTest(testSuite, "ProcessAudioLargerThanSharedMemory", _testProcessAudioLargerThanSharedMemory);
+  addTest(testSuite, "Crash", _testCrashInSandbox);
+  addTest(testSuite, "Snapshot", _testSnapshotInSandbox);
+  addTest(testSuite, "SandboxPluginChain", _testSandboxPluginChain);
+  addTest(testSuite, "SandboxEachPluginInChain", _testSandboxEachPluginInChain);
+  return testSuite;
+}
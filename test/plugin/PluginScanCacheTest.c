@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <string.h>
+#if UNIX
+#include <unistd.h>
+#endif
+
+#include "unit/TestRunner.h"
+#include "plugin/PluginScanCache.h"
+
+#if UNIX
+#define TEST_CACHE_FILE "/tmp/mrswatsontest-plugincache.txt"
+#define TEST_PLUGIN_LOCATION "/tmp"
+#define TEST_PLUGIN_FILE "/tmp/mrswatsontest-plugin.so"
+#elif WINDOWS
+#define TEST_CACHE_FILE "C:\\Temp\\mrswatsontest-plugincache.txt"
+#define TEST_PLUGIN_LOCATION "C:\\Temp"
+#define TEST_PLUGIN_FILE "C:\\Temp\\mrswatsontest-plugin.dll"
+#else
+#define TEST_CACHE_FILE "mrswatsontest-plugincache.txt"
+#define TEST_PLUGIN_LOCATION "."
+#define TEST_PLUGIN_FILE "mrswatsontest-plugin.so"
+#endif
+
+static void _writeTestFile(const char* filename, const char* contents) {
+  FILE* fp = fopen(filename, "w");
+  if(fp != NULL) {
+    fputs(contents, fp);
+    fclose(fp);
+  }
+}
+
+static void _pluginScanCacheTestTeardown(void) {
+  unlink(TEST_CACHE_FILE);
+  unlink(TEST_PLUGIN_FILE);
+}
+
+static void _addTestPlugin(PluginScanCache c) {
+  CharString pluginName = newCharStringWithCString("mrswatsontest-plugin");
+  CharString pluginRoot = newCharStringWithCString(TEST_PLUGIN_LOCATION);
+  CharString location = newCharStringWithCString(TEST_PLUGIN_LOCATION);
+  CharString absolutePath = newCharStringWithCString(TEST_PLUGIN_FILE);
+  pluginScanCacheAddPlugin(c, pluginName, pluginRoot, location, absolutePath);
+  freeCharString(pluginName);
+  freeCharString(pluginRoot);
+  freeCharString(location);
+  freeCharString(absolutePath);
+}
+
+static boolByte _findTestPlugin(PluginScanCache c) {
+  CharString pluginName = newCharStringWithCString("mrswatsontest-plugin");
+  CharString pluginRoot = newCharStringWithCString(TEST_PLUGIN_LOCATION);
+  CharString location = newCharString();
+  CharString absolutePath = newCharString();
+  boolByte result = pluginScanCacheFindPlugin(c, pluginName, pluginRoot, location, absolutePath);
+  if(result) {
+    result = (boolByte)(!strcmp(location->data, TEST_PLUGIN_LOCATION) && !strcmp(absolutePath->data, TEST_PLUGIN_FILE));
+  }
+  freeCharString(pluginName);
+  freeCharString(pluginRoot);
+  freeCharString(location);
+  freeCharString(absolutePath);
+  return result;
+}
+
+static void _setTestPluginInfo(PluginScanCache c) {
+  CharString absolutePath = newCharStringWithCString(TEST_PLUGIN_FILE);
+  PluginScanInfo info = newPluginScanInfo();
+  info->uniqueId = 1234;
+  info->pluginType = PLUGIN_TYPE_INSTRUMENT;
+  info->numInputs = 0;
+  info->numOutputs = 2;
+  info->tailSizeInFrames = 100;
+  pluginScanInfoAddShellPlugin(info, 5);
+  pluginScanInfoAddShellPlugin(info, 6);
+  pluginScanCacheSetInfo(c, absolutePath, info);
+  freePluginScanInfo(info);
+  freeCharString(absolutePath);
+}
+
+static int _testNewPluginScanCache(void) {
+  PluginScanCache c = newPluginScanCache();
+  assertNotNull(c);
+  assertIntEquals(c->numEntries, 0);
+  assertIntEquals(c->numLookups, 0);
+  assertFalse(c->isModified);
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testLoadMissingFile(void) {
+  PluginScanCache c = newPluginScanCache();
+  CharString filename = newCharStringWithCString(TEST_CACHE_FILE);
+  assert(pluginScanCacheLoad(c, filename));
+  assertIntEquals(c->numEntries, 0);
+  freeCharString(filename);
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testLoadUnknownVersion(void) {
+  PluginScanCache c = newPluginScanCache();
+  CharString filename = newCharStringWithCString(TEST_CACHE_FILE);
+  _writeTestFile(TEST_CACHE_FILE, "# MrsWatson plugin cache, version 999\nplugin\t/a\t1\t1\t0\t0\tunknown\t0\t0\t0\t\n");
+  assert(pluginScanCacheLoad(c, filename));
+  assertIntEquals(c->numEntries, 0);
+  freeCharString(filename);
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testFindPlugin(void) {
+  PluginScanCache c = newPluginScanCache();
+  _writeTestFile(TEST_PLUGIN_FILE, "plugin");
+  assertFalse(_findTestPlugin(c));
+  _addTestPlugin(c);
+  assert(c->isModified);
+  assert(_findTestPlugin(c));
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testFindChangedPlugin(void) {
+  PluginScanCache c = newPluginScanCache();
+  CharString absolutePath = newCharStringWithCString(TEST_PLUGIN_FILE);
+  PluginScanInfo info = newPluginScanInfo();
+
+  _writeTestFile(TEST_PLUGIN_FILE, "plugin");
+  _addTestPlugin(c);
+  _setTestPluginInfo(c);
+  // Changing the size of the file invalidates the cached information
+  _writeTestFile(TEST_PLUGIN_FILE, "new plugin");
+  assertFalse(_findTestPlugin(c));
+  assertFalse(pluginScanCacheGetInfo(c, absolutePath, info));
+  _addTestPlugin(c);
+  assert(_findTestPlugin(c));
+
+  freePluginScanInfo(info);
+  freeCharString(absolutePath);
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testFindRemovedPlugin(void) {
+  PluginScanCache c = newPluginScanCache();
+  _writeTestFile(TEST_PLUGIN_FILE, "plugin");
+  _addTestPlugin(c);
+  unlink(TEST_PLUGIN_FILE);
+  assertFalse(_findTestPlugin(c));
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testSetAndGetInfo(void) {
+  PluginScanCache c = newPluginScanCache();
+  CharString absolutePath = newCharStringWithCString(TEST_PLUGIN_FILE);
+  PluginScanInfo info = newPluginScanInfo();
+
+  _writeTestFile(TEST_PLUGIN_FILE, "plugin");
+  assertFalse(pluginScanCacheGetInfo(c, absolutePath, info));
+  _setTestPluginInfo(c);
+  assert(pluginScanCacheGetInfo(c, absolutePath, info));
+  assertUnsignedLongEquals(info->uniqueId, 1234l);
+  assertIntEquals(info->pluginType, PLUGIN_TYPE_INSTRUMENT);
+  assertIntEquals(info->numOutputs, 2);
+  assertIntEquals(info->tailSizeInFrames, 100);
+  assertIntEquals(info->numShellPlugins, 2);
+  assertUnsignedLongEquals(info->shellPluginIds[1], 6l);
+
+  freePluginScanInfo(info);
+  freeCharString(absolutePath);
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testSetSameInfoDoesNotModify(void) {
+  PluginScanCache c = newPluginScanCache();
+  _writeTestFile(TEST_PLUGIN_FILE, "plugin");
+  _setTestPluginInfo(c);
+  c->isModified = false;
+  _setTestPluginInfo(c);
+  assertFalse(c->isModified);
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testSaveAndLoad(void) {
+  PluginScanCache c = newPluginScanCache();
+  CharString filename = newCharStringWithCString(TEST_CACHE_FILE);
+  CharString absolutePath = newCharStringWithCString(TEST_PLUGIN_FILE);
+  PluginScanInfo info = newPluginScanInfo();
+
+  _writeTestFile(TEST_PLUGIN_FILE, "plugin");
+  _addTestPlugin(c);
+  _setTestPluginInfo(c);
+  assert(pluginScanCacheSave(c, filename));
+  assertFalse(c->isModified);
+  freePluginScanCache(c);
+
+  c = newPluginScanCache();
+  assert(pluginScanCacheLoad(c, filename));
+  assertIntEquals(c->numEntries, 1);
+  assertIntEquals(c->numLookups, 1);
+  assertFalse(c->isModified);
+  assert(_findTestPlugin(c));
+  assert(pluginScanCacheGetInfo(c, absolutePath, info));
+  assertUnsignedLongEquals(info->uniqueId, 1234l);
+  assertIntEquals(info->pluginType, PLUGIN_TYPE_INSTRUMENT);
+  assertIntEquals(info->numShellPlugins, 2);
+  assertUnsignedLongEquals(info->shellPluginIds[0], 5l);
+
+  freePluginScanInfo(info);
+  freeCharString(absolutePath);
+  freeCharString(filename);
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testSaveReplacesFileWithoutPluginRoot(void) {
+  PluginScanCache c = newPluginScanCache();
+  CharString filename = newCharStringWithCString(TEST_CACHE_FILE);
+  CharString pluginName = newCharStringWithCString("mrswatsontest-plugin");
+  CharString location = newCharStringWithCString(TEST_PLUGIN_LOCATION);
+  CharString absolutePath = newCharStringWithCString(TEST_PLUGIN_FILE);
+
+  _writeTestFile(TEST_CACHE_FILE, "old cache contents\n");
+  _writeTestFile(TEST_PLUGIN_FILE, "plugin");
+  pluginScanCacheAddPlugin(c, pluginName, NULL, location, absolutePath);
+  assert(pluginScanCacheSave(c, filename));
+  freePluginScanCache(c);
+
+  c = newPluginScanCache();
+  assert(pluginScanCacheLoad(c, filename));
+  assertIntEquals(c->numLookups, 1);
+  assertCharStringEquals(c->lookups[0]->pluginRoot, "");
+
+  freeCharString(pluginName);
+  freeCharString(location);
+  freeCharString(absolutePath);
+  freeCharString(filename);
+  freePluginScanCache(c);
+  return 0;
+}
+
+static int _testLoadInvalidRecord(void) {
+  PluginScanCache c = newPluginScanCache();
+  CharString filename = newCharStringWithCString(TEST_CACHE_FILE);
+  _writeTestFile(TEST_CACHE_FILE, "# MrsWatson plugin cache, version 1\n"
+    "plugin\t/a\t1\t1\n"
+    "plugin\t/b\t1\t1\t0\t0\tunknown\t0\t0\t0\t\n");
+  assert(pluginScanCacheLoad(c, filename));
+  assertIntEquals(c->numEntries, 1);
+  assert(c->isModified);
+  freeCharString(filename);
+  freePluginScanCache(c);
+  return 0;
+}
+
+TestSuite addPluginScanCacheTests(void);
+TestSuite addPluginScanCacheTests(void) {
+  TestSuite testSuite = newTestSuite("PluginScanCache", NULL, _pluginScanCacheTestTeardown);
+  addTest(testSuite, "NewObject", _testNewPluginScanCache);
+  addTest(testSuite, "LoadMissingFile", _testLoadMissingFile);
+  addTest(testSuite, "LoadUnknownVersion", _testLoadUnknownVersion);
+  addTest(testSuite, "FindPlugin", _testFindPlugin);
+  addTest(testSuite, "FindChangedPlugin", _testFindChangedPlugin);
+  addTest(testSuite, "FindRemovedPlugin", _testFindRemovedPlugin);
+  addTest(testSuite, "SetAndGetInfo", _testSetAndGetInfo);
+  addTest(testSuite, "SetSameInfoDoesNotModify", _testSetSameInfoDoesNotModify);
+  addTest(testSuite, "SaveAndLoad", _testSaveAndLoad);
+  addTest(testSuite, "SaveReplacesFileWithoutPluginRoot", _testSaveReplacesFileWithoutPluginRoot);
+  addTest(testSuite, "LoadInvalidRecord", _testLoadInvalidRecord);
+  return testSuite;
+}
@@ -60,6 +60,34 @@ static int _testAdvanceClockMulitpleTimes(void) {
   return 0;
 }
 
+static int _testRewindAudioClock(void) {
+  AudioClock audioClock = getAudioClock();
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  audioClockRewind(audioClock);
+  assertFalse(audioClock->isPlaying);
+  assertUnsignedLongEquals(audioClock->currentFrame, 0l);
+  advanceAudioClock(audioClock, kAudioClockTestBlocksize);
+  assert(audioClock->isPlaying);
+  assert(audioClock->transportChanged);
+  assertUnsignedLongEquals(audioClock->currentFrame, kAudioClockTestBlocksize);
+  return 0;
+}
+
+static int _testSetThreadAudioClock(void) {
+  AudioClock globalClock = getAudioClock();
+  AudioClock threadClock = newAudioClock();
+  setThreadAudioClock(threadClock);
+  assert(getAudioClock() == threadClock);
+  advanceAudioClock(getAudioClock(), kAudioClockTestBlocksize);
+  setThreadAudioClock(NULL);
+  assert(getAudioClock() == globalClock);
+  assertUnsignedLongEquals(globalClock->currentFrame, 0l);
+  assertUnsignedLongEquals(threadClock->currentFrame, kAudioClockTestBlocksize);
+  freeAudioClock(threadClock);
+  return 0;
+}
+
 TestSuite addAudioClockTests(void);
 TestSuite addAudioClockTests(void) {
   TestSuite testSuite = newTestSuite("AudioClock", _audioClockTestSetup, _audioClockTestTeardown);
@@ -68,5 +96,7 @@ TestSuite addAudioClockTests(void) {
   addTest(testSuite, "StopClock", _testStopAudioClock);
   addTest(testSuite, "RestartClock", _testRestartAudioClock);
   addTest(testSuite, "MultipleAdvance", _testAdvanceClockMulitpleTimes);
+  addTest(testSuite, "RewindClock", _testRewindAudioClock);
+  addTest(testSuite, "SetThreadClock", _testSetThreadAudioClock);
   return testSuite;
 }
@@ -5,7 +5,7 @@
 static int _testNewMidiSequence(void) {
   MidiSequence m = newMidiSequence();
   assertNotNull(m);
-  assertIntEquals(linkedListLength(m->midiEvents), 0);
+  assertUnsignedLongEquals(m->numMidiEvents, 0l);
   freeMidiSequence(m);
   return 0;
 }
@@ -14,7 +14,7 @@ static int _testAppendMidiEventToSequence(void) {
   MidiSequence m = newMidiSequence();
   MidiEvent e = newMidiEvent();
   appendMidiEventToSequence(m, e);
-  assertIntEquals(linkedListLength(m->midiEvents), 1);
+  assertUnsignedLongEquals(m->numMidiEvents, 1l);
   freeMidiSequence(m);
   return 0;
 }
@@ -22,7 +22,7 @@ static int _testAppendMidiEventToSequence(void) {
 static int _testAppendNullMidiEventToSequence(void) {
   MidiSequence m = newMidiSequence();
   appendMidiEventToSequence(m, NULL);
-  assertIntEquals(linkedListLength(m->midiEvents), 0);
+  assertUnsignedLongEquals(m->numMidiEvents, 0l);
   freeMidiSequence(m);
   return 0;
 }
@@ -113,6 +113,86 @@ static int _testFillEventsFromRangePastSequence(void) {
   return 0;
 }
 
+static MidiEvent _newMidiEventAtTime(const unsigned long timestamp, const byte data1) {
+  MidiEvent e = newMidiEvent();
+  e->eventType = MIDI_TYPE_REGULAR;
+  e->status = 0x90;
+  e->data1 = data1;
+  e->timestamp = timestamp;
+  return e;
+}
+
+static int _testAppendManyEventsToSequence(void) {
+  MidiSequence m = newMidiSequence();
+  unsigned long i;
+
+  for(i = 0; i < MIDI_SEQUENCE_INITIAL_CAPACITY * 3; i++) {
+    appendMidiEventToSequence(m, _newMidiEventAtTime(i, (byte)(i % 128)));
+  }
+  assertUnsignedLongEquals(m->numMidiEvents, MIDI_SEQUENCE_INITIAL_CAPACITY * 3l);
+  assertUnsignedLongEquals(m->midiEvents[MIDI_SEQUENCE_INITIAL_CAPACITY * 2].timestamp, MIDI_SEQUENCE_INITIAL_CAPACITY * 2l);
+
+  freeMidiSequence(m);
+  return 0;
+}
+
+static int _testAppendEventsOutOfOrder(void) {
+  MidiSequence m = newMidiSequence();
+
+  appendMidiEventToSequence(m, _newMidiEventAtTime(300, 1));
+  appendMidiEventToSequence(m, _newMidiEventAtTime(100, 2));
+  appendMidiEventToSequence(m, _newMidiEventAtTime(300, 3));
+  appendMidiEventToSequence(m, _newMidiEventAtTime(200, 4));
+  assertUnsignedLongEquals(m->numMidiEvents, 4l);
+  assertIntEquals(m->midiEvents[0].data1, 2);
+  assertIntEquals(m->midiEvents[1].data1, 4);
+  // Events at the same time keep the order they were added in
+  assertIntEquals(m->midiEvents[2].data1, 1);
+  assertIntEquals(m->midiEvents[3].data1, 3);
+
+  freeMidiSequence(m);
+  return 0;
+}
+
+static int _testSeekSequence(void) {
+  MidiSequence m = newMidiSequence();
+  LinkedList l = newLinkedList();
+
+  appendMidiEventToSequence(m, _newMidiEventAtTime(100, 1));
+  appendMidiEventToSequence(m, _newMidiEventAtTime(200, 2));
+  appendMidiEventToSequence(m, _newMidiEventAtTime(200, 3));
+  appendMidiEventToSequence(m, _newMidiEventAtTime(300, 4));
+  midiSequenceSeek(m, 150);
+  assert(fillMidiEventsFromRange(m, 150, 100, l));
+  assertIntEquals(linkedListLength(l), 2);
+  assertIntEquals(((MidiEvent)l->item)->data1, 2);
+  assertUnsignedLongEquals(((MidiEvent)l->item)->deltaFrames, 50l);
+
+  // Seeking backwards plays events again
+  linkedListClear(l);
+  midiSequenceSeek(m, 200);
+  assertFalse(fillMidiEventsFromRange(m, 200, 256, l));
+  assertIntEquals(linkedListLength(l), 3);
+
+  freeMidiSequence(m);
+  freeLinkedList(l);
+  return 0;
+}
+
+static int _testSeekPastSequenceEnd(void) {
+  MidiSequence m = newMidiSequence();
+  LinkedList l = newLinkedList();
+
+  appendMidiEventToSequence(m, _newMidiEventAtTime(100, 1));
+  midiSequenceSeek(m, 101);
+  assertFalse(fillMidiEventsFromRange(m, 101, 256, l));
+  assertIntEquals(linkedListLength(l), 0);
+
+  freeMidiSequence(m);
+  freeLinkedList(l);
+  return 0;
+}
+
 TestSuite addMidiSequenceTests(void);
 TestSuite addMidiSequenceTests(void) {
   TestSuite testSuite = newTestSuite("MidiSequence", NULL, NULL);
@@ -121,10 +201,14 @@ TestSuite addMidiSequenceTests(void) {
   addTest(testSuite, "AppendEvent", _testAppendMidiEventToSequence);
   addTest(testSuite, "AppendNullEvent", _testAppendNullMidiEventToSequence);
   addTest(testSuite, "AppendEventToNullSequence", _testAppendEventToNullSequence);
+  addTest(testSuite, "AppendManyEvents", _testAppendManyEventsToSequence);
+  addTest(testSuite, "AppendEventsOutOfOrder", _testAppendEventsOutOfOrder);
   addTest(testSuite, "FillEventsFromRangeStart", _testFillMidiEventsFromRangeStart);
   addTest(testSuite, "FillEventsFromEmptyRange", _testFillEventsFromEmptyRange);
   addTest(testSuite, "FillEventsSequentially", _testFillEventsSequentially);
   addTest(testSuite, "FillEventsFromRangePastSequenceEnd", _testFillEventsFromRangePastSequence);
+  addTest(testSuite, "Seek", _testSeekSequence);
+  addTest(testSuite, "SeekPastSequenceEnd", _testSeekPastSequenceEnd);
 
   return testSuite;
 }
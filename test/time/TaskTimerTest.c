@@ -113,6 +113,96 @@ static int _testCallStopBeforeStart(void) {
   return 0;
 }
 
+static int _testFinishBlock(void) {
+  TaskTimer t = newTaskTimer(2);
+
+  startTimingTask(t, 0);
+  _testSleep();
+  startTimingTask(t, 1);
+  taskTimerFinishBlock(t, 0.0);
+  assertIntEquals(t->currentTask, 1);
+  assertUnsignedLongEquals(t->taskHistograms[0]->count, 1l);
+  assertUnsignedLongEquals(t->taskHistograms[1]->count, 1l);
+  assertUnsignedLongEquals(t->blockHistogram->count, 1l);
+  assertDoubleEquals((double)t->taskHistograms[0]->max / 1000000.0, SLEEP_DURATION_MS, MAX_TIMER_TOLERANCE_MS);
+
+  // Task 1 is still running, but task 0 was not used in this block
+  _testSleep();
+  stopTiming(t);
+  taskTimerFinishBlock(t, 0.0);
+  assertUnsignedLongEquals(t->taskHistograms[0]->count, 1l);
+  assertUnsignedLongEquals(t->taskHistograms[1]->count, 2l);
+  assertDoubleEquals((double)t->taskHistograms[1]->max / 1000000.0, SLEEP_DURATION_MS, MAX_TIMER_TOLERANCE_MS);
+
+  // Nothing was run in this block
+  taskTimerFinishBlock(t, 0.0);
+  assertUnsignedLongEquals(t->blockHistogram->count, 2l);
+  assertUnsignedLongEquals(t->numMissedBlockDeadlines, 0l);
+
+  freeTaskTimer(t);
+  return 0;
+}
+
+static int _testFinishBlockMissedDeadline(void) {
+  TaskTimer t = newTaskTimer(2);
+
+  startTimingTask(t, 0);
+  _testSleep();
+  stopTiming(t);
+  taskTimerFinishBlock(t, SLEEP_DURATION_MS / 2.0);
+  startTimingTask(t, 1);
+  stopTiming(t);
+  taskTimerFinishBlock(t, SLEEP_DURATION_MS / 2.0);
+  assertUnsignedLongEquals(t->numMissedTaskDeadlines[0], 1l);
+  assertUnsignedLongEquals(t->numMissedTaskDeadlines[1], 0l);
+  assertUnsignedLongEquals(t->numMissedBlockDeadlines, 1l);
+
+  freeTaskTimer(t);
+  return 0;
+}
+
+static int _testMergeTask(void) {
+  TaskTimer t = newTaskTimer(2);
+  TaskTimer other = newTaskTimer(1);
+
+  startTimingTask(other, 0);
+  _testSleep();
+  stopTiming(other);
+  taskTimerFinishBlock(other, SLEEP_DURATION_MS / 2.0);
+  taskTimerMergeTask(t, 1, other, 0);
+  assertDoubleEquals(t->totalTaskTimes[1], other->totalTaskTimes[0], 0.0);
+  assertUnsignedLongEquals(t->taskHistograms[1]->count, 1l);
+  assertUnsignedLongEquals(t->numMissedTaskDeadlines[1], 1l);
+  assertUnsignedLongEquals(t->taskHistograms[0]->count, 0l);
+  assertUnsignedLongEquals(t->blockHistogram->count, 0l);
+
+  taskTimerReset(other);
+  assertDoubleEquals(other->totalTaskTimes[0], 0.0, 0.0);
+  assertUnsignedLongEquals(other->taskHistograms[0]->count, 0l);
+
+  freeTaskTimer(t);
+  freeTaskTimer(other);
+  return 0;
+}
+
+static int _testMerge(void) {
+  TaskTimer t = newTaskTimer(2);
+  TaskTimer other = newTaskTimer(2);
+
+  startTimingTask(other, 1);
+  _testSleep();
+  stopTiming(other);
+  taskTimerFinishBlock(other, SLEEP_DURATION_MS / 2.0);
+  taskTimerMerge(t, other);
+  assertUnsignedLongEquals(t->taskHistograms[1]->count, 1l);
+  assertUnsignedLongEquals(t->blockHistogram->count, 1l);
+  assertUnsignedLongEquals(t->numMissedBlockDeadlines, 1l);
+
+  freeTaskTimer(t);
+  freeTaskTimer(other);
+  return 0;
+}
+
 TestSuite addTaskTimerTests(void);
 TestSuite addTaskTimerTests(void) {
   TestSuite testSuite = newTestSuite("TaskTimer", NULL, NULL);
@@ -123,5 +213,9 @@ TestSuite addTaskTimerTests(void) {
   addTest(testSuite, "CallStopTwice", _testTaskTimerCallStopTwice);
   addTest(testSuite, "CallStartTwice", _testTaskTimerCallStartTwice);
   addTest(testSuite, "CallStopBeforeStart", _testCallStopBeforeStart);
+  addTest(testSuite, "FinishBlock", _testFinishBlock);
+  addTest(testSuite, "FinishBlockMissedDeadline", _testFinishBlockMissedDeadline);
+  addTest(testSuite, "MergeTask", _testMergeTask);
+  addTest(testSuite, "Merge", _testMerge);
   return testSuite;
 }
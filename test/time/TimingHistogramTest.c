@@ -0,0 +1,125 @@
+#include "time/TimingHistogram.h"
+#include "unit/TestRunner.h"
+
+static int _testNewTimingHistogram(void) {
+  TimingHistogram h = newTimingHistogram();
+  assertNotNull(h);
+  assertUnsignedLongEquals(h->count, 0l);
+  assertUnsignedLongEquals((unsigned long)timingHistogramGetPercentile(h, 50.0), 0l);
+  freeTimingHistogram(h);
+  return 0;
+}
+
+static int _testSmallValuesAreExact(void) {
+  TimingHistogram h = newTimingHistogram();
+  unsigned long i;
+
+  for(i = 1; i <= 60; i++) {
+    timingHistogramAdd(h, i);
+  }
+  assertUnsignedLongEquals(h->count, 60l);
+  assertUnsignedLongEquals((unsigned long)h->total, 1830l);
+  assertUnsignedLongEquals((unsigned long)timingHistogramGetPercentile(h, 50.0), 30l);
+  assertUnsignedLongEquals((unsigned long)timingHistogramGetPercentile(h, 0.0), 1l);
+  assertUnsignedLongEquals((unsigned long)timingHistogramGetPercentile(h, 100.0), 60l);
+
+  freeTimingHistogram(h);
+  return 0;
+}
+
+static int _testPercentileRelativeError(void) {
+  TimingHistogram h = newTimingHistogram();
+  unsigned long long percentile;
+  unsigned long i;
+
+  // One value each from 1us to 10ms
+  for(i = 1; i <= 10000; i++) {
+    timingHistogramAdd(h, i * 1000ull);
+  }
+  percentile = timingHistogramGetPercentile(h, 50.0);
+  assert(percentile >= 5000000ull && percentile <= 5000000ull * 33 / 32);
+  percentile = timingHistogramGetPercentile(h, 99.0);
+  assert(percentile >= 9900000ull && percentile <= 9900000ull * 33 / 32);
+  percentile = timingHistogramGetPercentile(h, 99.9);
+  assert(percentile >= 9990000ull && percentile <= 10000000ull);
+  assertUnsignedLongEquals((unsigned long)h->max, 10000000l);
+
+  freeTimingHistogram(h);
+  return 0;
+}
+
+static int _testPercentileNotLargerThanMax(void) {
+  TimingHistogram h = newTimingHistogram();
+  timingHistogramAdd(h, 1000001ull);
+  assertUnsignedLongEquals((unsigned long)timingHistogramGetPercentile(h, 50.0), 1000001l);
+  freeTimingHistogram(h);
+  return 0;
+}
+
+static int _testOutlierIsCounted(void) {
+  TimingHistogram h = newTimingHistogram();
+  int i;
+
+  for(i = 0; i < 999; i++) {
+    timingHistogramAdd(h, 60);
+  }
+  timingHistogramAdd(h, 50000000ull);
+  assertUnsignedLongEquals((unsigned long)timingHistogramGetPercentile(h, 99.0), 60l);
+  assertUnsignedLongEquals((unsigned long)timingHistogramGetPercentile(h, 100.0), 50000000l);
+
+  freeTimingHistogram(h);
+  return 0;
+}
+
+static int _testVeryLongDuration(void) {
+  TimingHistogram h = newTimingHistogram();
+  timingHistogramAdd(h, 0xffffffffffffffffull);
+  assertUnsignedLongEquals(h->count, 1l);
+  assertUnsignedLongEquals(h->buckets[h->numBuckets - 1], 1l);
+  freeTimingHistogram(h);
+  return 0;
+}
+
+static int _testMerge(void) {
+  TimingHistogram h = newTimingHistogram();
+  TimingHistogram other = newTimingHistogram();
+
+  timingHistogramAdd(h, 10);
+  timingHistogramAdd(other, 20);
+  timingHistogramAdd(other, 30);
+  timingHistogramMerge(h, other);
+  assertUnsignedLongEquals(h->count, 3l);
+  assertUnsignedLongEquals((unsigned long)h->total, 60l);
+  assertUnsignedLongEquals((unsigned long)h->max, 30l);
+  assertUnsignedLongEquals((unsigned long)timingHistogramGetPercentile(h, 50.0), 20l);
+  assertUnsignedLongEquals(other->count, 2l);
+
+  freeTimingHistogram(h);
+  freeTimingHistogram(other);
+  return 0;
+}
+
+static int _testClear(void) {
+  TimingHistogram h = newTimingHistogram();
+  timingHistogramAdd(h, 10);
+  timingHistogramClear(h);
+  assertUnsignedLongEquals(h->count, 0l);
+  assertUnsignedLongEquals((unsigned long)h->max, 0l);
+  assertUnsignedLongEquals(h->buckets[10], 0l);
+  freeTimingHistogram(h);
+  return 0;
+}
+
+TestSuite addTimingHistogramTests(void);
+TestSuite addTimingHistogramTests(void) {
+  TestSuite testSuite = newTestSuite("TimingHistogram", NULL, NULL);
+  addTest(testSuite, "NewObject", _testNewTimingHistogram);
+  addTest(testSuite, "SmallValuesAreExact", _testSmallValuesAreExact);
+  addTest(testSuite, "PercentileRelativeError", _testPercentileRelativeError);
+  addTest(testSuite, "PercentileNotLargerThanMax", _testPercentileNotLargerThanMax);
+  addTest(testSuite, "OutlierIsCounted", _testOutlierIsCounted);
+  addTest(testSuite, "VeryLongDuration", _testVeryLongDuration);
+  addTest(testSuite, "Merge", _testMerge);
+  addTest(testSuite, "Clear", _testClear);
+  return testSuite;
+}
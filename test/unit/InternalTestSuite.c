@@ -4,21 +4,34 @@
 
 extern TestSuite addAudioClockTests(void);
 extern TestSuite addAudioSettingsTests(void);
+extern TestSuite addBatchManifestTests(void);
+extern TestSuite addByteRingBufferTests(void);
 extern TestSuite addCharStringTests(void);
 extern TestSuite addFileTests(void);
 extern TestSuite addFileUtilitiesTests(void);
 extern TestSuite addLinkedListTests(void);
 extern TestSuite addMidiSequenceTests(void);
 extern TestSuite addMidiSourceTests(void);
+extern TestSuite addMrsWatsonContextTests(void);
+extern TestSuite addMrsWatsonRendererTests(void);
+extern TestSuite addPcmStreamTests(void);
 extern TestSuite addPlatformUtilitiesTests(void);
 extern TestSuite addPluginTests(void);
 extern TestSuite addPluginChainTests(void);
 extern TestSuite addPluginPresetTests(void);
+extern TestSuite addPluginSandboxTests(void);
+extern TestSuite addPluginScanCacheTests(void);
 extern TestSuite addProgramOptionTests(void);
+extern TestSuite addRecordQueueTests(void);
+extern TestSuite addRingBufferTests(void);
+extern TestSuite addRunStatisticsTests(void);
 extern TestSuite addSampleBufferTests(void);
+extern TestSuite addSampleConversionTests(void);
 extern TestSuite addSampleSourceTests(void);
 extern TestSuite addStringUtilitiesTests(void);
 extern TestSuite addTaskTimerTests(void);
+extern TestSuite addThreadPoolTests(void);
+extern TestSuite addTimingHistogramTests(void);
 
 extern TestSuite addAnalysisClippingTests(void);
 extern TestSuite addAnalysisDistortionTests(void);
@@ -37,6 +50,8 @@ static LinkedList _getTestSuites(void) {
   LinkedList internalTestSuites = newLinkedList();
   linkedListAppend(internalTestSuites, addAudioClockTests());
   linkedListAppend(internalTestSuites, addAudioSettingsTests());
+  linkedListAppend(internalTestSuites, addBatchManifestTests());
+  linkedListAppend(internalTestSuites, addByteRingBufferTests());
   linkedListAppend(internalTestSuites, addCharStringTests());
 #if USE_NEW_FILE_API
   linkedListAppend(internalTestSuites, addFileTests());
@@ -45,15 +60,26 @@ static LinkedList _getTestSuites(void) {
   linkedListAppend(internalTestSuites, addLinkedListTests());
   linkedListAppend(internalTestSuites, addMidiSequenceTests());
   linkedListAppend(internalTestSuites, addMidiSourceTests());
+  linkedListAppend(internalTestSuites, addMrsWatsonContextTests());
+  linkedListAppend(internalTestSuites, addMrsWatsonRendererTests());
+  linkedListAppend(internalTestSuites, addPcmStreamTests());
   linkedListAppend(internalTestSuites, addPlatformUtilitiesTests());
   linkedListAppend(internalTestSuites, addPluginTests());
   linkedListAppend(internalTestSuites, addPluginChainTests());
   linkedListAppend(internalTestSuites, addPluginPresetTests());
+  linkedListAppend(internalTestSuites, addPluginSandboxTests());
+  linkedListAppend(internalTestSuites, addPluginScanCacheTests());
   linkedListAppend(internalTestSuites, addProgramOptionTests());
+  linkedListAppend(internalTestSuites, addRecordQueueTests());
+  linkedListAppend(internalTestSuites, addRingBufferTests());
+  linkedListAppend(internalTestSuites, addRunStatisticsTests());
   linkedListAppend(internalTestSuites, addSampleBufferTests());
+  linkedListAppend(internalTestSuites, addSampleConversionTests());
   linkedListAppend(internalTestSuites, addSampleSourceTests());
   linkedListAppend(internalTestSuites, addStringUtilitiesTests());
   linkedListAppend(internalTestSuites, addTaskTimerTests());
+  linkedListAppend(internalTestSuites, addThreadPoolTests());
+  linkedListAppend(internalTestSuites, addTimingHistogramTests());
 
   linkedListAppend(internalTestSuites, addAnalysisClippingTests());
   linkedListAppend(internalTestSuites, addAnalysisDistortionTests());